@@ -16,15 +16,61 @@
 #include "MRM.h"
 
 #include <memory>
+#include <string>
 
 using namespace Microsoft::Resources;
 
+// A resolution snapshot holds the winning candidate of every decision in the primary resource map for one PRI
+// file and one set of qualifier values, in the format used by ResolverBase::GetDecisionTable.
+constexpr UINT32 c_snapshotMagic = 0x6e73726d; // "mrsn"
+constexpr UINT16 c_snapshotMajorVersion = 2;
+
+// Identifies the PRI file and qualifier values that a snapshot was taken for. priChecksum only covers the file
+// header and table of contents.
+typedef struct
+{
+    UINT64 priFileSize;
+    UINT64 priLastWriteTime;
+    DEF_CHECKSUM priChecksum;
+    DEF_CHECKSUM qualifierChecksum;
+} MrmSnapshotKey;
+
+typedef struct
+{
+    UINT32 magic;
+    UINT16 majorVersion;
+    UINT16 minorVersion;
+    UINT64 priFileSize;
+    UINT64 priLastWriteTime;
+    DEF_CHECKSUM priChecksum;
+    DEF_CHECKSUM qualifierChecksum;
+    DEF_CHECKSUM entriesChecksum;
+    UINT32 numEntries;
+} MrmSnapshotHeader;
+
 typedef struct
 {
     CoreProfile* profile = nullptr;
     UnifiedResourceView* unifiedView = nullptr;
     const PriFile* priFile = nullptr;
     ProviderResolver* resolver = nullptr;
+
+    // Resolution snapshot in use by the resolver, if any. Released after the resolver.
+    wil::unique_handle snapshotMapping;
+    wil::unique_mapview_ptr<void> snapshotView;
+
+    // Entries of that snapshot, and the qualifier values they were resolved for, so that new resource contexts
+    // can use them too.
+    const UINT16* snapshotEntries = nullptr;
+    UINT32 numSnapshotEntries = 0;
+    DEF_CHECKSUM snapshotQualifierChecksum = 0;
+
+    // Writes a new snapshot in the background when there was no usable one. Destroying the resource manager
+    // waits for it before releasing anything else.
+    PTP_WORK snapshotWork = nullptr;
+    std::wstring snapshotFileName;
+    MrmSnapshotKey snapshotKey = {};
+    UINT32 numSnapshotEntriesToWrite = 0;
 } MrmObjects;
 
 constexpr wchar_t ResourceUriPrefix[] = L"ms-resource://";
@@ -46,6 +92,35 @@ static HRESULT StringResultReleaseOwnershipBuffer(_Inout_ StringResult& result,
     return S_OK;
 }
 
+static HRESULT StringResultGetView(
+    _Inout_ StringResult& result,
+    _Out_ MrmStringView* view,
+    _Outptr_result_maybenull_ PWSTR* buffer)
+{
+    view->length = 0;
+    view->data = nullptr;
+    *buffer = nullptr;
+
+    size_t length;
+    RETURN_IF_FAILED(result.GetLength(&length));
+    RETURN_IF_FAILED(SizeTToUInt32(length, &view->length));
+
+    if (result.GetType() == DefResultType_Reference)
+    {
+        // UTF-16 values refer directly to the PRI file, which outlives any lookup. No copy is needed.
+        view->data = result.GetRef();
+    }
+    else
+    {
+        // The value was built during the lookup (e.g. decoded from UTF-8 or combined with the package root).
+        // The result already owns it, so releasing it to the caller doesn't copy it either.
+        RETURN_IF_FAILED(StringResultReleaseOwnershipBuffer(result, buffer));
+        view->data = *buffer;
+    }
+
+    return S_OK;
+}
+
 static HRESULT BlobResultReleaseOwnershipBuffer(
     _Inout_ BlobResult& result,
     _Outptr_result_bytebuffer_(*releasedBufferSizeInBytes) void** releasedBuffer,
@@ -333,7 +408,8 @@ static HRESULT LoadStringResource(
     _In_opt_ void* resourceMap,
     int index,
     _In_opt_ PCWSTR resourceIdOrUri,
-    _Outptr_ PWSTR* resourceString)
+    _Outptr_result_maybenull_ PWSTR* resourceString,
+    _Out_opt_ MrmStringView* resourceView)
 {
     ResourceCandidateResult candidate;
     RETURN_IF_FAILED_WITH_EXPECTED(LoadResourceCandidate(resourceManager, resourceContext, resourceMap, index, resourceIdOrUri, &candidate, nullptr, nullptr, nullptr, nullptr),
@@ -345,12 +421,210 @@ static HRESULT LoadStringResource(
         return HRESULT_FROM_WIN32(ERROR_MRM_RESOURCE_TYPE_MISMATCH);
     }
 
-    // This ensures the string result holds a copy of the data we can return to the caller, not a pointer to the PRI file.
-    RETURN_IF_FAILED(StringResultReleaseOwnershipBuffer(stringResult, resourceString));
+    if (resourceView != nullptr)
+    {
+        RETURN_IF_FAILED(StringResultGetView(stringResult, resourceView, resourceString));
+    }
+    else
+    {
+        // This ensures the string result holds a copy of the data we can return to the caller, not a pointer to the PRI file.
+        RETURN_IF_FAILED(StringResultReleaseOwnershipBuffer(stringResult, resourceString));
+    }
 
     return S_OK;
 }
 
+struct BatchStringEntry : public DefObject
+{
+    NamedResourceResult namedResource;
+    DecisionResult decision;
+    StringResult value;
+    int decisionIndex;
+    HRESULT hr;
+};
+
+static HRESULT GetBatchStringValue(
+    _In_ const ProviderResolver* resolver,
+    _Inout_ BatchStringEntry* entry,
+    int resultIndex,
+    int resultSetIndex,
+    _Out_ size_t* valueSizeInBytes)
+{
+    *valueSizeInBytes = 0;
+
+    QualifierSetResult qualifierSet;
+    RETURN_IF_FAILED(resolver->GetDecisions()->GetQualifierSet(resultSetIndex, &qualifierSet));
+
+    bool isMatch, isDefault, isMatchAsDefault;
+    RETURN_IF_FAILED(resolver->EvaluateQualifierSet(&qualifierSet, &isMatch, &isDefault, &isMatchAsDefault, nullptr));
+
+    if (!isMatch && !isDefault)
+    {
+        return HRESULT_FROM_WIN32(ERROR_MRM_NO_MATCH_OR_DEFAULT_CANDIDATE);
+    }
+
+    ResourceCandidateResult candidate;
+    RETURN_IF_FAILED(entry->namedResource.GetCandidate(resultIndex, &candidate));
+
+    if (!candidate.TryGetStringValue(&entry->value))
+    {
+        return HRESULT_FROM_WIN32(ERROR_MRM_RESOURCE_TYPE_MISMATCH);
+    }
+
+    size_t length;
+    RETURN_IF_FAILED(entry->value.GetLength(&length));
+    RETURN_IF_FAILED(SizeTAdd(length, 1, &length));
+    RETURN_IF_FAILED(SizeTMult(length, sizeof(wchar_t), valueSizeInBytes));
+
+    return S_OK;
+}
+
+static HRESULT LoadStringResources(
+    _In_ void* resourceManager,
+    _In_opt_ void* resourceContext,
+    _In_opt_ void* resourceMap,
+    UINT32 resourceIdCount,
+    _In_reads_(resourceIdCount) PCWSTR* resourceIds,
+    _Outptr_result_buffer_(resourceIdCount) PWSTR** resourceStrings,
+    _Out_writes_opt_(resourceIdCount) HRESULT* resourceResults)
+{
+    *resourceStrings = nullptr;
+
+    RETURN_HR_IF(E_INVALIDARG, (resourceIdCount == 0) || (resourceIdCount > INT_MAX) || (resourceIds == nullptr));
+
+    MrmObjects* resourceManagerObjects = reinterpret_cast<MrmObjects*>(resourceManager);
+
+    const ProviderResolver* resolver;
+    if (resourceContext == nullptr)
+    {
+        resolver = resourceManagerObjects->resolver;
+    }
+    else
+    {
+        resolver = reinterpret_cast<ProviderResolver*>(resourceContext);
+    }
+
+    const ResourceMapSubtree* internalResourceMap;
+    if (resourceMap == nullptr)
+    {
+        // The primary resource map is the default.
+        const IResourceMapBase* primaryMap;
+        RETURN_IF_FAILED(resourceManagerObjects->priFile->GetPrimaryResourceMap(&primaryMap));
+        internalResourceMap = primaryMap->GetRootSubtree();
+    }
+    else
+    {
+        // Use the supplied resource map.
+        internalResourceMap = reinterpret_cast<ResourceMapSubtree*>(resourceMap);
+    }
+
+    std::unique_ptr<BatchStringEntry[]> entries(new (std::nothrow) BatchStringEntry[resourceIdCount]);
+    RETURN_IF_NULL_ALLOC(entries);
+
+    std::unique_ptr<const IDecision*[]> decisions(new (std::nothrow) const IDecision*[resourceIdCount]);
+    RETURN_IF_NULL_ALLOC(decisions);
+
+    std::unique_ptr<int[]> resultIndexes(new (std::nothrow) int[resourceIdCount]);
+    RETURN_IF_NULL_ALLOC(resultIndexes);
+
+    std::unique_ptr<int[]> resultSetIndexes(new (std::nothrow) int[resourceIdCount]);
+    RETURN_IF_NULL_ALLOC(resultSetIndexes);
+
+    // With per-id results, a decision that fails to resolve only fails its own resource.
+    std::unique_ptr<HRESULT[]> decisionResults;
+    if (resourceResults != nullptr)
+    {
+        decisionResults.reset(new (std::nothrow) HRESULT[resourceIdCount]);
+        RETURN_IF_NULL_ALLOC(decisionResults);
+    }
+
+    // Find every named resource first so that all of the decisions can be evaluated as one batch.
+    int numDecisions = 0;
+    for (UINT32 i = 0; i < resourceIdCount; i++)
+    {
+        BatchStringEntry& entry = entries[i];
+
+        entry.hr = (resourceIds[i] != nullptr) ? internalResourceMap->GetResource(resourceIds[i], &entry.namedResource) : E_INVALIDARG;
+        if (SUCCEEDED(entry.hr))
+        {
+            entry.hr = entry.namedResource.GetDecision(&entry.decision);
+        }
+
+        if (SUCCEEDED(entry.hr))
+        {
+            entry.decisionIndex = numDecisions;
+            decisions[numDecisions++] = &entry.decision;
+        }
+        else if (resourceResults == nullptr)
+        {
+            return entry.hr;
+        }
+    }
+
+    RETURN_IF_FAILED(
+        resolver->EvaluateDecisions(numDecisions, decisions.get(), resultIndexes.get(), resultSetIndexes.get(), decisionResults.get()));
+
+    // The returned buffer holds the string pointers followed by the string data.
+    size_t bufferSize;
+    RETURN_IF_FAILED(SizeTMult(resourceIdCount, sizeof(**resourceStrings), &bufferSize));
+
+    for (UINT32 i = 0; i < resourceIdCount; i++)
+    {
+        BatchStringEntry& entry = entries[i];
+        if (FAILED(entry.hr))
+        {
+            continue;
+        }
+
+        size_t valueSize;
+        entry.hr = (decisionResults != nullptr) ? decisionResults[entry.decisionIndex] : S_OK;
+        if (SUCCEEDED(entry.hr))
+        {
+            entry.hr = GetBatchStringValue(
+                resolver, &entry, resultIndexes[entry.decisionIndex], resultSetIndexes[entry.decisionIndex], &valueSize);
+        }
+
+        if (SUCCEEDED(entry.hr))
+        {
+            RETURN_IF_FAILED(SizeTAdd(bufferSize, valueSize, &bufferSize));
+        }
+        else if (resourceResults == nullptr)
+        {
+            return entry.hr;
+        }
+    }
+
+    PWSTR* stringTable = reinterpret_cast<PWSTR*>(MrmAllocateBuffer(bufferSize));
+    RETURN_IF_NULL_ALLOC(stringTable);
+
+    PWSTR nextString = reinterpret_cast<PWSTR>(stringTable + resourceIdCount);
+    for (UINT32 i = 0; i < resourceIdCount; i++)
+    {
+        BatchStringEntry& entry = entries[i];
+        if (SUCCEEDED(entry.hr))
+        {
+            size_t length = entry.value.GetLength();
+            memcpy(nextString, entry.value.GetRef(), length * sizeof(wchar_t));
+            nextString[length] = L'\0';
+
+            stringTable[i] = nextString;
+            nextString += length + 1;
+        }
+        else
+        {
+            stringTable[i] = nullptr;
+        }
+
+        if (resourceResults != nullptr)
+        {
+            resourceResults[i] = entry.hr;
+        }
+    }
+
+    *resourceStrings = stringTable;
+    return S_OK;
+}
+
 static HRESULT LoadEmbeddedResource(
     _In_ void* resourceManager,
     _In_opt_ void* resourceContext,
@@ -386,6 +660,7 @@ static HRESULT LoadStringOrEmbeddedResource(
     _In_opt_ PCWSTR resourceIdOrUri,
     _Out_ MrmType* resourceType,
     _Outptr_result_maybenull_ PWSTR* resourceString,
+    _Out_opt_ MrmStringView* resourceView,
     _Out_ MrmResourceData* data,
     _Outptr_opt_result_maybenull_ PWSTR* resourceName,
     _Out_opt_ UINT32* qualifierCount, 
@@ -395,6 +670,12 @@ static HRESULT LoadStringOrEmbeddedResource(
     data->data = nullptr;
     data->size = 0;
 
+    if (resourceView != nullptr)
+    {
+        resourceView->length = 0;
+        resourceView->data = nullptr;
+    }
+
     ResourceCandidateResult candidate;
     PWSTR localName = nullptr;
     RETURN_IF_FAILED_WITH_EXPECTED(LoadResourceCandidate(
@@ -436,8 +717,15 @@ static HRESULT LoadStringOrEmbeddedResource(
             return E_UNEXPECTED;
         }
 
-        // This ensures the string result holds a copy of the data we can return to the caller, not a pointer to the PRI file.
-        RETURN_IF_FAILED(StringResultReleaseOwnershipBuffer(stringResult, resourceString));
+        if (resourceView != nullptr)
+        {
+            RETURN_IF_FAILED(StringResultGetView(stringResult, resourceView, resourceString));
+        }
+        else
+        {
+            // This ensures the string result holds a copy of the data we can return to the caller, not a pointer to the PRI file.
+            RETURN_IF_FAILED(StringResultReleaseOwnershipBuffer(stringResult, resourceString));
+        }
 
         if (MrmEnvironment::IsStringResourceValueType(internalResourceType))
         {
@@ -465,6 +753,13 @@ static void DestroyResourceManager(_In_ void* resourceManager)
 {
     MrmObjects* resourceManagerObjects = reinterpret_cast<MrmObjects*>(resourceManager);
 
+    if (resourceManagerObjects->snapshotWork != nullptr)
+    {
+        WaitForThreadpoolWorkCallbacks(resourceManagerObjects->snapshotWork, FALSE);
+        CloseThreadpoolWork(resourceManagerObjects->snapshotWork);
+        resourceManagerObjects->snapshotWork = nullptr;
+    }
+
     if (resourceManagerObjects->profile != nullptr)
     {
         delete resourceManagerObjects->profile;
@@ -488,7 +783,189 @@ static void DestroyResourceManager(_In_ void* resourceManager)
     return;
 }
 
-STDAPI MrmCreateResourceManager(_In_ PCWSTR priFileName, _Out_ MrmManagerHandle* resourceManager)
+static HRESULT ComputeSnapshotKey(_In_ const MrmObjects* resourceManagerObjects, _In_ PCWSTR priFilePath, _Out_ MrmSnapshotKey* key)
+{
+    *key = {};
+
+    WIN32_FILE_ATTRIBUTE_DATA attributes;
+    RETURN_IF_WIN32_BOOL_FALSE(GetFileAttributesExW(priFilePath, GetFileExInfoStandard, &attributes));
+    key->priFileSize = (static_cast<UINT64>(attributes.nFileSizeHigh) << 32) | attributes.nFileSizeLow;
+    key->priLastWriteTime =
+        (static_cast<UINT64>(attributes.ftLastWriteTime.dwHighDateTime) << 32) | attributes.ftLastWriteTime.dwLowDateTime;
+
+    // The size and time stamp catch a rebuilt PRI file. Only the header and table of contents are checksummed on top
+    // of that, because checksumming the whole file on every start would cost more than the snapshot saves.
+    const BaseFile* baseFile;
+    RETURN_IF_FAILED(resourceManagerObjects->priFile->GetBaseFile(&baseFile));
+
+    const DEFFILE_HEADER* fileHeader = baseFile->GetFileHeader();
+    size_t cbHeaderAndToc = fileHeader->tocOffset + (static_cast<size_t>(fileHeader->sizeToc) * sizeof(DEFFILE_TOC_ENTRY));
+    RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), cbHeaderAndToc > baseFile->GetFileSizeInBytes());
+    key->priChecksum = DefChecksum::ComputeChecksum(0, reinterpret_cast<const BYTE*>(fileHeader), static_cast<UINT32>(cbHeaderAndToc));
+
+    RETURN_IF_FAILED(resourceManagerObjects->resolver->ComputeQualifierChecksum(&key->qualifierChecksum));
+    return S_OK;
+}
+
+// Maps the snapshot and hands its entries to the resolver if it matches. Returns S_FALSE if there is no usable snapshot.
+static HRESULT TryUseSnapshot(
+    _Inout_ MrmObjects* resourceManagerObjects,
+    _In_ PCWSTR snapshotFileName,
+    _In_ const MrmSnapshotKey& key,
+    _In_ UINT32 numEntries)
+{
+    wil::unique_hfile file(CreateFileW(snapshotFileName, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, 0, nullptr));
+    if (!file)
+    {
+        return S_FALSE;
+    }
+
+    LARGE_INTEGER fileSize;
+    RETURN_IF_WIN32_BOOL_FALSE(GetFileSizeEx(file.get(), &fileSize));
+    UINT64 cbExpected = sizeof(MrmSnapshotHeader) + (static_cast<UINT64>(numEntries) * sizeof(UINT16));
+    if (static_cast<UINT64>(fileSize.QuadPart) != cbExpected)
+    {
+        return S_FALSE;
+    }
+
+    wil::unique_handle mapping(CreateFileMappingW(file.get(), nullptr, PAGE_READONLY, 0, 0, nullptr));
+    RETURN_LAST_ERROR_IF_NULL(mapping);
+
+    wil::unique_mapview_ptr<void> view(MapViewOfFile(mapping.get(), FILE_MAP_READ, 0, 0, 0));
+    RETURN_LAST_ERROR_IF_NULL(view);
+
+    const MrmSnapshotHeader* header = static_cast<const MrmSnapshotHeader*>(view.get());
+    const UINT16* entries = reinterpret_cast<const UINT16*>(header + 1);
+    if ((header->magic != c_snapshotMagic) || (header->majorVersion != c_snapshotMajorVersion) ||
+        (header->priFileSize != key.priFileSize) || (header->priLastWriteTime != key.priLastWriteTime) ||
+        (header->priChecksum != key.priChecksum) || (header->qualifierChecksum != key.qualifierChecksum) ||
+        (header->numEntries != numEntries) ||
+        (header->entriesChecksum != DefChecksum::ComputeChecksum(0, reinterpret_cast<const BYTE*>(entries), numEntries * sizeof(UINT16))))
+    {
+        return S_FALSE;
+    }
+
+    // This also checks that every entry is a qualifier set of its decision.
+    if (FAILED(resourceManagerObjects->resolver->UseDecisionTable(entries, static_cast<int>(numEntries))))
+    {
+        return S_FALSE;
+    }
+
+    resourceManagerObjects->snapshotMapping = std::move(mapping);
+    resourceManagerObjects->snapshotView = std::move(view);
+    resourceManagerObjects->snapshotEntries = entries;
+    resourceManagerObjects->numSnapshotEntries = numEntries;
+    resourceManagerObjects->snapshotQualifierChecksum = key.qualifierChecksum;
+    return S_OK;
+}
+
+static HRESULT WriteSnapshot(
+    _In_ const MrmObjects* resourceManagerObjects,
+    _In_ PCWSTR snapshotFileName,
+    _In_ const MrmSnapshotKey& key,
+    _In_ UINT32 numEntries)
+{
+    UINT32 cbEntries;
+    RETURN_IF_FAILED(UInt32Mult(numEntries, sizeof(UINT16), &cbEntries));
+    UINT32 cbSnapshot;
+    RETURN_IF_FAILED(UInt32Add(cbEntries, sizeof(MrmSnapshotHeader), &cbSnapshot));
+
+    std::unique_ptr<BYTE[]> snapshot(new (std::nothrow) BYTE[cbSnapshot]);
+    RETURN_IF_NULL_ALLOC(snapshot);
+
+    MrmSnapshotHeader* header = reinterpret_cast<MrmSnapshotHeader*>(snapshot.get());
+    UINT16* entries = reinterpret_cast<UINT16*>(header + 1);
+    RETURN_IF_FAILED(resourceManagerObjects->resolver->GetDecisionTable(static_cast<int>(numEntries), entries));
+
+    header->magic = c_snapshotMagic;
+    header->majorVersion = c_snapshotMajorVersion;
+    header->minorVersion = 0;
+    header->priFileSize = key.priFileSize;
+    header->priLastWriteTime = key.priLastWriteTime;
+    header->priChecksum = key.priChecksum;
+    header->qualifierChecksum = key.qualifierChecksum;
+    header->entriesChecksum = DefChecksum::ComputeChecksum(0, reinterpret_cast<const BYTE*>(entries), cbEntries);
+    header->numEntries = numEntries;
+
+    // Write a temporary file and move it into place so that a concurrent start never maps a partial snapshot. The
+    // temporary name includes the process and thread so that processes starting at the same time don't collide.
+    wchar_t tempSuffix[32];
+    RETURN_IF_FAILED(StringCchPrintfW(tempSuffix, ARRAYSIZE(tempSuffix), L".%08x%08x.tmp", GetCurrentProcessId(), GetCurrentThreadId()));
+    std::wstring tempFileName(snapshotFileName);
+    tempFileName += tempSuffix;
+
+    auto deleteTempFile = wil::scope_exit([&] { (void)DeleteFileW(tempFileName.c_str()); });
+    {
+        wil::unique_hfile file(CreateFileW(tempFileName.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, 0, nullptr));
+        RETURN_LAST_ERROR_IF(!file);
+
+        DWORD cbWritten;
+        RETURN_IF_WIN32_BOOL_FALSE(WriteFile(file.get(), snapshot.get(), cbSnapshot, &cbWritten, nullptr));
+        RETURN_HR_IF(E_FAIL, cbWritten != cbSnapshot);
+    }
+    RETURN_IF_WIN32_BOOL_FALSE(MoveFileExW(tempFileName.c_str(), snapshotFileName, MOVEFILE_REPLACE_EXISTING));
+    deleteTempFile.release();
+
+    return S_OK;
+}
+
+static void CALLBACK WriteSnapshotCallback(_Inout_ PTP_CALLBACK_INSTANCE, _Inout_opt_ PVOID context, _Inout_ PTP_WORK)
+{
+    const MrmObjects* resourceManagerObjects = static_cast<const MrmObjects*>(context);
+    (void)WriteSnapshot(
+        resourceManagerObjects,
+        resourceManagerObjects->snapshotFileName.c_str(),
+        resourceManagerObjects->snapshotKey,
+        resourceManagerObjects->numSnapshotEntriesToWrite);
+}
+
+// The snapshot is only an optimization, so nothing in here fails resource manager creation.
+static void ApplySnapshot(_Inout_ MrmObjects* resourceManagerObjects, _In_ PCWSTR priFilePath, _In_ PCWSTR snapshotFileName)
+{
+    MrmSnapshotKey key;
+    if (FAILED(ComputeSnapshotKey(resourceManagerObjects, priFilePath, &key)))
+    {
+        return;
+    }
+
+    const IResourceMapBase* primaryMap;
+    if (FAILED(resourceManagerObjects->priFile->GetPrimaryResourceMap(&primaryMap)))
+    {
+        return;
+    }
+    UINT32 numEntries = static_cast<UINT32>(primaryMap->GetDecisionInfo()->GetNumDecisions()) * 2;
+
+    if (TryUseSnapshot(resourceManagerObjects, snapshotFileName, key, numEntries) == S_OK)
+    {
+        return;
+    }
+
+    // No usable snapshot. Lookups fill in the decision table as they go, and a background work item resolves the
+    // rest and saves the results for the next start, so that creating the resource manager doesn't wait for it.
+    if (FAILED(resourceManagerObjects->resolver->EnableDecisionTable(true)))
+    {
+        return;
+    }
+
+    try
+    {
+        resourceManagerObjects->snapshotFileName = snapshotFileName;
+    }
+    catch (...)
+    {
+        return;
+    }
+    resourceManagerObjects->snapshotKey = key;
+    resourceManagerObjects->numSnapshotEntriesToWrite = numEntries;
+
+    resourceManagerObjects->snapshotWork = CreateThreadpoolWork(WriteSnapshotCallback, resourceManagerObjects, nullptr);
+    if (resourceManagerObjects->snapshotWork != nullptr)
+    {
+        SubmitThreadpoolWork(resourceManagerObjects->snapshotWork);
+    }
+}
+
+static HRESULT CreateResourceManager(_In_ PCWSTR priFileName, _In_opt_ PCWSTR snapshotFileName, _Out_ MrmManagerHandle* resourceManager)
 {
     *resourceManager = nullptr;
 
@@ -503,21 +980,18 @@ STDAPI MrmCreateResourceManager(_In_ PCWSTR priFileName, _Out_ MrmManagerHandle*
     RETURN_IF_FAILED(CoreProfile::ChooseDefaultProfile(&resourceManagerObjects->profile));
     RETURN_IF_FAILED(UnifiedResourceView::CreateInstance(resourceManagerObjects->profile, &resourceManagerObjects->unifiedView));
 
-    HRESULT hr = S_OK;
+    std::unique_ptr<wchar_t, decltype(&MrmFreeResource)> priPath(nullptr, MrmFreeResource);
+    PCWSTR priFilePath = priFileName;
     if (wcschr(priFileName, L'\\') == nullptr)
     {
         // If it's filename without path, use the module path.
         PWSTR filepath = nullptr;
         RETURN_IF_FAILED(MrmGetFilePathFromName(priFileName, &filepath));
 
-        std::unique_ptr<wchar_t, decltype(&MrmFreeResource)> priPath(filepath, MrmFreeResource);
-        hr = resourceManagerObjects->unifiedView->SetApplicationPriFile(priPath.get(), nullptr, &resourceManagerObjects->priFile);
-    }
-    else
-    {
-        hr = resourceManagerObjects->unifiedView->SetApplicationPriFile(priFileName, nullptr, &resourceManagerObjects->priFile);
+        priPath.reset(filepath);
+        priFilePath = priPath.get();
     }
-    RETURN_IF_FAILED(hr);
+    RETURN_IF_FAILED(resourceManagerObjects->unifiedView->SetApplicationPriFile(priFilePath, nullptr, &resourceManagerObjects->priFile));
 
     const IResourceMapBase* primaryMap;
     RETURN_IF_FAILED(resourceManagerObjects->priFile->GetPrimaryResourceMap(&primaryMap));
@@ -528,10 +1002,29 @@ STDAPI MrmCreateResourceManager(_In_ PCWSTR priFileName, _Out_ MrmManagerHandle*
         primaryMap->GetDecisionInfo(),
         &resourceManagerObjects->resolver));
 
+    if (snapshotFileName != nullptr)
+    {
+        ApplySnapshot(resourceManagerObjects.get(), priFilePath, snapshotFileName);
+    }
+
     *resourceManager = reinterpret_cast<MrmManagerHandle>(resourceManagerObjects.release());
     return S_OK;
 }
 
+STDAPI MrmCreateResourceManager(_In_ PCWSTR priFileName, _Out_ MrmManagerHandle* resourceManager)
+{
+    return CreateResourceManager(priFileName, nullptr, resourceManager);
+}
+
+STDAPI MrmCreateResourceManagerWithSnapshot(_In_ PCWSTR priFileName, _In_ PCWSTR snapshotFileName, _Out_ MrmManagerHandle* resourceManager)
+{
+    *resourceManager = nullptr;
+
+    RETURN_HR_IF(E_INVALIDARG, (snapshotFileName == nullptr) || (*snapshotFileName == L'\0'));
+
+    return CreateResourceManager(priFileName, snapshotFileName, resourceManager);
+}
+
 STDAPI_(void) MrmDestroyResourceManager(MrmManagerHandle resourceManager)
 {
     if (resourceManager != nullptr)
@@ -557,6 +1050,19 @@ STDAPI MrmCreateResourceContext(_In_ MrmManagerHandle resourceManager, _Out_ Mrm
         primaryMap->GetDecisionInfo(),
         &resolver));
 
+    // A new context starts out with the same qualifier values as the resource manager, so it can use the
+    // resource manager's snapshot unless those values have changed since the snapshot was taken.
+    if (resourceManagerObjects->snapshotEntries != nullptr)
+    {
+        DEF_CHECKSUM qualifierChecksum;
+        if (SUCCEEDED(resolver->ComputeQualifierChecksum(&qualifierChecksum)) &&
+            (qualifierChecksum == resourceManagerObjects->snapshotQualifierChecksum))
+        {
+            (void)resolver->UseDecisionTable(
+                resourceManagerObjects->snapshotEntries, static_cast<int>(resourceManagerObjects->numSnapshotEntries));
+        }
+    }
+
     *resourceContext = reinterpret_cast<MrmContextHandle>(resolver);
     return S_OK;
 }
@@ -717,7 +1223,36 @@ STDAPI MrmLoadStringResource(
     _In_ PCWSTR resourceId,
     _Outptr_ PWSTR* resourceString)
 {
-    RETURN_IF_FAILED_WITH_EXPECTED(LoadStringResource(resourceManager, resourceContext, resourceMap, INDEX_RESOURCE_ID, resourceId, resourceString), HRESULT_FROM_WIN32(ERROR_MRM_NAMED_RESOURCE_NOT_FOUND));
+    RETURN_IF_FAILED_WITH_EXPECTED(LoadStringResource(resourceManager, resourceContext, resourceMap, INDEX_RESOURCE_ID, resourceId, resourceString, nullptr), HRESULT_FROM_WIN32(ERROR_MRM_NAMED_RESOURCE_NOT_FOUND));
+    return S_OK;
+}
+
+STDAPI MrmLoadStringResources(
+    _In_ MrmManagerHandle resourceManager,
+    _In_opt_ MrmContextHandle resourceContext,
+    _In_opt_ MrmMapHandle resourceMap,
+    UINT32 resourceIdCount,
+    _In_reads_(resourceIdCount) PCWSTR* resourceIds,
+    _Outptr_result_buffer_(resourceIdCount) PWSTR** resourceStrings,
+    _Out_writes_opt_(resourceIdCount) HRESULT* resourceResults)
+{
+    RETURN_IF_FAILED_WITH_EXPECTED(
+        LoadStringResources(resourceManager, resourceContext, resourceMap, resourceIdCount, resourceIds, resourceStrings, resourceResults),
+        HRESULT_FROM_WIN32(ERROR_MRM_NAMED_RESOURCE_NOT_FOUND));
+    return S_OK;
+}
+
+STDAPI MrmLoadStringResourceView(
+    _In_ MrmManagerHandle resourceManager,
+    _In_opt_ MrmContextHandle resourceContext,
+    _In_opt_ MrmMapHandle resourceMap,
+    _In_ PCWSTR resourceId,
+    _Out_ MrmStringView* resourceView,
+    _Outptr_result_maybenull_ PWSTR* resourceString)
+{
+    RETURN_IF_FAILED_WITH_EXPECTED(
+        LoadStringResource(resourceManager, resourceContext, resourceMap, INDEX_RESOURCE_ID, resourceId, resourceString, resourceView),
+        HRESULT_FROM_WIN32(ERROR_MRM_NAMED_RESOURCE_NOT_FOUND));
     return S_OK;
 }
 
@@ -727,7 +1262,7 @@ STDAPI MrmLoadStringResourceFromResourceUri(
     _In_ PCWSTR resourceUri,
     _Outptr_ PWSTR* resourceString)
 {
-    RETURN_IF_FAILED_WITH_EXPECTED(LoadStringResource(resourceManager, resourceContext, nullptr, INDEX_RESOURCE_URI, resourceUri, resourceString), HRESULT_FROM_WIN32(ERROR_MRM_NAMED_RESOURCE_NOT_FOUND));
+    RETURN_IF_FAILED_WITH_EXPECTED(LoadStringResource(resourceManager, resourceContext, nullptr, INDEX_RESOURCE_URI, resourceUri, resourceString, nullptr), HRESULT_FROM_WIN32(ERROR_MRM_NAMED_RESOURCE_NOT_FOUND));
     return S_OK;
 }
 
@@ -762,7 +1297,23 @@ STDAPI MrmLoadStringOrEmbeddedResource(
     _Out_ MrmResourceData* data)
 {
     RETURN_IF_FAILED_WITH_EXPECTED(LoadStringOrEmbeddedResource(
-        resourceManager, resourceContext, resourceMap, INDEX_RESOURCE_ID, resourceId, resourceType, resourceString, data, nullptr, nullptr, nullptr, nullptr),
+        resourceManager, resourceContext, resourceMap, INDEX_RESOURCE_ID, resourceId, resourceType, resourceString, nullptr, data, nullptr, nullptr, nullptr, nullptr),
+        HRESULT_FROM_WIN32(ERROR_MRM_NAMED_RESOURCE_NOT_FOUND));
+    return S_OK;
+}
+
+STDAPI MrmLoadStringOrEmbeddedResourceView(
+    _In_ MrmManagerHandle resourceManager,
+    _In_opt_ MrmContextHandle resourceContext,
+    _In_opt_ MrmMapHandle resourceMap,
+    _In_ PCWSTR resourceId,
+    _Out_ MrmType* resourceType,
+    _Out_ MrmStringView* resourceView,
+    _Outptr_result_maybenull_ PWSTR* resourceString,
+    _Out_ MrmResourceData* data)
+{
+    RETURN_IF_FAILED_WITH_EXPECTED(LoadStringOrEmbeddedResource(
+        resourceManager, resourceContext, resourceMap, INDEX_RESOURCE_ID, resourceId, resourceType, resourceString, resourceView, data, nullptr, nullptr, nullptr, nullptr),
         HRESULT_FROM_WIN32(ERROR_MRM_NAMED_RESOURCE_NOT_FOUND));
     return S_OK;
 }
@@ -787,6 +1338,7 @@ STDAPI MrmLoadStringOrEmbeddedResourceWithQualifierValues(
         resourceId, 
         resourceType, 
         resourceString, 
+        nullptr, 
         data, 
         nullptr, 
         qualifierCount, 
@@ -805,7 +1357,7 @@ STDAPI MrmLoadStringOrEmbeddedFromResourceUri(
     _Out_ MrmResourceData* data)
 {
     RETURN_IF_FAILED_WITH_EXPECTED(LoadStringOrEmbeddedResource(
-        resourceManager, resourceContext, nullptr, INDEX_RESOURCE_URI, resourceUri, resourceType, resourceString, data, nullptr, nullptr, nullptr, nullptr),
+        resourceManager, resourceContext, nullptr, INDEX_RESOURCE_URI, resourceUri, resourceType, resourceString, nullptr, data, nullptr, nullptr, nullptr, nullptr),
         HRESULT_FROM_WIN32(ERROR_MRM_NAMED_RESOURCE_NOT_FOUND));
     return S_OK;
 }
@@ -821,7 +1373,7 @@ STDAPI MrmLoadStringOrEmbeddedResourceByIndex(
     _Out_ MrmResourceData* data)
 {
     RETURN_IF_FAILED(LoadStringOrEmbeddedResource(
-        resourceManager, resourceContext, resourceMap, index, nullptr, resourceType, resourceString, data, resourceName, nullptr, nullptr, nullptr));
+        resourceManager, resourceContext, resourceMap, index, nullptr, resourceType, resourceString, nullptr, data, resourceName, nullptr, nullptr, nullptr));
     return S_OK;
 }
 
@@ -846,6 +1398,7 @@ STDAPI MrmLoadStringOrEmbeddedResourceByIndexWithQualifierValues(
         nullptr, 
         resourceType, 
         resourceString, 
+        nullptr, 
         data, 
         resourceName, 
         qualifierCount, 
@@ -26,7 +26,25 @@ extern "C"
         void* data;
     };
 
+    // A string that is not necessarily null-terminated.
+    struct MrmStringView
+    {
+        UINT32 length;
+        PCWSTR data;
+    };
+
     STDAPI MrmCreateResourceManager(_In_ PCWSTR priFileName, _Out_ MrmManagerHandle* resourceManager);
+
+    // Like MrmCreateResourceManager, but also uses a resolution snapshot stored in snapshotFileName. If the snapshot
+    // matches the PRI file and the current qualifier values, lookups take their winning candidates from it instead of
+    // resolving them. That covers lookups without a resource context, and lookups with a context created by
+    // MrmCreateResourceContext whenever its qualifier values match the snapshot's. If the snapshot doesn't match, it is
+    // rewritten in the background for the next start, and MrmDestroyResourceManager waits for that to finish.
+    // Problems with the snapshot never fail the call. Resource contexts must be destroyed before the resource manager.
+    STDAPI MrmCreateResourceManagerWithSnapshot(
+        _In_ PCWSTR priFileName,
+        _In_ PCWSTR snapshotFileName,
+        _Out_ MrmManagerHandle* resourceManager);
     STDAPI_(void) MrmDestroyResourceManager(_In_opt_ MrmManagerHandle resourceManager);
 
     STDAPI MrmCreateResourceContext(_In_ MrmManagerHandle resourceManager, _Out_ MrmContextHandle* resourceContext);
@@ -52,6 +70,30 @@ extern "C"
         _In_ PCWSTR resourceId,
         _Outptr_ PWSTR* resourceString);
 
+    // Loads several string resources from the same resource map in one call. On success, *resourceStrings is a
+    // single buffer holding resourceIdCount string pointers followed by the strings themselves, and is freed with
+    // one MrmFreeResource call. When resourceResults is supplied, a resource that fails to load gets a null string
+    // and its own error code and the call still succeeds; otherwise the first failure fails the whole call.
+    STDAPI MrmLoadStringResources(
+        _In_ MrmManagerHandle resourceManager,
+        _In_opt_ MrmContextHandle resourceContext,
+        _In_opt_ MrmMapHandle resourceMap,
+        UINT32 resourceIdCount,
+        _In_reads_(resourceIdCount) PCWSTR* resourceIds,
+        _Outptr_result_buffer_(resourceIdCount) PWSTR** resourceStrings,
+        _Out_writes_opt_(resourceIdCount) HRESULT* resourceResults);
+
+    // Like MrmLoadStringResource, but does not copy values that are stored as UTF-16 in the PRI file. In that case
+    // *resourceString is null and resourceView is valid until the resource manager is destroyed. Otherwise
+    // resourceView points into *resourceString, which must be freed with MrmFreeResource.
+    STDAPI MrmLoadStringResourceView(
+        _In_ MrmManagerHandle resourceManager,
+        _In_opt_ MrmContextHandle resourceContext,
+        _In_opt_ MrmMapHandle resourceMap,
+        _In_ PCWSTR resourceId,
+        _Out_ MrmStringView* resourceView,
+        _Outptr_result_maybenull_ PWSTR* resourceString);
+
     STDAPI MrmLoadStringResourceFromResourceUri(
         _In_ MrmManagerHandle resourceManager,
         _In_opt_ MrmContextHandle resourceContext,
@@ -80,6 +122,17 @@ extern "C"
         _Outptr_result_maybenull_ PWSTR* resourceString,
         _Out_ MrmResourceData* data);
 
+    // Like MrmLoadStringOrEmbeddedResource, but returns string values the same way as MrmLoadStringResourceView.
+    STDAPI MrmLoadStringOrEmbeddedResourceView(
+        _In_ MrmManagerHandle resourceManager,
+        _In_opt_ MrmContextHandle resourceContext,
+        _In_opt_ MrmMapHandle resourceMap,
+        _In_ PCWSTR resourceId,
+        _Out_ MrmType* resourceType,
+        _Out_ MrmStringView* resourceView,
+        _Outptr_result_maybenull_ PWSTR* resourceString,
+        _Out_ MrmResourceData* data);
+
     STDAPI MrmLoadStringOrEmbeddedResourceWithQualifierValues(
         _In_ MrmManagerHandle resourceManager,
         _In_opt_ MrmContextHandle resourceContext,
@@ -566,6 +566,91 @@ public:
         MrmDestroyResourceManager(resourceManager);
     }
 
+    TEST_METHOD(ReadResourceStrings)
+    {
+        MrmManagerHandle resourceManager;
+        VERIFY_ARE_EQUAL(MrmCreateResourceManager(L".\\resources.pri", &resourceManager), S_OK);
+
+        MrmMapHandle childResourceMap;
+        VERIFY_ARE_EQUAL(MrmGetChildResourceMap(resourceManager, nullptr, L"Microsoft.UI.Xaml", &childResourceMap), S_OK);
+
+        MrmMapHandle childChildResourceMap;
+        VERIFY_ARE_EQUAL(MrmGetChildResourceMap(resourceManager, childResourceMap, L"Resources", &childChildResourceMap), S_OK);
+
+        PCWSTR resourceIds[] = {L"HelpTextMoreButton", L"AutomationNameAlphaSlider", L"wrongresource", L"HelpTextMoreButton"};
+
+        PWSTR* resourceStrings;
+        VERIFY_ARE_EQUAL(
+            MrmLoadStringResources(resourceManager, nullptr, childChildResourceMap, ARRAYSIZE(resourceIds), resourceIds, &resourceStrings, nullptr),
+            HRESULT_FROM_WIN32(ERROR_MRM_NAMED_RESOURCE_NOT_FOUND));
+
+        HRESULT resourceResults[ARRAYSIZE(resourceIds)];
+        VERIFY_ARE_EQUAL(
+            MrmLoadStringResources(
+                resourceManager, nullptr, childChildResourceMap, ARRAYSIZE(resourceIds), resourceIds, &resourceStrings, resourceResults),
+            S_OK);
+
+        VERIFY_ARE_EQUAL(resourceResults[0], S_OK);
+        VerifyStringEqual(resourceStrings[0], L"Invoke to show or hide the text entry fields.");
+        VERIFY_ARE_EQUAL(resourceResults[1], S_OK);
+        VerifyStringEqual(resourceStrings[1], L"Opacity");
+        VERIFY_ARE_EQUAL(resourceResults[2], HRESULT_FROM_WIN32(ERROR_MRM_NAMED_RESOURCE_NOT_FOUND));
+        VERIFY_IS_NULL(resourceStrings[2]);
+        VERIFY_ARE_EQUAL(resourceResults[3], S_OK);
+        VerifyStringEqual(resourceStrings[3], L"Invoke to show or hide the text entry fields.");
+
+        // All strings live in a single buffer.
+        MrmFreeResource(resourceStrings);
+
+        PCWSTR validResourceIds[] = {L"HelpTextMoreButton", L"AutomationNameAlphaSlider"};
+        VERIFY_ARE_EQUAL(
+            MrmLoadStringResources(
+                resourceManager, nullptr, childChildResourceMap, ARRAYSIZE(validResourceIds), validResourceIds, &resourceStrings, nullptr),
+            S_OK);
+        VerifyStringEqual(resourceStrings[0], L"Invoke to show or hide the text entry fields.");
+        VerifyStringEqual(resourceStrings[1], L"Opacity");
+
+        MrmFreeResource(resourceStrings);
+        MrmDestroyResourceManager(resourceManager);
+    }
+
+    TEST_METHOD(ReadResourceStringView)
+    {
+        MrmManagerHandle resourceManager;
+        VERIFY_ARE_EQUAL(MrmCreateResourceManager(L".\\resources.pri", &resourceManager), S_OK);
+
+        MrmStringView resourceView;
+        wchar_t* resourceString;
+        VERIFY_ARE_EQUAL(
+            MrmLoadStringResourceView(resourceManager, nullptr, nullptr, L"resources/IDS_MANIFEST_MUSIC_APP_NAME", &resourceView, &resourceString),
+            S_OK);
+        VERIFY_ARE_EQUAL(resourceView.length, static_cast<UINT32>(wcslen(L"Groove Music")));
+        VERIFY_ARE_EQUAL(wcsncmp(resourceView.data, L"Groove Music", resourceView.length), 0);
+        if (resourceString != nullptr)
+        {
+            VERIFY_ARE_EQUAL(resourceView.data, resourceString);
+        }
+        MrmFreeResource(resourceString);
+
+        VERIFY_ARE_EQUAL(
+            MrmLoadStringResourceView(resourceManager, nullptr, nullptr, L"resources/wrongresource", &resourceView, &resourceString),
+            HRESULT_FROM_WIN32(ERROR_MRM_NAMED_RESOURCE_NOT_FOUND));
+
+        MrmType resourceType;
+        MrmResourceData data;
+        VERIFY_ARE_EQUAL(
+            MrmLoadStringOrEmbeddedResourceView(
+                resourceManager, nullptr, nullptr, L"resources/IDS_MANIFEST_MUSIC_APP_NAME", &resourceType, &resourceView, &resourceString, &data),
+            S_OK);
+        VERIFY_ARE_EQUAL(resourceType, MrmType_String);
+        VERIFY_ARE_EQUAL(resourceView.length, static_cast<UINT32>(wcslen(L"Groove Music")));
+        VERIFY_ARE_EQUAL(wcsncmp(resourceView.data, L"Groove Music", resourceView.length), 0);
+        VERIFY_IS_NULL(data.data);
+        MrmFreeResource(resourceString);
+
+        MrmDestroyResourceManager(resourceManager);
+    }
+
     TEST_METHOD(RepeatedCalls)
     {
         MrmManagerHandle resourceManager;
@@ -599,6 +684,121 @@ public:
         }
     }
 
+    TEST_METHOD(ResolutionSnapshot)
+    {
+        PCWSTR snapshotFileName = L".\\resources.pri.snapshot";
+        DeleteFileW(snapshotFileName);
+
+        // No snapshot yet: the snapshot is written in the background, and is there once the resource manager is gone.
+        MrmManagerHandle resourceManager;
+        VERIFY_ARE_EQUAL(MrmCreateResourceManagerWithSnapshot(L".\\resources.pri", snapshotFileName, &resourceManager), S_OK);
+
+        wchar_t* resourceString;
+        VERIFY_ARE_EQUAL(MrmLoadStringResource(resourceManager, nullptr, nullptr, L"resources/IDS_MANIFEST_MUSIC_APP_NAME", &resourceString), S_OK);
+        VerifyStringEqual(resourceString, L"Groove Music");
+        MrmFreeResource(resourceString);
+        MrmDestroyResourceManager(resourceManager);
+        VERIFY_ARE_NOT_EQUAL(GetFileAttributesW(snapshotFileName), INVALID_FILE_ATTRIBUTES);
+
+        // A context that sets the values it already has, as applying a resource context does, still gets the right
+        // results.
+        VERIFY_ARE_EQUAL(MrmCreateResourceManagerWithSnapshot(L".\\resources.pri", snapshotFileName, &resourceManager), S_OK);
+        MrmContextHandle resourceContext;
+        VERIFY_ARE_EQUAL(MrmCreateResourceContext(resourceManager, &resourceContext), S_OK);
+        wchar_t* language;
+        VERIFY_ARE_EQUAL(MrmGetQualifier(resourceContext, L"Language", &language), S_OK);
+        VERIFY_ARE_EQUAL(MrmSetQualifier(resourceContext, L"Language", language), S_OK);
+        MrmFreeResource(language);
+        VERIFY_ARE_EQUAL(MrmLoadStringResource(resourceManager, resourceContext, nullptr, L"resources/IDS_MANIFEST_MUSIC_APP_NAME", &resourceString), S_OK);
+        VerifyStringEqual(resourceString, L"Groove Music");
+        MrmFreeResource(resourceString);
+        MrmDestroyResourceContext(resourceContext);
+        MrmDestroyResourceManager(resourceManager);
+
+        // Snapshot hit.
+        VERIFY_ARE_EQUAL(MrmCreateResourceManagerWithSnapshot(L".\\resources.pri", snapshotFileName, &resourceManager), S_OK);
+        VERIFY_ARE_EQUAL(MrmLoadStringResource(resourceManager, nullptr, nullptr, L"resources/IDS_MANIFEST_MUSIC_APP_NAME", &resourceString), S_OK);
+        VerifyStringEqual(resourceString, L"Groove Music");
+        MrmFreeResource(resourceString);
+        MrmDestroyResourceManager(resourceManager);
+
+        // A damaged snapshot is ignored and rewritten.
+        {
+            HANDLE file = CreateFileW(snapshotFileName, GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, 0, nullptr);
+            VERIFY_ARE_NOT_EQUAL(file, INVALID_HANDLE_VALUE);
+            VERIFY_ARE_NOT_EQUAL(SetFilePointer(file, -2, nullptr, FILE_END), INVALID_SET_FILE_POINTER);
+            const BYTE garbage[] = {0xff, 0xfe};
+            DWORD cbWritten;
+            VERIFY_WIN32_BOOL_SUCCEEDED(WriteFile(file, garbage, sizeof(garbage), &cbWritten, nullptr));
+            CloseHandle(file);
+        }
+        VERIFY_ARE_EQUAL(MrmCreateResourceManagerWithSnapshot(L".\\resources.pri", snapshotFileName, &resourceManager), S_OK);
+        VERIFY_ARE_EQUAL(MrmLoadStringResource(resourceManager, nullptr, nullptr, L"resources/IDS_MANIFEST_MUSIC_APP_NAME", &resourceString), S_OK);
+        VerifyStringEqual(resourceString, L"Groove Music");
+        MrmFreeResource(resourceString);
+        MrmDestroyResourceManager(resourceManager);
+
+        DeleteFileW(snapshotFileName);
+    }
+
+    // Compares starting up and loading one string without a snapshot, with a snapshot hit, and when writing a new snapshot.
+    TEST_METHOD(ResolutionSnapshotStartupTime)
+    {
+        PCWSTR snapshotFileName = L".\\resources.pri.snapshot";
+        const int numStarts = 100;
+
+        LARGE_INTEGER frequency;
+        QueryPerformanceFrequency(&frequency);
+
+        for (int mode = 0; mode < 3; mode++)
+        {
+            PCWSTR description = (mode == 0) ? L"Cold PRI load" : ((mode == 1) ? L"Snapshot hit" : L"Snapshot miss");
+            if (mode == 1)
+            {
+                // Make sure there's a snapshot to hit.
+                MrmManagerHandle resourceManager;
+                VERIFY_ARE_EQUAL(MrmCreateResourceManagerWithSnapshot(L".\\resources.pri", snapshotFileName, &resourceManager), S_OK);
+                MrmDestroyResourceManager(resourceManager);
+            }
+
+            LARGE_INTEGER start;
+            LARGE_INTEGER end;
+            QueryPerformanceCounter(&start);
+            for (int i = 0; i < numStarts; i++)
+            {
+                if (mode == 2)
+                {
+                    DeleteFileW(snapshotFileName);
+                }
+
+                MrmManagerHandle resourceManager;
+                if (mode == 0)
+                {
+                    VERIFY_ARE_EQUAL(MrmCreateResourceManager(L".\\resources.pri", &resourceManager), S_OK);
+                }
+                else
+                {
+                    VERIFY_ARE_EQUAL(MrmCreateResourceManagerWithSnapshot(L".\\resources.pri", snapshotFileName, &resourceManager), S_OK);
+                }
+
+                wchar_t* resourceString;
+                VERIFY_ARE_EQUAL(
+                    MrmLoadStringResource(resourceManager, nullptr, nullptr, L"resources/IDS_MANIFEST_MUSIC_APP_NAME", &resourceString), S_OK);
+                MrmFreeResource(resourceString);
+                MrmDestroyResourceManager(resourceManager);
+            }
+            QueryPerformanceCounter(&end);
+
+            Log::Comment(String().Format(
+                L"%s: %d starts in %lld us",
+                description,
+                numStarts,
+                ((end.QuadPart - start.QuadPart) * 1000000) / frequency.QuadPart));
+        }
+
+        DeleteFileW(snapshotFileName);
+    }
+
     TEST_METHOD(GetFilePath)
     {
         wchar_t* path;
@@ -84,6 +84,21 @@ namespace CommonTestCode
             Verify.AreEqual(resource, "Invoke to show or hide the text entry fields.");
         }
 
+        public static void GetStringsTest()
+        {
+            var resourceLoader = new ResourceLoader("resources.pri.standalone", "Microsoft.UI.Xaml/Resources");
+            var resources = resourceLoader.GetStrings(new string[] { "HelpTextMoreButton", "AutomationNameAlphaSlider", "HelpTextMoreButton" });
+            Verify.AreEqual(resources.Length, 3);
+            Verify.AreEqual(resources[0], "Invoke to show or hide the text entry fields.");
+            Verify.AreEqual(resources[1], "Opacity");
+            Verify.AreEqual(resources[2], "Invoke to show or hide the text entry fields.");
+
+            Verify.AreEqual(resourceLoader.GetStrings(new string[] { }).Length, 0);
+
+            var ex = Verify.Throws<Exception>(() => resourceLoader.GetStrings(new string[] { "HelpTextMoreButton", "abc" }));
+            Verify.AreEqual((uint)ex.HResult, 0x80073b17); // HRESULT_FROM_WIN32(ERROR_MRM_NAMED_RESOURCE_NOT_FOUND)
+        }
+
         public static void GetStringForUriTest()
         {
             var resourceLoader = new ResourceLoader("resources.pri.standalone");
@@ -475,6 +490,25 @@ namespace CommonTestCode
             Verify.IsNull(resourceCandidate);
         }
 
+        public static void DefaultContextNotModifiedByHandlerTest()
+        {
+            var resourceManager = new ResourceManager("resources.pri.standalone");
+            var resourceMap = resourceManager.MainResourceMap.GetSubtree("resources");
+            var defaultValue = resourceMap.GetValue("IDS_WHATS_NEW_1710_2_EQUALIZER_TITLE").ValueAsString;
+
+            resourceManager.ResourceNotFound += (sender, args) =>
+            {
+                // Changes to the context received by the handler must not leak into the default context.
+                args.Context.QualifierValues[KnownResourceQualifierName.Language] =
+                    (defaultValue == "Equaliser") ? "en-US" : "en-GB";
+                args.SetResolvedCandidate(new ResourceCandidate(ResourceCandidateKind.String, "abcValue"));
+            };
+
+            Verify.AreEqual(resourceMap.GetValue("abc").ValueAsString, "abcValue");
+            Verify.AreEqual(resourceMap.GetValue("IDS_WHATS_NEW_1710_2_EQUALIZER_TITLE").ValueAsString, defaultValue);
+            Verify.AreEqual(resourceMap.TryGetValue("IDS_WHATS_NEW_1710_2_EQUALIZER_TITLE").ValueAsString, defaultValue);
+        }
+
         public static void NoResourceFileWithContextTest()
         {
             var resourceManager = new ResourceManager("NoSuchFile.pri");
@@ -312,6 +312,23 @@ namespace MrtCoreUnpackagedTests
             CommonTestCode.ResourceLoaderTest.GetStringTest_NonDefaultNamespace();
         }
 
+        [TestMethod]
+        public void ResourceLoader_GetStringsTest()
+        {
+            if (m_rs5)
+            {
+                // Test doesn't run before 19H1. Make it pass as skipped is treated as failure in Helix.
+                return;
+            }
+
+            if (m_exeFolder != m_assemblyFolder)
+            {
+                File.Copy(Path.Combine(m_assemblyFolder, "resources.pri.standalone"), Path.Combine(m_exeFolder, "resources.pri.standalone"));
+            }
+
+            CommonTestCode.ResourceLoaderTest.GetStringsTest();
+        }
+
         [TestMethod]
         public void ResourceLoader_GetStringForUriTest()
         {
@@ -601,6 +618,23 @@ namespace MrtCoreUnpackagedTests
             CommonTestCode.ResourceContextTest.ResourceNotFoundWithContextTest();
         }
 
+        [TestMethod]
+        public void ResourceContext_DefaultContextNotModifiedByHandlerTest()
+        {
+            if (m_rs5)
+            {
+                // Test doesn't run before 19H1. Make it pass as skipped is treated as failure in Helix.
+                return;
+            }
+
+            if (m_exeFolder != m_assemblyFolder)
+            {
+                File.Copy(Path.Combine(m_assemblyFolder, "resources.pri.standalone"), Path.Combine(m_exeFolder, "resources.pri.standalone"));
+            }
+
+            CommonTestCode.ResourceContextTest.DefaultContextNotModifiedByHandlerTest();
+        }
+
         [TestMethod]
         public void ResourceContext_NoResourceFileWithContextTest()
         {
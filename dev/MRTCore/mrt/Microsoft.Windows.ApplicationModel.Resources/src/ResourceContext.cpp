@@ -103,6 +103,16 @@ void ResourceContext::Apply()
     }
 }
 
+void ResourceContext::ApplyLanguages(hstring const& languages)
+{
+    if ((m_resourceContext == nullptr) || languages.empty())
+    {
+        return;
+    }
+
+    winrt::check_hresult(MrmSetQualifier(m_resourceContext, c_languageQualifierName, languages.c_str()));
+}
+
 hstring ResourceContext::GetLangugageContext()
 {
     hstring context;
@@ -11,19 +11,31 @@ struct ResourceContext : ResourceContextT<ResourceContext>
 {
     ResourceContext() = delete;
     ResourceContext(MrmContextHandle resourceContext) : m_resourceContext(resourceContext) {}
+    ResourceContext(MrmContextHandle resourceContext, bool isShared) : m_resourceContext(resourceContext), m_isShared(isShared) {}
     ~ResourceContext() { MrmDestroyResourceContext(m_resourceContext); }
 
     winrt::Windows::Foundation::Collections::IMap<hstring, hstring> QualifierValues();
 
     void Apply();
+
+    // Sets only the language, which is the one qualifier the default context overrides. The other qualifiers
+    // are left to the context's providers rather than pinned to the values they had when it was created.
+    void ApplyLanguages(hstring const& languages);
+
     MrmContextHandle GetContextHandle() { return m_resourceContext; }
 
+    // A shared context is the per-ResourceManager default context. It is applied once and must never be
+    // handed to callers that can modify it; those get a copy instead.
+    bool IsShared() { return m_isShared; }
+
+    static hstring GetLangugageContext();
+
 private:
     void InitializeQualifierNames();
     void InitializeQualifierValueMap();
-    hstring GetLangugageContext();
 
     MrmContextHandle m_resourceContext = nullptr;
+    bool m_isShared = false;
     com_array<hstring> m_qualifierNames;
     winrt::Windows::Foundation::Collections::IMap<hstring, hstring> m_qualifierValueMap = nullptr;
 };
@@ -41,11 +41,13 @@ hstring ResourceLoader::GetDefaultResourceFilePath()
 
 hstring ResourceLoader::GetString(hstring const& resourceId)
 {
+    MrmStringView resourceView;
     wchar_t* resourceString;
-    winrt::check_hresult(MrmLoadStringResource(m_resourceManager, nullptr, m_currentResourceMap, resourceId.c_str(), &resourceString));
+    winrt::check_hresult(
+        MrmLoadStringResourceView(m_resourceManager, nullptr, m_currentResourceMap, resourceId.c_str(), &resourceView, &resourceString));
 
     string_resoure_ptr resourceContainer(resourceString);
-    return winrt::to_hstring(resourceContainer.get());
+    return hstring(resourceView.data, resourceView.length);
 }
 
 hstring ResourceLoader::GetStringForUri(winrt::Windows::Foundation::Uri const& resourceUri)
@@ -56,4 +58,33 @@ hstring ResourceLoader::GetStringForUri(winrt::Windows::Foundation::Uri const& r
     string_resoure_ptr resourceContainer(resourceString);
     return winrt::to_hstring(resourceContainer.get());
 }
+
+com_array<hstring> ResourceLoader::GetStrings(array_view<hstring const> resourceIds)
+{
+    if (resourceIds.empty())
+    {
+        return com_array<hstring>();
+    }
+
+    std::vector<PCWSTR> ids;
+    ids.reserve(resourceIds.size());
+    for (auto const& resourceId : resourceIds)
+    {
+        ids.push_back(resourceId.c_str());
+    }
+
+    // All strings come back in a single buffer, which is freed in one go.
+    PWSTR* resourceStrings;
+    winrt::check_hresult(MrmLoadStringResources(
+        m_resourceManager, nullptr, m_currentResourceMap, resourceIds.size(), ids.data(), &resourceStrings, nullptr));
+
+    embedded_resoure_ptr resourceContainer(resourceStrings);
+    com_array<hstring> strings(resourceIds.size());
+    for (uint32_t i = 0; i < resourceIds.size(); i++)
+    {
+        strings[i] = resourceStrings[i];
+    }
+
+    return strings;
+}
 } // namespace winrt::Microsoft::Windows::ApplicationModel::Resources::implementation
@@ -17,6 +17,7 @@ struct ResourceLoader : ResourceLoaderT<ResourceLoader>
 
     hstring GetString(hstring const& resourceId);
     hstring GetStringForUri(winrt::Windows::Foundation::Uri const& resourceUri);
+    com_array<hstring> GetStrings(array_view<hstring const> resourceIds);
 
 private:
     ~ResourceLoader();
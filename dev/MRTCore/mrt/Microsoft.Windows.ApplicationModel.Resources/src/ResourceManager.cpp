@@ -41,7 +41,7 @@ Microsoft::Windows::ApplicationModel::Resources::ResourceMap ResourceManager::Ma
     return winrt::make<ResourceMap>(*this, m_resourceManagerHandle, nullptr);
 }
 
-Microsoft::Windows::ApplicationModel::Resources::ResourceContext ResourceManager::CreateResourceContext()
+Microsoft::Windows::ApplicationModel::Resources::ResourceContext ResourceManager::CreateResourceContextImpl(bool isShared)
 {
     MrmContextHandle contextHandle = nullptr;
     if (m_resourceManagerHandle != nullptr)
@@ -49,7 +49,48 @@ Microsoft::Windows::ApplicationModel::Resources::ResourceContext ResourceManager
         winrt::check_hresult(MrmCreateResourceContext(m_resourceManagerHandle, &contextHandle));
     }
 
-    return winrt::make<ResourceContext>(contextHandle);
+    return winrt::make<ResourceContext>(contextHandle, isShared);
+}
+
+Microsoft::Windows::ApplicationModel::Resources::ResourceContext ResourceManager::CreateResourceContext()
+{
+    return CreateResourceContextImpl(false);
+}
+
+Microsoft::Windows::ApplicationModel::Resources::ResourceContext ResourceManager::CopyResourceContext(
+    Microsoft::Windows::ApplicationModel::Resources::ResourceContext const& context)
+{
+    Microsoft::Windows::ApplicationModel::Resources::ResourceContext copy = CreateResourceContextImpl(false);
+
+    winrt::Windows::Foundation::Collections::IMap<hstring, hstring> qualifierValues = copy.QualifierValues();
+    for (auto const& eachValue : context.QualifierValues())
+    {
+        qualifierValues.Insert(eachValue.Key(), eachValue.Value());
+    }
+
+    return copy;
+}
+
+Microsoft::Windows::ApplicationModel::Resources::ResourceContext ResourceManager::GetDefaultResourceContext()
+{
+    // Application languages can be changed at runtime (e.g. PrimaryLanguageOverride) and there is no change
+    // notification for them, so check them on every call like a per-call context would.
+    hstring languages = ResourceContext::GetLangugageContext();
+
+    slim_lock_guard const guard {m_defaultResourceContextLock};
+    if ((m_defaultResourceContext == nullptr) || (languages != m_defaultResourceContextLanguages))
+    {
+        Microsoft::Windows::ApplicationModel::Resources::ResourceContext context = CreateResourceContextImpl(true);
+
+        // Only the languages are set, so every other qualifier (Contrast, Theme, Scale, ...) keeps following its
+        // provider instead of being pinned to its value at creation. Lookups using the shared context skip Apply().
+        context.as<ResourceContext>()->ApplyLanguages(languages);
+
+        m_defaultResourceContext = context;
+        m_defaultResourceContextLanguages = languages;
+    }
+
+    return m_defaultResourceContext;
 }
 
 winrt::event_token ResourceManager::ResourceNotFound(winrt::Windows::Foundation::TypedEventHandler<
@@ -70,6 +111,12 @@ Microsoft::Windows::ApplicationModel::Resources::ResourceCandidate ResourceManag
     Microsoft::Windows::ApplicationModel::Resources::ResourceContext context,
     hstring name)
 {
+    if (context.as<ResourceContext>()->IsShared())
+    {
+        // Event handlers may change qualifier values on the context they receive. Never give them the shared one.
+        context = CopyResourceContext(context);
+    }
+
     Microsoft::Windows::ApplicationModel::Resources::ResourceNotFoundEventArgs args = winrt::make<ResourceNotFoundEventArgs>(context, name);
     m_resourceNotFound(*this, args);
     Microsoft::Windows::ApplicationModel::Resources::ResourceCandidate candidate = args.as<ResourceNotFoundEventArgs>()->GetResolvedCandidate();
@@ -25,11 +25,23 @@ struct ResourceManager : ResourceManagerT<ResourceManager>
         Microsoft::Windows::ApplicationModel::Resources::ResourceContext context,
         hstring name);
 
+    Microsoft::Windows::ApplicationModel::Resources::ResourceContext GetDefaultResourceContext();
+
 private:
     ~ResourceManager();
+    Microsoft::Windows::ApplicationModel::Resources::ResourceContext CreateResourceContextImpl(bool isShared);
+    Microsoft::Windows::ApplicationModel::Resources::ResourceContext CopyResourceContext(
+        Microsoft::Windows::ApplicationModel::Resources::ResourceContext const& context);
+
     MrmManagerHandle m_resourceManagerHandle = nullptr;
     slim_mutex m_lock;
 
+    // Lazily created context used by lookups that don't supply one. Sharing it keeps the resolver's decision
+    // cache warm across lookups. Only its languages are set, and it is rebuilt when they change.
+    Microsoft::Windows::ApplicationModel::Resources::ResourceContext m_defaultResourceContext = nullptr;
+    hstring m_defaultResourceContextLanguages;
+    slim_mutex m_defaultResourceContextLock;
+
     winrt::event<winrt::Windows::Foundation::TypedEventHandler<
         Microsoft::Windows::ApplicationModel::Resources::ResourceManager,
         Microsoft::Windows::ApplicationModel::Resources::ResourceNotFoundEventArgs>>
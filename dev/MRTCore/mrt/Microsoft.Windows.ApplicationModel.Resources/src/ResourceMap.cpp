@@ -56,8 +56,9 @@ Resources::ResourceMap ResourceMap::TryGetSubtree(hstring const& reference)
 
 Resources::ResourceCandidate ResourceMap::GetValueImpl(const Resources::ResourceContext* context, hstring const& resource, bool treatNotFoundAsOk)
 {
-    // Always use a context as we override the languages.
-    Resources::ResourceContext resourceContext = (context != nullptr) ? *context : m_resourceManager.CreateResourceContext();
+    // Always use a context as we override the languages. Without one, use the manager's shared default context.
+    Resources::ResourceContext resourceContext =
+        (context != nullptr) ? *context : m_resourceManager.as<ResourceManager>()->GetDefaultResourceContext();
 
     if (m_resourceManagerHandle == nullptr)
     {
@@ -75,18 +76,24 @@ Resources::ResourceCandidate ResourceMap::GetValueImpl(const Resources::Resource
         winrt::throw_hresult(HRESULT_FROM_WIN32(ERROR_NOT_FOUND));
     }
 
-    resourceContext.as<Resources::implementation::ResourceContext>()->Apply();
+    // The shared default context gets its languages when it is created and follows its providers otherwise.
+    if (context != nullptr)
+    {
+        resourceContext.as<Resources::implementation::ResourceContext>()->Apply();
+    }
 
     MrmType resourceType;
+    MrmStringView resourceView {};
     wchar_t* resourceString;
     MrmResourceData resourceData {};
 
-    HRESULT hr = MrmLoadStringOrEmbeddedResource(
+    HRESULT hr = MrmLoadStringOrEmbeddedResourceView(
         m_resourceManagerHandle,
         resourceContext.as<Resources::implementation::ResourceContext>()->GetContextHandle(),
         m_resourceMapHandle,
         resource.c_str(),
         &resourceType,
+        &resourceView,
         &resourceString,
         &resourceData);
     if (IsResourceNotFound(hr))
@@ -127,7 +134,7 @@ Resources::ResourceCandidate ResourceMap::GetValueImpl(const Resources::Resource
             static_cast<uint32_t>(-1),
             resource,
             ResourceCandidateKind::String, 
-            winrt::to_hstring(resourceContainer.get()));
+            hstring(resourceView.data, resourceView.length));
     }
     case MrmType_Path:
     {
@@ -139,7 +146,7 @@ Resources::ResourceCandidate ResourceMap::GetValueImpl(const Resources::Resource
             static_cast<uint32_t>(-1),
             resource,
             ResourceCandidateKind::FilePath, 
-            winrt::to_hstring(resourceContainer.get()));
+            hstring(resourceView.data, resourceView.length));
     }
     }
     // Should never happen.
@@ -170,11 +177,15 @@ IKeyValuePair<hstring, Resources::ResourceCandidate> ResourceMap::GetValueByInde
     const Resources::ResourceContext* context,
     uint32_t index)
 {
-    // Always use a context as we override the languages.
+    // Always use a context as we override the languages. Without one, use the manager's shared default context.
     Microsoft::Windows::ApplicationModel::Resources::ResourceContext resourceContext =
-        (context != nullptr) ? *context : m_resourceManager.CreateResourceContext();
+        (context != nullptr) ? *context : m_resourceManager.as<ResourceManager>()->GetDefaultResourceContext();
 
-    resourceContext.as<Resources::implementation::ResourceContext>()->Apply();
+    // The shared default context gets its languages when it is created and follows its providers otherwise.
+    if (context != nullptr)
+    {
+        resourceContext.as<Resources::implementation::ResourceContext>()->Apply();
+    }
 
     MrmType resourceType;
     wchar_t* resourceName;
@@ -22,6 +22,12 @@ namespace ManagedTest
             CommonTestCode.ResourceLoaderTest.GetStringTest_NonDefaultNamespace();
         }
 
+        [TestMethod]
+        public void GetStringsTest()
+        {
+            CommonTestCode.ResourceLoaderTest.GetStringsTest();
+        }
+
         [TestMethod]
         public void GetStringForUriTest()
         {
@@ -138,6 +144,12 @@ namespace ManagedTest
             CommonTestCode.ResourceContextTest.ResourceNotFoundWithContextTest();
         }
 
+        [TestMethod]
+        public void DefaultContextNotModifiedByHandlerTest()
+        {
+            CommonTestCode.ResourceContextTest.DefaultContextNotModifiedByHandlerTest();
+        }
+
         [TestMethod]
         public void NoResourceFileWithContextTest()
         {
@@ -6,6 +6,8 @@
 
 #include "Helpers.h"
 #include "mrm/build/Base.h"
+#include "mrm/readers/MrmReaders.h"
+#include "mrm/platform/WindowsCore.h"
 
 using namespace WEX::Common;
 using namespace WEX::TestExecution;
@@ -161,6 +163,16 @@ class FileAtomPoolUnitTests : public WEX::TestClass<FileAtomPoolUnitTests>, publ
     BEGIN_TEST_METHOD(BigPoolBuilderReaderTests)
         TEST_METHOD_PROPERTY(L"DataSource", L"Table:AtomPool.UnitTests.xml#BigAtomPoolTests")
     END_TEST_METHOD()
+
+    TEST_METHOD(HashVersion2Tests);
+
+    BEGIN_TEST_METHOD(HashMethodPerformanceTests)
+        TEST_METHOD_PROPERTY(L"DataSource", L"Table:AtomPool.UnitTests.xml#HashMethodPerformanceTests")
+    END_TEST_METHOD()
+
+    BEGIN_TEST_METHOD(BulkInternTests)
+        TEST_METHOD_PROPERTY(L"DataSource", L"Table:AtomPool.UnitTests.xml#BulkInternTests")
+    END_TEST_METHOD()
 };
 
 void FileAtomPoolUnitTests::New_ParamChecks(void)
@@ -518,6 +530,314 @@ void FileAtomPoolUnitTests::BigPoolBuilderReaderTests(void)
     delete pBuilder;
 }
 
+void FileAtomPoolUnitTests::HashVersion2Tests(void)
+{
+    // Version 2 folds case for the case-insensitive method only, both in the ASCII fast path
+    // and for other characters.
+    VERIFY_ARE_EQUAL(
+        Atom::HashString(L"Resources/AppDisplayName", Atom::HashMethodCaseInsensitiveVersion2),
+        Atom::HashString(L"RESOURCES/appdisplayname", Atom::HashMethodCaseInsensitiveVersion2));
+    VERIFY_ARE_EQUAL(
+        Atom::HashString(L"\x00C4pfel/Gr\x00FCn", Atom::HashMethodCaseInsensitiveVersion2),
+        Atom::HashString(L"\x00E4PFEL/gR\x00DCN", Atom::HashMethodCaseInsensitiveVersion2));
+    VERIFY_ARE_NOT_EQUAL(
+        Atom::HashString(L"Resources/AppDisplayName", Atom::HashMethodVersion2),
+        Atom::HashString(L"RESOURCES/appdisplayname", Atom::HashMethodVersion2));
+
+    // Length is part of the hash, so zero padding of the last block doesn't matter
+    VERIFY_ARE_NOT_EQUAL(Atom::HashString(L"abcde", Atom::HashMethodVersion2), Atom::HashString(L"abcdef", Atom::HashMethodVersion2));
+
+    // Long names that differ only at the end
+    VERIFY_ARE_NOT_EQUAL(
+        Atom::HashString(L"Files/Assets/Images/Square44x44Logo.targetsize-16.png", Atom::HashMethodCaseInsensitiveVersion2),
+        Atom::HashString(L"Files/Assets/Images/Square44x44Logo.targetsize-61.png", Atom::HashMethodCaseInsensitiveVersion2));
+
+    // Atom pools in files always use the legacy hash, even if a header claims the version 2 hash
+    FileAtomPoolBuilder* pBuilder = NULL;
+    const FileAtomPool* pReader = NULL;
+    Atom atom;
+
+    VERIFY_SUCCEEDED(FileAtomPoolBuilder::CreateInstance(L"Test", true, &pBuilder));
+    pBuilder->SetPoolIndex(1);
+    VERIFY_SUCCEEDED(pBuilder->GetOrAddAtom(L"Resources/AppDisplayName", &atom));
+
+    BuildHelper pool;
+    VERIFY_SUCCEEDED(pool.Build(pBuilder));
+
+    DEFFILE_ATOMPOOL_HEADER* pHeader = reinterpret_cast<DEFFILE_ATOMPOOL_HEADER*>(pool.GetBuffer());
+    VERIFY_IS_TRUE((pHeader->flags & DEF_HASH_VERSION_2) == 0);
+    pHeader->flags |= DEF_HASH_VERSION_2;
+
+    VERIFY_SUCCEEDED(FileAtomPool::CreateInstance(pool.GetBuffer(), pool.GetBufferSize(), (FileAtomPool**)&pReader));
+    VERIFY_IS_TRUE(pReader->TryGetAtom(L"resources/appdisplayname", &atom));
+    VERIFY_ARE_EQUAL(0, atom.GetIndex());
+
+    delete pReader;
+    delete pBuilder;
+}
+
+static int __cdecl CompareHashes(const void* pLeft, const void* pRight)
+{
+    const Atom::Hash left = *static_cast<const Atom::Hash*>(pLeft);
+    const Atom::Hash right = *static_cast<const Atom::Hash*>(pRight);
+    return (left < right) ? -1 : ((left > right) ? 1 : 0);
+}
+
+static int CountHashCollisions(_Inout_updates_(numHashes) Atom::Hash* pHashes, int numHashes)
+{
+    qsort(pHashes, numHashes, sizeof(Atom::Hash), CompareHashes);
+
+    int numCollisions = 0;
+    for (int i = 1; i < numHashes; i++)
+    {
+        if (pHashes[i] == pHashes[i - 1])
+        {
+            numCollisions++;
+        }
+    }
+    return numCollisions;
+}
+
+static void TimeAtomHashes(_In_ PCWSTR description, _In_ const IAtomPool* pPool, int numPasses)
+{
+    String tmp;
+    SYSTEMTIME start;
+    SYSTEMTIME checkpoint;
+    SYSTEMTIME legacyElapsed;
+    SYSTEMTIME version2Elapsed;
+
+    VERIFY_IS_NOT_NULL(pPool);
+    int numNames = static_cast<int>(pPool->GetNumAtoms());
+    Atom::HashMethod legacyMethod = (pPool->GetIsCaseInsensitive() ? Atom::HashMethodCaseInsensitive : Atom::HashMethodDefault);
+    Atom::HashMethod version2Method =
+        (pPool->GetIsCaseInsensitive() ? Atom::HashMethodCaseInsensitiveVersion2 : Atom::HashMethodVersion2);
+
+    StringResult* pNames = new StringResult[numNames];
+    Atom::Hash* legacyHashes = new Atom::Hash[numNames];
+    Atom::Hash* version2Hashes = new Atom::Hash[numNames];
+    VERIFY_IS_NOT_NULL(pNames);
+    VERIFY_IS_NOT_NULL(legacyHashes);
+    VERIFY_IS_NOT_NULL(version2Hashes);
+
+    for (int i = 0; i < numNames; i++)
+    {
+        VERIFY_IS_TRUE(pPool->TryGetString(static_cast<Atom::Index>(i), &pNames[i]));
+    }
+
+    GetSystemTime(&start);
+    for (int iPass = 0; iPass < numPasses; iPass++)
+    {
+        for (int i = 0; i < numNames; i++)
+        {
+            legacyHashes[i] = Atom::HashString(pNames[i].GetRef(), legacyMethod);
+        }
+    }
+    GetSystemTime(&checkpoint);
+    ComputeElapsedTime(start, checkpoint, &legacyElapsed);
+
+    start = checkpoint;
+    for (int iPass = 0; iPass < numPasses; iPass++)
+    {
+        for (int i = 0; i < numNames; i++)
+        {
+            version2Hashes[i] = Atom::HashString(pNames[i].GetRef(), version2Method);
+        }
+    }
+    GetSystemTime(&checkpoint);
+    ComputeElapsedTime(start, checkpoint, &version2Elapsed);
+
+    int legacyCollisions = CountHashCollisions(legacyHashes, numNames);
+    int version2Collisions = CountHashCollisions(version2Hashes, numNames);
+    Log::Comment(tmp.Format(
+        L"[ %s: %d names, %d legacy hash collisions, %d version 2 hash collisions ]", description, numNames, legacyCollisions, version2Collisions));
+    Log::Comment(tmp.Format(
+        L"[ %s: %d legacy hashes in %02d:%02d:%02d:%03d, %d version 2 hashes in %02d:%02d:%02d:%03d ]",
+        description,
+        numNames * numPasses,
+        legacyElapsed.wHour,
+        legacyElapsed.wMinute,
+        legacyElapsed.wSecond,
+        legacyElapsed.wMilliseconds,
+        numNames * numPasses,
+        version2Elapsed.wHour,
+        version2Elapsed.wMinute,
+        version2Elapsed.wSecond,
+        version2Elapsed.wMilliseconds));
+
+    delete[] version2Hashes;
+    delete[] legacyHashes;
+    delete[] pNames;
+}
+
+void FileAtomPoolUnitTests::HashMethodPerformanceTests(void)
+{
+    WEX::Common::String testDirectory;
+    String priFile;
+    int numPasses;
+
+    if (FAILED(RuntimeParameters::TryGetValue(L"TestDeploymentDir", testDirectory)))
+    {
+        Log::Error(L"Unable to find TestDeploymentDir");
+        return;
+    }
+
+    if (FAILED(TestData::TryGetValue(L"PriFile", priFile)) || FAILED(TestData::TryGetValue(L"NumPasses", numPasses)))
+    {
+        Log::Error(L"Couldn't load test data");
+        return;
+    }
+
+    // Use the names from a real PRI file, which is what the hashes see in practice.
+    StringResult priFilePath;
+    VERIFY_SUCCEEDED(priFilePath.SetRef(testDirectory));
+    VERIFY_SUCCEEDED(priFilePath.ConcatPathElement(priFile));
+
+    AutoDeletePtr<CoreProfile> pProfile;
+    VERIFY_SUCCEEDED(CoreProfile::ChooseDefaultProfile(&pProfile));
+    AutoDeletePtr<StandalonePriFile> pPri;
+    VERIFY_SUCCEEDED(StandalonePriFile::CreateInstance(0, priFilePath.GetRef(), pProfile, &pPri));
+
+    const IHierarchicalSchema* pSchema = nullptr;
+    VERIFY_SUCCEEDED(pPri->GetPrimarySchema(&pSchema));
+
+    TimeAtomHashes(L"Scope names", pSchema->GetScopeNames(), numPasses);
+    TimeAtomHashes(L"Item names", pSchema->GetItemNames(), numPasses);
+}
+
+void FileAtomPoolUnitTests::BulkInternTests(void)
+{
+    String nameFormat;
+    String tmp;
+    int numStrings;
+    int numPreexisting;
+    int maxThreads;
+
+    if (FAILED(TestData::TryGetValue(L"NameFormat", nameFormat)) || FAILED(TestData::TryGetValue(L"NumStrings", numStrings)) ||
+        FAILED(TestData::TryGetValue(L"NumPreexisting", numPreexisting)) || FAILED(TestData::TryGetValue(L"MaxThreads", maxThreads)))
+    {
+        Log::Error(L"Couldn't load test data");
+        return;
+    }
+
+    FileAtomPoolBuilder* pSerial = NULL;
+    FileAtomPoolBuilder* pBulk = NULL;
+    VERIFY_SUCCEEDED(FileAtomPoolBuilder::CreateInstance(L"Pool", true, &pSerial));
+    VERIFY_SUCCEEDED(FileAtomPoolBuilder::CreateInstance(L"Pool", true, &pBulk));
+    pSerial->SetPoolIndex(1);
+    pBulk->SetPoolIndex(1);
+
+    WCHAR nameBuf[MAX_PATH];
+    Atom atom;
+    for (int i = 0; i < numPreexisting; i++)
+    {
+        VERIFY_SUCCEEDED(StringCchPrintf(nameBuf, ARRAYSIZE(nameBuf), (PCWSTR)nameFormat, i));
+        VERIFY_SUCCEEDED(pSerial->GetOrAddAtom(nameBuf, &atom));
+        VERIFY_SUCCEEDED(pBulk->GetOrAddAtom(nameBuf, &atom));
+    }
+
+    // Every name appears three times: as is, in upper case, and as its second half, which the
+    // string pool can store as a suffix of the whole name. The first few names are already in both pools.
+    PWSTR* ppStrings = new PWSTR[numStrings];
+    VERIFY_IS_NOT_NULL(ppStrings);
+    for (int i = 0; i < numStrings; i++)
+    {
+        VERIFY_SUCCEEDED(StringCchPrintf(nameBuf, ARRAYSIZE(nameBuf), (PCWSTR)nameFormat, i / 3));
+        PCWSTR pName = nameBuf;
+        if ((i % 3) == 1)
+        {
+            VERIFY_ARE_EQUAL(0, _wcsupr_s(nameBuf, ARRAYSIZE(nameBuf)));
+        }
+        else if ((i % 3) == 2)
+        {
+            pName += wcslen(nameBuf) / 2;
+        }
+
+        size_t cchName = wcslen(pName) + 1;
+        ppStrings[i] = new WCHAR[cchName];
+        VERIFY_IS_NOT_NULL(ppStrings[i]);
+        VERIFY_SUCCEEDED(StringCchCopy(ppStrings[i], cchName, pName));
+    }
+
+    Atom* serialAtoms = new Atom[numStrings];
+    Atom* bulkAtoms = new Atom[numStrings];
+    VERIFY_IS_NOT_NULL(serialAtoms);
+    VERIFY_IS_NOT_NULL(bulkAtoms);
+
+    SYSTEMTIME start;
+    SYSTEMTIME checkpoint;
+    SYSTEMTIME elapsed;
+
+    GetSystemTime(&start);
+    for (int i = 0; i < numStrings; i++)
+    {
+        VERIFY_SUCCEEDED(pSerial->GetOrAddAtom(ppStrings[i], &serialAtoms[i]));
+    }
+    GetSystemTime(&checkpoint);
+    ComputeElapsedTime(start, checkpoint, &elapsed);
+    Log::Comment(tmp.Format(
+        L"[ GetOrAddAtom: %d strings in %02d:%02d:%02d:%03d ]",
+        numStrings,
+        elapsed.wHour,
+        elapsed.wMinute,
+        elapsed.wSecond,
+        elapsed.wMilliseconds));
+
+    GetSystemTime(&start);
+    VERIFY_SUCCEEDED(pBulk->GetOrAddAtoms(ppStrings, static_cast<UINT32>(numStrings), static_cast<UINT32>(maxThreads), bulkAtoms));
+    GetSystemTime(&checkpoint);
+    ComputeElapsedTime(start, checkpoint, &elapsed);
+    Log::Comment(tmp.Format(
+        L"[ GetOrAddAtoms: %d strings on up to %d threads in %02d:%02d:%02d:%03d ]",
+        numStrings,
+        maxThreads,
+        elapsed.wHour,
+        elapsed.wMinute,
+        elapsed.wSecond,
+        elapsed.wMilliseconds));
+
+    VERIFY_ARE_EQUAL(pSerial->GetNumAtoms(), pBulk->GetNumAtoms());
+    for (int i = 0; i < numStrings; i++)
+    {
+        if ((serialAtoms[i].GetIndex() != bulkAtoms[i].GetIndex()) || (serialAtoms[i].GetPoolIndex() != bulkAtoms[i].GetPoolIndex()))
+        {
+            // only report failures to reduce noise
+            VERIFY_ARE_EQUAL(serialAtoms[i].GetIndex(), bulkAtoms[i].GetIndex());
+            VERIFY_ARE_EQUAL(serialAtoms[i].GetPoolIndex(), bulkAtoms[i].GetPoolIndex());
+        }
+        VERIFY_IS_TRUE(pBulk->Equals(bulkAtoms[i], ppStrings[i]));
+    }
+
+    // Both pools should build to the same bytes, including the strings that share storage with others.
+    BuildHelper serialPool;
+    VERIFY_SUCCEEDED(serialPool.Build(pSerial));
+    BuildHelper pool;
+    VERIFY_SUCCEEDED(pool.Build(pBulk));
+    VERIFY_ARE_EQUAL(serialPool.GetBufferSize(), pool.GetBufferSize());
+    VERIFY_ARE_EQUAL(0, memcmp(serialPool.GetBuffer(), pool.GetBuffer(), pool.GetBufferSize()));
+
+    // The bulk pool should read back with every string in place.
+    const FileAtomPool* pReader = NULL;
+    VERIFY_SUCCEEDED(FileAtomPool::CreateInstance(pool.GetBuffer(), pool.GetBufferSize(), (FileAtomPool**)&pReader));
+    VERIFY_ARE_EQUAL(pBulk->GetNumAtoms(), pReader->GetNumAtoms());
+    for (int i = 0; i < numStrings; i++)
+    {
+        Atom::Index index = Atom::IndexNone;
+        VERIFY_IS_TRUE(pReader->TryGetIndex(ppStrings[i], &index));
+        VERIFY_ARE_EQUAL(bulkAtoms[i].GetIndex(), index);
+    }
+
+    for (int i = 0; i < numStrings; i++)
+    {
+        delete[] ppStrings[i];
+    }
+    delete[] ppStrings;
+    delete[] bulkAtoms;
+    delete[] serialAtoms;
+    delete pReader;
+    delete pBulk;
+    delete pSerial;
+}
+
 /*!
      * StaticAtomPool Unit Tests
      */
@@ -7,6 +7,8 @@
 
 #include "mrm/readers/MrmReaders.h"
 #include "mrm/build/MrmBuilders.h"
+#include "mrm/platform/WindowsCore.h"
+#include "mrm/platform/CoreQualifierTypes.h"
 
 #include "TestUtils.h"
 #include "TestPri.h"
@@ -47,6 +49,10 @@ public:
     BEGIN_TEST_METHOD(UnifiedDecisionInfoTests)
         TEST_METHOD_PROPERTY(L"DataSource", L"Table:DecisionInfo.UnitTests.xml#MergeTests")
     END_TEST_METHOD();
+
+    BEGIN_TEST_METHOD(ParsedQualifierValueTests)
+        TEST_METHOD_PROPERTY(L"DataSource", L"Table:DecisionInfo.UnitTests.xml#ParsedQualifierValueTests")
+    END_TEST_METHOD();
 };
 
 bool DecisionInfoUnitTests::ClassSetup() { return true; }
@@ -372,4 +378,179 @@ void DecisionInfoUnitTests::UnifiedDecisionInfoTests()
     validate.ValidateDecisions(pMergedDI, pBuilderEnvironment);
 }
 
+// Checks that parsed provider values score exactly like the strings they came from, then times both.
+static void VerifyParsedEvaluation(
+    _In_ PCWSTR pLabel,
+    _In_ const IQualifierType* pType,
+    _In_reads_(numAssets) const QualifierResult* pAssetQualifiers,
+    _In_ int numAssets,
+    _In_reads_(numProviderValues) const PCWSTR* ppProviderValues,
+    _In_ int numProviderValues,
+    _In_ int iterations)
+{
+    String tmp;
+
+    ParsedQualifierValue** ppParsedValues = new ParsedQualifierValue*[numProviderValues];
+    VERIFY_IS_NOT_NULL(ppParsedValues);
+    for (int i = 0; i < numProviderValues; i++)
+    {
+        VERIFY_SUCCEEDED(pType->ParseProviderValue(ppProviderValues[i], &ppParsedValues[i]));
+    }
+
+    for (int iProvider = 0; iProvider < numProviderValues; iProvider++)
+    {
+        for (int iAsset = 0; iAsset < numAssets; iAsset++)
+        {
+            double score = -1.0;
+            double parsedScore = -1.0;
+            HRESULT hr = pType->Evaluate(&pAssetQualifiers[iAsset], ppProviderValues[iProvider], &score);
+            HRESULT hrParsed = pType->EvaluateParsed(&pAssetQualifiers[iAsset], ppParsedValues[iProvider], &parsedScore);
+
+            if ((hr != hrParsed) || (score != parsedScore))
+            {
+                StringResult assetValue;
+                VERIFY_SUCCEEDED(pAssetQualifiers[iAsset].GetOperand2Literal(&assetValue));
+                Log::Error(tmp.Format(
+                    L"[ %s: asset value \"%s\" with provider value \"%s\": expected 0x%08x/%f, got 0x%08x/%f ]",
+                    pLabel,
+                    assetValue.GetRef(),
+                    ppProviderValues[iProvider],
+                    hr,
+                    score,
+                    hrParsed,
+                    parsedScore));
+            }
+        }
+    }
+
+    SYSTEMTIME start;
+    SYSTEMTIME checkpoint;
+    SYSTEMTIME elapsed;
+    double score;
+
+    GetSystemTime(&start);
+    for (int iteration = 0; iteration < iterations; iteration++)
+    {
+        for (int iProvider = 0; iProvider < numProviderValues; iProvider++)
+        {
+            for (int iAsset = 0; iAsset < numAssets; iAsset++)
+            {
+                (void)pType->Evaluate(&pAssetQualifiers[iAsset], ppProviderValues[iProvider], &score);
+            }
+        }
+    }
+    GetSystemTime(&checkpoint);
+    ComputeElapsedTime(start, checkpoint, &elapsed);
+    Log::Comment(tmp.Format(
+        L"[ %s Evaluate: %d evaluations in %02d:%02d:%02d:%03d ]",
+        pLabel,
+        iterations * numProviderValues * numAssets,
+        elapsed.wHour,
+        elapsed.wMinute,
+        elapsed.wSecond,
+        elapsed.wMilliseconds));
+
+    GetSystemTime(&start);
+    for (int iteration = 0; iteration < iterations; iteration++)
+    {
+        for (int iProvider = 0; iProvider < numProviderValues; iProvider++)
+        {
+            for (int iAsset = 0; iAsset < numAssets; iAsset++)
+            {
+                (void)pType->EvaluateParsed(&pAssetQualifiers[iAsset], ppParsedValues[iProvider], &score);
+            }
+        }
+    }
+    GetSystemTime(&checkpoint);
+    ComputeElapsedTime(start, checkpoint, &elapsed);
+    Log::Comment(tmp.Format(
+        L"[ %s EvaluateParsed: %d evaluations in %02d:%02d:%02d:%03d ]",
+        pLabel,
+        iterations * numProviderValues * numAssets,
+        elapsed.wHour,
+        elapsed.wMinute,
+        elapsed.wSecond,
+        elapsed.wMilliseconds));
+
+    for (int i = 0; i < numProviderValues; i++)
+    {
+        delete ppParsedValues[i];
+    }
+    delete[] ppParsedValues;
+}
+
+void DecisionInfoUnitTests::ParsedQualifierValueTests()
+{
+    String qualifierName;
+    TestDataArray<String> assetValues;
+    TestDataArray<String> providerValues;
+    int iterations;
+
+    if (FAILED(TestData::TryGetValue(L"Qualifier", qualifierName)) || FAILED(TestData::TryGetValue(L"AssetValues", assetValues)) ||
+        FAILED(TestData::TryGetValue(L"ProviderValues", providerValues)) || FAILED(TestData::TryGetValue(L"Iterations", iterations)))
+    {
+        Log::Error(L"[ Couldn't load test data ]");
+        return;
+    }
+
+    AutoDeletePtr<CoreProfile> pProfile;
+    VERIFY_SUCCEEDED(CoreProfile::ChooseDefaultProfile(&pProfile));
+    AutoDeletePtr<AtomPoolGroup> pAtoms;
+    VERIFY_SUCCEEDED(AtomPoolGroup::CreateInstance(&pAtoms));
+    AutoDeletePtr<UnifiedEnvironment> pEnvironment;
+    VERIFY_SUCCEEDED(UnifiedEnvironment::CreateInstance(pProfile, pAtoms, &pEnvironment));
+    AutoDeletePtr<DecisionInfoBuilder> pBuilder;
+    VERIFY_SUCCEEDED(DecisionInfoBuilder::CreateInstance(pEnvironment, &pBuilder));
+
+    int numAssets = static_cast<int>(assetValues.GetSize());
+    QualifierResult* pAssetQualifiers = new QualifierResult[numAssets];
+    VERIFY_IS_NOT_NULL(pAssetQualifiers);
+    for (int i = 0; i < numAssets; i++)
+    {
+        VERIFY_SUCCEEDED(pBuilder->GetOrAddQualifier((PCWSTR)qualifierName, (PCWSTR)assetValues[i], 0.0, &pAssetQualifiers[i]));
+    }
+
+    // Every type also sees an empty provider value, which some types accept and some reject.
+    int numProviderValues = static_cast<int>(providerValues.GetSize()) + 1;
+    PCWSTR* ppProviderValues = new PCWSTR[numProviderValues];
+    VERIFY_IS_NOT_NULL(ppProviderValues);
+    for (int i = 0; i < numProviderValues; i++)
+    {
+        ppProviderValues[i] = ((i < numProviderValues - 1) ? (PCWSTR)providerValues[i] : L"");
+    }
+
+    const IBuildQualifierType* pType;
+    VERIFY_SUCCEEDED(pEnvironment->GetTypeOfQualifier((PCWSTR)qualifierName, &pType));
+    VerifyParsedEvaluation((PCWSTR)qualifierName, pType, pAssetQualifiers, numAssets, ppProviderValues, numProviderValues, iterations);
+
+    // The default profile uses generic types, so check the typed core qualifier types directly too.
+    AutoDeletePtr<IBuildQualifierType> pCoreType;
+    if (DefString_ICompare((PCWSTR)qualifierName, CoreEnvironment::Qualifier_Contrast) == Def_Equal)
+    {
+        VERIFY_SUCCEEDED(ContrastQualifierType::CreateInstance((ContrastQualifierType**)&pCoreType));
+    }
+    else if (DefString_ICompare((PCWSTR)qualifierName, CoreEnvironment::Qualifier_Scale) == Def_Equal)
+    {
+        VERIFY_SUCCEEDED(ScaleQualifierType::CreateInstance((ScaleQualifierType**)&pCoreType));
+    }
+    else if (DefString_ICompare((PCWSTR)qualifierName, CoreEnvironment::Qualifier_DXFeatureLevel) == Def_Equal)
+    {
+        VERIFY_SUCCEEDED(DXFeatureLevelQualifierType::CreateInstance((DXFeatureLevelQualifierType**)&pCoreType));
+    }
+    else if (DefString_ICompare((PCWSTR)qualifierName, CoreEnvironment::Qualifier_DeviceFamily) == Def_Equal)
+    {
+        VERIFY_SUCCEEDED(DeviceFamilyQualifierType::CreateInstance((DeviceFamilyQualifierType**)&pCoreType));
+    }
+
+    if (pCoreType != nullptr)
+    {
+        String label;
+        label.Format(L"%s (core type)", (PCWSTR)qualifierName);
+        VerifyParsedEvaluation((PCWSTR)label, pCoreType, pAssetQualifiers, numAssets, ppProviderValues, numProviderValues, iterations);
+    }
+
+    delete[] ppProviderValues;
+    delete[] pAssetQualifiers;
+}
+
 } // namespace UnitTests
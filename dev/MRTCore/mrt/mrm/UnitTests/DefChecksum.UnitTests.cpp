@@ -39,8 +39,25 @@ public:
         TEST_METHOD_PROPERTY(L"DataSource", L"Table:DefChecksum.UnitTests.xml#FileChecksumTests")
     END_TEST_METHOD()
     TEST_METHOD(FileChecksumFailsForMissingFile);
+    TEST_METHOD(Crc32MatchesReferenceTests);
+    TEST_METHOD(Crc32ThroughputTests);
 };
 
+// Bit-at-a-time CRC-32 (ISO 3309), used to check _DefComputeCrc32 whichever engine it picks.
+static UINT32 ComputeReferenceCrc32(_In_ UINT32 partialCrc, _In_reads_bytes_(cbBuf) const BYTE* pBuf, _In_ UINT32 cbBuf)
+{
+    UINT32 crc = ~partialCrc;
+    for (UINT32 i = 0; i < cbBuf; i++)
+    {
+        crc ^= pBuf[i];
+        for (int bit = 0; bit < 8; bit++)
+        {
+            crc = ((crc & 1) != 0) ? (0xedb88320 ^ (crc >> 1)) : (crc >> 1);
+        }
+    }
+    return ~crc;
+}
+
 void DefChecksumUnitTests::IntegerChecksumTests(void)
 {
     DefChecksum::Checksum cs1;
@@ -356,4 +373,84 @@ void DefChecksumUnitTests::FileChecksumFailsForMissingFile(void)
     VERIFY_FAILED(DefChecksum::ComputeFileChecksum(0, L"missingfile.htm", &checksum));
 }
 
+void DefChecksumUnitTests::Crc32MatchesReferenceTests(void)
+{
+    // The well-known check value for CRC-32.
+    const char check[] = "123456789";
+    VERIFY_ARE_EQUAL(0xcbf43926u, _DefComputeCrc32(0, reinterpret_cast<const BYTE*>(check), 9));
+
+    // Cover short buffers, every alignment, lengths on both sides of the folding block
+    // sizes, and continuing from a partial CRC.
+    const UINT32 cbBuffer = 4096 + 64;
+    BYTE* pBuffer = new BYTE[cbBuffer];
+    for (UINT32 i = 0; i < cbBuffer; i++)
+    {
+        pBuffer[i] = static_cast<BYTE>((i * 167) ^ (i >> 5));
+    }
+
+    const UINT32 partialCrcs[] = {0, 0xffffffff, 0x12345678};
+    for (UINT32 offset = 0; offset < 16; offset++)
+    {
+        for (UINT32 cbData = 0; cbData <= 4096; cbData = ((cbData < 300) ? (cbData + 1) : (cbData + 61)))
+        {
+            for (int p = 0; p < ARRAYSIZE(partialCrcs); p++)
+            {
+                UINT32 expected = ComputeReferenceCrc32(partialCrcs[p], &pBuffer[offset], cbData);
+                UINT32 actual = _DefComputeCrc32(partialCrcs[p], &pBuffer[offset], cbData);
+                if (expected != actual)
+                {
+                    VERIFY_ARE_EQUAL(expected, actual, String().Format(L"offset %u, %u bytes, partial 0x%08x", offset, cbData, partialCrcs[p]));
+                }
+            }
+        }
+    }
+
+    // Computing in pieces must give the same answer as computing all at once.
+    UINT32 whole = _DefComputeCrc32(0, pBuffer, cbBuffer);
+    UINT32 pieces = _DefComputeCrc32(0, pBuffer, 100);
+    pieces = _DefComputeCrc32(pieces, &pBuffer[100], 1000);
+    pieces = _DefComputeCrc32(pieces, &pBuffer[1100], cbBuffer - 1100);
+    VERIFY_ARE_EQUAL(whole, pieces);
+
+    delete[] pBuffer;
+}
+
+void DefChecksumUnitTests::Crc32ThroughputTests(void)
+{
+    const UINT32 bufferSizes[] = {16, 64, 256, 4096, 32 * 1024, 1024 * 1024};
+    const UINT64 cbPerSize = 256 * 1024 * 1024;
+
+    const UINT32 cbBuffer = 1024 * 1024;
+    BYTE* pBuffer = new BYTE[cbBuffer];
+    for (UINT32 i = 0; i < cbBuffer; i++)
+    {
+        pBuffer[i] = static_cast<BYTE>(i * 31);
+    }
+
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+
+    for (int s = 0; s < ARRAYSIZE(bufferSizes); s++)
+    {
+        UINT32 cbData = bufferSizes[s];
+        UINT64 iterations = cbPerSize / cbData;
+        UINT32 crc = 0;
+
+        LARGE_INTEGER start;
+        LARGE_INTEGER end;
+        QueryPerformanceCounter(&start);
+        for (UINT64 i = 0; i < iterations; i++)
+        {
+            crc = _DefComputeCrc32(crc, pBuffer, cbData);
+        }
+        QueryPerformanceCounter(&end);
+
+        double seconds = static_cast<double>(end.QuadPart - start.QuadPart) / static_cast<double>(frequency.QuadPart);
+        double gigabytesPerSecond = (seconds > 0) ? ((static_cast<double>(iterations) * cbData) / seconds / 1e9) : 0;
+        Log::Comment(String().Format(L"%7u byte buffers: %.2f GB/s (crc 0x%08x)", cbData, gigabytesPerSecond, crc));
+    }
+
+    delete[] pBuffer;
+}
+
 }; // namespace UnitTests
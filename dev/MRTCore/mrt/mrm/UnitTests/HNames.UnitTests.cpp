@@ -34,9 +34,25 @@ class HierarchicalNamesUnitTests : public WEX::TestClass<HierarchicalNamesUnitTe
         TEST_METHOD_PROPERTY(L"DataSource", L"Table:HNames.UnitTests.xml#SimpleBuilderReaderTests")
     END_TEST_METHOD()
 
+    BEGIN_TEST_METHOD(SimpleBuilderReaderPathIndexTests)
+        TEST_METHOD_PROPERTY(L"DataSource", L"Table:HNames.UnitTests.xml#SimpleBuilderReaderTests")
+    END_TEST_METHOD()
+
     BEGIN_TEST_METHOD(LargeBuilderReaderTests)
         TEST_METHOD_PROPERTY(L"DataSource", L"Table:HNames.UnitTests.xml#LargeBuilderReaderTests")
     END_TEST_METHOD()
+
+    BEGIN_TEST_METHOD(PathIndexLookupTests)
+        TEST_METHOD_PROPERTY(L"DataSource", L"Table:HNames.UnitTests.xml#PathIndexLookupTests")
+    END_TEST_METHOD()
+
+    BEGIN_TEST_METHOD(SimpleBuilderReaderDeferredSortTests)
+        TEST_METHOD_PROPERTY(L"DataSource", L"Table:HNames.UnitTests.xml#SimpleBuilderReaderTests")
+    END_TEST_METHOD()
+
+    BEGIN_TEST_METHOD(DeferredChildSortTests)
+        TEST_METHOD_PROPERTY(L"DataSource", L"Table:HNames.UnitTests.xml#DeferredChildSortTests")
+    END_TEST_METHOD()
 };
 
 void CheckNames(_In_ const IHierarchicalNames* pNames)
@@ -604,6 +620,7 @@ static void SimpleBuilderReaderTestsInternal(_In_ UINT32 flags, _In_ const DEFFI
     // Should be able to read the built pool
     hr = HierarchicalNames::CreateInstance(type, names.GetBuffer(), names.GetBufferSize(), (HierarchicalNames**)&pReader);
     VERIFY_HRESULT_EXPR((pReader != NULL), hr);
+    VERIFY(pReader->HasPathIndex() == ((flags & HierarchicalNamesBuilder::BuildPathIndex) != 0));
 
     CheckNames(pReader);
     CheckContents(pReader);
@@ -627,6 +644,13 @@ void HierarchicalNamesUnitTests::SimpleBuilderReaderExTests(void)
     SimpleBuilderReaderTestsInternal(HierarchicalNamesBuilder::BuildAsciiOrUtf16, gHierarchicalNamesExSectionType);
 }
 
+void HierarchicalNamesUnitTests::SimpleBuilderReaderPathIndexTests(void)
+{
+    Log::Comment(L"[ Building ASCII/UTF-16 with full path index ]");
+    SimpleBuilderReaderTestsInternal(
+        HierarchicalNamesBuilder::BuildAsciiOrUtf16 | HierarchicalNamesBuilder::BuildPathIndex, gHierarchicalNamesExSectionType);
+}
+
 void HierarchicalNamesUnitTests::LargeBuilderReaderTests(void)
 {
     HRESULT hr = S_OK;
@@ -795,4 +819,332 @@ void HierarchicalNamesUnitTests::LargeBuilderReaderTests(void)
     }
 }
 
+static void TimePathLookups(
+    _In_ PCWSTR description,
+    _In_ const HierarchicalNames* pReader,
+    _In_ int numItems,
+    _In_ int itemsPerScope,
+    _In_ PCWSTR nameFormat,
+    _In_ int numPasses)
+{
+    String tmp;
+    WCHAR nameBuf[MAX_PATH];
+    SYSTEMTIME start;
+    SYSTEMTIME checkpoint;
+    SYSTEMTIME elapsed;
+
+    GetSystemTime(&start);
+    for (int iPass = 0; iPass < numPasses; iPass++)
+    {
+        for (int iItem = 0; iItem < numItems; iItem++)
+        {
+            VERIFY_SUCCEEDED(StringCchPrintf(nameBuf, ARRAYSIZE(nameBuf), nameFormat, iItem / itemsPerScope, iItem));
+
+            int itemIndex = -1;
+            if (!pReader->Contains(nameBuf, nullptr, &itemIndex) || (itemIndex < 0))
+            {
+                Log::Error(tmp.Format(L"[ Couldn't find '%s' ]", nameBuf));
+                return;
+            }
+        }
+
+        // and one miss per item
+        for (int iItem = 0; iItem < numItems; iItem++)
+        {
+            VERIFY_SUCCEEDED(StringCchPrintf(nameBuf, ARRAYSIZE(nameBuf), nameFormat, iItem / itemsPerScope, numItems + iItem));
+            if (pReader->Contains(nameBuf))
+            {
+                Log::Error(tmp.Format(L"[ Unexpectedly found '%s' ]", nameBuf));
+                return;
+            }
+        }
+    }
+    GetSystemTime(&checkpoint);
+    ComputeElapsedTime(start, checkpoint, &elapsed);
+    Log::Comment(tmp.Format(
+        L"[ %s: %d lookups in %02d:%02d:%02d:%03d ]",
+        description,
+        numItems * numPasses * 2,
+        elapsed.wHour,
+        elapsed.wMinute,
+        elapsed.wSecond,
+        elapsed.wMilliseconds));
+}
+
+void HierarchicalNamesUnitTests::PathIndexLookupTests(void)
+{
+    HRESULT hr = S_OK;
+    String tmp;
+
+    int numItems = -1;
+    int itemsPerScope = 100;
+    int numPasses = 1;
+    String nameFormat = L"Resources/Group%d/Item%d";
+
+    if (FAILED(TestData::TryGetValue(L"NumItems", numItems)))
+    {
+        Log::Error(L"[ NumItems not defined ]");
+        return;
+    }
+    (void)TestData::TryGetValue(L"ItemsPerScope", itemsPerScope);
+    (void)TestData::TryGetValue(L"NumPasses", numPasses);
+    (void)TestData::TryGetValue(L"NameFormat", nameFormat);
+
+    AutoDeletePtr<HierarchicalNamesBuilder> pPlainBuilder;
+    AutoDeletePtr<HierarchicalNamesBuilder> pIndexedBuilder;
+    VERIFY_SUCCEEDED(HierarchicalNamesBuilder::CreateInstance(HierarchicalNamesBuilder::BuildAsciiOrUtf16, &pPlainBuilder));
+    VERIFY_SUCCEEDED(HierarchicalNamesBuilder::CreateInstance(
+        HierarchicalNamesBuilder::BuildAsciiOrUtf16 | HierarchicalNamesBuilder::BuildPathIndex, &pIndexedBuilder));
+
+    WCHAR nameBuf[MAX_PATH];
+    for (int iItem = 0; iItem < numItems; iItem++)
+    {
+        VERIFY_SUCCEEDED(StringCchPrintf(nameBuf, ARRAYSIZE(nameBuf), (PCWSTR)nameFormat, iItem / itemsPerScope, iItem));
+
+        ItemInfo* item;
+        VERIFY_SUCCEEDED(pPlainBuilder->GetOrAddItem(nameBuf, &item));
+        VERIFY_SUCCEEDED(pIndexedBuilder->GetOrAddItem(nameBuf, &item));
+    }
+
+    BuildHelper plainNames;
+    BuildHelper indexedNames;
+    VERIFY_HRESULT(plainNames.Build(pPlainBuilder));
+    VERIFY_HRESULT(indexedNames.Build(pIndexedBuilder));
+    Log::Comment(tmp.Format(
+        L"[ %d names: %d bytes without index, %d bytes with index ]", numItems, plainNames.GetBufferSize(), indexedNames.GetBufferSize()));
+
+    AutoDeletePtr<HierarchicalNames> pPlainReader;
+    AutoDeletePtr<HierarchicalNames> pIndexedReader;
+    hr = HierarchicalNames::CreateInstance(
+        pPlainBuilder->GetSectionType(), plainNames.GetBuffer(), plainNames.GetBufferSize(), &pPlainReader);
+    VERIFY_HRESULT_EXPR((pPlainReader != NULL), hr);
+    hr = HierarchicalNames::CreateInstance(
+        pIndexedBuilder->GetSectionType(), indexedNames.GetBuffer(), indexedNames.GetBufferSize(), &pIndexedReader);
+    VERIFY_HRESULT_EXPR((pIndexedReader != NULL), hr);
+
+    VERIFY(!pPlainReader->HasPathIndex());
+    VERIFY(pIndexedReader->HasPathIndex());
+
+    // Both readers must agree on every name, whichever way they look it up.
+    for (int iName = 1; iName < pIndexedReader->GetNumNames(); iName++)
+    {
+        StringResult name;
+        int scopeIndex;
+        int itemIndex;
+        VERIFY(pIndexedReader->TryGetName(iName, &name, &scopeIndex, &itemIndex));
+
+        int plainScopeIndex, plainItemIndex, plainNameIndex;
+        int indexedScopeIndex, indexedItemIndex, indexedNameIndex;
+        VERIFY(pPlainReader->Contains(name.GetRef(), &plainScopeIndex, &plainItemIndex, &plainNameIndex));
+        VERIFY(pIndexedReader->Contains(name.GetRef(), &indexedScopeIndex, &indexedItemIndex, &indexedNameIndex));
+        VERIFY_ARE_EQUAL(plainScopeIndex, indexedScopeIndex);
+        VERIFY_ARE_EQUAL(plainItemIndex, indexedItemIndex);
+        VERIFY_ARE_EQUAL(plainNameIndex, indexedNameIndex);
+        VERIFY_ARE_EQUAL(iName, indexedNameIndex);
+        VERIFY_ARE_EQUAL(scopeIndex, indexedScopeIndex);
+        VERIFY_ARE_EQUAL(itemIndex, indexedItemIndex);
+    }
+
+    // Lookups relative to a scope, with the other separator and in a different case.
+    int scopeIndex = -1;
+    VERIFY(pIndexedReader->Contains(L"resources", &scopeIndex));
+    VERIFY(pIndexedReader->Contains(L"GROUP0\\item0", scopeIndex));
+    VERIFY(pIndexedReader->Contains(L"/resources/group0/ITEM0"));
+    VERIFY(!pIndexedReader->Contains(L"resources//group0/item0"));
+    VERIFY(!pIndexedReader->Contains(L"group0/item0"));
+    VERIFY(!pIndexedReader->Contains(L"item0", scopeIndex));
+
+    // Stored names with a dotless i or long s can compare equal to an ASCII query, so the index must not report
+    // a miss that the segment walk would find.
+    const PCWSTR foldedNames[] = { L"Resources/D\x0131alog", L"Resources/Me\x017Fsage", L"Resources/\x017Fave" };
+    const PCWSTR foldedQueries[] = { L"resources/dialog", L"RESOURCES/MESSAGE", L"Resources/Save", L"Resources/Dialogs" };
+    AutoDeletePtr<HierarchicalNamesBuilder> pFoldedPlainBuilder;
+    AutoDeletePtr<HierarchicalNamesBuilder> pFoldedIndexedBuilder;
+    VERIFY_SUCCEEDED(HierarchicalNamesBuilder::CreateInstance(HierarchicalNamesBuilder::BuildAsciiOrUtf16, &pFoldedPlainBuilder));
+    VERIFY_SUCCEEDED(HierarchicalNamesBuilder::CreateInstance(
+        HierarchicalNamesBuilder::BuildAsciiOrUtf16 | HierarchicalNamesBuilder::BuildPathIndex, &pFoldedIndexedBuilder));
+    for (unsigned int i = 0; i < ARRAYSIZE(foldedNames); i++)
+    {
+        ItemInfo* item;
+        VERIFY_SUCCEEDED(pFoldedPlainBuilder->GetOrAddItem(foldedNames[i], &item));
+        VERIFY_SUCCEEDED(pFoldedIndexedBuilder->GetOrAddItem(foldedNames[i], &item));
+    }
+
+    BuildHelper foldedPlainNames;
+    BuildHelper foldedIndexedNames;
+    VERIFY_HRESULT(foldedPlainNames.Build(pFoldedPlainBuilder));
+    VERIFY_HRESULT(foldedIndexedNames.Build(pFoldedIndexedBuilder));
+
+    AutoDeletePtr<HierarchicalNames> pFoldedPlainReader;
+    AutoDeletePtr<HierarchicalNames> pFoldedIndexedReader;
+    hr = HierarchicalNames::CreateInstance(
+        pFoldedPlainBuilder->GetSectionType(), foldedPlainNames.GetBuffer(), foldedPlainNames.GetBufferSize(), &pFoldedPlainReader);
+    VERIFY_HRESULT_EXPR((pFoldedPlainReader != NULL), hr);
+    hr = HierarchicalNames::CreateInstance(
+        pFoldedIndexedBuilder->GetSectionType(), foldedIndexedNames.GetBuffer(), foldedIndexedNames.GetBufferSize(), &pFoldedIndexedReader);
+    VERIFY_HRESULT_EXPR((pFoldedIndexedReader != NULL), hr);
+    VERIFY(pFoldedIndexedReader->HasPathIndex());
+
+    for (unsigned int i = 0; i < ARRAYSIZE(foldedQueries); i++)
+    {
+        int plainScopeIndex, plainItemIndex, plainNameIndex;
+        int indexedScopeIndex, indexedItemIndex, indexedNameIndex;
+        bool plainFound = pFoldedPlainReader->Contains(foldedQueries[i], &plainScopeIndex, &plainItemIndex, &plainNameIndex);
+        bool indexedFound = pFoldedIndexedReader->Contains(foldedQueries[i], &indexedScopeIndex, &indexedItemIndex, &indexedNameIndex);
+        VERIFY_ARE_EQUAL(plainFound, indexedFound);
+        if (plainFound)
+        {
+            VERIFY_ARE_EQUAL(plainItemIndex, indexedItemIndex);
+            VERIFY_ARE_EQUAL(plainNameIndex, indexedNameIndex);
+        }
+    }
+
+    TimePathLookups(L"Segment walk", pPlainReader, numItems, itemsPerScope, (PCWSTR)nameFormat, numPasses);
+    TimePathLookups(L"Full path index", pIndexedReader, numItems, itemsPerScope, (PCWSTR)nameFormat, numPasses);
+}
+
+void HierarchicalNamesUnitTests::SimpleBuilderReaderDeferredSortTests(void)
+{
+    Log::Comment(L"[ Building ASCII/UTF-16 with full path index and deferred child sorting ]");
+    SimpleBuilderReaderTestsInternal(
+        HierarchicalNamesBuilder::BuildAsciiOrUtf16 | HierarchicalNamesBuilder::BuildPathIndex | HierarchicalNamesBuilder::BuildDeferChildSort,
+        gHierarchicalNamesExSectionType);
+}
+
+// Adds numItems names to pBuilder in descending order, which is the worst case for sorted insertion, then adds
+// every tenth name again in upper case and checks that it finds the existing item.  Builds the section into
+// pNames and logs how long each step took.
+static void BuildFlatScope(
+    _In_ PCWSTR description,
+    _In_ HierarchicalNamesBuilder* pBuilder,
+    _In_ int numItems,
+    _In_ PCWSTR nameFormat,
+    _Inout_ BuildHelper* pNames)
+{
+    String tmp;
+    WCHAR nameBuf[MAX_PATH];
+    SYSTEMTIME start;
+    SYSTEMTIME populated;
+    SYSTEMTIME built;
+    SYSTEMTIME populateElapsed;
+    SYSTEMTIME buildElapsed;
+
+    GetSystemTime(&start);
+    for (int iItem = numItems - 1; iItem >= 0; iItem--)
+    {
+        VERIFY_SUCCEEDED(StringCchPrintf(nameBuf, ARRAYSIZE(nameBuf), nameFormat, iItem));
+
+        ItemInfo* pItem;
+        VERIFY_SUCCEEDED(pBuilder->GetOrAddItem(nameBuf, &pItem));
+    }
+
+    for (int iItem = 0; iItem < numItems; iItem += 10)
+    {
+        VERIFY_SUCCEEDED(StringCchPrintf(nameBuf, ARRAYSIZE(nameBuf), nameFormat, iItem));
+        _wcsupr_s(nameBuf, ARRAYSIZE(nameBuf));
+
+        ItemInfo* pItem;
+        VERIFY_SUCCEEDED(pBuilder->GetOrAddItem(nameBuf, &pItem));
+        VERIFY_ARE_EQUAL(pItem->GetIndex(), numItems - 1 - iItem);
+    }
+    VERIFY_ARE_EQUAL(pBuilder->GetNumItems(), numItems);
+    GetSystemTime(&populated);
+
+    VERIFY_SUCCEEDED(pNames->Build(pBuilder));
+    GetSystemTime(&built);
+
+    ComputeElapsedTime(start, populated, &populateElapsed);
+    ComputeElapsedTime(populated, built, &buildElapsed);
+    Log::Comment(tmp.Format(
+        L"[ %s: %d names added in %02d:%02d:%02d:%03d, built %d bytes in %02d:%02d:%02d:%03d ]",
+        description,
+        numItems,
+        populateElapsed.wHour,
+        populateElapsed.wMinute,
+        populateElapsed.wSecond,
+        populateElapsed.wMilliseconds,
+        pNames->GetBufferSize(),
+        buildElapsed.wHour,
+        buildElapsed.wMinute,
+        buildElapsed.wSecond,
+        buildElapsed.wMilliseconds));
+}
+
+void HierarchicalNamesUnitTests::DeferredChildSortTests(void)
+{
+    HRESULT hr = S_OK;
+
+    int numItems = -1;
+    String nameFormat = L"Resources/Item%d";
+    bool compareWithSortedInsert = true;
+
+    if (FAILED(TestData::TryGetValue(L"NumItems", numItems)))
+    {
+        Log::Error(L"[ NumItems not defined ]");
+        return;
+    }
+    (void)TestData::TryGetValue(L"NameFormat", nameFormat);
+    (void)TestData::TryGetValue(L"CompareWithSortedInsert", compareWithSortedInsert);
+
+    const UINT32 flags = HierarchicalNamesBuilder::BuildAsciiOrUtf16 | HierarchicalNamesBuilder::BuildPathIndex;
+
+    AutoDeletePtr<HierarchicalNamesBuilder> pDeferredBuilder;
+    VERIFY_SUCCEEDED(HierarchicalNamesBuilder::CreateInstance(flags | HierarchicalNamesBuilder::BuildDeferChildSort, &pDeferredBuilder));
+
+    BuildHelper deferredNames;
+    BuildFlatScope(L"Deferred sort", pDeferredBuilder, numItems, (PCWSTR)nameFormat, &deferredNames);
+
+    if (compareWithSortedInsert)
+    {
+        AutoDeletePtr<HierarchicalNamesBuilder> pSortedBuilder;
+        VERIFY_SUCCEEDED(HierarchicalNamesBuilder::CreateInstance(flags, &pSortedBuilder));
+
+        BuildHelper sortedNames;
+        BuildFlatScope(L"Sorted insert", pSortedBuilder, numItems, (PCWSTR)nameFormat, &sortedNames);
+
+        // Both modes must produce exactly the same section.
+        VERIFY_ARE_EQUAL(sortedNames.GetBufferSize(), deferredNames.GetBufferSize());
+        VERIFY_ARE_EQUAL(memcmp(sortedNames.GetBuffer(), deferredNames.GetBuffer(), deferredNames.GetBufferSize()), 0);
+    }
+
+    AutoDeletePtr<HierarchicalNames> pReader;
+    hr = HierarchicalNames::CreateInstance(
+        pDeferredBuilder->GetSectionType(), deferredNames.GetBuffer(), deferredNames.GetBufferSize(), &pReader);
+    VERIFY_HRESULT_EXPR((pReader != NULL), hr);
+
+    // Children must come back in order, and every name must be found under its original item index.
+    int scopeIndex = -1;
+    VERIFY(pReader->Contains(L"Resources", &scopeIndex));
+
+    StringResult previousName;
+    StringResult name;
+    int numChildren = 0;
+    VERIFY(pReader->TryGetScopeInfo(scopeIndex, &name, &numChildren));
+    VERIFY_ARE_EQUAL(numChildren, numItems);
+
+    for (int iChild = 0; iChild < numChildren; iChild++)
+    {
+        VERIFY(pReader->TryGetScopeChildName(scopeIndex, iChild, &name));
+        if ((iChild > 0) && (DefString_ICompare(previousName.GetRef(), name.GetRef()) != Def_Less))
+        {
+            Log::Error(String().Format(L"[ Child %d '%s' is out of order after '%s' ]", iChild, name.GetRef(), previousName.GetRef()));
+            return;
+        }
+        VERIFY_SUCCEEDED(previousName.SetCopy(name.GetRef()));
+    }
+
+    WCHAR nameBuf[MAX_PATH];
+    for (int iItem = 0; iItem < numItems; iItem++)
+    {
+        VERIFY_SUCCEEDED(StringCchPrintf(nameBuf, ARRAYSIZE(nameBuf), (PCWSTR)nameFormat, iItem));
+
+        int itemIndex = -1;
+        if (!pReader->Contains(nameBuf, nullptr, &itemIndex) || (itemIndex != (numItems - 1 - iItem)))
+        {
+            Log::Error(String().Format(L"[ Couldn't find '%s' at index %d ]", nameBuf, numItems - 1 - iItem));
+            return;
+        }
+    }
+}
+
 }; // namespace UnitTests
@@ -32,6 +32,35 @@ public:
     BEGIN_TEST_METHOD(DeduplicationTests)
         TEST_METHOD_PROPERTY(L"DataSource", L"Table:PriBuilder.UnitTests.xml#DeduplicationTests")
     END_TEST_METHOD();
+
+    BEGIN_TEST_METHOD(DataMemoryLimitTests)
+        TEST_METHOD_PROPERTY(L"DataSource", L"Table:PriBuilder.UnitTests.xml#DataMemoryLimitTests")
+    END_TEST_METHOD();
+
+    BEGIN_TEST_METHOD(DeduplicationScaleTests)
+        TEST_METHOD_PROPERTY(L"DataSource", L"Table:PriBuilder.UnitTests.xml#DeduplicationScaleTests")
+    END_TEST_METHOD();
+
+    BEGIN_TEST_METHOD(ConcurrentSectionBuildTests)
+        TEST_METHOD_PROPERTY(L"DataSource", L"Table:PriBuilder.UnitTests.xml#ConcurrentSectionBuildTests")
+    END_TEST_METHOD();
+
+    BEGIN_TEST_METHOD(IncrementalBuildTests)
+        TEST_METHOD_PROPERTY(L"DataSource", L"Table:PriBuilder.UnitTests.xml#IncrementalBuildTests")
+    END_TEST_METHOD();
+
+private:
+    static void BuildWithDataItems(
+        _In_ const TestDataArray<int>& dataItemSizes,
+        _In_ UINT32 maxInMemoryDataSize,
+        _Outptr_result_bytebuffer_(*pcbPriOut) void** ppPriOut,
+        _Out_ UINT32* pcbPriOut);
+
+    static void BuildWithGeneratedResources(
+        _In_ int numResources,
+        _In_ UINT32 maxBuildThreads,
+        _Outptr_result_bytebuffer_(*pcbPriOut) void** ppPriOut,
+        _Out_ UINT32* pcbPriOut);
 };
 
 void PriBuilderUnitTests::SimpleBuilderReaderTests()
@@ -320,4 +349,399 @@ void PriBuilderUnitTests::DeduplicationTests()
         (actualDataValueSize2 * 2 == ((wcslen(utf16String2) + 1) * sizeof(wchar_t))));
 }
 
+void PriBuilderUnitTests::BuildWithDataItems(
+    _In_ const TestDataArray<int>& dataItemSizes,
+    _In_ UINT32 maxInMemoryDataSize,
+    _Outptr_result_bytebuffer_(*pcbPriOut) void** ppPriOut,
+    _Out_ UINT32* pcbPriOut)
+{
+    *ppPriOut = nullptr;
+    *pcbPriOut = 0;
+
+    TestHPri pri;
+    AutoDeletePtr<CoreProfile> profile;
+    VERIFY_SUCCEEDED(CoreProfile::ChooseDefaultProfile(&profile));
+    profile->GetBuildConfiguration()->SetMaxInMemoryDataSize(maxInMemoryDataSize);
+
+    VERIFY_SUCCEEDED(pri.InitFromTestVars(L"", NULL, profile, NULL));
+
+    DecisionInfoBuilder* pDecisions = pri.GetPriSectionBuilder()->GetDecisionInfoBuilder();
+    AutoDeletePtr<DecisionInfoQualifierSetBuilder> englishSetBuilder;
+    VERIFY_SUCCEEDED(DecisionInfoQualifierSetBuilder::CreateInstance(pDecisions, &englishSetBuilder));
+    VERIFY_SUCCEEDED(englishSetBuilder->AddQualifier(L"Language", L"en-US", 0.0));
+
+    // Items alternate between two qualifier sets, so two data item sections share the spill file.
+    AutoDeletePtr<DecisionInfoQualifierSetBuilder> germanSetBuilder;
+    VERIFY_SUCCEEDED(DecisionInfoQualifierSetBuilder::CreateInstance(pDecisions, &germanSetBuilder));
+    VERIFY_SUCCEEDED(germanSetBuilder->AddQualifier(L"Language", L"de-DE", 0.0));
+
+    DataItemOrchestrator* dataItemOrchestrator = pri.GetPriSectionBuilder()->GetDataItemOrchestrator();
+
+    UINT cbLargestItem = 0;
+    for (size_t i = 0; i < dataItemSizes.GetSize(); i++)
+    {
+        DecisionInfoQualifierSetBuilder* qualifierSetBuilder = (((i % 2) == 0) ? englishSetBuilder : germanSetBuilder);
+        UINT cbItem = static_cast<UINT>(dataItemSizes[i]);
+        cbLargestItem = max(cbLargestItem, cbItem);
+        BlobResult itemBlob;
+        BYTE* item;
+        VERIFY_SUCCEEDED(itemBlob.SetEmptyContents(cbItem, (void**)&item));
+        for (UINT b = 0; b < cbItem; b++)
+        {
+            item[b] = static_cast<BYTE>((b * 31) + i);
+        }
+
+        // Each item goes in twice; the second copy must be found as a duplicate even if the first was spilled.
+        int qualifierSetIndex;
+        OrchestratorDataReference* reference1 = nullptr;
+        OrchestratorDataReference* reference2 = nullptr;
+        VERIFY_SUCCEEDED(dataItemOrchestrator->AddDataAndCreateInstanceReference(
+            item, cbItem, qualifierSetBuilder, (IBuildInstanceReference**)&reference1, &qualifierSetIndex));
+        VERIFY_SUCCEEDED(dataItemOrchestrator->AddDataAndCreateInstanceReference(
+            item, cbItem, qualifierSetBuilder, (IBuildInstanceReference**)&reference2, &qualifierSetIndex));
+
+        VERIFY_ARE_EQUAL(reference1->GetInnerReference().isLarge, reference2->GetInnerReference().isLarge);
+        VERIFY_ARE_EQUAL(reference1->GetInnerReference().index, reference2->GetInnerReference().index);
+
+        BlobResult blob;
+        size_t cbBlob;
+        VERIFY_SUCCEEDED(reference2->GetDataBlob(&blob));
+        const void* pBlob = blob.GetRef(&cbBlob);
+        VERIFY_ARE_EQUAL(static_cast<size_t>(cbItem), cbBlob);
+        VERIFY_ARE_EQUAL(0, memcmp(pBlob, item, cbItem));
+
+        // The limit is checked before each item is added, so one item (and its padding) can go over it.
+        if (maxInMemoryDataSize != 0)
+        {
+            VERIFY_IS_TRUE(dataItemOrchestrator->GetDataSizeInMemory() <= static_cast<UINT64>(maxInMemoryDataSize) + cbLargestItem + 8);
+        }
+    }
+
+    VERIFY_SUCCEEDED(pri.GetFileBuilder()->GenerateFileContents(ppPriOut, pcbPriOut));
+}
+
+void PriBuilderUnitTests::DataMemoryLimitTests()
+{
+    TestDataArray<int> dataItemSizes;
+    int maxInMemoryDataSize;
+    VERIFY_SUCCEEDED(TestData::TryGetValue(L"DataItemSizes", dataItemSizes));
+    VERIFY_SUCCEEDED(TestData::TryGetValue(L"MaxInMemoryDataSize", maxInMemoryDataSize));
+
+    Log::Comment(L"[ Building without a memory limit ]");
+    void* pUnlimited = nullptr;
+    UINT32 cbUnlimited = 0;
+    BuildWithDataItems(dataItemSizes, 0, &pUnlimited, &cbUnlimited);
+
+    Log::Comment(String().Format(L"[ Building with a %d byte memory limit ]", maxInMemoryDataSize));
+    void* pLimited = nullptr;
+    UINT32 cbLimited = 0;
+    BuildWithDataItems(dataItemSizes, static_cast<UINT32>(maxInMemoryDataSize), &pLimited, &cbLimited);
+
+    Log::Comment(L"[ Verifying the two files are identical ]");
+    VERIFY_ARE_EQUAL(cbUnlimited, cbLimited);
+    VERIFY_ARE_EQUAL(0, memcmp(pUnlimited, pLimited, cbUnlimited));
+
+    Def_Free(pUnlimited);
+    Def_Free(pLimited);
+}
+
+
+void PriBuilderUnitTests::DeduplicationScaleTests()
+{
+    String tmp;
+    int numValues;
+    int numDistinctValues;
+    VERIFY_SUCCEEDED(TestData::TryGetValue(L"NumValues", numValues));
+    VERIFY_SUCCEEDED(TestData::TryGetValue(L"NumDistinctValues", numDistinctValues));
+    VERIFY_IS_TRUE((numDistinctValues > 0) && (numDistinctValues <= numValues));
+
+    TestHPri pri;
+    AutoDeletePtr<CoreProfile> profile;
+    VERIFY_SUCCEEDED(CoreProfile::ChooseDefaultProfile(&profile));
+    VERIFY_SUCCEEDED(pri.InitFromTestVars(L"", NULL, profile, NULL));
+
+    DecisionInfoBuilder* pDecisions = pri.GetPriSectionBuilder()->GetDecisionInfoBuilder();
+    AutoDeletePtr<DecisionInfoQualifierSetBuilder> qualifierSetBuilder;
+    VERIFY_SUCCEEDED(DecisionInfoQualifierSetBuilder::CreateInstance(pDecisions, &qualifierSetBuilder));
+    VERIFY_SUCCEEDED(qualifierSetBuilder->AddQualifier(L"Language", L"en-US", 0.0));
+
+    DataItemOrchestrator* dataItemOrchestrator = pri.GetPriSectionBuilder()->GetDataItemOrchestrator();
+
+    // Item index of the first reference to each distinct value; every later copy must resolve to it.
+    int* pFirstIndex = _DefArray_Alloc(int, numDistinctValues);
+    VERIFY_IS_NOT_NULL(pFirstIndex);
+    for (int i = 0; i < numDistinctValues; i++)
+    {
+        pFirstIndex[i] = -1;
+    }
+
+    SYSTEMTIME start;
+    SYSTEMTIME checkpoint;
+    SYSTEMTIME elapsed;
+    WCHAR valueBuf[MAX_PATH];
+
+    GetSystemTime(&start);
+    for (int i = 0; i < numValues; i++)
+    {
+        int distinctValue = (i % numDistinctValues);
+        VERIFY_SUCCEEDED(StringCchPrintf(valueBuf, ARRAYSIZE(valueBuf), L"Deduplicated value %d", distinctValue));
+
+        int qualifierSetIndex;
+        UINT cbValue = static_cast<UINT>((wcslen(valueBuf) + 1) * sizeof(WCHAR));
+        AutoDeletePtr<OrchestratorDataReference> reference;
+        VERIFY_SUCCEEDED(dataItemOrchestrator->AddDataAndCreateInstanceReference(
+            valueBuf, cbValue, qualifierSetBuilder, (IBuildInstanceReference**)&reference, &qualifierSetIndex));
+
+        // Distinct values must never be merged, even when their checksums collide.
+        if (!reference->IsValueEqual(valueBuf, cbValue))
+        {
+            Log::Error(tmp.Format(L"[ Value %d was merged with a different value ]", distinctValue));
+            break;
+        }
+
+        int index = reference->GetInnerReference().index;
+        if (pFirstIndex[distinctValue] < 0)
+        {
+            pFirstIndex[distinctValue] = index;
+        }
+        else if (pFirstIndex[distinctValue] != index)
+        {
+            Log::Error(tmp.Format(L"[ Value %d wasn't deduplicated (%d != %d) ]", distinctValue, index, pFirstIndex[distinctValue]));
+            break;
+        }
+    }
+    GetSystemTime(&checkpoint);
+    ComputeElapsedTime(start, checkpoint, &elapsed);
+    Log::Comment(tmp.Format(
+        L"[ %d values (%d distinct) added in %02d:%02d:%02d:%03d ]",
+        numValues,
+        numDistinctValues,
+        elapsed.wHour,
+        elapsed.wMinute,
+        elapsed.wSecond,
+        elapsed.wMilliseconds));
+
+    _DefFree(pFirstIndex);
+}
+
+void PriBuilderUnitTests::BuildWithGeneratedResources(
+    _In_ int numResources,
+    _In_ UINT32 maxBuildThreads,
+    _Outptr_result_bytebuffer_(*pcbPriOut) void** ppPriOut,
+    _Out_ UINT32* pcbPriOut)
+{
+    *ppPriOut = nullptr;
+    *pcbPriOut = 0;
+
+    String tmp;
+    TestHPri pri;
+    AutoDeletePtr<CoreProfile> profile;
+    VERIFY_SUCCEEDED(CoreProfile::ChooseDefaultProfile(&profile));
+    profile->GetBuildConfiguration()->SetMaxBuildThreads(maxBuildThreads);
+
+    VERIFY_SUCCEEDED(pri.InitFromTestVars(L"", NULL, profile, NULL));
+
+    String simpleId;
+    VERIFY_SUCCEEDED(TestData::TryGetValue(L"SimpleId", simpleId));
+
+    QualifierSetResult qualifiers;
+    VERIFY_SUCCEEDED(pri.GetTestDI()->GetQualifierSetData()->GetOrAddQualifierSet(
+        L"$en", pri.GetPriSectionBuilder()->GetDecisionInfoBuilder(), &qualifiers));
+
+    MrmEnvironment::ResourceValueType type;
+    VERIFY_SUCCEEDED(MrmEnvironment::GetResourceValueType(L"string", &type));
+
+    WCHAR nameBuf[MAX_PATH];
+    WCHAR valueBuf[MAX_PATH];
+    for (int i = 0; i < numResources; i++)
+    {
+        VERIFY_SUCCEEDED(StringCchPrintf(nameBuf, ARRAYSIZE(nameBuf), L"Generated/Scope%d/Item%d", i / 100, i));
+        VERIFY_SUCCEEDED(StringCchPrintf(valueBuf, ARRAYSIZE(valueBuf), L"Generated value %d for a large resource map", i));
+        VERIFY_SUCCEEDED(pri.GetPriSectionBuilder()->AddCandidateWithString(simpleId, nameBuf, type, valueBuf, &qualifiers));
+    }
+
+    SYSTEMTIME start;
+    SYSTEMTIME checkpoint;
+    SYSTEMTIME elapsed;
+
+    GetSystemTime(&start);
+    VERIFY_SUCCEEDED(pri.GetFileBuilder()->GenerateFileContents(ppPriOut, pcbPriOut));
+    GetSystemTime(&checkpoint);
+    ComputeElapsedTime(start, checkpoint, &elapsed);
+    Log::Comment(tmp.Format(
+        L"[ %d resources, %u build threads: %u bytes generated in %02d:%02d:%02d:%03d ]",
+        numResources,
+        maxBuildThreads,
+        *pcbPriOut,
+        elapsed.wHour,
+        elapsed.wMinute,
+        elapsed.wSecond,
+        elapsed.wMilliseconds));
+}
+
+void PriBuilderUnitTests::ConcurrentSectionBuildTests()
+{
+    int numResources;
+    int maxBuildThreads;
+    VERIFY_SUCCEEDED(TestData::TryGetValue(L"NumGeneratedResources", numResources));
+    VERIFY_SUCCEEDED(TestData::TryGetValue(L"MaxBuildThreads", maxBuildThreads));
+
+    Log::Comment(L"[ Building every section on one thread ]");
+    void* pSerial = nullptr;
+    UINT32 cbSerial = 0;
+    BuildWithGeneratedResources(numResources, 0, &pSerial, &cbSerial);
+
+    Log::Comment(String().Format(L"[ Building independent sections on up to %d threads ]", maxBuildThreads));
+    void* pConcurrent = nullptr;
+    UINT32 cbConcurrent = 0;
+    BuildWithGeneratedResources(numResources, static_cast<UINT32>(maxBuildThreads), &pConcurrent, &cbConcurrent);
+
+    Log::Comment(L"[ Verifying the two files are identical ]");
+    VERIFY_ARE_EQUAL(cbSerial, cbConcurrent);
+    VERIFY_ARE_EQUAL(0, memcmp(pSerial, pConcurrent, cbSerial));
+
+    Def_Free(pSerial);
+    Def_Free(pConcurrent);
+}
+
+void PriBuilderUnitTests::IncrementalBuildTests()
+{
+    String tmp;
+    int numResources;
+    VERIFY_SUCCEEDED(TestData::TryGetValue(L"NumGeneratedResources", numResources));
+    VERIFY_IS_TRUE(numResources >= 3);
+
+    FileBasedTest files;
+    VERIFY_IS_TRUE(files.SetupClassFolders(L"PriBuilderUnitTests"));
+    String previousPath;
+    String incrementalPath;
+    files.GetOutputFilePath(L"Previous.pri", previousPath);
+    files.GetOutputFilePath(L"Incremental.pri", incrementalPath);
+
+    AutoDeletePtr<CoreProfile> profile;
+    VERIFY_SUCCEEDED(CoreProfile::ChooseDefaultProfile(&profile));
+
+    TestHPri pri;
+    VERIFY_SUCCEEDED(pri.InitFromTestVars(L"", NULL, profile, NULL));
+
+    String simpleId;
+    VERIFY_SUCCEEDED(TestData::TryGetValue(L"SimpleId", simpleId));
+
+    QualifierSetResult qualifiers;
+    VERIFY_SUCCEEDED(pri.GetTestDI()->GetQualifierSetData()->GetOrAddQualifierSet(
+        L"$en", pri.GetPriSectionBuilder()->GetDecisionInfoBuilder(), &qualifiers));
+
+    MrmEnvironment::ResourceValueType type;
+    VERIFY_SUCCEEDED(MrmEnvironment::GetResourceValueType(L"string", &type));
+
+    WCHAR nameBuf[MAX_PATH];
+    WCHAR valueBuf[MAX_PATH];
+    for (int i = 0; i < numResources; i++)
+    {
+        VERIFY_SUCCEEDED(StringCchPrintf(nameBuf, ARRAYSIZE(nameBuf), L"Generated/Scope%d/Item%d", i / 100, i));
+        VERIFY_SUCCEEDED(StringCchPrintf(valueBuf, ARRAYSIZE(valueBuf), L"Generated value %d", i));
+        VERIFY_SUCCEEDED(pri.GetPriSectionBuilder()->AddCandidateWithString(simpleId, nameBuf, type, valueBuf, &qualifiers));
+    }
+
+    SYSTEMTIME start;
+    SYSTEMTIME checkpoint;
+    SYSTEMTIME elapsed;
+
+    GetSystemTime(&start);
+    VERIFY_SUCCEEDED(pri.GetFileBuilder()->WriteToFile(previousPath));
+    GetSystemTime(&checkpoint);
+    ComputeElapsedTime(start, checkpoint, &elapsed);
+    Log::Comment(tmp.Format(
+        L"[ Full build of %d resources in %02d:%02d:%02d:%03d ]",
+        numResources,
+        elapsed.wHour,
+        elapsed.wMinute,
+        elapsed.wSecond,
+        elapsed.wMilliseconds));
+
+    // Change the first resource, drop the second and leave everything else alone.
+    GetSystemTime(&start);
+    AutoDeletePtr<PriIncrementalBuilder> pIncremental;
+    VERIFY_SUCCEEDED(PriIncrementalBuilder::CreateInstance(previousPath, profile, &pIncremental));
+    VERIFY_SUCCEEDED(pIncremental->AddOrUpdateCandidate(L"Generated/Scope0/Item0", type, L"Updated value 0", &qualifiers));
+    VERIFY_SUCCEEDED(pIncremental->RemoveResource(L"Generated/Scope0/Item1"));
+    VERIFY_ARE_EQUAL(HRESULT_FROM_WIN32(ERROR_MRM_NAMED_RESOURCE_NOT_FOUND), pIncremental->RemoveResource(L"Generated/NoSuchItem"));
+    VERIFY_IS_TRUE(pIncremental->IsUsingPreviousSchemaSection());
+    VERIFY_SUCCEEDED(pIncremental->WriteToFile(incrementalPath));
+    GetSystemTime(&checkpoint);
+    ComputeElapsedTime(start, checkpoint, &elapsed);
+    Log::Comment(tmp.Format(
+        L"[ Incremental build with one update and one removal in %02d:%02d:%02d:%03d ]",
+        elapsed.wHour,
+        elapsed.wMinute,
+        elapsed.wSecond,
+        elapsed.wMilliseconds));
+
+    // Adding a name that the previous schema doesn't have means the schema has to be rebuilt.
+    AutoDeletePtr<PriIncrementalBuilder> pRenamed;
+    VERIFY_SUCCEEDED(PriIncrementalBuilder::CreateInstance(previousPath, profile, &pRenamed));
+    VERIFY_SUCCEEDED(pRenamed->AddOrUpdateCandidate(L"Generated/NewScope/NewItem", type, L"New value", &qualifiers));
+    VERIFY_IS_FALSE(pRenamed->IsUsingPreviousSchemaSection());
+
+    Log::Comment(L"[ Verifying the incremental PRI ]");
+    AutoDeletePtr<StandalonePriFile> pPrevious;
+    AutoDeletePtr<StandalonePriFile> pResult;
+    VERIFY_SUCCEEDED(StandalonePriFile::CreateInstance(BaseFile::LoadFileFlag, previousPath, profile, &pPrevious));
+    VERIFY_SUCCEEDED(StandalonePriFile::CreateInstance(BaseFile::LoadFileFlag, incrementalPath, profile, &pResult));
+
+    const IHierarchicalSchema* pPreviousSchema;
+    const IHierarchicalSchema* pResultSchema;
+    VERIFY_SUCCEEDED(pPrevious->GetPrimarySchema(&pPreviousSchema));
+    VERIFY_SUCCEEDED(pResult->GetPrimarySchema(&pResultSchema));
+    VERIFY_ARE_EQUAL(pPreviousSchema->GetVersionChecksum(), pResultSchema->GetVersionChecksum());
+    VERIFY_ARE_EQUAL(pPreviousSchema->GetNumItems(), pResultSchema->GetNumItems());
+
+    const IResourceMapBase* pMap;
+    const IResourceMapBase* pPreviousMap;
+    VERIFY_SUCCEEDED(pResult->GetPrimaryResourceMap(&pMap));
+    VERIFY_SUCCEEDED(pPrevious->GetPrimaryResourceMap(&pPreviousMap));
+
+    for (int i = 0; i < numResources; i++)
+    {
+        VERIFY_SUCCEEDED(StringCchPrintf(nameBuf, ARRAYSIZE(nameBuf), L"Generated/Scope%d/Item%d", i / 100, i));
+
+        NamedResourceResult resource;
+        VERIFY_SUCCEEDED(pMap->GetResource(nameBuf, &resource));
+        if (i == 1)
+        {
+            // The name stays in the reused schema but its candidates are gone.
+            VERIFY_ARE_EQUAL(0, resource.GetNumCandidates());
+            continue;
+        }
+
+        VERIFY_ARE_EQUAL(1, resource.GetNumCandidates());
+
+        ResourceCandidateResult candidate;
+        StringResult value;
+        VERIFY_SUCCEEDED(resource.GetCandidate(0, &candidate));
+        VERIFY_IS_TRUE(candidate.TryGetStringValue(&value));
+
+        if (i == 0)
+        {
+            VERIFY_SUCCEEDED(StringCchCopy(valueBuf, ARRAYSIZE(valueBuf), L"Updated value 0"));
+        }
+        else
+        {
+            VERIFY_SUCCEEDED(StringCchPrintf(valueBuf, ARRAYSIZE(valueBuf), L"Generated value %d", i));
+
+            // Copied candidates keep the encoding they had in the previous file.
+            NamedResourceResult previousResource;
+            ResourceCandidateResult previousCandidate;
+            MrmEnvironment::ResourceValueType previousType;
+            MrmEnvironment::ResourceValueType resultType;
+            VERIFY_SUCCEEDED(pPreviousMap->GetResource(nameBuf, &previousResource));
+            VERIFY_SUCCEEDED(previousResource.GetCandidate(0, &previousCandidate));
+            VERIFY_SUCCEEDED(previousCandidate.GetResourceValueType(&previousType));
+            VERIFY_SUCCEEDED(candidate.GetResourceValueType(&resultType));
+            VERIFY_ARE_EQUAL(previousType, resultType);
+        }
+        VERIFY_ARE_EQUAL(0, wcscmp(valueBuf, value.GetRef()));
+    }
+}
+
 } // namespace UnitTests
\ No newline at end of file
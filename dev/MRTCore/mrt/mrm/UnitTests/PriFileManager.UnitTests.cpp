@@ -43,6 +43,18 @@ public:
     BEGIN_TEST_METHOD(SingleFileSectionDemandLoadTests)
         TEST_METHOD_PROPERTY(L"DataSource", L"Table:PriFileManager.UnitTests.xml#SingleFileTypedSectionTests")
     END_TEST_METHOD();
+
+    BEGIN_TEST_METHOD(ManyFileRegistryTests)
+        TEST_METHOD_PROPERTY(L"DataSource", L"Table:PriFileManager.UnitTests.xml#ManyFileRegistryTests")
+    END_TEST_METHOD();
+
+    BEGIN_TEST_METHOD(RepeatedRelativePathTests)
+        TEST_METHOD_PROPERTY(L"DataSource", L"Table:PriFileManager.UnitTests.xml#ManyFileRegistryTests")
+    END_TEST_METHOD();
+
+    BEGIN_TEST_METHOD(ResidencyBudgetTests)
+        TEST_METHOD_PROPERTY(L"DataSource", L"Table:PriFileManager.UnitTests.xml#ResidencyBudgetTests")
+    END_TEST_METHOD();
 };
 
 bool ModuleSetup() { return true; }
@@ -470,4 +482,389 @@ void PriFileManagerUnitTests::SingleFileSectionDemandLoadTests()
     TryCleanupTestMethodOutputFolder();
 }
 
+void PriFileManagerUnitTests::ManyFileRegistryTests()
+{
+    TestHPri pri;
+    String tmp;
+    int numFiles;
+
+    if (FAILED(TestData::TryGetValue(L"NumFiles", numFiles)) || (numFiles < 3))
+    {
+        Log::Error(L"[ Couldn't load test data ]");
+        return;
+    }
+
+    if (!SetupTestMethodOutputFolder(L"ManyFileRegistryTests"))
+    {
+        return;
+    }
+
+    AutoDeletePtr<CoreProfile> pProfile;
+    VERIFY_SUCCEEDED(CoreProfile::ChooseDefaultProfile(&pProfile));
+
+    if (FAILED(pri.InitFromTestVars(L"", NULL, pProfile, NULL)) || FAILED(pri.Build()))
+    {
+        Log::Error(L"[ Couldn't build test PRI ]");
+        return;
+    }
+
+    String templatePath;
+    VERIFY_IS_NOT_NULL(GetOutputFilePath(L"template.pri", templatePath));
+    VERIFY_SUCCEEDED(pri.WriteToFile((PCWSTR)templatePath));
+
+    // Every file is a copy of the same PRI under its own name, like the resource packs of many packages.
+    String* pFilePaths = new String[numFiles];
+    VERIFY_IS_NOT_NULL(pFilePaths);
+    for (int i = 0; i < numFiles; i++)
+    {
+        VERIFY_IS_NOT_NULL(GetOutputFilePath(tmp.Format(L"resources.pack%04d.pri", i), pFilePaths[i]));
+        VERIFY_WIN32_BOOL_SUCCEEDED(CopyFile((PCWSTR)templatePath, (PCWSTR)pFilePaths[i], FALSE));
+    }
+
+    AutoDeletePtr<AtomPoolGroup> pAtoms;
+    VERIFY_SUCCEEDED(AtomPoolGroup::CreateInstance(&pAtoms));
+    AutoDeletePtr<UnifiedEnvironment> pEnvironment;
+    VERIFY_SUCCEEDED(UnifiedEnvironment::CreateInstance(pProfile, pAtoms, &pEnvironment));
+    AutoDeletePtr<PriFileManager> pManager;
+    VERIFY_SUCCEEDED(PriFileManager::CreateInstance(pEnvironment, &pManager));
+
+    ManagedFile** ppFiles = new ManagedFile*[numFiles];
+    VERIFY_IS_NOT_NULL(ppFiles);
+
+    SYSTEMTIME start;
+    SYSTEMTIME checkpoint;
+    SYSTEMTIME elapsed;
+
+    GetSystemTime(&start);
+    for (int i = 0; i < numFiles; i++)
+    {
+        VERIFY_SUCCEEDED(pManager->GetOrAddFile((PCWSTR)pFilePaths[i], nullptr, LoadPriFlags::Default, &ppFiles[i]));
+    }
+    GetSystemTime(&checkpoint);
+    ComputeElapsedTime(start, checkpoint, &elapsed);
+    Log::Comment(tmp.Format(
+        L"[ GetOrAddFile: %d new files in %02d:%02d:%02d:%03d ]",
+        numFiles,
+        elapsed.wHour,
+        elapsed.wMinute,
+        elapsed.wSecond,
+        elapsed.wMilliseconds));
+    VERIFY_ARE_EQUAL(numFiles, pManager->GetNumFiles());
+
+    // Lookups ignore case and find the file that was already added.
+    GetSystemTime(&start);
+    for (int i = 0; i < numFiles; i++)
+    {
+        WCHAR upperPath[MAX_PATH];
+        VERIFY_SUCCEEDED(StringCchCopy(upperPath, ARRAYSIZE(upperPath), (PCWSTR)pFilePaths[i]));
+        VERIFY_ARE_EQUAL(0, _wcsupr_s(upperPath, ARRAYSIZE(upperPath)));
+
+        ManagedFile* pFile;
+        VERIFY_SUCCEEDED(pManager->GetOrAddFile(upperPath, nullptr, LoadPriFlags::Default, &pFile));
+        VERIFY_ARE_EQUAL(ppFiles[i], pFile);
+        VERIFY_SUCCEEDED(pManager->GetFile(upperPath, &pFile));
+        VERIFY_ARE_EQUAL(ppFiles[i], pFile);
+    }
+    GetSystemTime(&checkpoint);
+    ComputeElapsedTime(start, checkpoint, &elapsed);
+    Log::Comment(tmp.Format(
+        L"[ GetOrAddFile and GetFile: %d existing files in %02d:%02d:%02d:%03d ]",
+        numFiles,
+        elapsed.wHour,
+        elapsed.wMinute,
+        elapsed.wSecond,
+        elapsed.wMilliseconds));
+    VERIFY_ARE_EQUAL(numFiles, pManager->GetNumFiles());
+
+    ManagedFile* pDuplicate;
+    VERIFY_ARE_EQUAL(HRESULT_FROM_WIN32(ERROR_MRM_DUPLICATE_ENTRY), pManager->AddFile((PCWSTR)pFilePaths[0], nullptr, false, &pDuplicate));
+
+    // Removed files are no longer found, everything else still is, and removed paths can be added again.
+    for (int i = 0; i < numFiles; i += 3)
+    {
+        VERIFY_SUCCEEDED(pManager->RemoveFile(ppFiles[i]));
+        ppFiles[i] = nullptr;
+    }
+
+    for (int i = 0; i < numFiles; i++)
+    {
+        ManagedFile* pFile;
+        HRESULT hr = pManager->GetFile((PCWSTR)pFilePaths[i], &pFile);
+        if (ppFiles[i] == nullptr)
+        {
+            VERIFY_ARE_EQUAL(E_INVALIDARG, hr);
+            VERIFY_SUCCEEDED(pManager->GetOrAddFile((PCWSTR)pFilePaths[i], nullptr, LoadPriFlags::Default, &ppFiles[i]));
+            VERIFY_IS_NOT_NULL(ppFiles[i]);
+        }
+        else
+        {
+            VERIFY_SUCCEEDED(hr);
+            VERIFY_ARE_EQUAL(ppFiles[i], pFile);
+        }
+    }
+
+    for (int i = 0; i < numFiles; i++)
+    {
+        ManagedFile* pFile;
+        VERIFY_SUCCEEDED(pManager->GetFile((PCWSTR)pFilePaths[i], &pFile));
+        VERIFY_ARE_EQUAL(ppFiles[i], pFile);
+    }
+
+    delete[] ppFiles;
+    delete[] pFilePaths;
+}
+
+void PriFileManagerUnitTests::RepeatedRelativePathTests()
+{
+    TestHPri pri;
+    String tmp;
+    int numLookups;
+
+    if (FAILED(TestData::TryGetValue(L"NumRepeatedLookups", numLookups)) || (numLookups < 1))
+    {
+        Log::Error(L"[ Couldn't load test data ]");
+        return;
+    }
+
+    if (!SetupTestMethodOutputFolder(L"RepeatedRelativePathTests"))
+    {
+        return;
+    }
+
+    AutoDeletePtr<CoreProfile> pProfile;
+    VERIFY_SUCCEEDED(CoreProfile::ChooseDefaultProfile(&pProfile));
+
+    if (FAILED(pri.InitFromTestVars(L"", NULL, pProfile, NULL)) || FAILED(pri.Build()))
+    {
+        Log::Error(L"[ Couldn't build test PRI ]");
+        return;
+    }
+
+    String priFilePath;
+    VERIFY_IS_NOT_NULL(GetOutputFilePath(L"resources.pri", priFilePath));
+    VERIFY_SUCCEEDED(pri.WriteToFile((PCWSTR)priFilePath));
+
+    // Look the file up by a path relative to its folder, which has to be resolved through the file system.
+    WCHAR previousDirectory[MAX_PATH];
+    WCHAR outputFolder[MAX_PATH];
+    VERIFY_IS_TRUE(GetCurrentDirectory(ARRAYSIZE(previousDirectory), previousDirectory) > 0);
+    VERIFY_SUCCEEDED(StringCchCopy(outputFolder, ARRAYSIZE(outputFolder), (PCWSTR)priFilePath));
+    *wcsrchr(outputFolder, L'\\') = L'\0';
+    VERIFY_WIN32_BOOL_SUCCEEDED(SetCurrentDirectory(outputFolder));
+
+    AutoDeletePtr<AtomPoolGroup> pAtoms;
+    VERIFY_SUCCEEDED(AtomPoolGroup::CreateInstance(&pAtoms));
+    AutoDeletePtr<UnifiedEnvironment> pEnvironment;
+    VERIFY_SUCCEEDED(UnifiedEnvironment::CreateInstance(pProfile, pAtoms, &pEnvironment));
+    AutoDeletePtr<PriFileManager> pManager;
+    VERIFY_SUCCEEDED(PriFileManager::CreateInstance(pEnvironment, &pManager));
+
+    ManagedFile::ClearNormalizedPathCache();
+
+    ManagedFile* pExpected;
+    VERIFY_SUCCEEDED(pManager->GetOrAddFile(L"resources.pri", nullptr, LoadPriFlags::Default, &pExpected));
+    VERIFY_IS_TRUE(DefString_IEqual(pExpected->GetPath(), (PCWSTR)priFilePath));
+
+    SYSTEMTIME start;
+    SYSTEMTIME checkpoint;
+    SYSTEMTIME elapsed;
+    ManagedFile* pFile;
+
+    GetSystemTime(&start);
+    for (int i = 0; i < numLookups; i++)
+    {
+        ManagedFile::ClearNormalizedPathCache();
+        VERIFY_SUCCEEDED(pManager->GetOrAddFile(L"resources.pri", nullptr, LoadPriFlags::Default, &pFile));
+        VERIFY_ARE_EQUAL(pExpected, pFile);
+    }
+    GetSystemTime(&checkpoint);
+    ComputeElapsedTime(start, checkpoint, &elapsed);
+    Log::Comment(tmp.Format(
+        L"[ GetOrAddFile: %d lookups of a relative path without the cache in %02d:%02d:%02d:%03d ]",
+        numLookups,
+        elapsed.wHour,
+        elapsed.wMinute,
+        elapsed.wSecond,
+        elapsed.wMilliseconds));
+
+    GetSystemTime(&start);
+    for (int i = 0; i < numLookups; i++)
+    {
+        VERIFY_SUCCEEDED(pManager->GetOrAddFile(L"resources.pri", nullptr, LoadPriFlags::Default, &pFile));
+        VERIFY_ARE_EQUAL(pExpected, pFile);
+    }
+    GetSystemTime(&checkpoint);
+    ComputeElapsedTime(start, checkpoint, &elapsed);
+    Log::Comment(tmp.Format(
+        L"[ GetOrAddFile: %d lookups of a relative path with the cache in %02d:%02d:%02d:%03d ]",
+        numLookups,
+        elapsed.wHour,
+        elapsed.wMinute,
+        elapsed.wSecond,
+        elapsed.wMilliseconds));
+
+    // The cache is keyed by full path, so the same relative path from another folder is resolved again.
+    VERIFY_WIN32_BOOL_SUCCEEDED(SetCurrentDirectory(previousDirectory));
+    NormalizedFilePath otherPath;
+    HRESULT hr = otherPath.Init(L"resources.pri");
+    VERIFY_IS_TRUE(FAILED(hr) || !DefString_IEqual(otherPath.GetRef(), (PCWSTR)priFilePath));
+
+    ManagedFile::ClearNormalizedPathCache();
+}
+
+static void AccessFile(_In_ PriFileManager* pManager, _In_ const ManagedFile* pFile, _In_ int numSections)
+{
+    const BaseFile* pBaseFile;
+    VERIFY_SUCCEEDED(pFile->GetBaseFile(&pBaseFile));
+    VERIFY_ARE_EQUAL(numSections, pBaseFile->GetNumSections());
+
+    // Like a caller between lookups.
+    VERIFY_SUCCEEDED(pManager->EnforceResidencyBudget());
+}
+
+void PriFileManagerUnitTests::ResidencyBudgetTests()
+{
+    TestHPri pri;
+    String tmp;
+    int numFiles;
+    int numResidentFiles;
+    int numPasses;
+
+    if (FAILED(TestData::TryGetValue(L"NumFiles", numFiles)) || FAILED(TestData::TryGetValue(L"NumResidentFiles", numResidentFiles)) ||
+        FAILED(TestData::TryGetValue(L"NumPasses", numPasses)) || (numResidentFiles < 3) || (numFiles <= numResidentFiles))
+    {
+        Log::Error(L"[ Couldn't load test data ]");
+        return;
+    }
+
+    if (!SetupTestMethodOutputFolder(L"ResidencyBudgetTests"))
+    {
+        return;
+    }
+
+    AutoDeletePtr<CoreProfile> pProfile;
+    VERIFY_SUCCEEDED(CoreProfile::ChooseDefaultProfile(&pProfile));
+
+    if (FAILED(pri.InitFromTestVars(L"", NULL, pProfile, NULL)) || FAILED(pri.Build()))
+    {
+        Log::Error(L"[ Couldn't build test PRI ]");
+        return;
+    }
+
+    String templatePath;
+    VERIFY_IS_NOT_NULL(GetOutputFilePath(L"template.pri", templatePath));
+    VERIFY_SUCCEEDED(pri.WriteToFile((PCWSTR)templatePath));
+
+    AutoDeletePtr<AtomPoolGroup> pAtoms;
+    VERIFY_SUCCEEDED(AtomPoolGroup::CreateInstance(&pAtoms));
+    AutoDeletePtr<UnifiedEnvironment> pEnvironment;
+    VERIFY_SUCCEEDED(UnifiedEnvironment::CreateInstance(pProfile, pAtoms, &pEnvironment));
+    AutoDeletePtr<PriFileManager> pManager;
+    VERIFY_SUCCEEDED(PriFileManager::CreateInstance(pEnvironment, &pManager));
+
+    // Every file is a copy of the same PRI, so they all have the same size and sections.
+    ManagedFile** ppFiles = new ManagedFile*[numFiles];
+    VERIFY_IS_NOT_NULL(ppFiles);
+    for (int i = 0; i < numFiles; i++)
+    {
+        String filePath;
+        VERIFY_IS_NOT_NULL(GetOutputFilePath(tmp.Format(L"resources.pack%02d.pri", i), filePath));
+        VERIFY_WIN32_BOOL_SUCCEEDED(CopyFile((PCWSTR)templatePath, (PCWSTR)filePath, FALSE));
+        VERIFY_SUCCEEDED(pManager->GetOrAddFile((PCWSTR)filePath, nullptr, LoadPriFlags::Default, &ppFiles[i]));
+        VERIFY_IS_FALSE(ppFiles[i]->IsLoaded());
+    }
+    VERIFY_ARE_EQUAL(0, pManager->GetNumResidentFiles());
+
+    const BaseFile* pTemplateFile;
+    VERIFY_SUCCEEDED(ppFiles[0]->GetBaseFile(&pTemplateFile));
+    int numSections = pTemplateFile->GetNumSections();
+    size_t cbFile = ppFiles[0]->GetSizeInBytes();
+
+    // Without a budget every file stays loaded.
+    for (int i = 0; i < numFiles; i++)
+    {
+        AccessFile(pManager, ppFiles[i], numSections);
+    }
+    VERIFY_ARE_EQUAL(numFiles, pManager->GetNumResidentFiles());
+    VERIFY_ARE_EQUAL(cbFile * numFiles, pManager->GetResidentSizeInBytes());
+    VERIFY_ARE_EQUAL(static_cast<UINT64>(numFiles), pManager->GetNumResidencyLoads());
+    VERIFY_ARE_EQUAL(0ull, pManager->GetNumResidencyEvictions());
+
+    // Setting a budget evicts the least recently used files right away.
+    VERIFY_SUCCEEDED(pManager->SetResidencyBudget(cbFile * numResidentFiles));
+    VERIFY_ARE_EQUAL(numResidentFiles, pManager->GetNumResidentFiles());
+    VERIFY_ARE_EQUAL(static_cast<UINT64>(numFiles - numResidentFiles), pManager->GetNumResidencyEvictions());
+    for (int i = 0; i < numFiles; i++)
+    {
+        VERIFY_ARE_EQUAL(i >= (numFiles - numResidentFiles), ppFiles[i]->IsLoaded());
+    }
+
+    // An evicted file is loaded again on its next access. Loading it doesn't evict anything, because the
+    // lookup might still use the other files, but the coldest file makes room for it after the lookup.
+    int coldest = numFiles - numResidentFiles;
+    const BaseFile* pReloadedFile;
+    VERIFY_SUCCEEDED(ppFiles[0]->GetBaseFile(&pReloadedFile));
+    VERIFY_IS_TRUE(ppFiles[coldest]->IsLoaded());
+    VERIFY_ARE_EQUAL(numResidentFiles + 1, pManager->GetNumResidentFiles());
+    VERIFY_SUCCEEDED(pManager->EnforceResidencyBudget());
+    VERIFY_IS_TRUE(ppFiles[0]->IsLoaded());
+    VERIFY_IS_FALSE(ppFiles[coldest]->IsLoaded());
+    VERIFY_ARE_EQUAL(1ull, pManager->GetNumResidencyReloads());
+    VERIFY_ARE_EQUAL(numResidentFiles, pManager->GetNumResidentFiles());
+
+    // Touching a resident file makes it the most recently used one, so the next file in line is evicted instead.
+    AccessFile(pManager, ppFiles[coldest + 1], numSections);
+    AccessFile(pManager, ppFiles[1], numSections);
+    VERIFY_IS_TRUE(ppFiles[0]->IsLoaded());
+    VERIFY_IS_TRUE(ppFiles[1]->IsLoaded());
+    VERIFY_IS_TRUE(ppFiles[coldest + 1]->IsLoaded());
+    VERIFY_IS_FALSE(ppFiles[coldest + 2]->IsLoaded());
+
+    // A pinned file is never evicted, even when every other file is accessed after it.
+    ppFiles[1]->Pin();
+
+    SYSTEMTIME start;
+    SYSTEMTIME checkpoint;
+    SYSTEMTIME elapsed;
+
+    GetSystemTime(&start);
+    for (int pass = 0; pass < numPasses; pass++)
+    {
+        for (int i = 0; i < numFiles; i++)
+        {
+            AccessFile(pManager, ppFiles[i], numSections);
+            VERIFY_IS_TRUE(ppFiles[1]->IsLoaded());
+            VERIFY_IS_TRUE(pManager->GetResidentSizeInBytes() <= pManager->GetResidencyBudget());
+        }
+    }
+    GetSystemTime(&checkpoint);
+    ComputeElapsedTime(start, checkpoint, &elapsed);
+
+    Log::Comment(tmp.Format(
+        L"[ %d passes over %d files with room for %d: %I64u loads, %I64u reloads, %I64u evictions in %02d:%02d:%02d:%03d ]",
+        numPasses,
+        numFiles,
+        numResidentFiles,
+        pManager->GetNumResidencyLoads(),
+        pManager->GetNumResidencyReloads(),
+        pManager->GetNumResidencyEvictions(),
+        elapsed.wHour,
+        elapsed.wMinute,
+        elapsed.wSecond,
+        elapsed.wMilliseconds));
+    VERIFY_ARE_EQUAL(pManager->GetNumResidencyLoads(), pManager->GetNumResidencyEvictions() + pManager->GetNumResidentFiles());
+
+    // Removing the budget stops eviction but leaves the resident files alone.
+    ppFiles[1]->Unpin();
+    VERIFY_SUCCEEDED(pManager->SetResidencyBudget(0));
+    VERIFY_ARE_EQUAL(numResidentFiles, pManager->GetNumResidentFiles());
+    for (int i = 0; i < numFiles; i++)
+    {
+        AccessFile(pManager, ppFiles[i], numSections);
+    }
+    VERIFY_ARE_EQUAL(numFiles, pManager->GetNumResidentFiles());
+
+    delete[] ppFiles;
+}
+
 } // namespace UnitTests
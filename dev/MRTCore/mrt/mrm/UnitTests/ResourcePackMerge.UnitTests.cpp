@@ -35,6 +35,10 @@ public:
         TEST_METHOD_PROPERTY(L"DataSource", L"Table:ResourcePackMerge.UnitTests.xml#LoadPriWitMergeTests")
     END_TEST_METHOD();
 
+    BEGIN_TEST_METHOD(ManyPacksMergeTest)
+        TEST_METHOD_PROPERTY(L"DataSource", L"Table:ResourcePackMerge.UnitTests.xml#ThreeFilesMergeTests")
+    END_TEST_METHOD();
+
 private:
     bool _BuildAndVerifyPri(_In_ TestHPri* pTestHPri, _In_ PCWSTR pVarPrefix, _In_ bool bAutoMerge, _In_ bool bResourcePackMerge);
 
@@ -48,6 +52,15 @@ private:
         _In_ bool bResourcePackMerge);
 
     bool _VerifyMergedFile(_In_ PCWSTR pszMergedFile, _In_ PCWSTR pszManifestClassName, _In_ TestHPri* pTestHPri);
+
+    void _MergePacks(
+        _In_ CoreProfile* pProfile,
+        _In_ PCWSTR pszMainFile,
+        _In_reads_(numPacks) const PCWSTR* ppszPackFiles,
+        _In_ UINT32 numPacks,
+        _In_ UINT32 maxThreads,
+        _In_ PCWSTR pszOutputFile,
+        _Out_writes_opt_(numPacks) DEF_CHECKSUM* pChecksums);
 };
 
 /*
@@ -240,6 +253,142 @@ void ResourcePackMergeTests::LoadUnloadWithResourcePackTest()
     fileBasedTestObj.CleanupClassFolders();
 }
 
+/*
+- ManyPacksMergeTest
+    -  Merge the main file with many copies of the resource packs, one at a time and then in a single
+       concurrent batch, and check that both produce the same file
+*/
+
+void ResourcePackMergeTests::_MergePacks(
+    _In_ CoreProfile* pProfile,
+    _In_ PCWSTR pszMainFile,
+    _In_reads_(numPacks) const PCWSTR* ppszPackFiles,
+    _In_ UINT32 numPacks,
+    _In_ UINT32 maxThreads,
+    _In_ PCWSTR pszOutputFile,
+    _Out_writes_opt_(numPacks) DEF_CHECKSUM* pChecksums)
+{
+    // Every copy of a pack repeats its candidates, so duplicates have to be dropped.
+    PriFileMerger::PriMergeFlags packFlags = static_cast<PriFileMerger::PriMergeFlags>(
+        PriFileMerger::InPlaceMerge | PriFileMerger::DropDuplicateCandidates | PriFileMerger::DefaultPriMergeFlags);
+
+    AutoDeletePtr<ResourcePackMerge> spResourcePackMerge;
+    VERIFY_SUCCEEDED(ResourcePackMerge::CreateInstance(pProfile, &spResourcePackMerge));
+    VERIFY_SUCCEEDED(spResourcePackMerge->AddPriFile(
+        pszMainFile, PriFileMerger::InPlaceMerge | PriFileMerger::SetPreLoad | PriFileMerger::DefaultPriMergeFlags));
+
+    SYSTEMTIME start;
+    SYSTEMTIME checkpoint;
+    SYSTEMTIME elapsed;
+
+    GetSystemTime(&start);
+    if (maxThreads == 0)
+    {
+        for (UINT32 i = 0; i < numPacks; i++)
+        {
+            VERIFY_SUCCEEDED(spResourcePackMerge->AddPriFile(ppszPackFiles[i], packFlags));
+        }
+    }
+    else
+    {
+        VERIFY_SUCCEEDED(spResourcePackMerge->AddPriFiles(ppszPackFiles, numPacks, packFlags, maxThreads, pChecksums));
+    }
+    VERIFY_SUCCEEDED(spResourcePackMerge->WriteToFile(pszOutputFile));
+    GetSystemTime(&checkpoint);
+    ComputeElapsedTime(start, checkpoint, &elapsed);
+
+    String tmp;
+    Log::Comment(tmp.Format(
+        L"[ %u packs, %u merge threads: merged in %02d:%02d:%02d:%03d ]",
+        numPacks,
+        maxThreads,
+        elapsed.wHour,
+        elapsed.wMinute,
+        elapsed.wSecond,
+        elapsed.wMilliseconds));
+}
+
+void ResourcePackMergeTests::ManyPacksMergeTest()
+{
+    int numPacks;
+    int maxThreads;
+    VERIFY_SUCCEEDED(TestData::TryGetValue(L"NumSyntheticPacks", numPacks));
+    VERIFY_SUCCEEDED(TestData::TryGetValue(L"MaxMergeThreads", maxThreads));
+
+    FileBasedTest fileBasedTestObj;
+    String strMainFilePath;
+    String strItFilePath;
+    String strKoFilePath;
+    TestHPri testHPriMain;
+    TestHPri testHPriIt;
+    TestHPri testHPriKo;
+
+    VERIFY_IS_TRUE(fileBasedTestObj.SetupClassFolders(L"ResourcePackMergeTests"));
+
+    VERIFY_IS_TRUE(_CreatePriFile(
+        L"Pri3_", L"ResourcePackMergeTests_ManyPacksMerge", L"ResourcePackMergeTests_Main.pri", testHPriMain, strMainFilePath, true, true));
+    VERIFY_IS_TRUE(_CreatePriFile(
+        L"Pri4_", L"ResourcePackMergeTests_ManyPacksMerge", L"ResourcePackMergeTests_it-it.pri", testHPriIt, strItFilePath, false, true));
+    VERIFY_IS_TRUE(_CreatePriFile(
+        L"Pri5_", L"ResourcePackMergeTests_ManyPacksMerge", L"ResourcePackMergeTests_ko-KR.pri", testHPriKo, strKoFilePath, false, true));
+
+    String strOutDir;
+    fileBasedTestObj.GetTestOutputDirectory(L"ResourcePackMergeTests_ManyPacksMerge", NULL, strOutDir);
+
+    // Make the synthetic packs by copying the two resource packs in turn.
+    Log::Comment(String().Format(L"[ Creating %d resource packs ]", numPacks));
+    String* packPaths = new String[numPacks];
+    PCWSTR* ppszPackPaths = new PCWSTR[numPacks];
+    for (int i = 0; i < numPacks; i++)
+    {
+        packPaths[i].Format(L"%s\\ResourcePackMergeTests_Pack%d.pri", static_cast<PCWSTR>(strOutDir), i);
+        ppszPackPaths[i] = packPaths[i];
+        VERIFY_WIN32_BOOL_SUCCEEDED(CopyFile(((i % 2) == 0) ? strItFilePath : strKoFilePath, ppszPackPaths[i], FALSE));
+    }
+
+    AutoDeletePtr<CoreProfile> pProfile;
+    VERIFY_SUCCEEDED(CoreProfile::ChooseDefaultProfile(&pProfile));
+
+    String strSerialOutPath = strOutDir;
+    strSerialOutPath += L"\\SerialMergedPriFile.pri";
+    String strBatchOutPath = strOutDir;
+    strBatchOutPath += L"\\BatchMergedPriFile.pri";
+
+    Log::Comment(L"[ Merging the packs one at a time ]");
+    _MergePacks(pProfile, strMainFilePath, ppszPackPaths, numPacks, 0, strSerialOutPath, nullptr);
+
+    Log::Comment(String().Format(L"[ Merging the packs in one batch on up to %d threads ]", maxThreads));
+    DEF_CHECKSUM* pChecksums = new DEF_CHECKSUM[numPacks];
+    _MergePacks(pProfile, strMainFilePath, ppszPackPaths, numPacks, static_cast<UINT32>(maxThreads), strBatchOutPath, pChecksums);
+
+    Log::Comment(L"[ Verifying the checksums ]");
+    DEF_CHECKSUM itChecksum;
+    DEF_CHECKSUM koChecksum;
+    VERIFY_SUCCEEDED(ResourcePackMerge::GetPriFileChecksums(strItFilePath, pProfile, &itChecksum));
+    VERIFY_SUCCEEDED(ResourcePackMerge::GetPriFileChecksums(strKoFilePath, pProfile, &koChecksum));
+    VERIFY_ARE_NOT_EQUAL(itChecksum, koChecksum);
+    for (int i = 0; i < numPacks; i++)
+    {
+        VERIFY_ARE_EQUAL(((i % 2) == 0) ? itChecksum : koChecksum, pChecksums[i]);
+    }
+
+    Log::Comment(L"[ Verifying the two merged files are identical ]");
+    AutoDeletePtr<BaseFile> pSerialFile;
+    AutoDeletePtr<BaseFile> pBatchFile;
+    VERIFY_SUCCEEDED(BaseFile::CreateInstance(BaseFile::LoadFileFlag, strSerialOutPath, &pSerialFile));
+    VERIFY_SUCCEEDED(BaseFile::CreateInstance(BaseFile::LoadFileFlag, strBatchOutPath, &pBatchFile));
+    VERIFY_ARE_EQUAL(pSerialFile->GetFileSizeInBytes(), pBatchFile->GetFileSizeInBytes());
+    VERIFY_ARE_EQUAL(0, memcmp(pSerialFile->GetFileHeader(), pBatchFile->GetFileHeader(), pSerialFile->GetFileSizeInBytes()));
+
+    _VerifyMergedFile(strBatchOutPath, L"PriMerged_3_4_5_", &testHPriMain);
+
+    delete[] pChecksums;
+    delete[] ppszPackPaths;
+    delete[] packPaths;
+
+    fileBasedTestObj.CleanupClassFolders();
+}
+
 bool ResourcePackMergeTests::_VerifyMergedFile(_In_ PCWSTR pszMergedFile, _In_ PCWSTR pszManifestClassName, _In_ TestHPri* pTestHPri)
 {
     // Load the merged PRI file with official API
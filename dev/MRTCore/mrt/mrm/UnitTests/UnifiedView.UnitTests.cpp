@@ -2,6 +2,7 @@
 // Licensed under the MIT License. See LICENSE in the project root for license information.
 
 #include "StdAfx.h"
+#include <psapi.h>
 #include "Helpers.h"
 #include "mrm/build/Base.h"
 #include "mrm/readers/MrmManagers.h"
@@ -73,6 +74,26 @@ public:
     END_TEST_METHOD();
 
     TEST_METHOD(EnvironmentValidationTests);
+
+    BEGIN_TEST_METHOD(ConcurrentResolutionTests)
+        TEST_METHOD_PROPERTY(L"DataSource", L"Table:UnifiedView.UnitTests.xml#ConcurrentResolutionTests")
+    END_TEST_METHOD();
+
+    BEGIN_TEST_METHOD(DecisionTableTests)
+        TEST_METHOD_PROPERTY(L"DataSource", L"Table:UnifiedView.UnitTests.xml#DecisionTableTests")
+    END_TEST_METHOD();
+
+    BEGIN_TEST_METHOD(DecodedStringCacheTests)
+        TEST_METHOD_PROPERTY(L"DataSource", L"Table:UnifiedView.UnitTests.xml#DecodedStringCacheTests")
+    END_TEST_METHOD();
+
+    BEGIN_TEST_METHOD(ConcurrentLoadPriFilesTests)
+        TEST_METHOD_PROPERTY(L"DataSource", L"Table:UnifiedView.UnitTests.xml#ConcurrentLoadPriFilesTests")
+    END_TEST_METHOD();
+
+    BEGIN_TEST_METHOD(MappedPriWorkingSetTests)
+        TEST_METHOD_PROPERTY(L"DataSource", L"Table:UnifiedView.UnitTests.xml#MappedPriWorkingSetTests")
+    END_TEST_METHOD();
 };
 
 bool UnifiedResourceViewUnitTests::ClassSetup()
@@ -1183,4 +1204,879 @@ void UnifiedResourceViewUnitTests::EnvironmentValidationTests()
     VERIFY_ARE_EQUAL(hr, HRESULT_FROM_WIN32(ERROR_MRM_UNKNOWN_QUALIFIER));
 }
 
+typedef struct _ConcurrentResolutionInfo
+{
+    const ManagedResourceMap* pMap;
+    ResolverBase* pResolver;
+    const int* pExpectedSetIndexes;
+    int numPasses;
+    volatile LONG numFailures;
+} ConcurrentResolutionInfo;
+
+// Resolves every resource in the map numPasses times and counts results that differ from the expected ones.
+static void ResolveAllResources(_Inout_ ConcurrentResolutionInfo* pInfo, _In_ bool bReset)
+{
+    int numResources = pInfo->pMap->GetNumResources();
+    for (int iPass = 0; iPass < pInfo->numPasses; iPass++)
+    {
+        if (bReset)
+        {
+            pInfo->pResolver->Reset();
+        }
+
+        for (int i = 0; i < numResources; i++)
+        {
+            NamedResourceResult resource;
+            DecisionResult decision;
+            int resultIndex = -1;
+            int resultSetIndex = -1;
+            if (FAILED(pInfo->pMap->GetResourceByIndex(i, &resource)) || FAILED(resource.GetDecision(&decision)) ||
+                FAILED(pInfo->pResolver->EvaluateDecision(&decision, 1, &resultIndex, &resultSetIndex)) ||
+                (resultSetIndex != pInfo->pExpectedSetIndexes[i]))
+            {
+                InterlockedIncrement(&pInfo->numFailures);
+            }
+        }
+    }
+}
+
+static DWORD WINAPI ResolveAllResourcesThreadProc(_In_ LPVOID pParam)
+{
+    ResolveAllResources(static_cast<ConcurrentResolutionInfo*>(pParam), false);
+    return 0;
+}
+
+static DWORD WINAPI ResolveAndResetThreadProc(_In_ LPVOID pParam)
+{
+    ResolveAllResources(static_cast<ConcurrentResolutionInfo*>(pParam), true);
+    return 0;
+}
+
+void UnifiedResourceViewUnitTests::ConcurrentResolutionTests()
+{
+    String tmp;
+    PCWSTR pVarPrefix = L"";
+    String filesSpec;
+    TestStringArray files;
+    TestDataArray<int> threadCounts;
+    int numPasses;
+    bool bResetWhileResolving;
+
+    if (!SetupTestMethodOutputFolder(L"ConcurrentResolutionTests"))
+    {
+        return;
+    }
+
+    if (FAILED(TestData::TryGetValue(L"ThreadCounts", threadCounts)) || FAILED(TestData::TryGetValue(L"NumPasses", numPasses)) ||
+        FAILED(TestData::TryGetValue(L"ResetWhileResolving", bResetWhileResolving)))
+    {
+        Log::Error(L"[ Couldn't load ThreadCounts, NumPasses or ResetWhileResolving ]");
+        return;
+    }
+
+    AutoDeletePtr<CoreProfile> pProfile;
+    VERIFY_SUCCEEDED(CoreProfile::ChooseDefaultProfile(&pProfile));
+
+    TestStringArray fileNames;
+    if (FAILED(TestHPri::BuildMultiplePriFilesFromTestVars(pVarPrefix, this, pProfile, &fileNames)))
+    {
+        return;
+    }
+
+    AutoDeletePtr<UnifiedResourceView> pView;
+    VERIFY_SUCCEEDED(UnifiedResourceView::CreateInstance(pProfile, &pView));
+    VERIFY(pView != NULL);
+
+    if (FAILED(TestData::TryGetValue(L"FilesToLoad", filesSpec)) || FAILED(files.InitFromList(filesSpec)) || (files.GetNumStrings() != 1))
+    {
+        Log::Error(L"[ Couldn't load FilesToLoad ]");
+        return;
+    }
+
+    String fullPath;
+    if (GetOutputFilePath(files.GetString(0), fullPath) == NULL)
+    {
+        Log::Error(tmp.Format(L"[ Unable to get output file path for \"%s\" ]", files.GetString(0)));
+        return;
+    }
+
+    const ManagedResourceMap* pMap;
+    VERIFY_SUCCEEDED(pView->GetOrAddReferencedFile((PCWSTR)fullPath, NULL, &pMap, NULL));
+    VERIFY(pMap != NULL);
+
+    // Resolve everything once on this thread to get the expected results.
+    ResolverBase* pResolver = pView->GetDefaultResolver();
+    int numResources = pMap->GetNumResources();
+    VERIFY_IS_TRUE(numResources > 0);
+
+    int* pExpectedSetIndexes = new int[numResources];
+    VERIFY_IS_NOT_NULL(pExpectedSetIndexes);
+    for (int i = 0; i < numResources; i++)
+    {
+        NamedResourceResult resource;
+        DecisionResult decision;
+        int resultIndex;
+        VERIFY_SUCCEEDED(pMap->GetResourceByIndex(i, &resource));
+        VERIFY_SUCCEEDED(resource.GetDecision(&decision));
+        VERIFY_SUCCEEDED(pResolver->EvaluateDecision(&decision, 1, &resultIndex, &pExpectedSetIndexes[i]));
+    }
+
+    for (size_t iCount = 0; iCount < threadCounts.GetSize(); iCount++)
+    {
+        int numThreads = threadCounts[iCount];
+        VERIFY_IS_TRUE((numThreads > 0) && (numThreads <= MAXIMUM_WAIT_OBJECTS));
+
+        ConcurrentResolutionInfo info = {pMap, pResolver, pExpectedSetIndexes, numPasses, 0};
+        HANDLE threads[MAXIMUM_WAIT_OBJECTS] = {};
+
+        SYSTEMTIME start;
+        SYSTEMTIME checkpoint;
+        SYSTEMTIME elapsed;
+
+        GetSystemTime(&start);
+        for (int i = 0; i < numThreads; i++)
+        {
+            // When asked to, the first thread resets the resolver at the start of every pass.
+            LPTHREAD_START_ROUTINE pThreadProc =
+                ((bResetWhileResolving && (i == 0)) ? ResolveAndResetThreadProc : ResolveAllResourcesThreadProc);
+            threads[i] = CreateThread(NULL, 0, pThreadProc, &info, 0, NULL);
+            VERIFY_IS_NOT_NULL(threads[i]);
+        }
+        VERIFY_ARE_EQUAL(WaitForMultipleObjects(numThreads, threads, TRUE, INFINITE), WAIT_OBJECT_0);
+        GetSystemTime(&checkpoint);
+        ComputeElapsedTime(start, checkpoint, &elapsed);
+
+        for (int i = 0; i < numThreads; i++)
+        {
+            CloseHandle(threads[i]);
+        }
+
+        Log::Comment(tmp.Format(
+            L"[ %d threads: %d resolutions in %02d:%02d:%02d:%03d ]",
+            numThreads,
+            numThreads * numPasses * numResources,
+            elapsed.wHour,
+            elapsed.wMinute,
+            elapsed.wSecond,
+            elapsed.wMilliseconds));
+        VERIFY_ARE_EQUAL(static_cast<LONG>(info.numFailures), 0L);
+    }
+
+    delete[] pExpectedSetIndexes;
+}
+
+// Resolves every resource in the map numPasses times, either with single-result lookups (which use the decision
+// table when it is enabled) or with two-result lookups (which never do), and checks the winners against pExpected.
+static void TimeDecisionLookups(
+    _In_ PCWSTR description,
+    _In_ const ManagedResourceMap* pMap,
+    _In_ ResolverBase* pResolver,
+    _In_ bool bSingleResult,
+    _In_reads_(numResources) const int* pExpectedSetIndexes,
+    _In_ int numResources,
+    _In_ int numPasses)
+{
+    String tmp;
+    SYSTEMTIME start;
+    SYSTEMTIME checkpoint;
+    SYSTEMTIME elapsed;
+    int numFailures = 0;
+
+    GetSystemTime(&start);
+    for (int iPass = 0; iPass < numPasses; iPass++)
+    {
+        for (int i = 0; i < numResources; i++)
+        {
+            NamedResourceResult resource;
+            DecisionResult decision;
+            int resultIndexes[2] = {-1, -1};
+            int resultSetIndexes[2] = {-1, -1};
+            if (FAILED(pMap->GetResourceByIndex(i, &resource)) || FAILED(resource.GetDecision(&decision)) ||
+                FAILED(pResolver->EvaluateDecision(&decision, (bSingleResult ? 1 : 2), resultIndexes, resultSetIndexes)) ||
+                (resultSetIndexes[0] != pExpectedSetIndexes[i]))
+            {
+                numFailures++;
+            }
+        }
+    }
+    GetSystemTime(&checkpoint);
+    ComputeElapsedTime(start, checkpoint, &elapsed);
+
+    Log::Comment(tmp.Format(
+        L"[ %s: %d resolutions in %02d:%02d:%02d:%03d ]",
+        description,
+        numPasses * numResources,
+        elapsed.wHour,
+        elapsed.wMinute,
+        elapsed.wSecond,
+        elapsed.wMilliseconds));
+    VERIFY_ARE_EQUAL(numFailures, 0);
+}
+
+void UnifiedResourceViewUnitTests::DecisionTableTests()
+{
+    String tmp;
+    PCWSTR pVarPrefix = L"";
+    String filesSpec;
+    TestStringArray files;
+    TestDataArray<String> languages;
+    int numPasses;
+
+    if (!SetupTestMethodOutputFolder(L"DecisionTableTests"))
+    {
+        return;
+    }
+
+    if (FAILED(TestData::TryGetValue(L"Languages", languages)) || FAILED(TestData::TryGetValue(L"NumPasses", numPasses)))
+    {
+        Log::Error(L"[ Couldn't load Languages or NumPasses ]");
+        return;
+    }
+
+    AutoDeletePtr<CoreProfile> pProfile;
+    VERIFY_SUCCEEDED(CoreProfile::ChooseDefaultProfile(&pProfile));
+
+    TestStringArray fileNames;
+    if (FAILED(TestHPri::BuildMultiplePriFilesFromTestVars(pVarPrefix, this, pProfile, &fileNames)))
+    {
+        return;
+    }
+
+    AutoDeletePtr<UnifiedResourceView> pView;
+    VERIFY_SUCCEEDED(UnifiedResourceView::CreateInstance(pProfile, &pView));
+    VERIFY(pView != NULL);
+
+    if (FAILED(TestData::TryGetValue(L"FilesToLoad", filesSpec)) || FAILED(files.InitFromList(filesSpec)) || (files.GetNumStrings() != 2))
+    {
+        Log::Error(L"[ Couldn't load FilesToLoad ]");
+        return;
+    }
+
+    String fullPath;
+    String laterPath;
+    if ((GetOutputFilePath(files.GetString(0), fullPath) == NULL) || (GetOutputFilePath(files.GetString(1), laterPath) == NULL))
+    {
+        Log::Error(L"[ Unable to get output file paths ]");
+        return;
+    }
+
+    const ManagedResourceMap* pMap;
+    VERIFY_SUCCEEDED(pView->GetOrAddReferencedFile((PCWSTR)fullPath, NULL, &pMap, NULL));
+    VERIFY(pMap != NULL);
+
+    ProviderResolver* pResolver = pView->GetDefaultResolver();
+    int numResources = pMap->GetNumResources();
+    VERIFY_IS_TRUE(numResources > 0);
+
+    int* pExpectedSetIndexes = new int[numResources];
+    VERIFY_IS_NOT_NULL(pExpectedSetIndexes);
+
+    VERIFY_IS_FALSE(pResolver->IsDecisionTableEnabled());
+    VERIFY_SUCCEEDED(pResolver->EnableDecisionTable(true));
+    VERIFY_IS_TRUE(pResolver->IsDecisionTableEnabled());
+
+    for (size_t iLanguage = 0; iLanguage < languages.GetSize(); iLanguage++)
+    {
+        // Changing a qualifier resets the resolver, which has to invalidate the table.
+        Log::Comment(tmp.Format(L"[ Language \"%s\" ]", (PCWSTR)languages[iLanguage]));
+        UINT64 generation = pResolver->GetGeneration();
+        VERIFY_SUCCEEDED(pResolver->SetQualifier(L"Language", languages[iLanguage]));
+        VERIFY_ARE_NOT_EQUAL(generation, pResolver->GetGeneration());
+
+        // Two-result lookups don't use the table, so they give the expected winners.
+        for (int i = 0; i < numResources; i++)
+        {
+            NamedResourceResult resource;
+            DecisionResult decision;
+            int resultIndexes[2];
+            int resultSetIndexes[2];
+            VERIFY_SUCCEEDED(pMap->GetResourceByIndex(i, &resource));
+            VERIFY_SUCCEEDED(resource.GetDecision(&decision));
+            VERIFY_SUCCEEDED(pResolver->EvaluateDecision(&decision, 2, resultIndexes, resultSetIndexes));
+            pExpectedSetIndexes[i] = resultSetIndexes[0];
+        }
+
+        TimeDecisionLookups(L"Decision cache", pMap, pResolver, false, pExpectedSetIndexes, numResources, numPasses);
+        TimeDecisionLookups(L"Decision table", pMap, pResolver, true, pExpectedSetIndexes, numResources, numPasses);
+    }
+
+    // A snapshot only covers the decisions that exist when it's taken. Loading the second file adds
+    // decisions, which grows the table past the end of the snapshot.
+    const IDecisionInfo* pDecisions = pResolver->GetDecisions();
+    int numSnapshotEntries = pDecisions->GetNumDecisions() * 2;
+    UINT16* pSnapshot = new UINT16[numSnapshotEntries];
+    VERIFY_IS_NOT_NULL(pSnapshot);
+    VERIFY_SUCCEEDED(pResolver->GetDecisionTable(numSnapshotEntries, pSnapshot));
+    VERIFY_SUCCEEDED(pResolver->UseDecisionTable(pSnapshot, numSnapshotEntries));
+
+    const ManagedResourceMap* pLaterMap;
+    VERIFY_SUCCEEDED(pView->GetOrAddReferencedFile((PCWSTR)laterPath, NULL, &pLaterMap, NULL));
+    VERIFY(pLaterMap != NULL);
+    VERIFY_IS_TRUE(pDecisions->GetNumDecisions() * 2 > numSnapshotEntries);
+
+    int numLaterResources = pLaterMap->GetNumResources();
+    int* pLaterExpectedSetIndexes = new int[numLaterResources];
+    VERIFY_IS_NOT_NULL(pLaterExpectedSetIndexes);
+    for (int i = 0; i < numLaterResources; i++)
+    {
+        NamedResourceResult resource;
+        DecisionResult decision;
+        int resultIndexes[2];
+        int resultSetIndexes[2];
+        VERIFY_SUCCEEDED(pLaterMap->GetResourceByIndex(i, &resource));
+        VERIFY_SUCCEEDED(resource.GetDecision(&decision));
+        VERIFY_SUCCEEDED(pResolver->EvaluateDecision(&decision, 2, resultIndexes, resultSetIndexes));
+        pLaterExpectedSetIndexes[i] = resultSetIndexes[0];
+    }
+
+    TimeDecisionLookups(L"Snapshot", pMap, pResolver, true, pExpectedSetIndexes, numResources, numPasses);
+    TimeDecisionLookups(L"Added after snapshot", pLaterMap, pResolver, true, pLaterExpectedSetIndexes, numLaterResources, numPasses);
+
+    // The snapshot is tied to qualifier values, not to resets. Name a different winner for one decision in a copy
+    // of it, so that single-result lookups show whether the copy is in use.
+    UINT16* pDoctored = new UINT16[numSnapshotEntries];
+    VERIFY_IS_NOT_NULL(pDoctored);
+    memcpy(pDoctored, pSnapshot, numSnapshotEntries * sizeof(UINT16));
+
+    DecisionResult doctoredDecision;
+    int doctoredWinner = -1;
+    for (int i = 0; (i < numSnapshotEntries / 2) && (doctoredWinner < 0); i++)
+    {
+        VERIFY_SUCCEEDED(pDecisions->GetDecision(i, &doctoredDecision));
+        if ((doctoredDecision.GetNumQualifierSets() > 1) && (pSnapshot[i * 2] != 0xffff))
+        {
+            int indexInPool;
+            doctoredWinner = (pSnapshot[i * 2] == 0) ? 1 : 0;
+            VERIFY_SUCCEEDED(doctoredDecision.GetQualifierSetIndexInPool(doctoredWinner, &indexInPool));
+            pDoctored[i * 2] = static_cast<UINT16>(doctoredWinner);
+            pDoctored[(i * 2) + 1] = static_cast<UINT16>(indexInPool);
+        }
+    }
+    VERIFY_IS_TRUE(doctoredWinner >= 0);
+    VERIFY_SUCCEEDED(pResolver->UseDecisionTable(pDoctored, numSnapshotEntries));
+
+    PCWSTR pSnapshotLanguage = languages[languages.GetSize() - 1];
+    PCWSTR pOtherLanguage = languages[0];
+    VERIFY_IS_TRUE(DefString_Compare(pSnapshotLanguage, pOtherLanguage) != Def_Equal);
+
+    int resultIndex;
+    int resultSetIndex;
+    int resultIndexes[2];
+    int resultSetIndexes[2];
+    VERIFY_SUCCEEDED(pResolver->EvaluateDecision(&doctoredDecision, 1, &resultIndex, &resultSetIndex));
+    VERIFY_ARE_EQUAL(resultIndex, doctoredWinner);
+
+    // Setting the value it already has, as applying a resource context does, keeps the snapshot.
+    VERIFY_SUCCEEDED(pResolver->SetQualifier(L"Language", pSnapshotLanguage));
+    VERIFY_SUCCEEDED(pResolver->EvaluateDecision(&doctoredDecision, 1, &resultIndex, &resultSetIndex));
+    VERIFY_ARE_EQUAL(resultIndex, doctoredWinner);
+
+    // Other values resolve for real.
+    VERIFY_SUCCEEDED(pResolver->SetQualifier(L"Language", pOtherLanguage));
+    VERIFY_SUCCEEDED(pResolver->EvaluateDecision(&doctoredDecision, 1, &resultIndex, &resultSetIndex));
+    VERIFY_SUCCEEDED(pResolver->EvaluateDecision(&doctoredDecision, 2, resultIndexes, resultSetIndexes));
+    VERIFY_ARE_EQUAL(resultIndex, resultIndexes[0]);
+
+    // And going back to the snapshot's values uses it again.
+    VERIFY_SUCCEEDED(pResolver->SetQualifier(L"Language", pSnapshotLanguage));
+    VERIFY_SUCCEEDED(pResolver->EvaluateDecision(&doctoredDecision, 1, &resultIndex, &resultSetIndex));
+    VERIFY_ARE_EQUAL(resultIndex, doctoredWinner);
+
+    VERIFY_SUCCEEDED(pResolver->EnableDecisionTable(false));
+    VERIFY_IS_FALSE(pResolver->IsDecisionTableEnabled());
+    TimeDecisionLookups(L"Table disabled", pMap, pResolver, true, pExpectedSetIndexes, numResources, numPasses);
+
+    // The snapshot has to outlive the resolver.
+    pView.Release();
+    delete[] pDoctored;
+    delete[] pSnapshot;
+    delete[] pLaterExpectedSetIndexes;
+    delete[] pExpectedSetIndexes;
+}
+
+// Reads the string value of every candidate of every resource in the map numPasses times and checks each one
+// against pExpected, which holds the values in the same order.
+static void TimeStringLookups(
+    _In_ PCWSTR description,
+    _In_ const ManagedResourceMap* pMap,
+    _In_reads_(numCandidates) const StringResult* pExpected,
+    _In_ int numCandidates,
+    _In_ int numPasses)
+{
+    String tmp;
+    SYSTEMTIME start;
+    SYSTEMTIME checkpoint;
+    SYSTEMTIME elapsed;
+    int numFailures = 0;
+
+    GetSystemTime(&start);
+    for (int iPass = 0; iPass < numPasses; iPass++)
+    {
+        int iCandidate = 0;
+        for (int i = 0; i < pMap->GetNumResources(); i++)
+        {
+            NamedResourceResult resource;
+            if (FAILED(pMap->GetResourceByIndex(i, &resource)))
+            {
+                numFailures++;
+                continue;
+            }
+
+            for (int j = 0; (j < resource.GetNumCandidates()) && (iCandidate < numCandidates); j++, iCandidate++)
+            {
+                ResourceCandidateResult candidate;
+                StringResult value;
+                if (FAILED(resource.GetCandidate(j, &candidate)) || !candidate.TryGetStringValue(&value) ||
+                    (DefString_Compare(value.GetRef(), pExpected[iCandidate].GetRef()) != Def_Equal))
+                {
+                    numFailures++;
+                }
+            }
+        }
+    }
+    GetSystemTime(&checkpoint);
+    ComputeElapsedTime(start, checkpoint, &elapsed);
+
+    Log::Comment(tmp.Format(
+        L"[ %s: %d string lookups in %02d:%02d:%02d:%03d ]",
+        description,
+        numPasses * numCandidates,
+        elapsed.wHour,
+        elapsed.wMinute,
+        elapsed.wSecond,
+        elapsed.wMilliseconds));
+    VERIFY_ARE_EQUAL(numFailures, 0);
+}
+
+void UnifiedResourceViewUnitTests::DecodedStringCacheTests()
+{
+    String tmp;
+    PCWSTR pVarPrefix = L"";
+    String filesSpec;
+    TestStringArray files;
+    int cacheBudget;
+    int numPasses;
+
+    if (!SetupTestMethodOutputFolder(L"DecodedStringCacheTests"))
+    {
+        return;
+    }
+
+    if (FAILED(TestData::TryGetValue(L"CacheBudget", cacheBudget)) || FAILED(TestData::TryGetValue(L"NumPasses", numPasses)))
+    {
+        Log::Error(L"[ Couldn't load CacheBudget or NumPasses ]");
+        return;
+    }
+
+    AutoDeletePtr<CoreProfile> pProfile;
+    VERIFY_SUCCEEDED(CoreProfile::ChooseDefaultProfile(&pProfile));
+
+    TestStringArray fileNames;
+    if (FAILED(TestHPri::BuildMultiplePriFilesFromTestVars(pVarPrefix, this, pProfile, &fileNames)))
+    {
+        return;
+    }
+
+    AutoDeletePtr<UnifiedResourceView> pView;
+    VERIFY_SUCCEEDED(UnifiedResourceView::CreateInstance(pProfile, &pView));
+    VERIFY(pView != NULL);
+
+    if (FAILED(TestData::TryGetValue(L"FilesToLoad", filesSpec)) || FAILED(files.InitFromList(filesSpec)) || (files.GetNumStrings() != 1))
+    {
+        Log::Error(L"[ Couldn't load FilesToLoad ]");
+        return;
+    }
+
+    String fullPath;
+    if (GetOutputFilePath(files.GetString(0), fullPath) == NULL)
+    {
+        Log::Error(tmp.Format(L"[ Unable to get output file path for \"%s\" ]", files.GetString(0)));
+        return;
+    }
+
+    const ManagedResourceMap* pMap;
+    VERIFY_SUCCEEDED(pView->GetOrAddReferencedFile((PCWSTR)fullPath, NULL, &pMap, NULL));
+    VERIFY(pMap != NULL);
+
+    ManagedFile* pFile;
+    VERIFY_SUCCEEDED(pView->GetFileManager()->GetFile((PCWSTR)fullPath, &pFile));
+    VERIFY_IS_NULL(pFile->GetDecodedStringCache());
+
+    // Collect the expected values without a cache, and count the ones that are stored as ASCII or UTF-8.
+    int numCandidates = 0;
+    int numDecodedCandidates = 0;
+    for (int i = 0; i < pMap->GetNumResources(); i++)
+    {
+        NamedResourceResult resource;
+        VERIFY_SUCCEEDED(pMap->GetResourceByIndex(i, &resource));
+        numCandidates += resource.GetNumCandidates();
+    }
+    VERIFY_IS_TRUE(numCandidates > 0);
+
+    StringResult* pExpected = new StringResult[numCandidates];
+    VERIFY_IS_NOT_NULL(pExpected);
+
+    int iCandidate = 0;
+    for (int i = 0; i < pMap->GetNumResources(); i++)
+    {
+        NamedResourceResult resource;
+        VERIFY_SUCCEEDED(pMap->GetResourceByIndex(i, &resource));
+        for (int j = 0; j < resource.GetNumCandidates(); j++, iCandidate++)
+        {
+            ResourceCandidateResult candidate;
+            MrmEnvironment::ResourceValueType valueType;
+            VERIFY_SUCCEEDED(resource.GetCandidate(j, &candidate));
+            VERIFY_IS_TRUE(candidate.TryGetStringValue(&pExpected[iCandidate]));
+            VERIFY_SUCCEEDED(candidate.GetResourceValueType(&valueType));
+            if (MrmEnvironment::MapResourceValueTypeToEncoding(valueType) != DEFSTRING_ENCODING_UTF16)
+            {
+                numDecodedCandidates++;
+            }
+        }
+    }
+    Log::Comment(tmp.Format(L"[ %d of %d candidates are stored as ASCII or UTF-8 ]", numDecodedCandidates, numCandidates));
+    VERIFY_IS_TRUE(numDecodedCandidates > 0);
+
+    TimeStringLookups(L"No cache", pMap, pExpected, numCandidates, numPasses);
+
+    VERIFY_SUCCEEDED(pView->SetDecodedStringCacheBudget(cacheBudget));
+    const DecodedStringCache* pCache = pFile->GetDecodedStringCache();
+    VERIFY_IS_NOT_NULL(pCache);
+    VERIFY_ARE_EQUAL(pCache->GetBudget(), static_cast<size_t>(cacheBudget));
+
+    // The first pass only misses, and fills the cache as far as the budget allows.
+    TimeStringLookups(L"First pass", pMap, pExpected, numCandidates, 1);
+    VERIFY_ARE_EQUAL(pCache->GetNumHits(), 0ull);
+    VERIFY_ARE_EQUAL(pCache->GetNumMisses(), static_cast<UINT64>(numDecodedCandidates));
+    VERIFY_IS_TRUE(pCache->GetSizeInBytes() <= pCache->GetBudget());
+
+    TimeStringLookups(L"Cache", pMap, pExpected, numCandidates, numPasses);
+    Log::Comment(tmp.Format(
+        L"[ %I64u hits, %I64u misses, %d entries, %Iu bytes ]",
+        pCache->GetNumHits(),
+        pCache->GetNumMisses(),
+        pCache->GetNumEntries(),
+        pCache->GetSizeInBytes()));
+    VERIFY_ARE_EQUAL(pCache->GetNumHits() + pCache->GetNumMisses(), static_cast<UINT64>(numDecodedCandidates) * (numPasses + 1));
+    VERIFY_IS_TRUE(pCache->GetSizeInBytes() <= pCache->GetBudget());
+    VERIFY_IS_TRUE(pCache->GetNumHits() > 0);
+
+    size_t cbLargestEntry = 0;
+    for (int i = 0; i < numCandidates; i++)
+    {
+        size_t cch;
+        VERIFY_SUCCEEDED(pExpected[i].GetLength(&cch));
+        cbLargestEntry = max(cbLargestEntry, (cch + 1) * sizeof(WCHAR));
+    }
+    if (cbLargestEntry * numDecodedCandidates <= pCache->GetBudget())
+    {
+        // Everything fits, so nothing after the first pass should miss.
+        VERIFY_ARE_EQUAL(pCache->GetNumMisses(), static_cast<UINT64>(numDecodedCandidates));
+
+        // Hits point at the cached string instead of copying it, so every lookup returns the same buffer.
+        for (int i = 0; i < pMap->GetNumResources(); i++)
+        {
+            NamedResourceResult resource;
+            VERIFY_SUCCEEDED(pMap->GetResourceByIndex(i, &resource));
+            for (int j = 0; j < resource.GetNumCandidates(); j++)
+            {
+                ResourceCandidateResult candidate;
+                MrmEnvironment::ResourceValueType valueType;
+                VERIFY_SUCCEEDED(resource.GetCandidate(j, &candidate));
+                VERIFY_SUCCEEDED(candidate.GetResourceValueType(&valueType));
+                if ((MrmEnvironment::MapResourceValueTypeToEncoding(valueType) != DEFSTRING_ENCODING_UTF16) &&
+                    !MrmEnvironment::IsPathResourceValueType(valueType))
+                {
+                    StringResult first;
+                    StringResult second;
+                    VERIFY_IS_TRUE(candidate.TryGetStringValue(&first));
+                    VERIFY_IS_TRUE(candidate.TryGetStringValue(&second));
+                    VERIFY_ARE_EQUAL(first.GetRef(), second.GetRef());
+                }
+            }
+        }
+    }
+
+    // Turning the cache off stops adding strings but keeps the ones that lookups may still point at.
+    int numEntries = pCache->GetNumEntries();
+    size_t cbEntries = pCache->GetSizeInBytes();
+    VERIFY_SUCCEEDED(pView->SetDecodedStringCacheBudget(0));
+    TimeStringLookups(L"Cache turned off", pMap, pExpected, numCandidates, 1);
+    VERIFY_ARE_EQUAL(pCache->GetNumEntries(), numEntries);
+    VERIFY_ARE_EQUAL(pCache->GetSizeInBytes(), cbEntries);
+
+    delete[] pExpected;
+}
+
+static void TimeLoadPriFiles(
+    _In_ PCWSTR description,
+    _In_ CoreProfile* pProfile,
+    _In_reads_(numFiles) StringResult* pFilePaths,
+    _In_ int numFiles,
+    _In_ int numFilesPerLoad)
+{
+    String tmp;
+    SYSTEMTIME start;
+    SYSTEMTIME checkpoint;
+    SYSTEMTIME elapsed;
+    int numLoaded = 0;
+
+    AutoDeletePtr<UnifiedResourceView> pView;
+    VERIFY_SUCCEEDED(UnifiedResourceView::CreateInstance(pProfile, &pView));
+
+    DynamicArray<StringResult*> filePathsCollection;
+
+    GetSystemTime(&start);
+    for (int first = 0; first < numFiles; first += numFilesPerLoad)
+    {
+        filePathsCollection.Reset();
+        for (int i = first; (i < first + numFilesPerLoad) && (i < numFiles); i++)
+        {
+            VERIFY_SUCCEEDED(filePathsCollection.Add(&pFilePaths[i]));
+        }
+
+        DynamicArray<UnifiedResourceView::PriFileInfo*>* pLoadedPriFilesInfo = nullptr;
+        VERIFY_SUCCEEDED(pView->LoadPriFiles(PACKAGE_INIT, &filePathsCollection, LoadPriFlags::Default, &pLoadedPriFilesInfo));
+        for (UINT i = 0; i < pLoadedPriFilesInfo->Count(); i++)
+        {
+            UnifiedResourceView::PriFileInfo* pLoadedPriFileInfo;
+            VERIFY_SUCCEEDED(pLoadedPriFilesInfo->Get(i, &pLoadedPriFileInfo));
+            numLoaded += (pLoadedPriFileInfo->GetFileLoaded() ? 1 : 0);
+            delete pLoadedPriFileInfo;
+        }
+        delete pLoadedPriFilesInfo;
+    }
+    GetSystemTime(&checkpoint);
+    ComputeElapsedTime(start, checkpoint, &elapsed);
+
+    Log::Comment(tmp.Format(
+        L"[ %s: loaded %d PRI files in %02d:%02d:%02d:%03d ]",
+        description,
+        numLoaded,
+        elapsed.wHour,
+        elapsed.wMinute,
+        elapsed.wSecond,
+        elapsed.wMilliseconds));
+
+    // Every file is a copy of the same PRI, so they all share one schema and one resource map.
+    VERIFY_ARE_EQUAL(numFiles, numLoaded);
+    VERIFY_ARE_EQUAL(numFiles, pView->GetNumReferencedFiles());
+    VERIFY_ARE_EQUAL(1, pView->GetNumResourceMaps());
+    for (int i = 0; i < pView->GetFileManager()->GetNumFiles(); i++)
+    {
+        ManagedFile* pFile;
+        VERIFY_SUCCEEDED(pView->GetFileManager()->GetFile(i, &pFile));
+        VERIFY_IS_TRUE(pFile->IsLoaded());
+    }
+}
+
+void UnifiedResourceViewUnitTests::ConcurrentLoadPriFilesTests()
+{
+    TestHPri pri;
+    String tmp;
+    int numFiles;
+
+    if (FAILED(TestData::TryGetValue(L"NumPriFiles", numFiles)) || (numFiles < 1))
+    {
+        Log::Error(L"[ Couldn't load NumPriFiles ]");
+        return;
+    }
+
+    if (!SetupTestMethodOutputFolder(L"ConcurrentLoadPriFilesTests"))
+    {
+        return;
+    }
+
+    AutoDeletePtr<CoreProfile> pProfile;
+    VERIFY_SUCCEEDED(CoreProfile::ChooseDefaultProfile(&pProfile));
+
+    if (FAILED(pri.InitFromTestVars(L"", NULL, pProfile, NULL)) || FAILED(pri.Build()))
+    {
+        Log::Error(L"[ Couldn't build test PRI ]");
+        return;
+    }
+
+    String templatePath;
+    VERIFY_IS_NOT_NULL(GetOutputFilePath(L"template.pri", templatePath));
+    VERIFY_SUCCEEDED(pri.WriteToFile((PCWSTR)templatePath));
+
+    // Stand in for the PRI files of an app and its framework packages.
+    StringResult* pFilePaths = new StringResult[numFiles];
+    VERIFY_IS_NOT_NULL(pFilePaths);
+    for (int i = 0; i < numFiles; i++)
+    {
+        String filePath;
+        VERIFY_IS_NOT_NULL(GetOutputFilePath(tmp.Format(L"framework%02d.pri", i), filePath));
+        VERIFY_WIN32_BOOL_SUCCEEDED(CopyFile((PCWSTR)templatePath, (PCWSTR)filePath, FALSE));
+        VERIFY_SUCCEEDED(pFilePaths[i].Init((PCWSTR)filePath));
+    }
+
+    // One file per call never has anything to load in parallel, which matches the old serial loop.
+    TimeLoadPriFiles(L"One file per call", pProfile, pFilePaths, numFiles, 1);
+    TimeLoadPriFiles(L"All files in one call", pProfile, pFilePaths, numFiles, numFiles);
+
+    delete[] pFilePaths;
+}
+
+static size_t GetWorkingSetSize()
+{
+    PROCESS_MEMORY_COUNTERS counters = {};
+    VERIFY_WIN32_BOOL_SUCCEEDED(GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)));
+    return counters.WorkingSetSize;
+}
+
+static void VerifyGeneratedResource(_In_ const IResourceMapBase* pMap, _In_ int index)
+{
+    WCHAR nameBuf[MAX_PATH];
+    WCHAR valueBuf[MAX_PATH];
+    VERIFY_SUCCEEDED(StringCchPrintf(nameBuf, ARRAYSIZE(nameBuf), L"Generated/Scope%d/Item%d", index / 100, index));
+    VERIFY_SUCCEEDED(StringCchPrintf(valueBuf, ARRAYSIZE(valueBuf), L"Generated value %d", index));
+
+    NamedResourceResult resource;
+    ResourceCandidateResult candidate;
+    StringResult value;
+    VERIFY_SUCCEEDED(pMap->GetResource(nameBuf, &resource));
+    VERIFY_SUCCEEDED(resource.GetCandidate(0, &candidate));
+    VERIFY_IS_TRUE(candidate.TryGetStringValue(&value));
+    VERIFY_ARE_EQUAL(Def_Equal, DefString_Compare(value.GetRef(), valueBuf));
+}
+
+void UnifiedResourceViewUnitTests::MappedPriWorkingSetTests()
+{
+    String tmp;
+    int numResources;
+
+    if (FAILED(TestData::TryGetValue(L"NumGeneratedResources", numResources)) || (numResources < 1))
+    {
+        Log::Error(L"[ Couldn't load NumGeneratedResources ]");
+        return;
+    }
+
+    if (!SetupTestMethodOutputFolder(L"MappedPriWorkingSetTests"))
+    {
+        return;
+    }
+
+    AutoDeletePtr<CoreProfile> pProfile;
+    VERIFY_SUCCEEDED(CoreProfile::ChooseDefaultProfile(&pProfile));
+
+    TestHPri pri;
+    VERIFY_SUCCEEDED(pri.InitFromTestVars(L"", NULL, pProfile, NULL));
+
+    String simpleId;
+    VERIFY_SUCCEEDED(TestData::TryGetValue(L"SimpleId", simpleId));
+
+    QualifierSetResult qualifiers;
+    VERIFY_SUCCEEDED(pri.GetTestDI()->GetQualifierSetData()->GetOrAddQualifierSet(
+        L"$en", pri.GetPriSectionBuilder()->GetDecisionInfoBuilder(), &qualifiers));
+
+    MrmEnvironment::ResourceValueType type;
+    VERIFY_SUCCEEDED(MrmEnvironment::GetResourceValueType(L"string", &type));
+
+    WCHAR nameBuf[MAX_PATH];
+    WCHAR valueBuf[MAX_PATH];
+    for (int i = 0; i < numResources; i++)
+    {
+        VERIFY_SUCCEEDED(StringCchPrintf(nameBuf, ARRAYSIZE(nameBuf), L"Generated/Scope%d/Item%d", i / 100, i));
+        VERIFY_SUCCEEDED(StringCchPrintf(valueBuf, ARRAYSIZE(valueBuf), L"Generated value %d", i));
+        VERIFY_SUCCEEDED(pri.GetPriSectionBuilder()->AddCandidateWithString(simpleId, nameBuf, type, valueBuf, &qualifiers));
+    }
+
+    String priPath;
+    VERIFY_IS_NOT_NULL(GetOutputFilePath(L"large.pri", priPath));
+    VERIFY_SUCCEEDED(pri.GetFileBuilder()->WriteToFile(priPath));
+
+    StringResult filePath;
+    VERIFY_SUCCEEDED(filePath.Init((PCWSTR)priPath));
+    DynamicArray<StringResult*> filePathsCollection;
+    VERIFY_SUCCEEDED(filePathsCollection.Add(&filePath));
+
+    SYSTEMTIME start;
+    SYSTEMTIME checkpoint;
+    SYSTEMTIME elapsed;
+
+    // Time to first lookup covers opening the file, which prefetches its hot sections, and one lookup.
+    size_t cbBeforeLoad = GetWorkingSetSize();
+    GetSystemTime(&start);
+
+    AutoDeletePtr<UnifiedResourceView> pView;
+    VERIFY_SUCCEEDED(UnifiedResourceView::CreateInstance(pProfile, &pView));
+
+    DynamicArray<UnifiedResourceView::PriFileInfo*>* pLoadedPriFilesInfo = nullptr;
+    VERIFY_SUCCEEDED(pView->LoadPriFiles(PACKAGE_INIT, &filePathsCollection, LoadPriFlags::Default, &pLoadedPriFilesInfo));
+    for (UINT i = 0; i < pLoadedPriFilesInfo->Count(); i++)
+    {
+        UnifiedResourceView::PriFileInfo* pLoadedPriFileInfo;
+        VERIFY_SUCCEEDED(pLoadedPriFilesInfo->Get(i, &pLoadedPriFileInfo));
+        VERIFY_IS_TRUE(pLoadedPriFileInfo->GetFileLoaded());
+        delete pLoadedPriFileInfo;
+    }
+    delete pLoadedPriFilesInfo;
+
+    const IResourceMapBase* pMap;
+    VERIFY_SUCCEEDED(pView->GetResourceMap(0, &pMap));
+    VerifyGeneratedResource(pMap, numResources - 1);
+
+    GetSystemTime(&checkpoint);
+    ComputeElapsedTime(start, checkpoint, &elapsed);
+    size_t cbFirstLookup = GetWorkingSetSize();
+
+    const PriFileManager* pManager = pView->GetFileManager();
+    ManagedFile* pFile;
+    VERIFY_SUCCEEDED(pManager->GetFile(0, &pFile));
+    const BaseFile* pBaseFile;
+    VERIFY_SUCCEEDED(pFile->GetBaseFile(&pBaseFile));
+
+    Log::Comment(tmp.Format(
+        L"[ %Iu byte %s PRI with %d resources: first lookup in %02d:%02d:%02d:%03d, working set +%Iu KB ]",
+        pFile->GetSizeInBytes(),
+        (pBaseFile->IsMapped() ? L"mapped" : L"loaded"),
+        numResources,
+        elapsed.wHour,
+        elapsed.wMinute,
+        elapsed.wSecond,
+        elapsed.wMilliseconds,
+        ((cbFirstLookup > cbBeforeLoad) ? (cbFirstLookup - cbBeforeLoad) / 1024 : 0)));
+
+    // Looking up every resource reads all of the candidate data.
+    for (int i = 0; i < numResources; i++)
+    {
+        VerifyGeneratedResource(pMap, i);
+    }
+    size_t cbAllLookups = GetWorkingSetSize();
+
+    VERIFY_SUCCEEDED(pView->TrimColdSections());
+    size_t cbTrimmed = GetWorkingSetSize();
+
+    Log::Comment(tmp.Format(
+        L"[ Working set after every lookup: %Iu KB, after trimming cold sections: %Iu KB ]", cbAllLookups / 1024, cbTrimmed / 1024));
+
+    // Trimmed pages come back from the file on their next use.
+    GetSystemTime(&start);
+    for (int i = 0; i < numResources; i++)
+    {
+        VerifyGeneratedResource(pMap, i);
+    }
+    GetSystemTime(&checkpoint);
+    ComputeElapsedTime(start, checkpoint, &elapsed);
+    Log::Comment(tmp.Format(
+        L"[ Every lookup again after trimming in %02d:%02d:%02d:%03d ]",
+        elapsed.wHour,
+        elapsed.wMinute,
+        elapsed.wSecond,
+        elapsed.wMilliseconds));
+
+    // Both hints do nothing for empty sections or files that were loaded rather than mapped.
+    HRESULT expected = (pBaseFile->IsMapped() ? S_OK : S_FALSE);
+    for (int i = 0; i < pBaseFile->GetNumSections(); i++)
+    {
+        const DEFFILE_TOC_ENTRY* pToc;
+        VERIFY_SUCCEEDED(pBaseFile->GetTocEntry(i, &pToc));
+        HRESULT expectedForSection = ((pToc->cbSectionTotal != 0) ? expected : S_FALSE);
+        VERIFY_ARE_EQUAL(expectedForSection, pBaseFile->PrefetchSectionPages(i));
+        VERIFY_ARE_EQUAL(expectedForSection, pBaseFile->TrimSectionPages(i));
+    }
+    VERIFY_ARE_EQUAL(E_INVALIDARG, pBaseFile->PrefetchSectionPages(pBaseFile->GetNumSections()));
+}
+
 } // namespace UnitTests
@@ -616,6 +616,30 @@ public:
     TEST_METHOD(RoundTripThroughPublicFunctionAscii);
     TEST_METHOD(RoundTripThroughPublicFunctionUtf8);
     TEST_METHOD(InvalidUtf8);
+    TEST_METHOD(AsciiAcrossBlockBoundaries);
+    TEST_METHOD(Utf8MatchesMultiByteToWideChar);
+    TEST_METHOD(IllFormedUtf8IsRejected);
+    TEST_METHOD(Utf16ToAscii);
+    TEST_METHOD(Utf8ConversionThroughput);
+};
+
+// Localized UI strings like the ones found in app resource files, used to build mixed UTF-8 input.
+static PCWSTR const c_pszLocalizedStrings[] = {
+    L"Save changes before closing?",
+    L"Änderungen vor dem Schließen speichern?",
+    L"Enregistrer les modifications avant de fermer ?",
+    L"¿Guardar los cambios antes de cerrar?",
+    L"Сохранить изменения перед закрытием?",
+    L"Αποθήκευση αλλαγών πριν από το κλείσιμο;",
+    L"閉じる前に変更を保存しますか?",
+    L"关闭前是否保存更改?",
+    L"닫기 전에 변경 내용을 저장하시겠습니까?",
+    L"هل تريد حفظ التغييرات قبل الإغلاق؟",
+    L"האם לשמור את השינויים לפני הסגירה?",
+    L"ปิดโดยไม่บันทึกการเปลี่ยนแปลงหรือไม่",
+    L"बंद करने से पहले परिवर्तन सहेजें?",
+    L"Settings > Privacy & security > Location 📍",
+    L"𠀀𠀁𪛕𪛖 ok",
 };
 
 // Round trip through public function.
@@ -791,4 +815,214 @@ void StringConversionUnitTests::InvalidUtf8()
     VERIFY_ARE_EQUAL(cchUtf16IncludingNull, 0u);
 }
 
+// The converters work on blocks of 16 bytes, so check every length around a few block boundaries.
+void StringConversionUnitTests::AsciiAcrossBlockBoundaries()
+{
+    char ascii[70];
+    for (size_t cch = 1; cch <= ARRAYSIZE(ascii); cch++)
+    {
+        for (size_t i = 0; i < cch - 1; i++)
+        {
+            ascii[i] = static_cast<char>(1 + ((i * 37) % 127));
+        }
+        ascii[cch - 1] = '\0';
+
+        PWSTR pszUtf16;
+        VERIFY_SUCCEEDED(DefString_ConvertAsciiToUtf16(ascii, cch, &pszUtf16));
+        for (size_t i = 0; i < cch; i++)
+        {
+            VERIFY_ARE_EQUAL(static_cast<WCHAR>(ascii[i]), pszUtf16[i]);
+        }
+        _DefFree(pszUtf16);
+
+        size_t cchUtf16IncludingNull;
+        VERIFY_SUCCEEDED(DefString_ConvertUtf8ToUtf16(ascii, cch, &cchUtf16IncludingNull, &pszUtf16));
+        VERIFY_ARE_EQUAL(cch, cchUtf16IncludingNull);
+        for (size_t i = 0; i < cch; i++)
+        {
+            VERIFY_ARE_EQUAL(static_cast<WCHAR>(ascii[i]), pszUtf16[i]);
+        }
+        _DefFree(pszUtf16);
+    }
+}
+
+// Put each localized string after ASCII prefixes of every length up to two blocks, so that multi-byte sequences
+// start at every position within a block and ASCII runs end at every position.
+void StringConversionUnitTests::Utf8MatchesMultiByteToWideChar()
+{
+    for (unsigned int i = 0; i < ARRAYSIZE(c_pszLocalizedStrings); i++)
+    {
+        for (int cchPrefix = 0; cchPrefix <= 32; cchPrefix++)
+        {
+            WCHAR pszInput[MAX_PATH] = {};
+            for (int j = 0; j < cchPrefix; j++)
+            {
+                pszInput[j] = static_cast<WCHAR>(L'a' + (j % 26));
+            }
+            VERIFY_SUCCEEDED(StringCchCopyW(pszInput + cchPrefix, ARRAYSIZE(pszInput) - cchPrefix, c_pszLocalizedStrings[i]));
+
+            char pszUtf8[MAX_PATH * 4] = {};
+            int cbUtf8 = WideCharToMultiByte(CP_UTF8, 0, pszInput, -1, pszUtf8, sizeof(pszUtf8), nullptr, nullptr);
+            VERIFY_IS_TRUE(cbUtf8 > 0);
+
+            WCHAR pszExpected[MAX_PATH] = {};
+            int cchExpected = MultiByteToWideChar(CP_UTF8, MB_ERR_INVALID_CHARS, pszUtf8, cbUtf8, pszExpected, ARRAYSIZE(pszExpected));
+            VERIFY_IS_TRUE(cchExpected > 0);
+
+            size_t cchUtf16IncludingNull;
+            PWSTR pszUtf16;
+            VERIFY_SUCCEEDED(DefString_ConvertUtf8ToUtf16(pszUtf8, cbUtf8, &cchUtf16IncludingNull, &pszUtf16));
+            VERIFY_ARE_EQUAL(static_cast<size_t>(cchExpected), cchUtf16IncludingNull);
+            VERIFY_ARE_EQUAL(0, memcmp(pszExpected, pszUtf16, cchExpected * sizeof(WCHAR)));
+            _DefFree(pszUtf16);
+        }
+    }
+}
+
+// Sequences that have the right shape but are still not well-formed UTF-8, each placed both at the start of the
+// string and after a full block of ASCII. MultiByteToWideChar must reject them too.
+void StringConversionUnitTests::IllFormedUtf8IsRejected()
+{
+    struct
+    {
+        PCSTR pszSequence;
+        PCWSTR pszDescription;
+    } const c_illFormed[] = {
+        {"\xC0\x80", L"Overlong two byte NUL"},
+        {"\xC1\xBF", L"Overlong two byte"},
+        {"\xE0\x80\x80", L"Overlong three byte"},
+        {"\xE0\x9F\xBF", L"Overlong three byte"},
+        {"\xF0\x80\x80\x80", L"Overlong four byte"},
+        {"\xF0\x8F\xBF\xBF", L"Overlong four byte"},
+        {"\xED\xA0\x80", L"Lead surrogate"},
+        {"\xED\xBF\xBF", L"Trail surrogate"},
+        {"\xF4\x90\x80\x80", L"Above U+10FFFF"},
+        {"\xF5\x80\x80\x80", L"Invalid lead byte"},
+        {"\x80", L"Lone continuation byte"},
+        {"\xE2\x82", L"Truncated three byte"},
+        {"\xF0\x9F\x98", L"Truncated four byte"},
+    };
+
+    for (unsigned int i = 0; i < ARRAYSIZE(c_illFormed); i++)
+    {
+        Log::Comment(String().Format(L"Testing %s.", c_illFormed[i].pszDescription));
+
+        for (int cchPrefix = 0; cchPrefix <= 16; cchPrefix += 16)
+        {
+            char pszUtf8[64] = {};
+            memset(pszUtf8, 'a', cchPrefix);
+            VERIFY_SUCCEEDED(StringCchCopyA(pszUtf8 + cchPrefix, ARRAYSIZE(pszUtf8) - cchPrefix, c_illFormed[i].pszSequence));
+            size_t cbUtf8 = strlen(pszUtf8) + 1;
+
+            VERIFY_ARE_EQUAL(0, MultiByteToWideChar(CP_UTF8, MB_ERR_INVALID_CHARS, pszUtf8, static_cast<int>(cbUtf8), nullptr, 0));
+
+            size_t cchUtf16IncludingNull;
+            PWSTR pszUtf16;
+            HRESULT hr = DefString_ConvertUtf8ToUtf16(pszUtf8, cbUtf8, &cchUtf16IncludingNull, &pszUtf16);
+            VERIFY_IS_NULL(pszUtf16);
+            VERIFY_ARE_EQUAL(hr, HRESULT_FROM_WIN32(ERROR_NO_UNICODE_TRANSLATION));
+            VERIFY_ARE_EQUAL(cchUtf16IncludingNull, 0u);
+        }
+    }
+
+    // The smallest and largest well-formed values around each of those ranges still convert.
+    PCSTR const c_wellFormed[] = {"\xC2\x80", "\xE0\xA0\x80", "\xED\x9F\xBF", "\xEE\x80\x80", "\xF0\x90\x80\x80", "\xF4\x8F\xBF\xBF"};
+    for (unsigned int i = 0; i < ARRAYSIZE(c_wellFormed); i++)
+    {
+        size_t cbUtf8 = strlen(c_wellFormed[i]) + 1;
+        WCHAR pszExpected[4] = {};
+        int cchExpected =
+            MultiByteToWideChar(CP_UTF8, MB_ERR_INVALID_CHARS, c_wellFormed[i], static_cast<int>(cbUtf8), pszExpected, ARRAYSIZE(pszExpected));
+        VERIFY_IS_TRUE(cchExpected > 0);
+
+        size_t cchUtf16IncludingNull;
+        PWSTR pszUtf16;
+        VERIFY_SUCCEEDED(DefString_ConvertUtf8ToUtf16(c_wellFormed[i], cbUtf8, &cchUtf16IncludingNull, &pszUtf16));
+        VERIFY_ARE_EQUAL(static_cast<size_t>(cchExpected), cchUtf16IncludingNull);
+        VERIFY_ARE_EQUAL(0, memcmp(pszExpected, pszUtf16, cchExpected * sizeof(WCHAR)));
+        _DefFree(pszUtf16);
+    }
+}
+
+void StringConversionUnitTests::Utf16ToAscii()
+{
+    WCHAR pszUtf16[70];
+    char pszAscii[70];
+    for (size_t cch = 1; cch <= ARRAYSIZE(pszUtf16); cch++)
+    {
+        for (size_t i = 0; i < cch; i++)
+        {
+            pszUtf16[i] = static_cast<WCHAR>((i * 37) % 128);
+        }
+
+        VERIFY_SUCCEEDED(DefString_ConvertUtf16ToAscii(pszUtf16, cch, pszAscii));
+        for (size_t i = 0; i < cch; i++)
+        {
+            VERIFY_ARE_EQUAL(static_cast<char>(pszUtf16[i]), pszAscii[i]);
+        }
+
+        // A single non-ASCII character anywhere fails the conversion, including ones that only differ in the high byte.
+        for (size_t i = 0; i < cch; i++)
+        {
+            WCHAR original = pszUtf16[i];
+            pszUtf16[i] = ((i % 2) == 0) ? L'\x80' : static_cast<WCHAR>(0x100 | original);
+            VERIFY_ARE_EQUAL(E_INVALIDARG, DefString_ConvertUtf16ToAscii(pszUtf16, cch, pszAscii));
+            pszUtf16[i] = original;
+        }
+    }
+}
+
+// Compares the converter with the two MultiByteToWideChar passes it replaced over the localized string table.
+// This is a measurement rather than a check, so it only logs the results.
+void StringConversionUnitTests::Utf8ConversionThroughput()
+{
+    const int c_iterations = 20000;
+
+    char pszUtf8[ARRAYSIZE(c_pszLocalizedStrings)][MAX_PATH] = {};
+    int cbUtf8[ARRAYSIZE(c_pszLocalizedStrings)] = {};
+    size_t cbTotal = 0;
+    for (unsigned int i = 0; i < ARRAYSIZE(c_pszLocalizedStrings); i++)
+    {
+        cbUtf8[i] = WideCharToMultiByte(CP_UTF8, 0, c_pszLocalizedStrings[i], -1, pszUtf8[i], MAX_PATH, nullptr, nullptr);
+        VERIFY_IS_TRUE(cbUtf8[i] > 0);
+        cbTotal += cbUtf8[i];
+    }
+
+    LARGE_INTEGER frequency, start, end;
+    QueryPerformanceFrequency(&frequency);
+
+    QueryPerformanceCounter(&start);
+    for (int iteration = 0; iteration < c_iterations; iteration++)
+    {
+        for (unsigned int i = 0; i < ARRAYSIZE(c_pszLocalizedStrings); i++)
+        {
+            int cch = MultiByteToWideChar(CP_UTF8, MB_ERR_INVALID_CHARS, pszUtf8[i], cbUtf8[i], nullptr, 0);
+            PWSTR pszUtf16 = _DefArray_Alloc(WCHAR, cch);
+            VERIFY_IS_NOT_NULL(pszUtf16);
+            MultiByteToWideChar(CP_UTF8, MB_ERR_INVALID_CHARS, pszUtf8[i], cbUtf8[i], pszUtf16, cch);
+            _DefFree(pszUtf16);
+        }
+    }
+    QueryPerformanceCounter(&end);
+    double systemSeconds = static_cast<double>(end.QuadPart - start.QuadPart) / frequency.QuadPart;
+
+    QueryPerformanceCounter(&start);
+    for (int iteration = 0; iteration < c_iterations; iteration++)
+    {
+        for (unsigned int i = 0; i < ARRAYSIZE(c_pszLocalizedStrings); i++)
+        {
+            size_t cchUtf16IncludingNull;
+            PWSTR pszUtf16;
+            VERIFY_SUCCEEDED(DefString_ConvertUtf8ToUtf16(pszUtf8[i], cbUtf8[i], &cchUtf16IncludingNull, &pszUtf16));
+            _DefFree(pszUtf16);
+        }
+    }
+    QueryPerformanceCounter(&end);
+    double convertSeconds = static_cast<double>(end.QuadPart - start.QuadPart) / frequency.QuadPart;
+
+    double megabytes = static_cast<double>(cbTotal) * c_iterations / (1024 * 1024);
+    Log::Comment(String().Format(L"MultiByteToWideChar (two passes): %.1f MB/s", megabytes / systemSeconds));
+    Log::Comment(String().Format(L"DefString_ConvertUtf8ToUtf16: %.1f MB/s", megabytes / convertSeconds));
+}
+
 } // namespace UnitTests
\ No newline at end of file
@@ -158,6 +158,8 @@ public:
 
     static const HashMethod HashMethodDefault = DEF_HASH_DEFAULT;
     static const HashMethod HashMethodCaseInsensitive = DEF_HASH_CASE_INSENSITIVE;
+    static const HashMethod HashMethodVersion2 = DEF_HASH_VERSION_2;
+    static const HashMethod HashMethodCaseInsensitiveVersion2 = static_cast<HashMethod>(DEF_HASH_CASE_INSENSITIVE | DEF_HASH_VERSION_2);
 
     static bool IsValidPoolIndex(Atom::Index index) { return (index > 0) && (index <= DEF_ATOM_MAX_INDEX); }
 
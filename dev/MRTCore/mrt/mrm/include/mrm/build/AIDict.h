@@ -212,6 +212,33 @@ protected:
          */
     HRESULT GetOrAddInternalIndex(_In_ Atom::Index nameIndex, _Out_opt_ int* pInternalIndexOut);
 
+    /*! 
+         * Gets or allocates internal indexes for a batch of items
+         * specified as indexes into the atom pool for the dictionary.
+         * Grows the internal pool of item data at most once for the
+         * whole batch, rather than once per item as repeated calls to
+         * \ref GetOrAddInternalIndex can.
+         * 
+         * \param pNameIndexes
+         * The names of the items for which internal indexes are
+         * to be returned.
+         *
+         * \param numNames
+         * The number of entries in \ref pNameIndexes.
+         *
+         * \param pInternalIndexesOut
+         * If non-NULL, returns the corresponding internal index for
+         * each item.
+         * 
+         * \return HRESULT
+         * Returns S_OK if every internal index was found or added,
+         * or failure if an error occurs.
+         */
+    HRESULT GetOrAddInternalIndexes(
+        _In_reads_(numNames) const Atom::Index* pNameIndexes,
+        _In_ int numNames,
+        _Out_writes_opt_(numNames) int* pInternalIndexesOut);
+
     /*! 
          * Resizes the internal pool of item data.
          *
@@ -19,6 +19,7 @@ private:
         fDefault = 0x0000,
         fIsCaseInsensitive = 0x0001,
         fIsNotSorted = 0x0004,
+        fBuildHashIndex = 0x0020,
         fStringPoolIsOwned = 0x0100
     };
 
@@ -54,6 +55,7 @@ public:
         __in WriteableStringPool* pStrings,
         bool isCaseInsensitive,
         _Outptr_ FileAtomPoolBuilder** result);
+
     static HRESULT CreateInstance(__in const IAtomPool* pCloneFrom, _Outptr_ FileAtomPoolBuilder** result);
 
     virtual ~FileAtomPoolBuilder();
@@ -61,6 +63,18 @@ public:
     WriteableStringPool* GetStringPool() { return m_pStrings; }
 
     HRESULT GetOrAddAtom(__in PCWSTR pString, _Out_ Atom* result, __out_opt bool* pIsNewOut = NULL);
+
+    /*!
+     * Gets or adds atoms for a batch of strings.  Produces the same atoms as calling
+     * GetOrAddAtom for each string in order, but hashes the strings up front (on up to
+     * maxThreads threads), finds duplicates and existing atoms with a single sort and
+     * merge, and grows the pool once.
+     */
+    HRESULT GetOrAddAtoms(
+        _In_reads_(numStrings) const PCWSTR* ppStrings,
+        _In_ UINT32 numStrings,
+        _In_ UINT32 maxThreads,
+        _Out_writes_(numStrings) Atom* pAtomsOut);
     AtomPoolGroup* GetAtomPoolGroup() const { return m_group; }
     void SetAtomPoolGroup(AtomPoolGroup* group) { m_group = group; }
     Atom::PoolIndex GetPoolIndex() const { return m_poolIndex; }
@@ -72,6 +72,13 @@ public:
     virtual UINT32 GetSectionQualifier() const = 0;
     virtual void SetSectionIndex(BaseFile::SectionIndex sectionIndex) = 0;
     virtual BaseFile::SectionIndex GetSectionIndex() const = 0;
+
+    /*!
+             * Indicates whether Build can run at the same time as the Build of other
+             * sections that also return true.  Such a section must only read state that
+             * was fixed by Finalize and must only modify state that it owns.
+             */
+    virtual bool CanBuildConcurrently() const { return false; }
 };
 
 // Build a UID-formatted file.
@@ -110,6 +117,8 @@ private:
     UINT32 m_cbSectionData;
     UINT32 m_nSectionDataUsed;
 
+    UINT32 m_maxBuildThreads;
+
 protected:
     FileBuilder(DEFFILE_MAGIC magic);
 
@@ -175,6 +184,11 @@ public:
 
     DEFFILE_MAGIC GetMagic() { return m_magic; }
 
+    // Maximum number of threads used to build sections that can be built concurrently.
+    // 0 or 1 builds every section on the calling thread.
+    UINT32 GetMaxBuildThreads() const { return m_maxBuildThreads; }
+    void SetMaxBuildThreads(UINT32 maxBuildThreads) { m_maxBuildThreads = maxBuildThreads; }
+
     virtual HRESULT GetMaxSize(_Out_ UINT32* size);
 
     virtual HRESULT FinalizeAllSections();
@@ -188,6 +202,10 @@ private:
 
     virtual HRESULT BuildAllSections();
 
+    HRESULT BuildSection(BaseFile::SectionIndex sectionIndex);
+
+    HRESULT BuildSectionsConcurrently(BaseFile::SectionIndex firstSectionIndex, BaseFile::SectionCount numSections);
+
     virtual HRESULT FinishGenerating();
 
     virtual HRESULT GenerateFileContentsInternal();
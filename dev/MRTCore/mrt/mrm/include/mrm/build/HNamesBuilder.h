@@ -24,6 +24,8 @@ public:
     virtual HRESULT AddItem(__in ItemInfo* pItem, __out int* pIndexOut) = 0;
 
     virtual const HierarchicalNamesConfig* GetConfig() const = 0;
+
+    virtual bool IsChildSortDeferred() const = 0;
 };
 
 class HierarchicalNameSegment
@@ -495,8 +497,22 @@ public:
     HRESULT GetOrAddItem(_In_ PCWSTR pName, _Out_ ItemInfo** result);
 
 protected:
+    // Entry in the child name index used when child sorting is deferred.
+    // pNode is nullptr for an empty bucket.
+    struct ChildIndexEntry
+    {
+        UINT32 hash;
+        HNamesNode* pNode;
+    };
+
+    static const UINT32 InitialNumChildIndexBuckets = 32;
+
     DynamicArray<HNamesNode*>* m_pChildren;
 
+    ChildIndexEntry* m_pChildIndex;
+    UINT32 m_numChildIndexBuckets;
+    mutable bool m_childrenSorted;
+
     int m_numChildScopes;
     int m_numChildItems;
 
@@ -561,6 +577,29 @@ protected:
     UINT FindInsertionPoint(_In_ PCWSTR pName, _In_ UINT first, _In_ UINT last, _Out_ int* pDiffOut) const;
 
     HRESULT GetOrAddChildNode(_In_ HNamesNode* newNode, _Out_ HNamesNode** foundNode);
+
+    /*!
+         * _INTERNAL ONLY_
+         * Computes the hash used by the child name index.  Names
+         * that GetOrAddChildNode would consider equal always get
+         * the same hash.
+         */
+    UINT32 ComputeChildIndexHash(_In_ PCWSTR pName) const;
+
+    bool TryGetIndexedChild(_In_ PCWSTR pName, _In_ UINT32 hash, _Outptr_result_maybenull_ HNamesNode** ppChildOut) const;
+
+    HRESULT EnsureChildIndexCapacity();
+
+    void AddIndexedChild(_In_ HNamesNode* pChild, _In_ UINT32 hash);
+
+    /*!
+         * _INTERNAL ONLY_
+         * Sorts children that were added while child sorting was
+         * deferred into the same order GetOrAddChildNode would have
+         * inserted them in.  Anything that reads children by
+         * position calls this first.
+         */
+    void EnsureChildrenSorted() const;
 };
 
 /*!
@@ -577,6 +616,8 @@ public:
     static const UINT32 BuildAsciiOrUtf16 = 0x1;
     static const UINT32 BuildEncodingFlagsMask = 0x1;
     static const UINT32 BuildLargeHNamesNode = 0x2;
+    static const UINT32 BuildPathIndex = 0x4;
+    static const UINT32 BuildDeferChildSort = 0x8;
 
     static HRESULT CreateInstance(_In_ UINT32 flags, _Outptr_ HierarchicalNamesBuilder** result);
     static HRESULT CreateInstance(_In_ UINT32 flags, _In_ AtomPoolGroup* pAtoms, _Outptr_ HierarchicalNamesBuilder** result);
@@ -753,6 +794,7 @@ private:
     int m_cchFinalizedAsciiNames;
     int m_cchFinalizedUtf16Names;
     int m_cchLongestFinalizedName;
+    UINT32 m_numPathIndexBuckets;
 
 protected:
     HierarchicalNamesBuilder(_In_ UINT32 flags);
@@ -795,6 +837,29 @@ protected:
 
     HRESULT AddItem(__in ItemInfo* pItem, __out int* pIndexOut);
 
+    bool IsChildSortDeferred() const { return ((m_flags & BuildDeferChildSort) != 0); }
+
+    UINT32 GetPathIndexSizeInBytes() const;
+
+    /*!
+         * Adds every descendent of a scope to the full path index.
+         * 
+         * \param pScope
+         * The scope whose descendents are added.
+         *
+         * \param scopePathHash
+         * The full path hash of pScope.
+         * 
+         * \return HRESULT
+         */
+    HRESULT BuildPathIndex(
+        _In_ const ScopeInfo* pScope,
+        _In_ UINT32 scopePathHash,
+        _Inout_updates_(numBuckets) DEFFILE_HNAMES_PATH_INDEX_ENTRY* pBuckets,
+        _In_ UINT32 numBuckets,
+        _Inout_updates_(numScopes) UINT32* pScopePathHashes,
+        _In_ UINT32 numScopes) const;
+
     template<typename T>
     HRESULT BuildNameNode(
         _In_ HNamesNode* pNode,
@@ -91,7 +91,9 @@ typedef enum
     PriBuildFromScratch = 0x00,
     PriBuildFromPrevSchema = 0x01,
     PriBuildFromPrevReadOnlySchema = 0x02,
-    PriBuildForDeploymentMerge = 0x04
+    PriBuildForDeploymentMerge = 0x04,
+    // Keeps the previous schema section as-is until a name is added to it.
+    PriBuildIncremental = 0x08
 } PriBuildType;
 
 typedef enum
@@ -232,6 +234,12 @@ public:
     void SetSectionIndex(_In_ BaseFile::SectionIndex sectionIndex) { m_sectionIndex = sectionIndex; }
     BaseFile::SectionIndex GetSectionIndex() const { return m_sectionIndex; }
 
+    // A schema copied from a previous file reads that file while building, so only a new schema qualifies.
+    bool CanBuildConcurrently() const { return (m_pPreviousSchema == nullptr); }
+
+    // True if the section will be copied unchanged from the previous schema.
+    bool IsUsingPreviousSchemaSection() const { return (m_pPreviousSchema != nullptr); }
+
 private:
     bool IsFinalized() const;
 
@@ -633,6 +641,8 @@ public:
 
     bool TryGetCandidateInfo(_In_ PCWSTR pItemName, _In_ int candidateIndex, _Inout_ BuilderCandidateResult* pBuilderCandidateResult) const;
 
+    bool HasCandidateForQualifierSet(_In_ PCWSTR pItemName, _In_ int qualifierSetIndex) const;
+
     bool IsValid() const;
 
     HRESULT Finalize();
@@ -651,6 +661,8 @@ public:
 
     BaseFile::SectionIndex GetSectionIndex() const { return m_sectionIndex; }
 
+    bool CanBuildConcurrently() const { return true; }
+
     static const int MaxInternalDataSize = 0xffff;
 
 protected:
@@ -935,6 +947,9 @@ public:
         _In_opt_ RemapUInt16* pQualifierMapRemapInfo,
         _Out_opt_ int* pIndexOut = nullptr);
 
+    // Like GetOrAddQualifierSet, but returns false instead of adding a qualifier set that isn't present.
+    bool TryGetQualifierSetIndex(_In_opt_ const IQualifierSet* pQualifierSet, _Out_ int* pIndexOut) const;
+
     int GetNumQualifierSets() const;
 
     HRESULT GetQualifierSet(_In_ int index, _Inout_ QualifierSetResult* pSetOut) const;
@@ -1139,7 +1154,7 @@ public:
 
     static HRESULT CreateInstance(
         _In_ DEF_CHECKSUM valueHash,
-        _In_reads_bytes_(valueSizeInBytes) const void* actualValue,
+        _In_reads_bytes_opt_(valueSizeInBytes) const void* actualValue,
         _In_ size_t valueSizeInBytes,
         _In_ DataItemsSectionBuilder* pBuilder,
         _In_ DataItemsSectionBuilder::PrebuildItemReference* pPreBuildItemReference,
@@ -1159,10 +1174,14 @@ public:
 
     DEF_CHECKSUM GetValueHash() const { return m_valueHash; }
 
+    // The actual value is only kept when the build has no in-memory data limit; otherwise these return
+    // nullptr and 0, and IsValueEqual reads the value back from the data items section builder.
     const void* GetActualValue() const;
 
     size_t GetActualValueSize() const;
 
+    bool IsValueEqual(_In_reads_bytes_(valueSizeInBytes) const void* value, _In_ size_t valueSizeInBytes) const;
+
     DataItemsSectionBuilder::PrebuildItemReference GetInnerReference() const { return m_innerReference; }
 
 private:
@@ -1171,7 +1190,7 @@ private:
         _In_ DataItemsSectionBuilder* pBuilder,
         _In_ DataItemsSectionBuilder::PrebuildItemReference* pPreBuildItemReference);
 
-    HRESULT Init(_In_reads_bytes_(valueSizeInBytes) const void* actualValue, _In_ size_t valueSizeInBytes);
+    HRESULT Init(_In_reads_bytes_opt_(valueSizeInBytes) const void* actualValue, _In_ size_t valueSizeInBytes);
 
     DataItemsSectionBuilder* m_disBuilder;
     DataItemsSectionBuilder::PrebuildItemReference m_innerReference;
@@ -1181,30 +1200,7 @@ private:
     DynamicArray<UINT>* m_metadata;
 };
 
-class OrchestratorHashNode : public DefObject
-{
-public:
-    static HRESULT CreateInstance(
-        _In_ DEF_CHECKSUM valueHash,
-        _In_ OrchestratorDataReference* dataReference,
-        _Outptr_ OrchestratorHashNode** result);
-
-    bool SetNext(_In_ OrchestratorHashNode* inputNode);
-
-    ~OrchestratorHashNode() {}
-
-    OrchestratorDataReference* GetDataReference() const { return m_dataReference; }
-    DEF_CHECKSUM GetHash() const { return m_valueHash; }
-    OrchestratorHashNode* GetNext() const { return m_nextOrchHashNode; }
-
-private:
-    OrchestratorHashNode(_In_ DEF_CHECKSUM valueHash, _In_ OrchestratorDataReference* dataReference);
-
-    OrchestratorHashNode* m_nextOrchHashNode;
-    DEF_CHECKSUM m_valueHash;
-    OrchestratorDataReference* m_dataReference;
-};
-
+// Maps value checksums to the data references that hold those values. The map does not own the data references.
 class OrchestratorHashMap : public DefObject
 {
 public:
@@ -1216,23 +1212,31 @@ public:
 
     HRESULT AddtoMap(_In_ DEF_CHECKSUM key, _In_ OrchestratorDataReference* value);
 
-    int HashCode(_In_ DEF_CHECKSUM key);
-
-    int HashCode(_In_ size_t newSize, _In_ DEF_CHECKSUM key);
-
     OrchestratorDataReference* TryGetFromMap(_In_ DEF_CHECKSUM key, _In_opt_ const void* value, _In_opt_ size_t valueSizeInBytes);
 
 private:
+    // Entries live inline in a single slot array and collisions are resolved by linear probing,
+    // so adding a value doesn't allocate and growing the map never touches the data references.
+    // A slot without a data reference is empty.
+    struct Slot
+    {
+        DEF_CHECKSUM hash;
+        OrchestratorDataReference* dataReference;
+    };
+
     HRESULT ResizeMap();
 
-    OrchestratorHashMap(_In_ int initCapacity, _In_ float loadFactor);
+    int GetFirstSlot(_In_ DEF_CHECKSUM key, _In_ int numSlots) const;
+
+    OrchestratorHashMap(_In_ float loadFactor);
 
     HRESULT Init(int initCapacity);
 
     int m_nodeCount;
-    int m_currentSize;
+    int m_numSlots;
+    int m_maxNodeCount;
     float m_loadFactor;
-    DynamicArray<OrchestratorHashNode*>* m_entries;
+    Slot* m_pSlots;
 };
 
 class DataItemOrchestrator : public DefObject
@@ -1251,6 +1255,10 @@ public:
 
     void DisableDeduplication();
 
+    // Bytes of large item data that the data item sections hold in memory. With a memory limit set, sections
+    // are spilled before each new item to keep this within the limit plus the size of one item.
+    UINT64 GetDataSizeInMemory() const { return m_spillFile->GetDataSizeInMemory(); }
+
     HRESULT GetValueSize(_In_ PCWSTR value, _Out_ size_t* size);
 
     virtual HRESULT AddDataAndCreateInstanceReference(
@@ -1302,6 +1310,10 @@ public:
 protected:
     HRESULT GetOrAddDataItemSectionBuilder(_In_ int qualifierSetIndex, _Out_ DataItemsSectionBuilder** result);
 
+    HRESULT EnforceDataMemoryLimit();
+
+    bool HasDataMemoryLimit() const { return (m_buildConfiguration->GetMaxInMemoryDataSize() != 0); }
+
     DataItemOrchestrator(_In_ FileBuilder* fileBuilder, _In_ CoreProfile* profile, _In_ DecisionInfoSectionBuilder* decisionInfo);
 
     HRESULT Init();
@@ -1314,6 +1326,7 @@ protected:
     DynamicArray<DataItemsSectionBuilder*>* m_buildersByQualifierSet;
     MrmBuildConfiguration* m_buildConfiguration; // do not delete this here
     OrchestratorHashMap* m_OrchestratorHashMap;
+    DataItemSpillFile* m_spillFile;
 };
 
 class PriSectionBuilder : public ISectionBuilder, public IResourceLinkBuilder
@@ -1777,6 +1790,14 @@ private:
 
 DEFINE_ENUM_FLAG_OPERATORS(PriFileMerger::PriMergeFlags);
 
+class IPriMergeCandidateFilter
+{
+public:
+    // resourceIndex is the index of the resource in the map being merged and qualifierSetIndex
+    // is the index of the candidate's qualifier set in the merged decision info.
+    virtual bool ShouldMergeCandidate(_In_ int resourceIndex, _In_ int qualifierSetIndex) const = 0;
+};
+
 class PriMapMerger : public DefObject
 {
 public:
@@ -1785,7 +1806,8 @@ public:
         _In_ bool bIsPrimary,
         _In_ PriFileMerger::PriMergeFlags mergeFlags,
         _In_opt_ PCWSTR pPackageRootFolder,
-        _Inout_ PriSectionBuilder* pMergedPriSectionBuilder);
+        _Inout_ PriSectionBuilder* pMergedPriSectionBuilder,
+        _In_opt_ const IPriMergeCandidateFilter* pFilter = nullptr);
 
     static HRESULT CheckIsCompatible(
         _In_ const IHierarchicalSchema* pHSchema,
@@ -1793,6 +1815,82 @@ public:
         _In_ PriFileMerger::PriMergeFlags mergeFlags);
 };
 
+/*!
+ * Rebuilds a PRI file from a previous build of it plus a set of changed candidates.
+ *
+ * Added and modified candidates are added directly; a candidate with the same resource
+ * name and qualifiers as a previous candidate replaces it.  The remaining candidates are
+ * copied from the previous file's primary resource map when the file is generated, so
+ * the sources for unchanged resources don't have to be processed again.  As long as no
+ * new resource names are added, the previous schema section is copied unchanged.
+ */
+class PriIncrementalBuilder : public DefObject, public IPriMergeCandidateFilter
+{
+public:
+    static HRESULT CreateInstance(_In_ PCWSTR pPreviousPriFile, _In_ CoreProfile* pProfile, _Outptr_ PriIncrementalBuilder** result);
+
+    virtual ~PriIncrementalBuilder();
+
+    HRESULT AddOrUpdateCandidate(
+        _In_ PCWSTR pResourceName,
+        _In_ MrmEnvironment::ResourceValueType valueType,
+        _In_ PCWSTR pValue,
+        _In_opt_ IQualifierSet* pQualifiers);
+
+    HRESULT AddOrUpdateCandidate(
+        _In_ PCWSTR pResourceName,
+        _In_ MrmEnvironment::ResourceValueType valueType,
+        _In_reads_bytes_(cbValue) const BYTE* pValue,
+        _In_ UINT cbValue,
+        _In_opt_ IQualifierSet* pQualifiers);
+
+    // Removes the previous candidate with the given qualifiers (the unconditional candidate if pQualifiers is null).
+    HRESULT RemoveCandidate(_In_ PCWSTR pResourceName, _In_opt_ IQualifierSet* pQualifiers);
+
+    // Removes every previous candidate for the resource.  The name stays in the schema.
+    HRESULT RemoveResource(_In_ PCWSTR pResourceName);
+
+    HRESULT GenerateFileContents(__deref_out void** ppBufferRtrn, __out_opt UINT32* pBufferLen);
+
+    HRESULT WriteToFile(_In_ PCWSTR pFilePath);
+
+    PriFileBuilder* GetPriFileBuilder() const { return m_pPriFileBuilder; }
+
+    bool IsUsingPreviousSchemaSection() const;
+
+    //! Implements IPriMergeCandidateFilter::ShouldMergeCandidate
+    bool ShouldMergeCandidate(_In_ int resourceIndex, _In_ int qualifierSetIndex) const;
+
+protected:
+    PriIncrementalBuilder();
+
+    HRESULT Init(_In_ PCWSTR pPreviousPriFile, _In_ CoreProfile* pProfile);
+
+    HRESULT MergePreviousCandidates();
+
+    HRESULT AddRemoval(_In_ PCWSTR pResourceName, _In_ int qualifierSetIndex);
+
+    // Keeps the previous candidate that a changed candidate replaces from being copied.
+    HRESULT SkipReplacedCandidate(_In_ PCWSTR pResourceName, _In_opt_ IQualifierSet* pQualifiers);
+
+private:
+    // Qualifier set index for a removal that can't match any previous candidate.
+    static const int NoQualifierSetIndex = -2;
+
+    // Previous candidates that are not copied, because they were removed or replaced.
+    struct RemovedCandidate
+    {
+        int resourceIndex;
+        int qualifierSetIndex; // -1 for every candidate of the resource
+    };
+
+    StandalonePriFile* m_pPreviousPri;
+    const IResourceMapBase* m_pPreviousMap;
+    PriFileBuilder* m_pPriFileBuilder;
+    DynamicArray<RemovedCandidate>* m_pRemovedCandidates;
+    bool m_bMergedPreviousCandidates;
+};
+
 #define DefBuilder_PhaseMismatch(GOT, WANT, STATUS) Def_Check0(((GOT) != (WANT)), E_DEFFILE_BUILD_BAD_PHASE, STATUS)
 #define DefBuilder_PhaseIsBefore(GOT, WANT, STATUS) Def_Check0(((GOT) < (WANT)), E_DEFFILE_BUILD_BAD_PHASE, STATUS)
 #define DefBuilder_PhaseIsAfter(GOT, WANT, STATUS) Def_Check0(((GOT) > (WANT)), E_DEFFILE_BUILD_BAD_PHASE, STATUS)
@@ -39,17 +39,35 @@ public:
 
     HRESULT AddPriFile(_In_ PCWSTR pszPriFileName, _In_ PriFileMerger::PriMergeFlags priMergeFlags);
 
+    // Opens, validates and checksums the files on up to maxThreads threads, then merges them one at a time in
+    // the order given, so the result is the same as calling AddPriFile for each file in turn.  Each file is
+    // opened only once.  Stops at the first file that fails, in that order.  pContentChecksums, if supplied,
+    // receives each file's checksum.
+    HRESULT AddPriFiles(
+        _In_reads_(numFiles) const PCWSTR* ppszPriFileNames,
+        _In_ UINT32 numFiles,
+        _In_ PriFileMerger::PriMergeFlags priMergeFlags,
+        _In_ UINT32 maxThreads,
+        _Out_writes_opt_(numFiles) DEF_CHECKSUM* pContentChecksums);
+
     bool IsFinalized() const;
 
     HRESULT WriteToFile(_In_ PCWSTR pszOutputFile);
 
-    static HRESULT GetPriFileChecksums(_In_ PCWSTR pPriFileName, _In_ CoreProfile* pProfile, _Out_ DEF_CHECKSUM* pContentChecksum);
+    static HRESULT GetPriFileChecksums(_In_ PCWSTR pPriFileName, _In_opt_ CoreProfile* pProfile, _Out_ DEF_CHECKSUM* pContentChecksum);
 
 private:
     ResourcePackMerge(_In_ CoreProfile* pProfile);
 
     HRESULT Init();
 
+    // Merges *ppPreloadedFile, if supplied, instead of opening the file again.  Sets it to nullptr once the
+    // file manager owns it.
+    HRESULT AddPriFile(
+        _In_ PCWSTR pszPriFileName,
+        _In_ PriFileMerger::PriMergeFlags priMergeFlags,
+        _Inout_opt_ MrmFile** ppPreloadedFile);
+
     HRESULT AddFileToFileList(_In_ PCWSTR pszFilePath, _In_ PriFileMerger::PriMergeFlags priMergeFlags, _Out_ FileInfo** ppFileInfo);
 
     HRESULT AddRootFolder(_In_ PWSTR pszLocalFilePath, _Out_ PWSTR* ppszFilePathNext, _Out_ FolderInfo** ppFolderInfo);
@@ -152,6 +152,48 @@ public:
     /*!@}*/
 };
 
+/*!
+ * A temporary file that the DataItemsSectionBuilders of one file spill large item
+ * data to, so that spilling opens one file no matter how many sections there are.
+ * Also keeps a running total of the large item data that those builders still
+ * hold in memory.
+ */
+class DataItemSpillFile : public DefObject
+{
+public:
+    static HRESULT CreateInstance(_Outptr_ DataItemSpillFile** result);
+
+    virtual ~DataItemSpillFile();
+
+    /*!
+     * Returns the number of bytes of large item data held in memory by the
+     * builders that use this file.
+     */
+    UINT64 GetDataSizeInMemory() const { return m_cbDataInMemory; }
+
+    void NoteDataInMemory(_In_ UINT32 cbData) { m_cbDataInMemory += cbData; }
+
+    /*!
+     * Appends data that a builder held in memory to the end of the file and
+     * returns the offset it was written at.  The file is created the first
+     * time that anything is spilled.
+     */
+    HRESULT Append(_In_reads_bytes_(cbData) const BYTE* pData, _In_ UINT32 cbData, _Out_ UINT64* pFileOffsetOut);
+
+    /*!
+     * Reads spilled data back.  Sections are built concurrently, so this can be
+     * called from several threads at once as long as nothing is being appended.
+     */
+    HRESULT Read(_In_ UINT64 fileOffset, _In_ UINT32 cbData, _Out_writes_bytes_(cbData) BYTE* pDataOut) const;
+
+private:
+    DataItemSpillFile();
+
+    HANDLE m_hFile;
+    UINT64 m_cbFile;
+    UINT64 m_cbDataInMemory;
+};
+
 class DataItemsSectionBuilder : public ISectionBuilder
 {
 private:
@@ -180,17 +222,36 @@ private:
     __ecount(m_sizeLargeItems) struct ItemRef* m_pLargeItems;
     __bcount(m_cbLargeItemDataCapacity) BYTE* m_pLargeItemData;
 
+    // Large item data before m_cbLargeItemDataSpilled lives in m_pSpillFile. m_pLargeItemData
+    // holds only the bytes after it. Each spill is one range of the shared file, and the ranges
+    // are sorted by offset, so range i holds the data from its offset up to the next range.
+    struct SpilledRange
+    {
+        int offset;
+        UINT64 fileOffset;
+    };
+
+    int m_cbLargeItemDataSpilled;
+    DataItemSpillFile* m_pSpillFile;
+    int m_numSpilledRanges;
+    int m_sizeSpilledRanges;
+    __ecount(m_sizeSpilledRanges) struct SpilledRange* m_pSpilledRanges;
+
     static const unsigned int InitialSmallItemSize = 32;
     static const unsigned int InitialSmallItemDataCapacity = 1024;
 
     static const unsigned int InitialLargeItemSize = 32;
     static const unsigned int InitialLargeItemDataCapacity = 1024;
 
+    static const unsigned int InitialSpilledRangeSize = 4;
+
     DataItemsSectionBuilder();
 
     HRESULT EnsureLargeItemCapacity(__in int cbTotal);
     HRESULT EnsureSmallItemCapacity(__in int cbTotal);
 
+    HRESULT ReadSpilledLargeItemData(__in int offset, __in int cbData, __out_bcount(cbData) BYTE* pDataOut) const;
+
 public:
     /*!
         * \name Constructors & Destructors
@@ -270,6 +331,25 @@ public:
 
     HRESULT GetDataBlob(_In_ int itemIndex, _Inout_ BlobResult* pBlobResult) const;
 
+    /*!
+         * Returns the number of bytes of large item data currently held in memory.
+         */
+    int GetLargeItemDataSizeInMemory() const { return m_cbLargeItemDataUsed - m_cbLargeItemDataSpilled; }
+
+    /*!
+         * Sets the file that SpillLargeItemData moves data to, which also counts
+         * the large item data this builder holds in memory.  Must be set before
+         * any data is added, and must outlive the builder.
+         */
+    HRESULT SetSpillFile(_In_ DataItemSpillFile* pSpillFile);
+
+    /*!
+         * Moves the large item data held in memory to the end of the spill file.
+         * Build copies it back into the section, so the built section is the same
+         * whether or not data was spilled.
+         */
+    HRESULT SpillLargeItemData();
+
     /*!
          * \name ISectionBuilder Implementation
          * @{
@@ -291,6 +371,8 @@ public:
 
     void SetSectionIndex(BaseFile::SectionIndex sectionIndex) { m_sectionIndex = sectionIndex; }
     BaseFile::SectionIndex GetSectionIndex() const { return m_sectionIndex; }
+
+    bool CanBuildConcurrently() const { return true; }
 };
 
 } // namespace Microsoft::Resources::Build
\ No newline at end of file
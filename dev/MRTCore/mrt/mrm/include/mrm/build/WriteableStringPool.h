@@ -274,6 +274,23 @@ public:
         return offset;
     }
 
+    /*! 
+         * Makes sure the string pool can accept a specified number of additional
+         * characters without growing.  Lets callers that add many strings at once
+         * grow the buffer a single time.
+         * 
+         * \param cchAdditional
+         * The number of characters, including terminators, that will be added.
+         * 
+         * \return HRESULT
+         * Returns S_OK on success, failure if an error occurs.
+         */
+    HRESULT EnsureCapacity(_In_ UINT32 cchAdditional)
+    {
+        RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_ARITHMETIC_OVERFLOW), cchAdditional > (UINT32_MAX - m_numChars));
+        return ExtendToFit(m_numChars + cchAdditional);
+    }
+
     /*! 
          * Reports whether the string pool uses case-insensitive comparison.
          * 
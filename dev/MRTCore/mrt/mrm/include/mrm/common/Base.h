@@ -117,7 +117,8 @@ extern "C"
     typedef enum
     {
         DEF_HASH_DEFAULT = 0, //!< Use the default hash function
-        DEF_HASH_CASE_INSENSITIVE = 1 //!< Use a case-insensitive hash function
+        DEF_HASH_CASE_INSENSITIVE = 1, //!< Use a case-insensitive hash function
+        DEF_HASH_VERSION_2 = 0x10 //!< Use the version 2 hash function; combines with DEF_HASH_CASE_INSENSITIVE; never stored in files
     } DEF_ATOM_HASH_METHOD;
 
     /*! \enum DEF_ATOM_COMPARISON
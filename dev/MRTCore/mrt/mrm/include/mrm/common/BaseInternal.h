@@ -108,7 +108,7 @@ extern "C"
     DEFSTRING_ENCODING DefString_ChooseBestEncoding(_In_ PCWSTR utf16String);
 
     // Convert to UTF-16 from ASCII and UTF-8.
-    // We don't need the other direction here, because the tools that write these strings can call existing system helpers.
+    // We don't need UTF-16 to UTF-8 here, because the tools that write these strings can call existing system helpers.
     // These functions operate on string sizes that include the nul terminator since that is what our pipeline deals with.
     HRESULT DefString_ConvertAsciiToUtf16(
         _In_reads_z_(stringSizeInAsciiCharsIncludingNull) PCSTR asciiString,
@@ -121,6 +121,12 @@ extern "C"
         _Out_ size_t* resultStringSizeInUtf16CharsIncludingNull,
         _Outptr_ PWSTR* result);
 
+    // Narrows a UTF-16 string to ASCII into a caller-supplied buffer. Fails with E_INVALIDARG if any character isn't ASCII.
+    HRESULT DefString_ConvertUtf16ToAscii(
+        _In_reads_(stringSizeInChars) PCWSTR utf16String,
+        _In_ size_t stringSizeInChars,
+        _Out_writes_(stringSizeInChars) PSTR asciiString);
+
 #define DefString_Compare(S1, S2) DefString_CompareWithOptions((S1), (S2), DefCompare_Default)
 #define DefString_ICompare(S1, S2) DefString_CompareWithOptions((S1), (S2), DefCompare_CaseInsensitive)
 #define DefString_CchCompare(S1, S2, N) DefString_CchCompareWithOptions((S1), (S2), DefCompare_Default)
@@ -62,6 +62,18 @@ extern "C"
 
     BOOLEAN _DefUnmapViewOfFile(__in PVOID pBaseAddress);
 
+    // Advisory only. Both return S_FALSE on platforms that ignore the hint.
+    HRESULT _DefPrefetchVirtualMemory(__in_bcount(cbSize) const VOID* pAddress, __in size_t cbSize);
+
+    HRESULT _DefTrimVirtualMemory(__in_bcount(cbSize) const VOID* pAddress, __in size_t cbSize);
+
+    typedef void (*PDEF_PARALLEL_CALLBACK)(__inout_opt PVOID pContext, __in ULONG index);
+
+    // Calls pCallback once for each index below count, on the calling thread and up to maxThreads - 1 thread
+    // pool threads, and returns when every call has finished. Calls run in no particular order, so each one
+    // should only touch the state for its own index. Platforms without a thread pool make every call here.
+    HRESULT _DefRunParallelForEach(__in ULONG count, __in ULONG maxThreads, __in PDEF_PARALLEL_CALLBACK pCallback, __inout_opt PVOID pContext);
+
     UINT32 _DefComputeCrc32(__in UINT32 partialCrc, __in_bcount(cbBuf) const BYTE* pBuf, __in UINT32 cbBuf);
 
     UINT32
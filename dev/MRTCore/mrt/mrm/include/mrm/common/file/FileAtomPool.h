@@ -61,7 +61,8 @@ extern "C"
         DEFFILE_ATOMPOOL_HASH_CASE_INSENSITIVE = 0x0001, //!< Uses case-insensitive hash method
         DEFFILE_ATOMPOOL_HASH_NONE = 0x0002, //!< No hash table present
         DEFFILE_ATOMPOOL_HASH_UNSORTED = 0x0004, //!< Hash table is unsorted
-        DEFFILE_ATOMPOOL_HASH_SMALL = 0x0008 //!< Hash table uses small atom index for hash table
+        DEFFILE_ATOMPOOL_HASH_SMALL = 0x0008, //!< Hash table uses small atom index for hash table
+        DEFFILE_ATOMPOOL_HASH_INDEX = 0x0020 //!< An open-addressing hash index follows the string pool
     } DefFileAtomPoolHashFlags;
 
 #define DEFFILE_ATOMPOOL_DESC_LENGTH 32
@@ -99,6 +100,33 @@ extern "C"
         DEF_ATOM_INDEX_SMALL index; //!< Index of the corresponding string in the hash table
     } DEFFILE_ATOMPOOL_HASHINDEX_SMALL, *PDEFFILE_ATOMPOOL_HASHINDEX_SMALL;
 
+    /*!
+     * Header for the optional hash index of an atom pool, present if DEFFILE_ATOMPOOL_HASH_INDEX
+     * is set.  The index follows the string pool, padded to the default alignment, and consists of
+     * this header followed by numBuckets DEFFILE_ATOMPOOL_HASHINDEX buckets.
+     *
+     * The buckets are filled using Robin Hood linear probing, starting at the bucket given by
+     * DefFileAtomPool_GetHashIndexHomeBucket.  Unused buckets have an index of
+     * DEFFILE_ATOMPOOL_HASH_INDEX_EMPTY.  numBuckets is a power of two greater than nAtoms.
+     */
+    typedef struct _DEFFILE_ATOMPOOL_HASH_INDEX_HEADER
+    {
+        UINT32 numBuckets; //!< Number of buckets in the index
+        UINT32 reserved; //!< reserved. must be 0
+    } DEFFILE_ATOMPOOL_HASH_INDEX_HEADER, *PDEFFILE_ATOMPOOL_HASH_INDEX_HEADER;
+
+#define DEFFILE_ATOMPOOL_HASH_INDEX_EMPTY (-1)
+
+    /*!
+     * Returns the preferred bucket for an atom hash.  Atom hashes (especially legacy ones) don't
+     * vary much in their low bits, so they are scrambled first.
+     */
+    inline UINT32 DefFileAtomPool_GetHashIndexHomeBucket(DEF_ATOM_HASH hash, UINT32 numBuckets)
+    {
+        UINT32 scrambled = hash * 0x9E3779B1;
+        return (scrambled ^ (scrambled >> 15)) & (numBuckets - 1);
+    }
+
     /*!
       * Describes the mapping from a range of one or more pools in another file to
       * a different range in this file.
@@ -138,6 +138,59 @@ extern "C"
         return largeScope;
     }
 
+    /*!
+     * Header for the optional full path index of a hierarchical names section.
+     * - numBuckets is the size of the hash table.  Always a power of two.
+     * - numScopeHashes is the number of entries in the scope path hash table
+     *   and always matches the number of scopes in the section.
+     */
+    typedef struct _DEFFILE_HNAMES_PATH_INDEX_HEADER
+    {
+        UINT32 numBuckets;
+        UINT32 numScopeHashes;
+    } DEFFILE_HNAMES_PATH_INDEX_HEADER, *PDEFFILE_HNAMES_PATH_INDEX_HEADER;
+
+    /*!
+     * A single bucket in the full path index.
+     * - pathHash is the HNamesHashPath value of the full path of the node
+     * - nodeIndex is the index of the node in the global nodes table.  The root
+     *   node is never indexed, so 0 marks an empty bucket.
+     */
+    typedef struct _DEFFILE_HNAMES_PATH_INDEX_ENTRY
+    {
+        UINT32 pathHash;
+        UINT32 nodeIndex;
+    } DEFFILE_HNAMES_PATH_INDEX_ENTRY, *PDEFFILE_HNAMES_PATH_INDEX_ENTRY;
+
+    __declspec(selectany) extern const UINT32 DEFFILE_HNAMES_PATH_HASH_SEED = 0x811c9dc5;
+
+    /*!
+     * Adds one character to a full path hash (32-bit FNV-1a).  Names compare
+     * case-insensitively, so ASCII letters are folded to upper case and both
+     * path separators hash the same.  The comparison also matches a few
+     * non-ASCII characters (dotless i, long s) to ASCII letters, so every
+     * non-ASCII character and the letters I and S hash to the same value and
+     * the hash never depends on how a particular character is case-folded;
+     * the stored name is always compared before a hash match is accepted.
+     */
+    inline UINT32 HNamesHashPathChar(_In_ UINT32 hash, _In_ WCHAR ch)
+    {
+        if ((ch >= L'a') && (ch <= L'z'))
+        {
+            ch -= (L'a' - L'A');
+        }
+        else if (ch == L'\\')
+        {
+            ch = L'/';
+        }
+
+        if ((ch >= 0x80) || (ch == L'I') || (ch == L'S'))
+        {
+            ch = 0x80;
+        }
+        return (hash ^ ch) * 0x01000193;
+    }
+
     /*!
      * Header for a Hierarchical names section.
      * If HNAMES_FLAGS_LARGE is _not_ set in hdr.flags, layout
@@ -155,6 +208,14 @@ extern "C"
      *      HNAMES_SCOPE_LARGE          scopes[hdr.numScopes]
      *      UINT32                      items[hdr.numItems]
      *      WCHAR                       names[hdr.cchNames];
+     *
+     * If HNAMES_FLAGS_PATH_INDEX is set in hdr.flags, the names are
+     * followed by an index over the full path of every node, aligned
+     * to the default section alignment:
+     *      HNAMES_PATH_INDEX_HEADER    indexHdr
+     *      HNAMES_PATH_INDEX_ENTRY     buckets[indexHdr.numBuckets]
+     *      UINT32                      scopePathHashes[indexHdr.numScopeHashes]
+     * Readers that don't know about the index ignore it.
      */
     typedef struct _DEFFILE_HNAMES_HEADER
     {
@@ -180,6 +241,7 @@ extern "C"
     } DEFFILE_HNAMES_HEADER_EX, *PDEFFILE_HNAMES_HEADER_EX;
 
     __declspec(selectany) extern const UINT32 DEFFILE_HNAMES_FLAGS_LARGE = 0x0001;
+    __declspec(selectany) extern const UINT32 DEFFILE_HNAMES_FLAGS_PATH_INDEX = 0x0002;
     __declspec(selectany) extern const UINT32 DEFFILE_MAX_STANDARD_SIZE = 0xffff;
 
     __declspec(selectany) extern const DEFFILE_SECTION_TYPEID gHierarchicalNamesSectionType = {
@@ -15,6 +15,8 @@ public:
 
     HRESULT Evaluate(_In_ const IQualifier* pQualifier, _In_ PCWSTR pValue, _Out_ double* score) const;
 
+    HRESULT EvaluateParsed(_In_ const IQualifier* pQualifier, _In_ const ParsedQualifierValue* pValue, _Out_ double* score) const;
+
 protected:
     ContrastQualifierType() :
         EnumerationQualifierType(CoreEnvironment::Qualifier_Contrast_AllowedValues, CoreEnvironment::Qualifier_Contrast_NumAllowedValues)
@@ -43,6 +45,8 @@ public:
 
     virtual HRESULT Evaluate(_In_ const IQualifier* pQualifier, _In_ PCWSTR pValue, _Out_ double* score) const;
 
+    virtual HRESULT EvaluateParsed(_In_ const IQualifier* pQualifier, _In_ const ParsedQualifierValue* pValue, _Out_ double* score) const;
+
     static double CalculateScaleFactorScore(_In_ int assetValue, _In_ int contextValue);
 
 protected:
@@ -62,6 +66,8 @@ public:
 
     HRESULT Evaluate(_In_ const IQualifier* pQualifier, _In_ PCWSTR pValue, _Outptr_ double* score) const;
 
+    HRESULT EvaluateParsed(_In_ const IQualifier* pQualifier, _In_ const ParsedQualifierValue* pValue, _Out_ double* score) const;
+
     inline IBuildQualifierType::PackagingFlags GetDefaultPackagingFlags() const
     {
         return IBuildQualifierType::PackagingAllowResourcePackage | IBuildQualifierType::PackagingReportQualifier;
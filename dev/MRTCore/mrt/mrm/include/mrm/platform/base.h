@@ -674,12 +674,91 @@ public:
     bool UseGranularResourceSplitting() const { return ((m_flags & UseGranularResourceSplittingFlag) != 0); }
     bool SplitLanguageVariants() const { return ((m_flags & SplitLanguageVariantsFlag) != 0); }
 
+    // Upper bound, in bytes, on the large data item payloads kept in memory while building. Payloads beyond
+    // it are spilled to a temporary file and copied back when the file is generated. 0 means no limit.
+    UINT32 GetMaxInMemoryDataSize() const { return m_cbMaxInMemoryData; }
+    void SetMaxInMemoryDataSize(UINT32 cbMaxInMemoryData) { m_cbMaxInMemoryData = cbMaxInMemoryData; }
+
+    // Maximum number of threads used to build independent sections (schemas, resource maps and data items)
+    // when the file is generated. 0 or 1 builds every section on the calling thread.
+    UINT32 GetMaxBuildThreads() const { return m_maxBuildThreads; }
+    void SetMaxBuildThreads(UINT32 maxBuildThreads) { m_maxBuildThreads = maxBuildThreads; }
+
 protected:
-    MrmBuildConfiguration(_In_ DEFFILE_MAGIC fileMagicNumber, _In_ UINT32 flags) : m_magic(fileMagicNumber), m_flags(flags) {}
+    MrmBuildConfiguration(_In_ DEFFILE_MAGIC fileMagicNumber, _In_ UINT32 flags) :
+        m_magic(fileMagicNumber), m_flags(flags), m_cbMaxInMemoryData(0), m_maxBuildThreads(0)
+    {}
 
 private:
     DEFFILE_MAGIC m_magic;
     UINT32 m_flags;
+    UINT32 m_cbMaxInMemoryData;
+    UINT32 m_maxBuildThreads;
+};
+
+// A qualifier value from a provider, parsed once by the qualifier type so that it can be scored
+// against any number of asset qualifiers without re-parsing or re-validating it.  Immutable once
+// it has been handed to IQualifierType::EvaluateParsed.
+class ParsedQualifierValue : public DefObject
+{
+public:
+    typedef enum _ValueKind
+    {
+        StringValue = 0, // Scored from the original string
+        EmptyValue = 1, // Valid but matches nothing
+        IntegerValue = 2,
+        OrdinalValue = 3, // Index into the allowed values of an enumeration
+        ListValue = 4, // Split into individual list values
+        InvalidValue = 5 // Rejected by the qualifier type; evaluation fails with GetError()
+    } ValueKind;
+
+    static HRESULT CreateInstance(_In_opt_ PCWSTR pValue, _Outptr_ ParsedQualifierValue** result);
+
+    virtual ~ParsedQualifierValue();
+
+    ValueKind GetKind() const { return m_kind; }
+    PCWSTR GetValue() const { return m_value.GetRef(); }
+    int GetIntegerValue() const { return m_integerValue; }
+    HRESULT GetError() const { return m_hrError; }
+    int GetNumListValues() const { return m_numListValues; }
+    PCWSTR GetListValue(_In_ int index) const { return (((index >= 0) && (index < m_numListValues)) ? m_ppListValues[index] : nullptr); }
+
+    void SetEmpty() { m_kind = EmptyValue; }
+    void SetInteger(_In_ int value)
+    {
+        m_kind = IntegerValue;
+        m_integerValue = value;
+    }
+    void SetOrdinal(_In_ int ordinal)
+    {
+        m_kind = OrdinalValue;
+        m_integerValue = ordinal;
+    }
+    void SetInvalid(_In_ HRESULT hr)
+    {
+        m_kind = InvalidValue;
+        m_hrError = hr;
+    }
+
+    // Splits the value on ';' the same way list values are processed everywhere else.  Values
+    // that can't be split that way are left as StringValue.
+    HRESULT SetList();
+
+    // The resolver generation the value was read for.
+    UINT64 GetGeneration() const { return m_generation; }
+    void SetGeneration(_In_ UINT64 generation) { m_generation = generation; }
+
+protected:
+    ParsedQualifierValue();
+
+    ValueKind m_kind;
+    int m_integerValue;
+    HRESULT m_hrError;
+    StringResult m_value;
+    PWSTR m_pListBuffer;
+    PCWSTR* m_ppListValues;
+    int m_numListValues;
+    UINT64 m_generation;
 };
 
 class IQualifierType : public DefObject
@@ -700,6 +779,13 @@ public:
 
     virtual HRESULT Evaluate(_In_ const IQualifier* pQualifier, _In_ PCWSTR pAttributeValue, _Out_ double* score) const = 0;
 
+    // ParseProviderValue does all of the parsing and validation of a provider value up front.
+    // EvaluateParsed must then give the same score as Evaluate would for the original string.
+    virtual HRESULT ParseProviderValue(_In_opt_ PCWSTR pAttributeValue, _Outptr_ ParsedQualifierValue** result) const = 0;
+
+    virtual HRESULT EvaluateParsed(_In_ const IQualifier* pQualifier, _In_ const ParsedQualifierValue* pAttributeValue, _Out_ double* score)
+        const = 0;
+
     virtual HRESULT Compare(_In_ const IQualifier* pQualifier1, _In_ const IQualifier* pQualifier2, _Out_ DEFCOMPARISON* result) const = 0;
 
     virtual HRESULT CompareForValue(
@@ -786,6 +872,11 @@ public:
 
     virtual HRESULT Evaluate(_In_ const IQualifier* pQualifier, _In_ PCWSTR pValue, _Out_ double* score) const;
 
+    // The default keeps the string and scores list values from their pre-split form.
+    virtual HRESULT ParseProviderValue(_In_opt_ PCWSTR pValue, _Outptr_ ParsedQualifierValue** result) const;
+
+    virtual HRESULT EvaluateParsed(_In_ const IQualifier* pQualifier, _In_ const ParsedQualifierValue* pValue, _Out_ double* score) const;
+
     virtual HRESULT Compare(_In_ const IQualifier* pQualifier1, _In_ const IQualifier* pQualifier2, _Out_ DEFCOMPARISON* result) const;
 
     virtual HRESULT CompareForValue(
@@ -881,6 +972,11 @@ public:
 
     virtual HRESULT Evaluate(_In_ const IQualifier* pQualifier, _In_ PCWSTR pszProviderValue, _Out_ double* score) const;
 
+    virtual HRESULT ParseProviderValue(_In_opt_ PCWSTR pszProviderValue, _Outptr_ ParsedQualifierValue** result) const;
+
+    virtual HRESULT EvaluateParsed(_In_ const IQualifier* pQualifier, _In_ const ParsedQualifierValue* pProviderValue, _Out_ double* score)
+        const;
+
 protected:
     EnumerationQualifierType(_In_reads_(numAllowedValues) const PCWSTR* pAllowedValues, _In_ size_t numAllowedValues) :
         QualifierTypeBase(ListValuesNotAllowed | EmptyValuesNotAllowed),
@@ -890,6 +986,13 @@ protected:
 
     HRESULT ValidateSingleQualifierValue(_In_ PCWSTR pValue) const;
 
+    // Returns the index of a value in the allowed values, or -1 if it isn't one of them.
+    int GetOrdinal(_In_opt_ PCWSTR pValue) const;
+
+    // Gets the ordinal of the value on an asset qualifier, checking the qualifier the way
+    // ValidateQualifier does.
+    HRESULT GetQualifierOrdinal(_In_ const IQualifier* pQualifier, _Out_ int* pOrdinalOut) const;
+
     _Field_size_(m_numAllowedValues) const PCWSTR* m_pAllowedValues;
     size_t m_numAllowedValues;
 };
@@ -907,6 +1010,14 @@ public:
 
     virtual HRESULT Evaluate(_In_ const IQualifier* pQualifier, _In_ PCWSTR pszProviderValue, _Out_ double* score) const;
 
+    virtual HRESULT ParseProviderValue(_In_opt_ PCWSTR pszProviderValue, _Outptr_ ParsedQualifierValue** result) const;
+
+    virtual HRESULT EvaluateParsed(_In_ const IQualifier* pQualifier, _In_ const ParsedQualifierValue* pProviderValue, _Out_ double* score)
+        const;
+
+    // Scores an asset value against a provider value.
+    static double CalculateIntegerScore(_In_ int assetValue, _In_ int providerValue);
+
     HRESULT
     CompareForValue(_In_ const IQualifier* pQualifier1, _In_ const IQualifier* pQualifier2, _In_ PCWSTR pValue, _Out_ DEFCOMPARISON* result)
         const;
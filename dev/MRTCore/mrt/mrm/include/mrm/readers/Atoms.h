@@ -18,6 +18,12 @@ public:
 
     static const int DescriptionLength = DEFFILE_ATOMPOOL_DESC_LENGTH;
 
+    // Pools without a hash index in the file get one in memory on first lookup, unless they are this small.
+    static const Atom::AtomCount MinAtomsForLazyHashIndex = 16;
+
+    // Largest pool that can have a hash index.
+    static const Atom::AtomCount MaxAtomsForHashIndex = 0x3FFFFFFF;
+
 protected:
     UINT32 m_flags;
     Atom::PoolIndex m_poolIndex;
@@ -31,6 +37,10 @@ protected:
     const WCHAR* m_pPool;
     const WCHAR* m_pPoolGroup;
 
+    const HashIndex* m_pHashIndex;
+    UINT32 m_numHashIndexBuckets;
+    mutable HashIndex* volatile m_pLazyHashIndex;
+
     static const DEFFILE_SECTION_TYPEID gAtomPoolSectionType;
 
     FileAtomPool();
@@ -145,10 +155,49 @@ public:
 
     static HRESULT ValidateHeader(__in_bcount(cbData) const void* pData, __in UINT32 cbData, __out_opt UINT32* pcbTotalRtrn);
 
+    /*!
+         * Reports the number of buckets in the hash index for a pool with the specified
+         * number of atoms, or 0 if the pool is too large to have a hash index.
+         */
+    static UINT32 GetHashIndexNumBuckets(__in Atom::AtomCount nAtoms);
+
+    /*!
+         * Reports the size of the hash index (including its header) for a pool with the
+         * specified number of atoms.
+         */
+    static UINT32 GetHashIndexSizeInBytes(__in Atom::AtomCount nAtoms);
+
+    /*!
+         * Fills a hash index from the hash table of an atom pool.  numBuckets must
+         * be the value reported by GetHashIndexNumBuckets.
+         */
+    static HRESULT BuildHashIndex(
+        __in_ecount(nAtoms) const HashIndex* pHashes,
+        __in Atom::AtomCount nAtoms,
+        __out_ecount(numBuckets) HashIndex* pBuckets,
+        __in UINT32 numBuckets);
+
+    //! Indicates whether lookups use a hash index, either from the file or built in memory.
+    bool HasHashIndex() const { return (m_pHashIndex != nullptr) || (m_pLazyHashIndex != nullptr); }
+
 protected:
     static HashIndex* HashIndex_Init(__inout HashIndex* pSelf, __in Atom::Hash hash, __in Atom::Index index);
     bool TryGetHashIndex(__in PCWSTR pString, __out_opt HashIndex* pIndexOut) const;
 
+    //! Atom pools in files always use the legacy hash, so only case sensitivity comes from the header.
+    Atom::HashMethod GetHashMethod() const
+    {
+        return ((m_pHeader->flags & DEFFILE_ATOMPOOL_HASH_CASE_INSENSITIVE) ? Atom::HashMethodCaseInsensitive : Atom::HashMethodDefault);
+    }
+
+    const HashIndex* GetHashIndex(__out UINT32* pNumBucketsOut) const;
+
+    bool TryGetIndexFromHashIndex(
+        __in_ecount(numBuckets) const HashIndex* pBuckets,
+        __in UINT32 numBuckets,
+        __in PCWSTR pString,
+        __out Atom::Index* pIndexOut) const;
+
     DEFCOMPARISON CompareAtIndex(__in Atom::Index index, __in PCWSTR pString) const;
 
     DEFCOMPARISON CompareAtHashIndex(__in Atom::Index hashIndex, __in PCWSTR pString) const;
@@ -112,6 +112,24 @@ public:
 
     HRESULT GetSectionData(_In_ int index, _Out_ const void** data, _Out_ UINT32* pcbSectionSizeOut) const;
 
+    /*!
+        * True if the file data is a view of the file mapped by this BaseFile.
+        */
+    bool IsMapped() const { return ((m_flags & (BaseFileOwnsDataFlag | MapFileFlag)) == (BaseFileOwnsDataFlag | MapFileFlag)); }
+
+    /*!
+        * Asks the system to read in the pages of a section ahead of use. Advisory only; returns
+        * S_FALSE without doing anything if the file isn't mapped or the section is empty.
+        */
+    HRESULT PrefetchSectionPages(_In_ SectionIndex index) const;
+
+    /*!
+        * Removes the pages of a section from the working set. They are read again from the file on
+        * their next use. Advisory only; returns S_FALSE without doing anything if the file isn't mapped
+        * or the section is empty.
+        */
+    HRESULT TrimSectionPages(_In_ SectionIndex index) const;
+
     /*!
         * Gets the section index for the first section with the specified section type
         */
@@ -259,6 +277,8 @@ protected:
 
     HRESULT InitFromData(__in_bcount(cbData) const void* pData, __in size_t cbData);
 
+    HRESULT GetMappedSectionRange(_In_ SectionIndex index, _Outptr_result_maybenull_ const void** ppStart, _Out_ size_t* pcbSize) const;
+
     HRESULT UnmapFileData();
 
     static HRESULT ValidateTocEntryAgainstSectionData(__in const DEFFILE_TOC_ENTRY* pToc, __in const DEFFILE_SECTION_HEADER* pHeader);
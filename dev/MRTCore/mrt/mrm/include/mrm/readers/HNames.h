@@ -190,6 +190,9 @@ public:
         _Out_writes_to_opt_(sizeItems, *pNumItemsWritten) int* pItemsOut,
         _Out_opt_ int* pNumItemsWritten) const;
 
+    //! Returns true if the section includes a full path index.
+    bool HasPathIndex() const { return (m_pPathIndex != nullptr); }
+
 private:
     bool m_largeNode;
     DEFFILE_HNAMES_HEADER_EX m_header;
@@ -204,6 +207,11 @@ private:
     __field_ecount(m_pHeader->cchUtf16NamesPool) const WCHAR* m_pUtf16Names;
     __field_ecount(m_pHeader->cchAsciiNamesPool) const char* m_pAsciiNames;
 
+    // optional, null if the section has no full path index
+    const DEFFILE_HNAMES_PATH_INDEX_HEADER* m_pPathIndex;
+    __field_ecount(m_pPathIndex->numBuckets) const DEFFILE_HNAMES_PATH_INDEX_ENTRY* m_pPathIndexEntries;
+    __field_ecount(m_pPathIndex->numScopeHashes) const UINT32* m_pScopePathHashes;
+
     IAtomPool* m_pScopeNames;
     IAtomPool* m_pItemNames;
 
@@ -217,6 +225,23 @@ private:
 
     HRESULT GetNumDescendents(_In_ int scopeIndex, _In_ UINT32 currentDepth, _Out_opt_ int* pNumScopes, _Out_opt_ int* pNumItems) const;
 
+    bool TryGetNode(_In_ int nodeIndex, _Out_ DEFFILE_HNAMES_NODE_LARGE* pNodeOut) const;
+
+    /*!
+     * Looks up a path using the full path index.  Returns false if the index
+     * can't answer the request (e.g. the path isn't plain ASCII or has empty
+     * segments), in which case the caller must walk the names one segment
+     * at a time.  Otherwise returns true and sets *pNameIndexOut to the
+     * matching node, or to -1 if there is no such name.
+     */
+    bool TryFindInPathIndex(_In_ PCWSTR pPath, _In_ int relativeToScope, _Out_ int* pNameIndexOut) const;
+
+    bool PathIndexEntryMatches(
+        _In_ UINT32 nodeIndex,
+        _In_ UINT32 relativeToNode,
+        _In_reads_(cchPath) PCWSTR pPath,
+        _In_ int cchPath) const;
+
     HRESULT GetAsciiName(_In_ int firstChar, _In_ int cchName, _Out_ PCSTR* result) const
     {
         *result = nullptr;
@@ -306,8 +306,33 @@ public:
 
     HRESULT Load() { return InnerLoad(); }
 
+    // Loads the file from pLoadedFile, which must have been opened from this file's path with this file's manager.
+    // This lets callers open files ahead of time on other threads. Takes ownership of pLoadedFile only on success.
+    HRESULT Load(_In_ MrmFile* pLoadedFile);
+
     HRESULT Unload() { return InnerUnload(); }
 
+    // Unloads the file to make room for others. The next section access loads it again.
+    HRESULT Evict();
+
+    // Pinned files hold sections that something else keeps pointers into, so the file manager never
+    // evicts them to stay within its residency budget.
+    void Pin() { m_numPins++; }
+
+    void Unpin()
+    {
+        DEF_ASSERT(m_numPins > 0);
+        m_numPins--;
+    }
+
+    bool IsPinned() const { return (m_numPins > 0); }
+
+    // Increases every time a section of the file is requested, relative to the other files of the same manager.
+    UINT64 GetLastAccess() const { return m_lastAccess; }
+
+    // See MrmFile::TrimColdSections. Does nothing if the file isn't loaded.
+    HRESULT TrimColdSections() const;
+
     int GetNumFiles() const { return m_pBaseFile->GetNumFiles(); }
 
     bool LoadFailed() const { return m_loadFailed; }
@@ -376,8 +401,22 @@ public:
 
     HRESULT GetFilePath(_In_ int fileIndex, _Inout_ StringResult* pStringResult) const;
 
+    DecodedStringCache* GetDecodedStringCache(_In_ int fileIndex) const override;
+
+    // Caches decoded ASCII and UTF-8 string values of this file, up to cbBudget bytes of UTF-16 strings.
+    // The cache is created on first use and is emptied whenever the file is unloaded. A budget of zero
+    // turns caching off.
+    HRESULT SetDecodedStringCacheBudget(_In_ size_t cbBudget);
+
+    // Returns nullptr if caching was never turned on for this file.
+    const DecodedStringCache* GetDecodedStringCache() const { return m_pDecodedStringCache; }
+
+    // Relative paths are resolved through the file system once and then remembered for the process,
+    // keyed by their full path.  Call ClearNormalizedPathCache after moving files or changing links.
     static HRESULT NormalizeFilePath(_In_ PCWSTR pFilePath, _Inout_ StringResult* pPathOut);
 
+    static void ClearNormalizedPathCache();
+
     static HRESULT NormalizePackageRoot(_In_ PCWSTR pPriFile, _In_opt_ PCWSTR pPackageRoot, _Inout_ StringResult* pPathOut);
 
 protected:
@@ -389,12 +428,18 @@ protected:
     mutable const IMrmFile* m_pBaseFile;
     mutable IMrmFile* m_pMyBaseFile;
 
+    int m_numPins;
+    mutable UINT64 m_lastAccess;
+    mutable bool m_bEvicted;
+
     PWSTR m_pPath;
     size_t m_fileSizeInBytes;
     UINT64 m_fileLastModifiedDate;
 
     PWSTR m_pPackageRoot;
 
+    DecodedStringCache* m_pDecodedStringCache;
+
     ManagedFile(_In_ const PriFileManager* pManager, _In_ int globalIndex);
 
     ManagedFile(_In_ const MrmFile* pBaseFile);
@@ -408,6 +453,12 @@ protected:
     virtual HRESULT InnerLoad() const;
 
     virtual HRESULT InnerUnload() const;
+
+    // Makes pFile the loaded file and notes the load with the file manager.
+    void AdoptLoadedFile(_In_ MrmFile* pFile) const;
+
+    // Loads the file if needed and notes the access with the file manager.
+    HRESULT EnsureLoaded() const;
 };
 
 class PriFileManager : public IFileSectionResolver
@@ -463,6 +514,37 @@ public:
 
     HRESULT SetDefaultFileFlags(_In_ UINT32 flags);
 
+    size_t GetDecodedStringCacheBudget() const { return m_cbDecodedStringCacheBudget; }
+
+    // Sets the decoded string cache budget of every file, including files added later. Zero turns caching off.
+    HRESULT SetDecodedStringCacheBudget(_In_ size_t cbBudget);
+
+    // Limits the total size of the loaded files to about cbBudget bytes by evicting the least recently used
+    // files that aren't pinned, and evicts right away to fit. Evicted files are loaded again on their next
+    // section access. Zero, the default, never evicts anything.
+    //
+    // Loading a file never evicts another one, because the lookup that loads it might still use sections
+    // of the others. Files loaded past the budget stay loaded until the next EnforceResidencyBudget.
+    HRESULT SetResidencyBudget(_In_ size_t cbBudget);
+
+    // Evicts the least recently used files that aren't pinned until the loaded files fit the budget. Call it
+    // between lookups, from the thread that uses the file manager. Eviction invalidates any pointer into the
+    // evicted files, so copy the values to keep first. UnifiedResourceView calls it after LoadPriFiles and
+    // RemoveFileReference.
+    HRESULT EnforceResidencyBudget();
+
+    size_t GetResidencyBudget() const { return m_cbResidencyBudget; }
+    size_t GetResidentSizeInBytes() const { return static_cast<size_t>(m_cbResident); }
+    int GetNumResidentFiles() const { return m_numResidentFiles; }
+
+    UINT64 GetNumResidencyLoads() const { return static_cast<UINT64>(m_numResidencyLoads); }
+    UINT64 GetNumResidencyReloads() const { return static_cast<UINT64>(m_numResidencyReloads); }
+    UINT64 GetNumResidencyEvictions() const { return static_cast<UINT64>(m_numResidencyEvictions); }
+
+    // Drops pages that lookups don't need (everything but the hot sections) of every loaded, mapped file
+    // from the working set, for example after a burst of lookups or when the app is suspended.
+    HRESULT TrimColdSections() const;
+
     /*
          * IFileSectionResolver methods
          */
@@ -528,21 +610,83 @@ public:
 
     HRESULT GetDefaultQualifierMapping(_In_ int fileIndex, _Out_ const RemapAtomPool** result) const;
 
+    DecodedStringCache* GetDecodedStringCache(_In_ int fileIndex) const override;
+
 private:
     static const int DefaultInitialFilesSize = 4;
 
+    static const int DefaultInitialFileIndexSize = 16;
+
     typedef struct FileManagerFileInfo
     {
         ManagedFile* pFile;
     } FileManagerFileInfo;
 
+    // One slot of the path index, an open-addressed table keyed by the case-insensitive hash of each
+    // file's normalized path.  Empty slots have a null pFile.
+    typedef struct FileIndexEntry
+    {
+        Atom::Hash pathHash;
+        ManagedFile* pFile;
+    } FileIndexEntry;
+
+    static Atom::Hash HashFilePath(_In_ PCWSTR pNormalizedPath)
+    {
+        return Atom::HashString(pNormalizedPath, Atom::HashMethodCaseInsensitiveVersion2);
+    }
+
+    // Finds the file with the lowest index whose path matches, like a scan of m_pFiles would.
+    ManagedFile* FindFile(_In_ PCWSTR pNormalizedPath) const;
+
+    HRESULT IndexFile(_In_ ManagedFile* pFile) const;
+
+    void UnindexFile(_In_ const ManagedFile* pFile) const;
+
+    // Called by ManagedFile to keep the residency counters and LRU order up to date. Files are also loaded
+    // on preload threads, so these use interlocked updates.
+    friend class ManagedFile;
+
+    UINT64 NoteFileAccess() const { return static_cast<UINT64>(InterlockedIncrement64(&m_accessClock)); }
+
+    void NoteFileLoaded(_In_ const ManagedFile* pFile, _In_ bool bReload) const;
+
+    void NoteFileUnloaded(_In_ const ManagedFile* pFile) const;
+
     UINT32 m_defaultFileFlags;
+    size_t m_cbDecodedStringCacheBudget;
+
+    size_t m_cbResidencyBudget;
+    mutable volatile LONG64 m_cbResident;
+    mutable volatile LONG m_numResidentFiles;
+    mutable volatile LONG64 m_accessClock;
+    mutable volatile LONG64 m_numResidencyLoads;
+    mutable volatile LONG64 m_numResidencyReloads;
+    volatile LONG64 m_numResidencyEvictions;
     mutable DynamicArray<FileManagerFileInfo>* m_pFiles;
     mutable MrmFileResolver* m_pFileResolver;
 
+    mutable FileIndexEntry* m_pFileIndex;
+    mutable int m_fileIndexSize;
+    mutable int m_numIndexedFiles;
+
     UnifiedEnvironment* m_pEnvironment;
 
-    PriFileManager() : m_pFiles(nullptr), m_pFileResolver(nullptr), m_pEnvironment(nullptr) {}
+    PriFileManager() :
+        m_cbDecodedStringCacheBudget(0),
+        m_cbResidencyBudget(0),
+        m_cbResident(0),
+        m_numResidentFiles(0),
+        m_accessClock(0),
+        m_numResidencyLoads(0),
+        m_numResidencyReloads(0),
+        m_numResidencyEvictions(0),
+        m_pFiles(nullptr),
+        m_pFileResolver(nullptr),
+        m_pFileIndex(nullptr),
+        m_fileIndexSize(0),
+        m_numIndexedFiles(0),
+        m_pEnvironment(nullptr)
+    {}
 
     HRESULT Init(_In_ UnifiedEnvironment* pEnvironment);
 };
@@ -873,6 +1017,17 @@ public:
 
     HRESULT SetDefaultFileFlags(_In_ UINT32 flags) { return m_pFileManager->SetDefaultFileFlags(flags); }
 
+    HRESULT SetDecodedStringCacheBudget(_In_ size_t cbBudget) { return m_pFileManager->SetDecodedStringCacheBudget(cbBudget); }
+
+    // The PRI files this view references stay pinned while it references them, because the view keeps
+    // pointers into them. Only files reached through them, such as resource packs, are evicted, which
+    // happens here, after LoadPriFiles and after RemoveFileReference.
+    HRESULT SetResidencyBudget(_In_ size_t cbBudget) { return m_pFileManager->SetResidencyBudget(cbBudget); }
+
+    HRESULT EnforceResidencyBudget() { return m_pFileManager->EnforceResidencyBudget(); }
+
+    HRESULT TrimColdSections() const { return m_pFileManager->TrimColdSections(); }
+
     // UnifiedResourceView
     AtomPoolGroup* GetAtoms() const { return m_pAtoms; }
     UnifiedDecisionInfo* GetDefaultDecisionInfo() const { return m_pDecisions; }
@@ -921,6 +1076,8 @@ protected:
 
     UnifiedViewFileInfo* m_pAppFile;
 
+    static const UINT32 MaxPreloadThreads = 8;
+
     UnifiedResourceView(_In_ CoreProfile* pProfile);
 
     HRESULT Init();
@@ -933,6 +1090,17 @@ protected:
 
     HRESULT AddReferencedFile(_In_ UnifiedViewFileInfo* pFile, _Out_opt_ int* pFileIndexOut);
 
+    // Registers the files that aren't referenced yet and loads them on up to MaxPreloadThreads threads, so
+    // that their I/O overlaps. Files that fail to load are unregistered again, so that LoadPriFiles adds and
+    // reports them as usual when it reaches them. pAddedFiles receives the files that stay registered.
+    HRESULT PreloadPriFiles(
+        _In_ DynamicArray<StringResult*>* pFilePathsCollection,
+        _In_ LoadPriFlags flags,
+        _Inout_ DynamicArray<ManagedFile*>* pAddedFiles);
+
+    // Unregisters the files in pAddedFiles that the view doesn't reference.
+    void RemoveUnreferencedFiles(_In_ DynamicArray<ManagedFile*>* pAddedFiles);
+
     HRESULT RemoveReferencedFile(_In_ UnifiedViewFileInfo* pFile);
 
     HRESULT
@@ -991,6 +1159,15 @@ public:
         _Out_writes_(numResults) int* pResultIndexesOut,
         _Out_writes_(numResults) int* pResultSetIndexesOut) const = 0;
 
+    // Evaluates each decision in turn. If pResultsOut is supplied, every decision gets its own result and
+    // the call only fails for bad arguments; otherwise the first decision that fails fails the call.
+    virtual HRESULT EvaluateDecisions(
+        _In_ int numDecisions,
+        _In_reads_(numDecisions) const IDecision* const* ppDecisions,
+        _Out_writes_(numDecisions) int* pResultIndexesOut,
+        _Out_writes_(numDecisions) int* pResultSetIndexesOut,
+        _Out_writes_opt_(numDecisions) HRESULT* pResultsOut) const = 0;
+
     virtual HRESULT GetQualifierProvider(_In_ PCWSTR qualifierName, _Out_ const IQualifierValueProvider** provider) const = 0;
 };
 
@@ -1008,8 +1185,11 @@ public:
 
     virtual HRESULT Reset(_In_reads_(numQualifierNames) Atom* pQualifierNames, _In_ int numQualifierNames);
 
-    UINT64 GetGeneration() const { return m_generation; }
+    // Changes every time the resolver is reset.
+    UINT64 GetGeneration() const { return static_cast<UINT64>(ReadAcquire64(&m_generation)); }
 
+    // Safe to call from any thread. Implementations hand back a copy of the value, so it stays valid
+    // after a concurrent SetQualifier or Reset.
     virtual HRESULT GetQualifierValue(_In_ PCWSTR pQualifier, _Inout_ StringResult* pValue) const = 0;
 
     virtual HRESULT GetQualifierValue(_In_ Atom qualifier, _Inout_ StringResult* pValue) const = 0;
@@ -1031,25 +1211,108 @@ public:
         _Out_writes_(numResults) int* pResultIndexesOut,
         _Out_writes_(numResults) int* pResultSetIndexesOut) const;
 
+    HRESULT EvaluateDecisions(
+        _In_ int numDecisions,
+        _In_reads_(numDecisions) const IDecision* const* ppDecisions,
+        _Out_writes_(numDecisions) int* pResultIndexesOut,
+        _Out_writes_(numDecisions) int* pResultSetIndexesOut,
+        _Out_writes_opt_(numDecisions) HRESULT* pResultsOut) const;
+
     virtual HRESULT GetQualifierProvider(_In_ PCWSTR qualifierName, _Out_ const IQualifierValueProvider** provider) const override = 0;
 
+    // Resolve-once mode. While enabled, the resolver keeps the winner of each decision in a table the first time
+    // that it resolves the decision in a generation, so later single-result EvaluateDecision calls become one
+    // table lookup. A Reset makes the table stale, and each decision is resolved again the next time it is used.
+    HRESULT EnableDecisionTable(_In_ bool enable);
+
+    bool IsDecisionTableEnabled() const { return (ReadAcquire(&m_decisionTableEnabled) != 0); }
+
+    // Copies the decision table for the current generation, resolving any decisions that aren't in it yet.
+    // numEntries must be twice the number of decisions. Fails with E_PENDING if the resolver is reset meanwhile.
+    HRESULT GetDecisionTable(_In_ int numEntries, _Out_writes_(numEntries) UINT16* pEntriesOut) const;
+
+    // Enables the decision table and uses the supplied entries, as returned by GetDecisionTable, for the
+    // current qualifier values instead of resolving everything. The entries are used again whenever the
+    // qualifiers are set back to those values. Fails with ERROR_INVALID_DATA if any entry isn't a qualifier set
+    // of its decision. pEntries must stay valid for the life of the resolver.
+    HRESULT UseDecisionTable(_In_reads_(numEntries) const UINT16* pEntries, _In_ int numEntries);
+
+    // Checksums the name and current value of every qualifier known to the resolver.
+    HRESULT ComputeQualifierChecksum(_Out_ DEF_CHECKSUM* pChecksumOut) const;
+
 protected:
     ResolverBase(_In_ const UnifiedEnvironment* pEnvironment, _In_ const IDecisionInfo* pDecisions);
 
     HRESULT Init();
 
-    HRESULT EvaluateQualifier(_In_ const IQualifier* pQualifier, _Out_ UINT16* pScoreOut, _Out_ UINT16* pFallbackScoreOut) const;
+    // The cache is lock-free. Each evaluation reads and writes cache entries for the cache generation that
+    // was current when it started, so a concurrent Reset never mixes old and new results.
+    HRESULT EvaluateQualifier(
+        _In_ const IQualifier* pQualifier,
+        _In_ UINT32 cacheGeneration,
+        _Out_ UINT16* pScoreOut,
+        _Out_ UINT16* pFallbackScoreOut) const;
+
+    HRESULT EvaluateQualifierSet(
+        _In_ const IQualifierSet* pQualifierSet,
+        _In_ UINT32 cacheGeneration,
+        _Out_ bool* pbIsMatchOut,
+        _Out_ bool* pbIsDefaultOut,
+        _Out_ bool* pbIsMatchAsDefaultOut,
+        _Out_opt_ UINT16* pScoreOut) const;
+
+    // Resolves through the decision cache, ignoring the decision table.
+    HRESULT ResolveDecision(
+        _In_ const IDecision* pDecision,
+        _In_ int numResults,
+        _Out_writes_(numResults) int* pResultIndexesOut,
+        _Out_writes_(numResults) int* pResultSetIndexesOut) const;
+
+    bool TryGetDecisionFromTable(_In_ const IDecision* pDecision, _Out_ int* pResultIndexOut, _Out_ int* pResultSetIndexOut) const;
+
+    // Remembers the winner of a decision that was resolved in the given generation.
+    HRESULT StoreDecisionInTable(_In_ const IDecision* pDecision, _In_ UINT64 generation, _In_ int indexInDecision, _In_ int indexInPool)
+        const;
+
+    // Called after a qualifier changes. Uses the entries passed to UseDecisionTable for the new generation if
+    // the qualifier values are the ones that they were resolved for.
+    void RevalidateDecisionTableSnapshot();
+
+    // Scores a qualifier against the provider value for its qualifier type.  Provider values are
+    // parsed once per cache generation and kept, so the type doesn't re-parse them for every asset
+    // qualifier.  Returns the error from getting the provider value, if any.
+    HRESULT EvaluateProviderValue(
+        _In_ const IQualifier* pQualifier,
+        _In_ Atom qualifierName,
+        _In_ const IBuildQualifierType* pType,
+        _In_ UINT32 cacheGeneration,
+        _Out_ double* pScoreOut) const;
 
     class DecisionInfoCache;
+    struct DecisionTable;
+
+    static HRESULT AllocateDecisionTable(_In_ int numDecisions, _Outptr_ DecisionTable** result);
+
+    struct ProviderValueEntry
+    {
+        Atom qualifierName;
+        ParsedQualifierValue* pValue;
+    };
 
     const UnifiedEnvironment* m_pEnvironment;
     const IDecisionInfo* m_pDecisions;
-    UINT64 m_generation;
+    volatile LONG64 m_generation;
 
     mutable DecisionInfoCache* m_pCache;
-    mutable SRWLOCK m_srwLock;
-    mutable SRWLOCK m_srwQualifierSetLock;
-    mutable SRWLOCK m_srwQualifierLock;
+
+    volatile LONG m_decisionTableEnabled;
+    mutable DecisionTable* volatile m_pDecisionTable;
+    mutable SRWLOCK m_srwDecisionTableLock;
+
+    // Indexed by qualifier name atom index.
+    mutable ProviderValueEntry* m_pProviderValues;
+    mutable int m_numProviderValues;
+    mutable SRWLOCK m_srwProviderValuesLock;
 };
 
 class ProviderResolver : public ResolverBase
@@ -1139,6 +1402,13 @@ public:
         _Out_writes_(numResults) int* pResultIndexesOut,
         _Out_writes_(numResults) int* pResultSetIndexesOut) const;
 
+    HRESULT EvaluateDecisions(
+        _In_ int numDecisions,
+        _In_reads_(numDecisions) const IDecision* const* ppDecisions,
+        _Out_writes_(numDecisions) int* pResultIndexesOut,
+        _Out_writes_(numDecisions) int* pResultSetIndexesOut,
+        _Out_writes_opt_(numDecisions) HRESULT* pResultsOut) const;
+
     HRESULT EvaluateQualifierSet(
         _In_ const IQualifierSet* pQualifierSet,
         _Out_ bool* pbIsMatchOut,
@@ -1159,6 +1159,71 @@ private:
 class FileAtomPool;
 class UnifiedEnvironment;
 
+/*!
+     * Keeps the UTF-16 forms of ASCII and UTF-8 data items from one file,
+     * keyed by data items section index and item index, so that repeated
+     * lookups of the same candidate don't decode it again.  Strings are
+     * added until the byte budget is used up and are never evicted, so a
+     * hit can return a reference that stays valid until the cache is
+     * cleared (when the file is unloaded) or destroyed, like a reference
+     * into the file itself.  All methods can be called concurrently.
+     */
+class DecodedStringCache : public DefObject
+{
+public:
+    static HRESULT CreateInstance(_In_ size_t cbBudget, _Outptr_ DecodedStringCache** result);
+
+    virtual ~DecodedStringCache();
+
+    // Points pStringOut at the cached string and counts a hit, or counts a miss and returns false.
+    bool TryGetString(_In_ UINT16 sectionIndex, _In_ UINT32 itemIndex, _Inout_ StringResult* pStringOut);
+
+    // cchString includes the null terminator. Strings that don't fit in what is left of the budget are not cached.
+    HRESULT AddString(_In_ UINT16 sectionIndex, _In_ UINT32 itemIndex, _In_reads_(cchString) PCWSTR pString, _In_ size_t cchString);
+
+    // Only affects strings added later. A budget of zero stops adding strings.
+    void SetBudget(_In_ size_t cbBudget);
+
+    // Frees every cached string, invalidating the references returned by TryGetString.
+    void Clear();
+
+    size_t GetBudget() const { return m_cbBudget; }
+    size_t GetSizeInBytes() const { return m_cbStrings; }
+    int GetNumEntries() const { return m_numEntries; }
+
+    UINT64 GetNumHits() const { return static_cast<UINT64>(m_numHits); }
+    UINT64 GetNumMisses() const { return static_cast<UINT64>(m_numMisses); }
+
+private:
+    struct Entry
+    {
+        PWSTR pString; // nullptr if the slot is free
+        size_t cchString;
+        UINT32 itemIndex;
+        UINT16 sectionIndex;
+        int next; // Next entry in the same bucket, or next free slot
+    };
+
+    static const int InitialNumSlots = 64;
+
+    Entry* m_pEntries;
+    int* m_pBuckets;
+    int m_numSlots;
+    int m_numEntries;
+    int m_firstFreeSlot;
+    size_t m_cbBudget;
+    size_t m_cbStrings;
+    volatile LONG64 m_numHits;
+    volatile LONG64 m_numMisses;
+    _DEF_SRWLOCK m_srwLock;
+
+    DecodedStringCache(_In_ size_t cbBudget);
+
+    int GetBucket(_In_ UINT16 sectionIndex, _In_ UINT32 itemIndex) const;
+    int FindEntry(_In_ UINT16 sectionIndex, _In_ UINT32 itemIndex) const;
+    HRESULT Grow();
+};
+
 class IFileSectionResolver : public DefObject
 {
 public:
@@ -1234,6 +1299,13 @@ public:
     virtual HRESULT GetDefaultQualifierMapping(_In_ int fileIndex, _Out_ const RemapAtomPool** result) const = 0;
 
     virtual int GetNumFiles() const = 0;
+
+    // Returns the decoded string cache for the file, or nullptr if the file doesn't have one.
+    virtual DecodedStringCache* GetDecodedStringCache(_In_ int fileIndex) const
+    {
+        UNREFERENCED_PARAMETER(fileIndex);
+        return nullptr;
+    }
 };
 
 class MrmFileSection;
@@ -1466,6 +1538,22 @@ public:
 
     int GetNumFiles() const;
 
+    DecodedStringCache* GetDecodedStringCache(_In_ int fileIndex) const override;
+
+    // The cache is owned by the caller and must outlive this file.
+    void SetDecodedStringCache(_In_opt_ DecodedStringCache* pCache) { m_pDecodedStringCache = pCache; }
+
+    // Hot sections are the ones every lookup reads: the PRI descriptor, schemas and names, decision
+    // info and resource maps. Files loaded through a PriFileManager prefetch them when they are opened.
+    // Both methods are advisory and do nothing for files that aren't mapped.
+    HRESULT PrefetchHotSections() const;
+
+    // Drops the pages of every other section, such as candidate data, from the working set. They are
+    // read again from the file on their next use.
+    HRESULT TrimColdSections() const;
+
+    static bool IsHotSectionType(_In_ const DEFFILE_SECTION_TYPEID& sectionType);
+
 protected:
     mutable const BaseFile* m_pBaseFile;
     mutable const BaseFile* m_pMyBaseFile;
@@ -1473,6 +1561,7 @@ protected:
     mutable PriFileManager* m_pPriFileManager;
     mutable MrmFileResolver* m_pFileResolver;
     UnifiedEnvironment* m_pEnvironment;
+    DecodedStringCache* volatile m_pDecodedStringCache;
 
     MrmFile() :
         m_pBaseFile(nullptr),
@@ -1480,7 +1569,8 @@ protected:
         m_pSections(nullptr),
         m_pPriFileManager(nullptr),
         m_pFileResolver(nullptr),
-        m_pEnvironment(nullptr)
+        m_pEnvironment(nullptr),
+        m_pDecodedStringCache(nullptr)
     {}
 
     HRESULT Init(_In_ UnifiedEnvironment* pEnvironment, _In_ UINT32 flags, _In_ PCWSTR pPath);
@@ -245,6 +245,79 @@ HRESULT AtomIndexedDictionaryBase::GetOrAddInternalIndex(_In_ Atom::Index nameIn
     return S_OK;
 }
 
+HRESULT AtomIndexedDictionaryBase::GetOrAddInternalIndexes(
+    _In_reads_(numNames) const Atom::Index* pNameIndexes,
+    _In_ int numNames,
+    _Out_writes_opt_(numNames) int* pInternalIndexesOut)
+{
+    RETURN_HR_IF(E_INVALIDARG, (pNameIndexes == nullptr) || (numNames < 0));
+
+    // Work out how much room the whole batch needs and grow the pool once.  After that
+    // GetOrAddInternalIndex only has to assign indexes.
+    int numMissing = 0;
+    Atom::Index newMin = m_minAtomIndex;
+    Atom::Index newMax = m_maxAtomIndex;
+    for (int i = 0; i < numNames; i++)
+    {
+        Atom::Index nameIndex = pNameIndexes[i];
+        RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_INDEX), !m_pNames->Contains(nameIndex));
+
+        if (!TryGetInternalIndex(nameIndex, nullptr))
+        {
+            numMissing++;
+            newMin = (((nameIndex < newMin) || (newMin < 0)) ? nameIndex : newMin);
+            newMax = ((nameIndex > newMax) ? nameIndex : newMax);
+        }
+    }
+
+    if (numMissing > 0)
+    {
+        switch (m_strategy)
+        {
+        case Full:
+        {
+            int newSize = m_pNames->GetNumAtoms();
+            RETURN_IF_FAILED(Extend(m_numItems, newSize, 0));
+
+            m_sizeItems = m_numItems = newSize;
+            m_minAtomIndex = 0;
+            m_maxAtomIndex = m_numItems - 1;
+        }
+        break;
+        case Subset:
+        {
+            int newSize = newMax - newMin + 1;
+            int offset = ((m_minAtomIndex >= 0) ? m_minAtomIndex - newMin : 0);
+
+            RETURN_IF_FAILED(Extend(m_numItems, newSize, offset));
+
+            m_minAtomIndex = newMin;
+            m_maxAtomIndex = newMax;
+            m_sizeItems = m_numItems = newSize;
+        }
+        break;
+        case Sparse:
+        {
+            if (m_numItems + numMissing > m_sizeItems)
+            {
+                int newSize = ((m_sizeItems < 1) ? InitialSparseSize : m_sizeItems * 2);
+                newSize = max(newSize, m_numItems + numMissing);
+                RETURN_IF_FAILED(Extend(m_sizeItems, newSize, 0));
+
+                m_sizeItems = newSize;
+            }
+        }
+        break;
+        }
+    }
+
+    for (int i = 0; i < numNames; i++)
+    {
+        RETURN_IF_FAILED(GetOrAddInternalIndex(pNameIndexes[i], (pInternalIndexesOut != nullptr) ? &pInternalIndexesOut[i] : nullptr));
+    }
+    return S_OK;
+}
+
 HRESULT AtomIndexedDictionaryBase::GetOrAddInternalIndex(_In_ PCWSTR pName, _Out_opt_ int* pInternalIndexOut)
 {
     RETURN_HR_IF_NULL(E_INVALIDARG, pName);
@@ -33,7 +33,8 @@ DataItemOrchestrator::DataItemOrchestrator(
     m_allBuilders(nullptr),
     m_buildersByQualifierSet(nullptr),
     m_buildConfiguration(profile->GetBuildConfiguration()),
-    m_OrchestratorHashMap(nullptr)
+    m_OrchestratorHashMap(nullptr),
+    m_spillFile(nullptr)
 {}
 
 HRESULT DataItemOrchestrator::Init()
@@ -41,6 +42,7 @@ HRESULT DataItemOrchestrator::Init()
     RETURN_IF_FAILED(DynamicArray<DataItemsSectionBuilder*>::CreateInstance(10, &m_allBuilders));
     RETURN_IF_FAILED(DynamicArray<DataItemsSectionBuilder*>::CreateInstance(10, &m_buildersByQualifierSet));
     RETURN_IF_FAILED(OrchestratorHashMap::CreateInstance(1019, 0.75, &m_OrchestratorHashMap));
+    RETURN_IF_FAILED(DataItemSpillFile::CreateInstance(&m_spillFile));
 
     return S_OK;
 }
@@ -62,6 +64,9 @@ DataItemOrchestrator::~DataItemOrchestrator()
 
     delete m_buildersByQualifierSet;
     delete m_OrchestratorHashMap;
+
+    // The builders read from the spill file, so it goes after them.
+    delete m_spillFile;
 }
 
 HRESULT DataItemOrchestrator::Finalize()
@@ -97,6 +102,10 @@ HRESULT DataItemOrchestrator::GetOrAddDataItemSectionBuilder(_In_ int qualifierS
     *result = nullptr;
     RETURN_HR_IF(E_DEF_ALREADY_INITIALIZED, m_finalized);
 
+    // Every new data item is added through here, so checking the limit before each one keeps the data
+    // held in memory within the limit plus the size of one item.
+    RETURN_IF_FAILED(EnforceDataMemoryLimit());
+
     // Return data section builder. Respective qualifier set has its own data section that will improve
     // data localility during Runtime search.
 
@@ -106,6 +115,7 @@ HRESULT DataItemOrchestrator::GetOrAddDataItemSectionBuilder(_In_ int qualifierS
     {
         AutoDeletePtr<DataItemsSectionBuilder> autoBuilder;
         RETURN_IF_FAILED(DataItemsSectionBuilder::CreateInstance(&autoBuilder));
+        RETURN_IF_FAILED(autoBuilder->SetSpillFile(m_spillFile));
         RETURN_IF_FAILED(m_fileBuilder->AddSection(autoBuilder));
         RETURN_IF_FAILED(m_allBuilders->Add(autoBuilder));
 
@@ -122,6 +132,38 @@ HRESULT DataItemOrchestrator::GetOrAddDataItemSectionBuilder(_In_ int qualifierS
     return S_OK;
 }
 
+HRESULT DataItemOrchestrator::EnforceDataMemoryLimit()
+{
+    if (!HasDataMemoryLimit())
+    {
+        return S_OK;
+    }
+
+    // The spill file keeps the total as builders add and spill data. Spill the builders holding
+    // the most first, so that the rest keep their data in memory.
+    while (m_spillFile->GetDataSizeInMemory() > m_buildConfiguration->GetMaxInMemoryDataSize())
+    {
+        DataItemsSectionBuilder* largest = nullptr;
+        for (int i = 0; i < m_allBuilders->Count(); i++)
+        {
+            DataItemsSectionBuilder* builder;
+            RETURN_IF_FAILED(m_allBuilders->Get(i, &builder));
+            if ((largest == nullptr) || (builder->GetLargeItemDataSizeInMemory() > largest->GetLargeItemDataSizeInMemory()))
+            {
+                largest = builder;
+            }
+        }
+
+        if ((largest == nullptr) || (largest->GetLargeItemDataSizeInMemory() == 0))
+        {
+            break;
+        }
+        RETURN_IF_FAILED(largest->SpillLargeItemData());
+    }
+
+    return S_OK;
+}
+
 HRESULT DataItemOrchestrator::AddDataAndCreateInstanceReference(
     _In_reads_bytes_(valueSizeInBytes) const void* value,
     _In_ UINT valueSizeInBytes,
@@ -149,7 +191,12 @@ HRESULT DataItemOrchestrator::AddDataAndCreateInstanceReference(
 
             AutoDeletePtr<OrchestratorDataReference> autoBuildInstanceReference;
             RETURN_IF_FAILED(OrchestratorDataReference::CreateInstance(
-                defCheckSum, value, valueSizeInBytes, dataItemSectionBuilder, &preBuildReference, &autoBuildInstanceReference));
+                defCheckSum,
+                (HasDataMemoryLimit() ? nullptr : value),
+                valueSizeInBytes,
+                dataItemSectionBuilder,
+                &preBuildReference,
+                &autoBuildInstanceReference));
 
             RETURN_IF_FAILED(m_OrchestratorHashMap->AddtoMap(defCheckSum, autoBuildInstanceReference));
 
@@ -221,7 +268,12 @@ HRESULT DataItemOrchestrator::AddStringAndCreateInstanceReference(
 
             AutoDeletePtr<OrchestratorDataReference> autoBuildInstanceReference;
             RETURN_IF_FAILED(OrchestratorDataReference::CreateInstance(
-                defCheckSum, value, valueLength, dataItemSectionBuilder, &preBuildReference, &autoBuildInstanceReference));
+                defCheckSum,
+                (HasDataMemoryLimit() ? nullptr : value),
+                valueLength,
+                dataItemSectionBuilder,
+                &preBuildReference,
+                &autoBuildInstanceReference));
 
             RETURN_IF_FAILED(m_OrchestratorHashMap->AddtoMap(defCheckSum, autoBuildInstanceReference));
 
@@ -276,12 +328,9 @@ HRESULT DataItemOrchestrator::OptimizeString(
 
     if (MrmEnvironment::IsAsciiResourceValueType(*optimalType))
     {
-        // WideCharToMultiByte supports only ANSI, not pure ASCII. So hand-roll an implementation here.
-        for (size_t i = 0; i < *writtenBytesIncludingNull; i++)
-        {
-            DEF_ASSERT(value[i] <= 127); // Established by the encoding chooser.
-            convertedString[i] = static_cast<char>(value[i]);
-        }
+        // WideCharToMultiByte supports only ANSI, not pure ASCII, so use our own narrowing.
+        // The encoding chooser has already established that every character is ASCII.
+        RETURN_IF_FAILED(DefString_ConvertUtf16ToAscii(value, *writtenBytesIncludingNull, convertedString));
 
         convertedString[*writtenBytesIncludingNull] = '\0';
         *writtenBytesIncludingNull =
@@ -359,7 +408,7 @@ HRESULT DataItemOrchestrator::AddOptimizedStringAndCreateInstanceReference(
                 AutoDeletePtr<OrchestratorDataReference> autoBuildInstanceReference;
                 RETURN_IF_FAILED(OrchestratorDataReference::CreateInstance(
                     defCheckSum,
-                    convertedString,
+                    (HasDataMemoryLimit() ? nullptr : convertedString),
                     static_cast<size_t>(writtenBytesIncludingNull),
                     dataItemSectionBuilder,
                     &preBuildReference,
@@ -392,7 +441,12 @@ HRESULT DataItemOrchestrator::AddOptimizedStringAndCreateInstanceReference(
 
                 AutoDeletePtr<OrchestratorDataReference> autoBuildInstanceReference;
                 RETURN_IF_FAILED(OrchestratorDataReference::CreateInstance(
-                    defCheckSum, value, valueLength, dataItemSectionBuilder, &preBuildReference, &autoBuildInstanceReference));
+                    defCheckSum,
+                    (HasDataMemoryLimit() ? nullptr : value),
+                    valueLength,
+                    dataItemSectionBuilder,
+                    &preBuildReference,
+                    &autoBuildInstanceReference));
 
                 RETURN_IF_FAILED(m_OrchestratorHashMap->AddtoMap(defCheckSum, autoBuildInstanceReference));
 
@@ -509,10 +563,14 @@ OrchestratorDataReference::OrchestratorDataReference(
     m_innerReference.isLarge = preBuildItemReference->isLarge;
 }
 
-HRESULT OrchestratorDataReference::Init(_In_reads_bytes_(valueSizeInBytes) const void* actualValue, _In_ size_t valueSizeInBytes)
+HRESULT OrchestratorDataReference::Init(_In_reads_bytes_opt_(valueSizeInBytes) const void* actualValue, _In_ size_t valueSizeInBytes)
 {
     RETURN_IF_FAILED(DynamicArray<UINT>::CreateInstance(10, &m_metadata));
-    RETURN_IF_FAILED(m_actualDataBlob.SetCopy(actualValue, valueSizeInBytes));
+
+    if (actualValue != nullptr)
+    {
+        RETURN_IF_FAILED(m_actualDataBlob.SetCopy(actualValue, valueSizeInBytes));
+    }
 
     return S_OK;
 }
@@ -593,67 +651,55 @@ const void* OrchestratorDataReference::GetActualValue() const
 
 size_t OrchestratorDataReference::GetActualValueSize() const { return m_actualDataBlob.GetSize(); }
 
-HRESULT OrchestratorHashNode::CreateInstance(
-    _In_ DEF_CHECKSUM valueHash,
-    _In_ OrchestratorDataReference* dataReference,
-    _Outptr_ OrchestratorHashNode** result)
+bool OrchestratorDataReference::IsValueEqual(_In_reads_bytes_(valueSizeInBytes) const void* value, _In_ size_t valueSizeInBytes) const
 {
-    *result = nullptr;
-    RETURN_HR_IF_NULL(E_INVALIDARG, dataReference);
-
-    OrchestratorHashNode* hashNode = new OrchestratorHashNode(valueHash, dataReference);
-    RETURN_IF_NULL_ALLOC(hashNode);
-
-    *result = hashNode;
-    return S_OK;
-}
+    size_t existingSize = m_actualDataBlob.GetSize();
+    if (existingSize > 0)
+    {
+        return ((existingSize == valueSizeInBytes) && (memcmp(value, m_actualDataBlob.GetRef(&existingSize), valueSizeInBytes) == 0));
+    }
 
-OrchestratorHashNode::OrchestratorHashNode(_In_ DEF_CHECKSUM valueHash, _In_ OrchestratorDataReference* dataReference) :
-    m_valueHash(valueHash), m_dataReference(dataReference), m_nextOrchHashNode(nullptr)
-{}
+    // No copy was kept, so compare against what the builder holds.
+    BlobResult existingValue;
+    Def_IfFailedReturnFalse(GetDataBlob(&existingValue));
 
-bool OrchestratorHashNode::SetNext(_In_ OrchestratorHashNode* inputNode)
-{
-    m_nextOrchHashNode = inputNode;
-    return true;
+    const void* pExisting = existingValue.GetRef(&existingSize);
+    return ((existingSize == valueSizeInBytes) && (memcmp(value, pExisting, valueSizeInBytes) == 0));
 }
 
 OrchestratorHashMap::~OrchestratorHashMap()
 {
-    if (m_entries != nullptr)
-    {
-        for (int entryIndex = 0; entryIndex < m_currentSize; entryIndex++)
-        {
-            OrchestratorHashNode* node = nullptr;
-            m_entries->TryGet(entryIndex, &node);
-            while (node != nullptr)
-            {
-                OrchestratorHashNode* nodeToBeDeleted = node;
-                node = node->GetNext();
-                delete nodeToBeDeleted;
-                nodeToBeDeleted = nullptr;
-            }
-        }
-
-        delete m_entries;
-    }
+    _DefFree(m_pSlots);
+    m_pSlots = nullptr;
 }
 
-OrchestratorHashMap::OrchestratorHashMap(_In_ int initCapacity, _In_ float loadFactor) :
-    m_currentSize(initCapacity), m_nodeCount(0), m_loadFactor(loadFactor)
+OrchestratorHashMap::OrchestratorHashMap(_In_ float loadFactor) :
+    m_nodeCount(0), m_numSlots(0), m_maxNodeCount(0), m_loadFactor(loadFactor), m_pSlots(nullptr)
 {}
 
 HRESULT OrchestratorHashMap::Init(int initCapacity)
 {
-    RETURN_IF_FAILED(DynamicArray<OrchestratorHashNode*>::CreateInstance(initCapacity, &m_entries));
+    int numSlots = 16;
+    while (numSlots < initCapacity)
+    {
+        RETURN_HR_IF(E_INVALIDARG, numSlots > (INT_MAX / 2));
+        numSlots *= 2;
+    }
+
+    m_pSlots = _DefArray_AllocZeroed(Slot, numSlots);
+    RETURN_IF_NULL_ALLOC(m_pSlots);
+
+    m_numSlots = numSlots;
+    m_maxNodeCount = static_cast<int>(numSlots * m_loadFactor);
     return S_OK;
 }
 
 HRESULT OrchestratorHashMap::CreateInstance(_In_ int initCapacity, _In_ float loadFactor, _Outptr_ OrchestratorHashMap** result)
 {
     *result = nullptr;
+    RETURN_HR_IF(E_INVALIDARG, (initCapacity < 1) || (loadFactor <= 0.0) || (loadFactor >= 1.0));
 
-    AutoDeletePtr<OrchestratorHashMap> orchsHashMap = new OrchestratorHashMap(initCapacity, loadFactor);
+    AutoDeletePtr<OrchestratorHashMap> orchsHashMap = new OrchestratorHashMap(loadFactor);
     RETURN_IF_NULL_ALLOC(orchsHashMap);
     RETURN_IF_FAILED(orchsHashMap->Init(initCapacity));
 
@@ -661,107 +707,64 @@ HRESULT OrchestratorHashMap::CreateInstance(_In_ int initCapacity, _In_ float lo
     return S_OK;
 }
 
-int OrchestratorHashMap::HashCode(_In_ DEF_CHECKSUM key)
-{
-    int index = key % m_currentSize;
-    return index;
-}
-
-int OrchestratorHashMap::HashCode(_In_ size_t newSize, _In_ DEF_CHECKSUM key)
+int OrchestratorHashMap::GetFirstSlot(_In_ DEF_CHECKSUM key, _In_ int numSlots) const
 {
-    int index = key % newSize;
-    return index;
+    // Spread the checksum bits so that the low bits used for the slot depend on the whole key.
+    UINT32 hash = static_cast<UINT32>(key) * 0x9E3779B1;
+    hash ^= (hash >> 15);
+    return static_cast<int>(hash & static_cast<UINT32>(numSlots - 1));
 }
 
 HRESULT OrchestratorHashMap::AddtoMap(_In_ DEF_CHECKSUM key, _In_ OrchestratorDataReference* dataReference)
 {
     RETURN_HR_IF_NULL(E_INVALIDARG, dataReference);
 
-    int valueIndex = HashCode(key);
-    OrchestratorHashNode* existingNode = nullptr;
-    m_entries->TryGet(valueIndex, &existingNode);
-
-    AutoDeletePtr<OrchestratorHashNode> newHashNode;
-    RETURN_IF_FAILED(OrchestratorHashNode::CreateInstance(key, dataReference, &newHashNode));
-
-    RETURN_IF_FAILED(m_entries->ExtendAndSet(valueIndex, newHashNode, &existingNode));
-    OrchestratorHashNode* newLocalHasNode = newHashNode.Detach();
-
-    if (existingNode != nullptr)
+    if (m_nodeCount >= m_maxNodeCount)
     {
-        newLocalHasNode->SetNext(existingNode);
+        RETURN_IF_FAILED(ResizeMap());
     }
 
-    m_nodeCount++;
-
-    if (m_nodeCount > m_currentSize * m_loadFactor)
+    int slot = GetFirstSlot(key, m_numSlots);
+    while (m_pSlots[slot].dataReference != nullptr)
     {
-        RETURN_IF_FAILED(ResizeMap());
+        slot = ((slot + 1) & (m_numSlots - 1));
     }
 
+    m_pSlots[slot].hash = key;
+    m_pSlots[slot].dataReference = dataReference;
+    m_nodeCount++;
+
     return S_OK;
 }
 
 HRESULT OrchestratorHashMap::ResizeMap()
 {
-    int oldindex = 0;
-    int newIndex = 0;
-    DEF_CHECKSUM key = 0;
-    OrchestratorHashNode* nodeToMove = nullptr;
-    OrchestratorHashNode* nestNodeInOldMap = nullptr;
-    OrchestratorHashNode* existingNodeInNewMap = nullptr;
-    OrchestratorDataReference* dataReference = nullptr;
-    DynamicArray<OrchestratorHashNode*>* oldMapEntry = m_entries;
-    AutoDeletePtr<DynamicArray<OrchestratorHashNode*>> newMapEntry;
+    RETURN_HR_IF(E_OUTOFMEMORY, m_numSlots > (INT_MAX / 2));
 
-    RETURN_IF_FAILED(DynamicArray<OrchestratorHashNode*>::CreateInstance(m_currentSize * 2, &newMapEntry));
+    int newNumSlots = m_numSlots * 2;
+    Slot* pNewSlots = _DefArray_AllocZeroed(Slot, newNumSlots);
+    RETURN_IF_NULL_ALLOC(pNewSlots);
 
-    for (oldindex = 0; oldindex < m_currentSize; oldindex++)
+    // The checksum is kept in the slot, so entries move without looking at their data references.
+    for (int oldSlot = 0; oldSlot < m_numSlots; oldSlot++)
     {
-        nestNodeInOldMap = nullptr;
-        if (!oldMapEntry->TryGet(oldindex, &nestNodeInOldMap))
+        if (m_pSlots[oldSlot].dataReference == nullptr)
         {
             continue;
         }
 
-        while (nestNodeInOldMap != nullptr)
+        int newSlot = GetFirstSlot(m_pSlots[oldSlot].hash, newNumSlots);
+        while (pNewSlots[newSlot].dataReference != nullptr)
         {
-            //move the odeNode pointer
-            nodeToMove = nestNodeInOldMap;
-            nestNodeInOldMap = nestNodeInOldMap->GetNext();
-
-            //set this node's nextpoint to null
-            nodeToMove->SetNext(nullptr);
-
-            //Calculate new index by the hash from its reference
-            dataReference = nodeToMove->GetDataReference();
-            key = dataReference->GetValueHash();
-            size_t newsize = 0;
-            RETURN_IF_FAILED(SizeTAdd(m_currentSize, m_currentSize, &newsize));
-
-            newIndex = HashCode(newsize, key);
-
-            //put the new node(actually not a totally new one)
-            //check if the position is null
-            existingNodeInNewMap = nullptr;
-            newMapEntry->TryGet(newIndex, &existingNodeInNewMap);
-
-            if (existingNodeInNewMap == nullptr) //the new position is empty, put the node in there
-            {
-                RETURN_IF_FAILED(newMapEntry->ExtendAndSet(newIndex, nodeToMove));
-            }
-            else //the new position is not empty, put the new node in front of the existing node.
-            {
-                nodeToMove->SetNext(existingNodeInNewMap);
-                RETURN_IF_FAILED(newMapEntry->ExtendAndSet(newIndex, nodeToMove));
-            }
-            //Finish adding one node continue check.
+            newSlot = ((newSlot + 1) & (newNumSlots - 1));
         }
+        pNewSlots[newSlot] = m_pSlots[oldSlot];
     }
 
-    m_entries = newMapEntry.Detach();
-    delete oldMapEntry;
-    m_currentSize = m_currentSize * 2;
+    _DefFree(m_pSlots);
+    m_pSlots = pNewSlots;
+    m_numSlots = newNumSlots;
+    m_maxNodeCount = static_cast<int>(newNumSlots * m_loadFactor);
     return S_OK;
 }
 
@@ -775,48 +778,14 @@ OrchestratorDataReference* OrchestratorHashMap::TryGetFromMap(
         return nullptr;
     }
 
-    int valueIndex = HashCode(key);
-    int ifEqual = 1;
-
-    // get the entry of the value
-    OrchestratorHashNode* existingNodeInCurrentMap = nullptr;
-
-    (void)m_entries->Get(valueIndex, &existingNodeInCurrentMap);
-
-    // if it is nullptr, there is no exsiting node in that position.
-    // Return nullptr means new node can be added to this position.
-    if (existingNodeInCurrentMap == nullptr)
+    // Walk the probe sequence until an empty slot, which means the value isn't in the map.
+    for (int slot = GetFirstSlot(key, m_numSlots); m_pSlots[slot].dataReference != nullptr; slot = ((slot + 1) & (m_numSlots - 1)))
     {
-        return nullptr;
-    }
-
-    // If the entry is not nullptr, need to check the link on this entry.
-    while (existingNodeInCurrentMap != nullptr)
-    {
-        // Firstly, check if there is any same hash code in the link.
-        if (existingNodeInCurrentMap->GetHash() == key)
+        // Only values with the same checksum can be duplicates, and only if their contents match.
+        if ((m_pSlots[slot].hash == key) && m_pSlots[slot].dataReference->IsValueEqual(value, valueSizeInBytes))
         {
-            // A node with the same hash code found
-            // Secondly, check if they have the same hash value.
-            // Only if so, they can be considered as duplicate values.
-            OrchestratorDataReference* dataReference = existingNodeInCurrentMap->GetDataReference();
-
-            // if the input value has the same size with the existing value, check the actual values.
-            // if they have different size, consider as different value.
-            if (valueSizeInBytes == dataReference->GetActualValueSize())
-            {
-                const void* existingValue = dataReference->GetActualValue();
-                ifEqual = memcmp(value, existingValue, valueSizeInBytes);
-            }
-
-            if (ifEqual == 0)
-            {
-                // A true duplication found, return the existing dataReference.
-                return dataReference;
-            }
+            return m_pSlots[slot].dataReference;
         }
-
-        existingNodeInCurrentMap = existingNodeInCurrentMap->GetNext();
     }
 
     return nullptr;
@@ -279,6 +279,97 @@ HRESULT DataSectionBuilder::Build(__out_bcount(cbBuffer) VOID* pBuffer, __in UIN
 */
 DataSectionBuilder::~DataSectionBuilder() {}
 
+/*
+     * DataItemSpillFile
+     */
+
+DataItemSpillFile::DataItemSpillFile() : m_hFile(INVALID_HANDLE_VALUE), m_cbFile(0), m_cbDataInMemory(0) {}
+
+HRESULT DataItemSpillFile::CreateInstance(_Outptr_ DataItemSpillFile** result)
+{
+    *result = nullptr;
+
+    DataItemSpillFile* pRtrn = new DataItemSpillFile();
+    RETURN_IF_NULL_ALLOC(pRtrn);
+
+    *result = pRtrn;
+    return S_OK;
+}
+
+DataItemSpillFile::~DataItemSpillFile()
+{
+    if (m_hFile != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(m_hFile);
+        m_hFile = INVALID_HANDLE_VALUE;
+    }
+}
+
+HRESULT DataItemSpillFile::Append(_In_reads_bytes_(cbData) const BYTE* pData, _In_ UINT32 cbData, _Out_ UINT64* pFileOffsetOut)
+{
+    *pFileOffsetOut = 0;
+    RETURN_HR_IF(E_INVALIDARG, (pData == nullptr) && (cbData > 0));
+
+    if (m_hFile == INVALID_HANDLE_VALUE)
+    {
+        WCHAR tempPath[MAX_PATH + 1];
+        WCHAR tempFileName[MAX_PATH + 1];
+        RETURN_LAST_ERROR_IF(GetTempPathW(ARRAYSIZE(tempPath), tempPath) == 0);
+        RETURN_LAST_ERROR_IF(GetTempFileNameW(tempPath, L"mrm", 0, tempFileName) == 0);
+
+        m_hFile = CreateFileW(
+            tempFileName,
+            GENERIC_READ | GENERIC_WRITE,
+            0,
+            NULL,
+            CREATE_ALWAYS,
+            FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE,
+            NULL);
+        if (m_hFile == INVALID_HANDLE_VALUE)
+        {
+            HRESULT hr = HRESULT_FROM_WIN32(GetLastError());
+            DeleteFileW(tempFileName);
+            return hr;
+        }
+    }
+
+    OVERLAPPED overlapped = {};
+    overlapped.Offset = static_cast<DWORD>(m_cbFile);
+    overlapped.OffsetHigh = static_cast<DWORD>(m_cbFile >> 32);
+
+    DWORD cbWritten = 0;
+    RETURN_IF_WIN32_BOOL_FALSE(WriteFile(m_hFile, pData, cbData, &cbWritten, &overlapped));
+    RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_WRITE_FAULT), cbWritten != cbData);
+
+    *pFileOffsetOut = m_cbFile;
+    m_cbFile += cbData;
+    m_cbDataInMemory -= min(m_cbDataInMemory, static_cast<UINT64>(cbData));
+
+    return S_OK;
+}
+
+HRESULT DataItemSpillFile::Read(_In_ UINT64 fileOffset, _In_ UINT32 cbData, _Out_writes_bytes_(cbData) BYTE* pDataOut) const
+{
+    RETURN_HR_IF(E_INVALIDARG, (fileOffset > m_cbFile) || (cbData > m_cbFile - fileOffset));
+
+    while (cbData > 0)
+    {
+        OVERLAPPED overlapped = {};
+        overlapped.Offset = static_cast<DWORD>(fileOffset);
+        overlapped.OffsetHigh = static_cast<DWORD>(fileOffset >> 32);
+
+        DWORD cbRead = 0;
+        RETURN_IF_WIN32_BOOL_FALSE(ReadFile(m_hFile, pDataOut, cbData, &cbRead, &overlapped));
+        RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_HANDLE_EOF), cbRead == 0);
+
+        fileOffset += cbRead;
+        cbData -= cbRead;
+        pDataOut += cbRead;
+    }
+
+    return S_OK;
+}
+
 /*
      * DataItemsSectionBuilder
      */
@@ -297,7 +388,12 @@ DataItemsSectionBuilder::DataItemsSectionBuilder() :
     m_cbLargeItemDataUsed(0),
     m_cbLargeItemDataCapacity(0),
     m_pLargeItemData(NULL),
-    m_pLargeItems(NULL)
+    m_pLargeItems(NULL),
+    m_cbLargeItemDataSpilled(0),
+    m_pSpillFile(nullptr),
+    m_numSpilledRanges(0),
+    m_sizeSpilledRanges(0),
+    m_pSpilledRanges(NULL)
 {}
 
 HRESULT DataItemsSectionBuilder::CreateInstance(_Outptr_ DataItemsSectionBuilder** result)
@@ -340,6 +436,25 @@ DataItemsSectionBuilder::~DataItemsSectionBuilder()
         Def_Free(m_pLargeItemData);
         m_pLargeItemData = NULL;
     }
+
+    // The spill file belongs to whoever set it.
+    m_cbLargeItemDataSpilled = 0;
+    m_pSpillFile = nullptr;
+    m_numSpilledRanges = m_sizeSpilledRanges = 0;
+    if (m_pSpilledRanges != NULL)
+    {
+        Def_Free(m_pSpilledRanges);
+        m_pSpilledRanges = NULL;
+    }
+}
+
+HRESULT DataItemsSectionBuilder::SetSpillFile(_In_ DataItemSpillFile* pSpillFile)
+{
+    RETURN_HR_IF_NULL(E_INVALIDARG, pSpillFile);
+    RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_OPERATION), (m_pSpillFile != nullptr) || (m_cbLargeItemDataUsed > 0));
+
+    m_pSpillFile = pSpillFile;
+    return S_OK;
 }
 
 HRESULT DataItemsSectionBuilder::AddDataItem(
@@ -391,16 +506,21 @@ HRESULT DataItemsSectionBuilder::AddDataItem(
     {
         startOffset = _DEFFILE_PAD(m_cbLargeItemDataUsed, align);
 
+        // Offsets are relative to all of the large item data, but only the part that
+        // hasn't been spilled is in memory.
+        int startOffsetInMemory = startOffset - m_cbLargeItemDataSpilled;
+
         // EnsureLargeCapacity takes the total required capacity, not the additional capacity
-        RETURN_IF_FAILED(EnsureLargeItemCapacity(startOffset + cbData));
+        RETURN_IF_FAILED(EnsureLargeItemCapacity(startOffsetInMemory + cbData));
 
-        __analysis_assume((startOffset + cbData) < m_cbLargeItemDataCapacity);
+        __analysis_assume((startOffsetInMemory + cbData) < m_cbLargeItemDataCapacity);
         __analysis_assume((m_numLargeItems < m_sizeLargeItems));
 
         // zero out any pad bytes
         while (m_cbLargeItemDataUsed < startOffset)
         {
-            m_pLargeItemData[m_cbLargeItemDataUsed++] = 0;
+            m_pLargeItemData[m_cbLargeItemDataUsed - m_cbLargeItemDataSpilled] = 0;
+            m_cbLargeItemDataUsed++;
         }
 
         // Data duplicate check can be done:
@@ -408,7 +528,7 @@ HRESULT DataItemsSectionBuilder::AddDataItem(
         // However if there are many duplicate resources that hamper disk footprint, then we can revisit it.
 
         // And copy the data
-        errno_t err = memcpy_s(&m_pLargeItemData[startOffset], (m_cbLargeItemDataCapacity - startOffset), pData, cbData);
+        errno_t err = memcpy_s(&m_pLargeItemData[startOffsetInMemory], (m_cbLargeItemDataCapacity - startOffsetInMemory), pData, cbData);
         RETURN_IF_FAILED(ErrnoToHResult(err));
 
         m_pLargeItems[m_numLargeItems].offset = startOffset;
@@ -417,6 +537,11 @@ HRESULT DataItemsSectionBuilder::AddDataItem(
         pRefOut->isLarge = true;
         pRefOut->index = m_numLargeItems;
 
+        if (m_pSpillFile != nullptr)
+        {
+            m_pSpillFile->NoteDataInMemory(static_cast<UINT32>((startOffset + cbData) - m_cbLargeItemDataUsed));
+        }
+
         m_cbLargeItemDataUsed = startOffset + cbData;
         m_numLargeItems++;
     }
@@ -483,9 +608,22 @@ HRESULT DataItemsSectionBuilder::GetDataBlob(_In_ int itemIndex, _Inout_ BlobRes
         int indexFromLargeBase = itemIndex - m_numSmallItems;
 
         int offset = m_pLargeItems[indexFromLargeBase].offset;
-        RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_RANGE_NOT_FOUND), offset >= m_cbLargeItemDataCapacity);
+        int cbData = m_pLargeItems[indexFromLargeBase].cbData;
 
-        RETURN_IF_FAILED(pBlobResult->SetRef(&m_pLargeItemData[offset], m_pLargeItems[indexFromLargeBase].cbData));
+        if (offset < m_cbLargeItemDataSpilled)
+        {
+            // Items are spilled whole, so this one is entirely in the spill file.
+            BYTE* pData;
+            RETURN_IF_FAILED(pBlobResult->SetEmptyContents(cbData, reinterpret_cast<void**>(&pData)));
+            RETURN_IF_FAILED(ReadSpilledLargeItemData(offset, cbData, pData));
+        }
+        else
+        {
+            int offsetInMemory = offset - m_cbLargeItemDataSpilled;
+            RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_RANGE_NOT_FOUND), offsetInMemory >= m_cbLargeItemDataCapacity);
+
+            RETURN_IF_FAILED(pBlobResult->SetRef(&m_pLargeItemData[offsetInMemory], cbData));
+        }
     }
 
     return S_OK;
@@ -605,10 +743,20 @@ HRESULT DataItemsSectionBuilder::Build(__out_bcount(cbBuffer) VOID* pBuffer, __i
         BYTE* pData = _SECTION_BUILDER_NEXT_ARRAY(data, m_cbLargeItemDataUsed, BYTE, &hr);
         RETURN_IF_FAILED(hr);
 
-        errno_t err = memcpy_s(pData, m_cbLargeItemDataUsed, m_pLargeItemData, m_cbLargeItemDataUsed);
+        // Spilled data goes first, followed by whatever is still in memory.
+        if (m_cbLargeItemDataSpilled > 0)
+        {
+            RETURN_IF_FAILED(ReadSpilledLargeItemData(0, m_cbLargeItemDataSpilled, pData));
+        }
 
-        // ErrnoFailed will set status if something failed.  Just fall through regardless.
-        RETURN_IF_FAILED(ErrnoToHResult(err));
+        int cbInMemory = GetLargeItemDataSizeInMemory();
+        if (cbInMemory > 0)
+        {
+            errno_t err = memcpy_s(&pData[m_cbLargeItemDataSpilled], cbInMemory, m_pLargeItemData, cbInMemory);
+
+            // ErrnoFailed will set status if something failed.  Just fall through regardless.
+            RETURN_IF_FAILED(ErrnoToHResult(err));
+        }
     }
 
     _SECTION_BUILDER_PAD(&data, &hr);
@@ -624,6 +772,80 @@ HRESULT DataItemsSectionBuilder::Build(__out_bcount(cbBuffer) VOID* pBuffer, __i
     return S_OK;
 }
 
+HRESULT DataItemsSectionBuilder::SpillLargeItemData()
+{
+    RETURN_HR_IF(E_DEF_NOT_READY, m_pSpillFile == nullptr);
+
+    int cbInMemory = GetLargeItemDataSizeInMemory();
+    if (cbInMemory == 0)
+    {
+        return S_OK;
+    }
+
+    if (m_numSpilledRanges >= m_sizeSpilledRanges)
+    {
+        int newSize = ((m_sizeSpilledRanges == 0) ? InitialSpilledRangeSize : (m_sizeSpilledRanges * 2));
+        if (!_DefArray_TryEnsureSize(&m_pSpilledRanges, struct SpilledRange, m_sizeSpilledRanges, newSize))
+        {
+            return E_OUTOFMEMORY;
+        }
+        m_sizeSpilledRanges = newSize;
+    }
+
+    UINT64 fileOffset;
+    RETURN_IF_FAILED(m_pSpillFile->Append(m_pLargeItemData, static_cast<UINT32>(cbInMemory), &fileOffset));
+
+    m_pSpilledRanges[m_numSpilledRanges].offset = m_cbLargeItemDataSpilled;
+    m_pSpilledRanges[m_numSpilledRanges].fileOffset = fileOffset;
+    m_numSpilledRanges++;
+    m_cbLargeItemDataSpilled = m_cbLargeItemDataUsed;
+
+    // Give the buffer back; it regrows from the initial capacity as new items are added.
+    Def_Free(m_pLargeItemData);
+    m_pLargeItemData = NULL;
+    m_cbLargeItemDataCapacity = 0;
+
+    return S_OK;
+}
+
+HRESULT DataItemsSectionBuilder::ReadSpilledLargeItemData(__in int offset, __in int cbData, __out_bcount(cbData) BYTE* pDataOut) const
+{
+    RETURN_HR_IF(E_INVALIDARG, (offset < 0) || (cbData < 0) || (offset + cbData > m_cbLargeItemDataSpilled));
+
+    // Find the last range that starts at or before offset. Single items never cross ranges, but
+    // Build reads all of the spilled data at once.
+    int lo = 0;
+    int hi = m_numSpilledRanges - 1;
+    while (lo < hi)
+    {
+        int mid = (lo + hi + 1) / 2;
+        if (m_pSpilledRanges[mid].offset <= offset)
+        {
+            lo = mid;
+        }
+        else
+        {
+            hi = mid - 1;
+        }
+    }
+
+    for (int i = lo; cbData > 0; i++)
+    {
+        RETURN_HR_IF(E_UNEXPECTED, i >= m_numSpilledRanges);
+
+        int rangeEnd = ((i + 1) < m_numSpilledRanges) ? m_pSpilledRanges[i + 1].offset : m_cbLargeItemDataSpilled;
+        int cbFromRange = min(cbData, rangeEnd - offset);
+        UINT64 fileOffset = m_pSpilledRanges[i].fileOffset + static_cast<UINT64>(offset - m_pSpilledRanges[i].offset);
+        RETURN_IF_FAILED(m_pSpillFile->Read(fileOffset, static_cast<UINT32>(cbFromRange), pDataOut));
+
+        offset += cbFromRange;
+        cbData -= cbFromRange;
+        pDataOut += cbFromRange;
+    }
+
+    return S_OK;
+}
+
 HRESULT DataItemsSectionBuilder::EnsureLargeItemCapacity(__in int cbTotal)
 {
     // ensure space for item
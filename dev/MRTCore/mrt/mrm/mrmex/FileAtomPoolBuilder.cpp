@@ -63,7 +63,8 @@ FileAtomPoolBuilder::CreateInstance(
     RETURN_HR_IF(E_INVALIDARG, (pStrings == nullptr) || (pDescription == nullptr));
     RETURN_HR_IF(E_INVALIDARG, wcslen(pDescription) >= FileAtomPool::DescriptionLength);
 
-    UINT32 flags = (isCaseInsensitive ? fIsCaseInsensitive : fDefault) | fIsNotSorted;
+    // These are recorded in the header flags. fBuildHashIndex matches DEFFILE_ATOMPOOL_HASH_INDEX.
+    UINT32 flags = (isCaseInsensitive ? fIsCaseInsensitive : fDefault) | fIsNotSorted | fBuildHashIndex;
     AutoDeletePtr<FileAtomPoolBuilder> pRtrn = new FileAtomPoolBuilder();
     RETURN_IF_NULL_ALLOC(pRtrn);
     RETURN_IF_FAILED(pRtrn->Init(pDescription, pStrings, flags));
@@ -187,6 +188,194 @@ HRESULT FileAtomPoolBuilder::GetOrAddAtom(__in PCWSTR pString, _Out_ Atom* resul
     return S_OK;
 }
 
+struct BulkAtomHashBatch
+{
+    const PCWSTR* ppStrings;
+    DEFFILE_ATOMPOOL_HASHINDEX* pHashes;
+    Atom::HashMethod hashMethod;
+    UINT32 numStrings;
+};
+
+static const UINT32 BulkAtomHashChunkSize = 1024;
+
+// Hashes one chunk of BulkAtomHashChunkSize strings.
+static void RunBulkAtomHashChunk(_Inout_opt_ PVOID pContext, _In_ ULONG index)
+{
+    BulkAtomHashBatch* pBatch = static_cast<BulkAtomHashBatch*>(pContext);
+    UINT32 first = static_cast<UINT32>(index) * BulkAtomHashChunkSize;
+    UINT32 last = min(first + BulkAtomHashChunkSize, pBatch->numStrings);
+    for (UINT32 j = first; j < last; j++)
+    {
+        pBatch->pHashes[j].hash = Atom::HashString(pBatch->ppStrings[j], pBatch->hashMethod);
+        pBatch->pHashes[j].index = static_cast<Atom::Index>(j);
+    }
+}
+
+static int __cdecl CompareHashIndex(_In_ const void* pLeft, _In_ const void* pRight)
+{
+    const DEFFILE_ATOMPOOL_HASHINDEX* pLeftHash = static_cast<const DEFFILE_ATOMPOOL_HASHINDEX*>(pLeft);
+    const DEFFILE_ATOMPOOL_HASHINDEX* pRightHash = static_cast<const DEFFILE_ATOMPOOL_HASHINDEX*>(pRight);
+
+    if (pLeftHash->hash != pRightHash->hash)
+    {
+        return ((pLeftHash->hash < pRightHash->hash) ? -1 : 1);
+    }
+    if (pLeftHash->index != pRightHash->index)
+    {
+        return ((pLeftHash->index < pRightHash->index) ? -1 : 1);
+    }
+    return 0;
+}
+
+HRESULT FileAtomPoolBuilder::GetOrAddAtoms(
+    _In_reads_(numStrings) const PCWSTR* ppStrings,
+    _In_ UINT32 numStrings,
+    _In_ UINT32 maxThreads,
+    _Out_writes_(numStrings) Atom* pAtomsOut)
+{
+    RETURN_HR_IF(E_INVALIDARG, (ppStrings == nullptr) || (pAtomsOut == nullptr));
+    RETURN_HR_IF(E_INVALIDARG, numStrings >= static_cast<UINT32>(Atom::MaxAtomIndex));
+
+    for (UINT32 i = 0; i < numStrings; i++)
+    {
+        pAtomsOut[i] = Atom::NullAtom;
+        RETURN_HR_IF(E_INVALIDARG, DefString_IsEmpty(ppStrings[i]));
+    }
+
+    if (numStrings == 0)
+    {
+        return S_OK;
+    }
+
+    unique_deffree_ptr<DEFFILE_ATOMPOOL_HASHINDEX> pNew(_DefArray_AllocZeroed(DEFFILE_ATOMPOOL_HASHINDEX, numStrings));
+    RETURN_IF_NULL_ALLOC(pNew.get());
+
+    // Hashing is the only part that is independent per string, so it's the part that runs in parallel.
+    BulkAtomHashBatch batch;
+    batch.ppStrings = ppStrings;
+    batch.pHashes = pNew.get();
+    batch.hashMethod = m_hashMethod;
+    batch.numStrings = numStrings;
+
+    UINT32 numChunks = (numStrings + BulkAtomHashChunkSize - 1) / BulkAtomHashChunkSize;
+    RETURN_IF_FAILED(_DefRunParallelForEach(numChunks, maxThreads, RunBulkAtomHashChunk, &batch));
+
+    unique_deffree_ptr<DEFFILE_ATOMPOOL_HASHINDEX> pExisting;
+    if (m_numAtoms > 0)
+    {
+        pExisting.reset(_DefArray_AllocZeroed(DEFFILE_ATOMPOOL_HASHINDEX, m_numAtoms));
+        RETURN_IF_NULL_ALLOC(pExisting.get());
+        memcpy(pExisting.get(), m_hash, m_numAtoms * sizeof(DEFFILE_ATOMPOOL_HASHINDEX));
+        qsort(pExisting.get(), m_numAtoms, sizeof(DEFFILE_ATOMPOOL_HASHINDEX), CompareHashIndex);
+    }
+    qsort(pNew.get(), numStrings, sizeof(DEFFILE_ATOMPOOL_HASHINDEX), CompareHashIndex);
+
+    // For each string, pMatch records its hash and either the index of a matching existing atom or,
+    // encoded as -(n + 1), the first string n in the batch that it duplicates.  Strings that match
+    // neither refer to themselves and become new atoms.
+    unique_deffree_ptr<DEFFILE_ATOMPOOL_HASHINDEX> pMatch(_DefArray_AllocZeroed(DEFFILE_ATOMPOOL_HASHINDEX, numStrings));
+    RETURN_IF_NULL_ALLOC(pMatch.get());
+
+    const DEFFILE_ATOMPOOL_HASHINDEX* pSortedNew = pNew.get();
+    const DEFFILE_ATOMPOOL_HASHINDEX* pSortedExisting = pExisting.get();
+    DEFCOMPAREOPTIONS compareOptions = (GetIsCaseInsensitive() ? DefCompare_CaseInsensitive : DefCompare_Default);
+    UINT32 numNewAtoms = 0;
+    size_t cchNewAtoms = 0;
+    Atom::Index nextExisting = 0;
+
+    for (UINT32 runStart = 0, runEnd = 0; runStart < numStrings; runStart = runEnd)
+    {
+        Atom::Hash hash = pSortedNew[runStart].hash;
+        for (runEnd = runStart + 1; (runEnd < numStrings) && (pSortedNew[runEnd].hash == hash); runEnd++)
+        {
+        }
+
+        while ((nextExisting < m_numAtoms) && (pSortedExisting[nextExisting].hash < hash))
+        {
+            nextExisting++;
+        }
+        Atom::Index existingEnd = nextExisting;
+        while ((existingEnd < m_numAtoms) && (pSortedExisting[existingEnd].hash == hash))
+        {
+            existingEnd++;
+        }
+
+        // Runs are sorted by position in the batch, so the first of any set of duplicates is seen first.
+        for (UINT32 i = runStart; i < runEnd; i++)
+        {
+            Atom::Index stringIndex = pSortedNew[i].index;
+            PCWSTR pString = ppStrings[stringIndex];
+            bool found = false;
+            pMatch.get()[stringIndex].hash = hash;
+
+            for (Atom::Index j = nextExisting; (j < existingEnd) && !found; j++)
+            {
+                if (m_pStrings->Equals(m_offset[pSortedExisting[j].index], pString))
+                {
+                    pMatch.get()[stringIndex].index = pSortedExisting[j].index;
+                    found = true;
+                }
+            }
+
+            for (UINT32 j = runStart; (j < i) && !found; j++)
+            {
+                Atom::Index otherIndex = pSortedNew[j].index;
+                if ((pMatch.get()[otherIndex].index == -(otherIndex + 1)) &&
+                    (DefString_CompareWithOptions(ppStrings[otherIndex], pString, compareOptions) == Def_Equal))
+                {
+                    pMatch.get()[stringIndex].index = -(otherIndex + 1);
+                    found = true;
+                }
+            }
+
+            if (!found)
+            {
+                pMatch.get()[stringIndex].index = -(stringIndex + 1);
+                numNewAtoms++;
+                cchNewAtoms += wcslen(pString) + 1;
+            }
+        }
+    }
+
+    if (numNewAtoms > 0)
+    {
+        RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_ARITHMETIC_OVERFLOW), cchNewAtoms > UINT32_MAX);
+        RETURN_IF_FAILED(Extend(m_numAtoms + numNewAtoms));
+        RETURN_IF_FAILED(m_pStrings->EnsureCapacity(static_cast<UINT32>(cchNewAtoms)));
+        m_finalized = false;
+    }
+
+    // Assign new atoms and add their strings in batch order, so that indexes and string offsets match
+    // what GetOrAddAtom would have produced.  A new atom can still reuse the bytes of a string that is
+    // already in the pool (for example when it is a suffix of one), so every string goes through the same
+    // search GetOrAddAtom uses.
+    for (UINT32 i = 0; i < numStrings; i++)
+    {
+        Atom::Index match = pMatch.get()[i].index;
+        if (match >= 0)
+        {
+            pAtomsOut[i].Set(match, m_poolIndex);
+        }
+        else if (match != -static_cast<Atom::Index>(i + 1))
+        {
+            pAtomsOut[i] = pAtomsOut[-(match + 1)];
+        }
+        else
+        {
+            m_hash[m_numAtoms].hash = pMatch.get()[i].hash;
+            m_hash[m_numAtoms].index = m_numAtoms;
+
+            m_offset[m_numAtoms] = m_pStrings->GetOrAddStringOffset(ppStrings[i]);
+            RETURN_HR_IF(E_ABORT, m_offset[m_numAtoms] == -1);
+
+            pAtomsOut[i].Set(m_numAtoms, m_poolIndex);
+            m_numAtoms++;
+        }
+    }
+
+    return S_OK;
+}
+
 HRESULT FileAtomPoolBuilder::GetString(Atom atom, _Out_ PCWSTR* result) const
 {
     *result = nullptr;
@@ -372,7 +561,13 @@ FileAtomPoolBuilder::GetMaxSizeInBytes() const
     {
         return 0;
     }
-    return FileAtomPool::GetSizeInBytes(m_numAtoms, m_pStrings->GetNumCharsInPool());
+
+    UINT32 cbSize = FileAtomPool::GetSizeInBytes(m_numAtoms, m_pStrings->GetNumCharsInPool());
+    if (m_flags & fBuildHashIndex)
+    {
+        cbSize = _DEFFILE_PAD_SECTION(cbSize) + FileAtomPool::GetHashIndexSizeInBytes(m_numAtoms);
+    }
+    return cbSize;
 }
 
 HRESULT FileAtomPoolBuilder::Build(__out_bcount(cbBuffer) VOID* pBuffer, UINT32 cbBuffer, __out_opt UINT32* pcbWritten) const
@@ -434,6 +629,20 @@ HRESULT FileAtomPoolBuilder::Build(__out_bcount(cbBuffer) VOID* pBuffer, UINT32
     err = memcpy_s(pChars, cbData, m_pStrings->GetBuffer(), cbData);
     RETURN_IF_FAILED(ErrnoToHResult(err));
 
+    if (m_flags & fBuildHashIndex)
+    {
+        UINT32 numBuckets = FileAtomPool::GetHashIndexNumBuckets(m_numAtoms);
+
+        _SECTION_BUILDER_PAD(&data, &hr);
+        DEFFILE_ATOMPOOL_HASH_INDEX_HEADER* pIndexHeader = _SECTION_BUILDER_NEXT(data, DEFFILE_ATOMPOOL_HASH_INDEX_HEADER, &hr);
+        DEFFILE_ATOMPOOL_HASHINDEX* pBuckets = _SECTION_BUILDER_NEXT_ARRAY(data, numBuckets, DEFFILE_ATOMPOOL_HASHINDEX, &hr);
+        RETURN_IF_FAILED(hr);
+
+        pIndexHeader->numBuckets = numBuckets;
+        pIndexHeader->reserved = 0;
+        RETURN_IF_FAILED(FileAtomPool::BuildHashIndex(m_hash, m_numAtoms, pBuckets, numBuckets));
+    }
+
     if (pcbWritten)
     {
         *pcbWritten = (UINT32)data.UsedBufferSizeInBytes();
@@ -20,7 +20,8 @@ FileBuilder::FileBuilder(__in DEFFILE_MAGIC magic) :
     m_pToc(NULL),
     m_pSectionData(NULL),
     m_cbSectionData(0),
-    m_nSectionDataUsed(0)
+    m_nSectionDataUsed(0),
+    m_maxBuildThreads(0)
 {}
 
 FileBuilder::~FileBuilder()
@@ -339,15 +340,89 @@ HRESULT FileBuilder::BuildAllSections()
 {
     RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_OPERATION), m_phase != Generating);
 
-    for (int i = 0; i < m_nSections; i++)
+    int i = 0;
+    while (i < m_nSections)
+    {
+        // A section that can't be built concurrently waits for every section before it and holds up every
+        // section after it, so only runs of adjacent concurrent sections are built in parallel.
+        int runEnd = i;
+        if (m_maxBuildThreads > 1)
+        {
+            while ((runEnd < m_nSections) && m_pSections[runEnd].m_pSectionBuilder->CanBuildConcurrently())
+            {
+                runEnd++;
+            }
+        }
+
+        if ((runEnd - i) > 1)
+        {
+            RETURN_IF_FAILED(BuildSectionsConcurrently(
+                static_cast<BaseFile::SectionIndex>(i), static_cast<BaseFile::SectionCount>(runEnd - i)));
+            i = runEnd;
+        }
+        else
+        {
+            RETURN_IF_FAILED(BuildSection(static_cast<BaseFile::SectionIndex>(i)));
+            i++;
+        }
+    }
+
+    return S_OK;
+}
+
+HRESULT FileBuilder::BuildSection(__in BaseFile::SectionIndex sectionIndex)
+{
+    FileBuilder::SectionInfo* pSectionInfo;
+    UINT32 cbWritten = 0;
+    RETURN_IF_FAILED(StartSection(sectionIndex, &pSectionInfo));
+
+    RETURN_IF_FAILED(pSectionInfo->m_pSectionBuilder->Build(pSectionInfo->m_pSectionData, pSectionInfo->m_cbSectionData, &cbWritten));
+    RETURN_IF_FAILED(FinishSection(sectionIndex, cbWritten));
+
+    return S_OK;
+}
+
+struct ConcurrentSectionBuild
+{
+    const ISectionBuilder* pSectionBuilder;
+    BYTE* pSectionData;
+    UINT32 cbSectionData;
+    UINT32 cbWritten;
+    HRESULT hr;
+};
+
+static void BuildConcurrentSection(_Inout_opt_ PVOID pContext, _In_ ULONG index)
+{
+    ConcurrentSectionBuild* pBuild = &static_cast<ConcurrentSectionBuild*>(pContext)[index];
+    pBuild->hr = pBuild->pSectionBuilder->Build(pBuild->pSectionData, pBuild->cbSectionData, &pBuild->cbWritten);
+}
+
+HRESULT FileBuilder::BuildSectionsConcurrently(__in BaseFile::SectionIndex firstSectionIndex, __in BaseFile::SectionCount numSections)
+{
+    RETURN_HR_IF(E_INVALIDARG, (numSections < 1) || ((firstSectionIndex + numSections) > m_nSections));
+
+    unique_deffree_ptr<ConcurrentSectionBuild> pBuilds(_DefArray_AllocZeroed(ConcurrentSectionBuild, numSections));
+    RETURN_IF_NULL_ALLOC(pBuilds.get());
+
+    // Reserve every slice before building any of them.  FinishSection never moves the end of the reserved
+    // data, so each slice starts exactly where it would in a serial build and the output is identical.
+    for (int i = 0; i < numSections; i++)
     {
-        BaseFile::SectionIndex sectionIndex = m_pSections[i].m_pSectionBuilder->GetSectionIndex();
         FileBuilder::SectionInfo* pSectionInfo;
-        UINT32 cbWritten = 0;
-        RETURN_IF_FAILED(StartSection(sectionIndex, &pSectionInfo));
+        RETURN_IF_FAILED(StartSection(static_cast<BaseFile::SectionIndex>(firstSectionIndex + i), &pSectionInfo));
 
-        RETURN_IF_FAILED(m_pSections[i].m_pSectionBuilder->Build(pSectionInfo->m_pSectionData, pSectionInfo->m_cbSectionData, &cbWritten));
-        RETURN_IF_FAILED(FinishSection(sectionIndex, cbWritten));
+        pBuilds.get()[i].pSectionBuilder = pSectionInfo->m_pSectionBuilder;
+        pBuilds.get()[i].pSectionData = pSectionInfo->m_pSectionData;
+        pBuilds.get()[i].cbSectionData = pSectionInfo->m_cbSectionData;
+        pBuilds.get()[i].hr = E_ABORT;
+    }
+
+    RETURN_IF_FAILED(_DefRunParallelForEach(numSections, m_maxBuildThreads, BuildConcurrentSection, pBuilds.get()));
+
+    for (int i = 0; i < numSections; i++)
+    {
+        RETURN_IF_FAILED(pBuilds.get()[i].hr);
+        RETURN_IF_FAILED(FinishSection(static_cast<BaseFile::SectionIndex>(firstSectionIndex + i), pBuilds.get()[i].cbWritten));
     }
 
     return S_OK;
@@ -141,6 +141,9 @@ HRESULT ItemInfo::AddToGlobal(_In_ ScopeInfo* parent)
 ScopeInfo::ScopeInfo(_In_ ScopeInfo* pParent) :
     HNamesNode(pParent),
     m_pChildren(nullptr),
+    m_pChildIndex(nullptr),
+    m_numChildIndexBuckets(0),
+    m_childrenSorted(true),
     m_numChildScopes(0),
     m_numChildItems(0),
     m_totalNumItems(0),
@@ -153,6 +156,9 @@ ScopeInfo::ScopeInfo(_In_ ScopeInfo* pParent) :
 ScopeInfo::ScopeInfo(__in IHNamesGlobalNodes* pGlobalNodes) :
     HNamesNode(pGlobalNodes->GetConfig()),
     m_pChildren(nullptr),
+    m_pChildIndex(nullptr),
+    m_numChildIndexBuckets(0),
+    m_childrenSorted(true),
     m_numChildScopes(0),
     m_numChildItems(0),
     m_totalNumItems(0),
@@ -180,6 +186,7 @@ HRESULT ScopeInfo::Init(_In_ const HierarchicalNameSegment* name)
 ScopeInfo::~ScopeInfo()
 {
     delete m_pChildren;
+    _DefFree(m_pChildIndex);
     // GlobalNodes owns the scopes and items and is responsible for deleting them
 }
 
@@ -224,6 +231,8 @@ HRESULT ScopeInfo::AddToGlobal(_In_ ScopeInfo* /*parent*/)
 
 HNamesNode* ScopeInfo::GetChild(UINT i) const
 {
+    EnsureChildrenSorted();
+
     if (i < m_pChildren->Count())
     {
         HNamesNode* node;
@@ -250,6 +259,7 @@ bool ScopeInfo::TryGetChild(_In_ int index, _Outptr_opt_result_maybenull_ HNames
         return false;
     }
 
+    EnsureChildrenSorted();
     return (SUCCEEDED(m_pChildren->Get(static_cast<UINT>(index), ppChildOut)));
 }
 
@@ -260,6 +270,21 @@ bool ScopeInfo::TryGetChild(_In_ const HierarchicalNameSegment* pName, _Outptr_o
         *ppChildOut = nullptr;
     }
 
+    if (m_pGlobalNodes->IsChildSortDeferred())
+    {
+        HNamesNode* pChild;
+        if (!TryGetIndexedChild(pName->GetName(), ComputeChildIndexHash(pName->GetName()), &pChild))
+        {
+            return false;
+        }
+
+        if (ppChildOut != nullptr)
+        {
+            *ppChildOut = pChild;
+        }
+        return true;
+    }
+
     int startSearch = -1;
     int endSearch = -1;
     int insert = -1;
@@ -646,6 +671,23 @@ HRESULT ScopeInfo::GetOrAddChildNode(_In_ HNamesNode* newNode, _Out_ HNamesNode*
 {
     *foundNode = nullptr;
 
+    if (m_pGlobalNodes->IsChildSortDeferred())
+    {
+        // Look the name up in the hash index and append new children unsorted.  EnsureChildrenSorted puts them
+        // in order once, instead of shifting the array on every insert.
+        UINT32 hash = ComputeChildIndexHash(newNode->GetName());
+        if (TryGetIndexedChild(newNode->GetName(), hash, foundNode))
+        {
+            return S_OK;
+        }
+
+        RETURN_IF_FAILED(EnsureChildIndexCapacity());
+        RETURN_IF_FAILED(m_pChildren->Add(newNode));
+        AddIndexedChild(newNode, hash);
+        m_childrenSorted = false;
+        return S_OK;
+    }
+
     int startSearch = -1;
     int endSearch = -1;
     int insert = -1;
@@ -672,6 +714,124 @@ HRESULT ScopeInfo::GetOrAddChildNode(_In_ HNamesNode* newNode, _Out_ HNamesNode*
     return S_OK;
 }
 
+UINT32 ScopeInfo::ComputeChildIndexHash(_In_ PCWSTR pName) const
+{
+    // GetOrAddChildNode treats two names as equal when their initial characters match and a case-insensitive
+    // ordinal comparison says they're equal.  The ordinal comparison uses the operating system's upper case
+    // table, which also maps a few non-ASCII characters (dotless i, long s) to ASCII letters, so only fold ASCII
+    // case here and give every character that could be one of those variants the same value.
+    UINT32 hash = 2166136261;
+    hash = (hash ^ GetConfig()->GetSegmentInitialChar(pName)) * 16777619;
+    for (PCWSTR pNext = pName; *pNext != L'\0'; pNext++)
+    {
+        WCHAR ch = *pNext;
+        if ((ch >= L'a') && (ch <= L'z'))
+        {
+            ch -= (L'a' - L'A');
+        }
+
+        if ((ch > 0x7F) || (ch == L'I') || (ch == L'S'))
+        {
+            ch = 0xFFFF;
+        }
+        hash = (hash ^ ch) * 16777619;
+    }
+    return hash;
+}
+
+bool ScopeInfo::TryGetIndexedChild(_In_ PCWSTR pName, _In_ UINT32 hash, _Outptr_result_maybenull_ HNamesNode** ppChildOut) const
+{
+    *ppChildOut = nullptr;
+
+    if (m_pChildIndex == nullptr)
+    {
+        return false;
+    }
+
+    WCHAR initialChar = GetConfig()->GetSegmentInitialChar(pName);
+    for (UINT32 bucket = (hash & (m_numChildIndexBuckets - 1)); m_pChildIndex[bucket].pNode != nullptr;
+         bucket = ((bucket + 1) & (m_numChildIndexBuckets - 1)))
+    {
+        HNamesNode* pNode = m_pChildIndex[bucket].pNode;
+        if ((m_pChildIndex[bucket].hash == hash) && (pNode->GetInitialChar() == initialChar) &&
+            (DefString_ICompare(pName, pNode->GetName()) == Def_Equal))
+        {
+            *ppChildOut = pNode;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Makes sure the child index can take one more child while staying at most two-thirds full.
+HRESULT ScopeInfo::EnsureChildIndexCapacity()
+{
+    UINT32 numChildren = m_pChildren->Count();
+    if ((m_pChildIndex != nullptr) && (((numChildren + 1) * 3) <= (m_numChildIndexBuckets * 2)))
+    {
+        return S_OK;
+    }
+
+    UINT32 numBuckets = ((m_numChildIndexBuckets > 0) ? m_numChildIndexBuckets * 2 : InitialNumChildIndexBuckets);
+    RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_MRM_TOO_MANY_RESOURCES), numBuckets <= m_numChildIndexBuckets);
+
+    ChildIndexEntry* pOldIndex = m_pChildIndex;
+    UINT32 numOldBuckets = m_numChildIndexBuckets;
+
+    m_pChildIndex = _DefArray_AllocZeroed(ChildIndexEntry, numBuckets);
+    if (m_pChildIndex == nullptr)
+    {
+        m_pChildIndex = pOldIndex;
+        return E_OUTOFMEMORY;
+    }
+    m_numChildIndexBuckets = numBuckets;
+
+    for (UINT32 i = 0; i < numOldBuckets; i++)
+    {
+        if (pOldIndex[i].pNode != nullptr)
+        {
+            AddIndexedChild(pOldIndex[i].pNode, pOldIndex[i].hash);
+        }
+    }
+    _DefFree(pOldIndex);
+
+    return S_OK;
+}
+
+void ScopeInfo::AddIndexedChild(_In_ HNamesNode* pChild, _In_ UINT32 hash)
+{
+    UINT32 bucket = (hash & (m_numChildIndexBuckets - 1));
+    while (m_pChildIndex[bucket].pNode != nullptr)
+    {
+        bucket = ((bucket + 1) & (m_numChildIndexBuckets - 1));
+    }
+    m_pChildIndex[bucket].hash = hash;
+    m_pChildIndex[bucket].pNode = pChild;
+}
+
+// Orders children the way FindSearchRange and FindInsertionPoint place them: by initial character, then by
+// case-insensitive name.  Names in a scope are unique under that ordering, so there are no ties.
+static int __cdecl CompareChildOrder(_In_ const void* pLeft, _In_ const void* pRight)
+{
+    const HNamesNode* pLeftNode = *static_cast<HNamesNode* const*>(pLeft);
+    const HNamesNode* pRightNode = *static_cast<HNamesNode* const*>(pRight);
+
+    if (pLeftNode->GetInitialChar() != pRightNode->GetInitialChar())
+    {
+        return ((pLeftNode->GetInitialChar() < pRightNode->GetInitialChar()) ? -1 : 1);
+    }
+    return DefString_ICompare(pLeftNode->GetName(), pRightNode->GetName());
+}
+
+void ScopeInfo::EnsureChildrenSorted() const
+{
+    if (!m_childrenSorted)
+    {
+        qsort(m_pChildren->GetAll(), m_pChildren->Count(), sizeof(HNamesNode*), CompareChildOrder);
+        m_childrenSorted = true;
+    }
+}
+
 class HNamesNodeAtomPool : public IAtomPool
 {
 public:
@@ -845,6 +1005,7 @@ protected:
 HierarchicalNamesBuilder::HierarchicalNamesBuilder(_In_ UINT32 flags) :
     m_sectionIndex(-1),
     m_numFinalizedNames(-1),
+    m_numPathIndexBuckets(0),
     m_pScopeNames(nullptr),
     m_pItemNames(nullptr),
     m_flags(flags),
@@ -1198,9 +1359,22 @@ HierarchicalNamesBuilder::GetMaxSizeInBytes() const
     totalSize += m_cchFinalizedUtf16Names * sizeof(WCHAR);
     totalSize += m_cchFinalizedAsciiNames * sizeof(char);
     totalSize = _DEFFILE_PAD_SECTION(totalSize);
+    totalSize += GetPathIndexSizeInBytes();
+    totalSize = _DEFFILE_PAD_SECTION(totalSize);
     return totalSize;
 }
 
+UINT32 HierarchicalNamesBuilder::GetPathIndexSizeInBytes() const
+{
+    if ((m_flags & BuildPathIndex) == 0)
+    {
+        return 0;
+    }
+
+    return sizeof(DEFFILE_HNAMES_PATH_INDEX_HEADER) + (m_numPathIndexBuckets * sizeof(DEFFILE_HNAMES_PATH_INDEX_ENTRY)) +
+           (GetNumScopes() * sizeof(UINT32));
+}
+
 bool HierarchicalNamesBuilder::AssignChildNameIndices(__in ScopeInfo* pScope, __in int* pNextNameIndex)
 {
     int childIndex = *pNextNameIndex;
@@ -1226,6 +1400,8 @@ HRESULT HierarchicalNamesBuilder::Finalize()
 {
     m_pRootScope->SetNameIndex(0);
 
+    // With BuildDeferChildSort, this is also where each scope's children get sorted, because
+    // AssignChildNameIndices walks every scope's children in order.
     int nextIndex = 1;
     if (!AssignChildNameIndices(m_pRootScope, &nextIndex))
     {
@@ -1270,6 +1446,64 @@ HRESULT HierarchicalNamesBuilder::Finalize()
         m_cchFinalizedUtf16Names++;
     }
 
+    if (m_flags & BuildPathIndex)
+    {
+        // Every name but the root is indexed. Keep the table at most two-thirds full.
+        // There are at most INT_MAX names, so this can't overflow.
+        UINT32 numIndexed = static_cast<UINT32>(m_numFinalizedNames - 1);
+        UINT32 minBuckets = numIndexed + (numIndexed / 2) + 1;
+
+        m_numPathIndexBuckets = 2;
+        while (m_numPathIndexBuckets < minBuckets)
+        {
+            RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_MRM_TOO_MANY_RESOURCES), m_numPathIndexBuckets > (UINT_MAX / 2));
+            m_numPathIndexBuckets *= 2;
+        }
+    }
+
+    return S_OK;
+}
+
+HRESULT HierarchicalNamesBuilder::BuildPathIndex(
+    _In_ const ScopeInfo* pScope,
+    _In_ UINT32 scopePathHash,
+    _Inout_updates_(numBuckets) DEFFILE_HNAMES_PATH_INDEX_ENTRY* pBuckets,
+    _In_ UINT32 numBuckets,
+    _Inout_updates_(numScopes) UINT32* pScopePathHashes,
+    _In_ UINT32 numScopes) const
+{
+    RETURN_HR_IF(E_INVALIDARG, (pScope->GetIndex() < 0) || (static_cast<UINT32>(pScope->GetIndex()) >= numScopes));
+    pScopePathHashes[pScope->GetIndex()] = scopePathHash;
+
+    // Children of the root have no leading separator.
+    UINT32 prefixHash = ((pScope != m_pRootScope) ? HNamesHashPathChar(scopePathHash, GetDefaultPathSeparator()) : scopePathHash);
+
+    HNamesNode* pChild = pScope->GetFirstChild();
+    UINT index = 1;
+    while (pChild != nullptr)
+    {
+        UINT32 childPathHash = prefixHash;
+        for (PCWSTR pName = pChild->GetName(); *pName != L'\0'; pName++)
+        {
+            childPathHash = HNamesHashPathChar(childPathHash, *pName);
+        }
+
+        // Linear probing. Finalize sized the table so that there is always an empty bucket.
+        UINT32 bucket = childPathHash & (numBuckets - 1);
+        while (pBuckets[bucket].nodeIndex != 0)
+        {
+            bucket = (bucket + 1) & (numBuckets - 1);
+        }
+        pBuckets[bucket].pathHash = childPathHash;
+        pBuckets[bucket].nodeIndex = pChild->GetNameIndex();
+
+        if (pChild->IsScope())
+        {
+            RETURN_IF_FAILED(BuildPathIndex(pChild->ToScope(), childPathHash, pBuckets, numBuckets, pScopePathHashes, numScopes));
+        }
+        pChild = pScope->GetChild(index++);
+    }
+
     return S_OK;
 }
 
@@ -1466,14 +1700,31 @@ HRESULT HierarchicalNamesBuilder::Build(__out_bcount(cbBuffer) VOID* pBuffer, UI
     pAsciiNames = _SECTION_BUILDER_NEXT_ARRAY(data, m_cchFinalizedAsciiNames, char, &hr);
     _SECTION_BUILDER_PAD(&data, &hr);
 
+    DEFFILE_HNAMES_PATH_INDEX_HEADER* pPathIndex = nullptr;
+    DEFFILE_HNAMES_PATH_INDEX_ENTRY* pPathIndexEntries = nullptr;
+    UINT32* pScopePathHashes = nullptr;
+    if (m_flags & BuildPathIndex)
+    {
+        pPathIndex = _SECTION_BUILDER_NEXT(data, DEFFILE_HNAMES_PATH_INDEX_HEADER, &hr);
+        pPathIndexEntries = _SECTION_BUILDER_NEXT_ARRAY(data, m_numPathIndexBuckets, DEFFILE_HNAMES_PATH_INDEX_ENTRY, &hr);
+        pScopePathHashes = _SECTION_BUILDER_NEXT_ARRAY(data, GetNumScopes(), UINT32, &hr);
+        _SECTION_BUILDER_PAD(&data, &hr);
+    }
+
     RETURN_IF_FAILED(hr);
 
+    UINT32 headerFlags = ((m_flags & BuildLargeHNamesNode) ? DEFFILE_HNAMES_FLAGS_LARGE : 0);
+    if (pPathIndex != nullptr)
+    {
+        headerFlags |= DEFFILE_HNAMES_FLAGS_PATH_INDEX;
+    }
+
     if (useExtendedHNames)
     {
         DEFFILE_HNAMES_HEADER_EX* pHeaderEx = static_cast<DEFFILE_HNAMES_HEADER_EX*>(pHeaderUnknownType);
 
         pHeaderEx->cchLongestPath = static_cast<UINT16>(m_cchLongestFinalizedName);
-        pHeaderEx->flags = (m_flags & BuildLargeHNamesNode) ? DEFFILE_HNAMES_FLAGS_LARGE : 0;
+        pHeaderEx->flags = static_cast<UINT16>(headerFlags);
         pHeaderEx->numNodes = GetNumNames();
         pHeaderEx->numScopes = GetNumScopes();
         pHeaderEx->numItems = GetNumItems();
@@ -1486,7 +1737,7 @@ HRESULT HierarchicalNamesBuilder::Build(__out_bcount(cbBuffer) VOID* pBuffer, UI
         DEFFILE_HNAMES_HEADER* pHeader = static_cast<DEFFILE_HNAMES_HEADER*>(pHeaderUnknownType);
 
         pHeader->cchLongestPath = static_cast<UINT16>(m_cchLongestFinalizedName);
-        pHeader->flags = (m_flags & BuildLargeHNamesNode) ? DEFFILE_HNAMES_FLAGS_LARGE : 0;
+        pHeader->flags = static_cast<UINT16>(headerFlags);
         pHeader->numNodes = GetNumNames();
         pHeader->numScopes = GetNumScopes();
         pHeader->numItems = GetNumItems();
@@ -1590,6 +1841,15 @@ HRESULT HierarchicalNamesBuilder::Build(__out_bcount(cbBuffer) VOID* pBuffer, UI
         }
     }
 
+    if (pPathIndex != nullptr)
+    {
+        pPathIndex->numBuckets = m_numPathIndexBuckets;
+        pPathIndex->numScopeHashes = GetNumScopes();
+        ZeroMemory(pPathIndexEntries, m_numPathIndexBuckets * sizeof(DEFFILE_HNAMES_PATH_INDEX_ENTRY));
+        RETURN_IF_FAILED(BuildPathIndex(
+            m_pRootScope, DEFFILE_HNAMES_PATH_HASH_SEED, pPathIndexEntries, m_numPathIndexBuckets, pScopePathHashes, GetNumScopes()));
+    }
+
     if (pcbWrittenOut != nullptr)
     {
         *pcbWrittenOut = static_cast<UINT32>(data.UsedBufferSizeInBytes());
@@ -113,6 +113,9 @@ HRESULT HierarchicalSchemaSectionBuilder::Init(
     UINT32 namesBuildFlags =
         (((m_buildFlags & MrmBuildConfiguration::UseOptimalSchemaEncodingFlag) == 0) ? HierarchicalNamesBuilder::BuildUtf16Only :
                                                                                        HierarchicalNamesBuilder::BuildAsciiOrUtf16);
+    // Resource lookups go through the schema names, so index them by full path.
+    // Sorting each scope once at Finalize produces the same section and is much faster for large, flat scopes.
+    namesBuildFlags |= (HierarchicalNamesBuilder::BuildPathIndex | HierarchicalNamesBuilder::BuildDeferChildSort);
 
     RETURN_IF_FAILED(HierarchicalNamesBuilder::CreateInstance(namesBuildFlags, pPriBuilder->GetAtoms(), &m_pNames));
 
@@ -142,12 +145,15 @@ HierarchicalSchemaSectionBuilder::Init(
     UINT32 namesBuildFlags =
         (((m_buildFlags & MrmBuildConfiguration::UseOptimalSchemaEncodingFlag) == 0) ? HierarchicalNamesBuilder::BuildUtf16Only :
                                                                                        HierarchicalNamesBuilder::BuildAsciiOrUtf16);
+    // Resource lookups go through the schema names, so index them by full path.
+    // Sorting each scope once at Finalize produces the same section and is much faster for large, flat scopes.
+    namesBuildFlags |= (HierarchicalNamesBuilder::BuildPathIndex | HierarchicalNamesBuilder::BuildDeferChildSort);
 
     RETURN_IF_FAILED(HierarchicalNamesBuilder::CreateInstance(namesBuildFlags, pPriBuilder->GetAtoms(), &m_pNames));
 
-    if ((m_priBuildType & PriBuildType::PriBuildForDeploymentMerge) == 0)
+    if ((m_priBuildType & (PriBuildType::PriBuildForDeploymentMerge | PriBuildType::PriBuildIncremental)) == 0)
     {
-        // When PriBuildForDeploymentMerge is set, the previous schema should not
+        // When PriBuildForDeploymentMerge or PriBuildIncremental is set, the previous schema should not
         // be unmapped as it can be read at the end of Build of the schema section.
         RETURN_IF_FAILED(ReadPreviousSchemaContents());
     }
@@ -278,6 +284,12 @@ HRESULT HierarchicalSchemaSectionBuilder::GetOrAddScope(PCWSTR pScopeName, int*
     *index = -1;
     if (m_pPreviousSchema != nullptr)
     {
+        // An incremental build only needs to rebuild the schema if a name is added.
+        if (((m_priBuildType & PriBuildType::PriBuildIncremental) != 0) && ContainsScope(pScopeName, index))
+        {
+            return S_OK;
+        }
+
         RETURN_IF_FAILED(ReadPreviousSchemaContents());
     }
 
@@ -301,6 +313,11 @@ HRESULT HierarchicalSchemaSectionBuilder::GetOrAddItem(PCWSTR pItemName, int* in
     *index = -1;
     if (m_pPreviousSchema != nullptr)
     {
+        if (((m_priBuildType & PriBuildType::PriBuildIncremental) != 0) && ContainsItem(pItemName, index))
+        {
+            return S_OK;
+        }
+
         RETURN_IF_FAILED(ReadPreviousSchemaContents());
     }
 
@@ -674,6 +691,9 @@ HRESULT HierarchicalSchemaSectionBuilder::Finalize()
     }
 
     m_finalized = true;
+
+    // Create the version info here rather than on first use so that Build doesn't modify the schema.
+    RETURN_HR_IF(E_ABORT, GetVersionInfo(0) == nullptr);
     return S_OK;
 }
 
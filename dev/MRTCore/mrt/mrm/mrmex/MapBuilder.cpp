@@ -1164,6 +1164,14 @@ bool ResourceMapSectionBuilder::TryGetCandidateInfo(
     return TryGetCandidateInfo(itemIndex, candidateIndex, pQualifierSetOut, pTypeOut, pValueOut);
 }
 
+bool ResourceMapSectionBuilder::HasCandidateForQualifierSet(_In_ PCWSTR pItemName, _In_ int qualifierSetIndex) const
+{
+    int itemIndex = -1;
+    const BUILDER_CANDIDATE* pCandidate;
+
+    return m_pSchema->ContainsItem(pItemName, &itemIndex) && m_pItems->TryFindCandidateForQualifierSet(itemIndex, qualifierSetIndex, &pCandidate);
+}
+
 bool ResourceMapSectionBuilder::TryGetCandidateInfo(
     _In_ PCWSTR pItemName,
     _In_ int candidateIndex,
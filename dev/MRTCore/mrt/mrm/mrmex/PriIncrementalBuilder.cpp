@@ -0,0 +1,194 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#include "StdAfx.h"
+
+namespace Microsoft::Resources::Build
+{
+
+HRESULT PriIncrementalBuilder::CreateInstance(_In_ PCWSTR pPreviousPriFile, _In_ CoreProfile* pProfile, _Outptr_ PriIncrementalBuilder** result)
+{
+    *result = nullptr;
+
+    AutoDeletePtr<PriIncrementalBuilder> pRtrn = new PriIncrementalBuilder();
+    RETURN_IF_NULL_ALLOC(pRtrn);
+    RETURN_IF_FAILED(pRtrn->Init(pPreviousPriFile, pProfile));
+
+    *result = pRtrn.Detach();
+    return S_OK;
+}
+
+PriIncrementalBuilder::PriIncrementalBuilder() :
+    m_pPreviousPri(nullptr),
+    m_pPreviousMap(nullptr),
+    m_pPriFileBuilder(nullptr),
+    m_pRemovedCandidates(nullptr),
+    m_bMergedPreviousCandidates(false)
+{}
+
+PriIncrementalBuilder::~PriIncrementalBuilder()
+{
+    // The builder can still refer to the previous schema, so release it first.
+    delete m_pPriFileBuilder;
+    delete m_pRemovedCandidates;
+    delete m_pPreviousPri;
+
+    m_pPriFileBuilder = nullptr;
+    m_pRemovedCandidates = nullptr;
+    m_pPreviousPri = nullptr;
+    m_pPreviousMap = nullptr;
+}
+
+HRESULT PriIncrementalBuilder::Init(_In_ PCWSTR pPreviousPriFile, _In_ CoreProfile* pProfile)
+{
+    RETURN_HR_IF(E_INVALIDARG, DefString_IsEmpty(pPreviousPriFile) || (pProfile == nullptr));
+
+    // Load rather than map the previous file so that the new file can replace it.
+    RETURN_IF_FAILED(StandalonePriFile::CreateInstance(BaseFile::LoadFileFlag, pPreviousPriFile, pProfile, &m_pPreviousPri));
+    RETURN_IF_FAILED(m_pPreviousPri->GetPrimaryResourceMap(&m_pPreviousMap));
+
+    const IHierarchicalSchema* pPreviousSchema;
+    RETURN_IF_FAILED(m_pPreviousPri->GetPrimarySchema(&pPreviousSchema));
+
+    RETURN_IF_FAILED(PriFileBuilder::CreateInstance(pPreviousSchema, pProfile, PriBuildType::PriBuildIncremental, &m_pPriFileBuilder));
+    RETURN_IF_FAILED(DynamicArray<RemovedCandidate>::CreateInstance(4, &m_pRemovedCandidates));
+
+    // Bring in the previous qualifiers up front so that previous qualifier sets keep their indexes and
+    // removals can be matched against them.
+    DecisionInfoSectionBuilder* pDecisions = m_pPriFileBuilder->GetDescriptor()->GetDecisionInfoBuilder();
+    RETURN_IF_FAILED(pDecisions->Merge(m_pPreviousMap->GetDecisionInfo()));
+
+    return S_OK;
+}
+
+HRESULT PriIncrementalBuilder::AddOrUpdateCandidate(
+    _In_ PCWSTR pResourceName,
+    _In_ MrmEnvironment::ResourceValueType valueType,
+    _In_ PCWSTR pValue,
+    _In_opt_ IQualifierSet* pQualifiers)
+{
+    RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_OPERATION), m_bMergedPreviousCandidates);
+
+    RETURN_IF_FAILED(m_pPriFileBuilder->GetDescriptor()->AddCandidateWithString(nullptr, pResourceName, valueType, pValue, pQualifiers));
+    return SkipReplacedCandidate(pResourceName, pQualifiers);
+}
+
+HRESULT PriIncrementalBuilder::AddOrUpdateCandidate(
+    _In_ PCWSTR pResourceName,
+    _In_ MrmEnvironment::ResourceValueType valueType,
+    _In_reads_bytes_(cbValue) const BYTE* pValue,
+    _In_ UINT cbValue,
+    _In_opt_ IQualifierSet* pQualifiers)
+{
+    RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_OPERATION), m_bMergedPreviousCandidates);
+
+    RETURN_IF_FAILED(
+        m_pPriFileBuilder->GetDescriptor()->AddCandidateWithEmbeddedData(nullptr, pResourceName, valueType, pValue, cbValue, pQualifiers));
+    return SkipReplacedCandidate(pResourceName, pQualifiers);
+}
+
+HRESULT PriIncrementalBuilder::SkipReplacedCandidate(_In_ PCWSTR pResourceName, _In_opt_ IQualifierSet* pQualifiers)
+{
+    // The candidate was just added, so its qualifier set is already in the builder.
+    DecisionInfoSectionBuilder* pDecisions = m_pPriFileBuilder->GetDescriptor()->GetDecisionInfoBuilder();
+    RemovedCandidate replaced;
+    RETURN_HR_IF(E_UNEXPECTED, !pDecisions->TryGetQualifierSetIndex(pQualifiers, &replaced.qualifierSetIndex));
+
+    // Names that are new in this build come after the previous ones, so they never match a previous candidate.
+    RETURN_HR_IF(E_UNEXPECTED, !m_pPriFileBuilder->GetDescriptor()->GetSchemaBuilder(0)->ContainsItem(pResourceName, &replaced.resourceIndex));
+
+    return m_pRemovedCandidates->Add(replaced);
+}
+
+HRESULT PriIncrementalBuilder::AddRemoval(_In_ PCWSTR pResourceName, _In_ int qualifierSetIndex)
+{
+    RETURN_HR_IF(E_INVALIDARG, DefString_IsEmpty(pResourceName));
+    RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_OPERATION), m_bMergedPreviousCandidates);
+
+    // Resources that aren't in the previous file have no previous candidates to remove.
+    RemovedCandidate removal;
+    if (!m_pPriFileBuilder->GetDescriptor()->GetSchemaBuilder(0)->ContainsItem(pResourceName, &removal.resourceIndex))
+    {
+        return HRESULT_FROM_WIN32(ERROR_MRM_NAMED_RESOURCE_NOT_FOUND);
+    }
+    if (qualifierSetIndex == NoQualifierSetIndex)
+    {
+        return S_OK;
+    }
+    removal.qualifierSetIndex = qualifierSetIndex;
+
+    return m_pRemovedCandidates->Add(removal);
+}
+
+HRESULT PriIncrementalBuilder::RemoveCandidate(_In_ PCWSTR pResourceName, _In_opt_ IQualifierSet* pQualifiers)
+{
+    // Every previous qualifier set was merged into the builder up front, so a qualifier set that isn't there
+    // can't belong to a previous candidate. Don't add it, since nothing would use it.
+    int qualifierSetIndex;
+    DecisionInfoSectionBuilder* pDecisions = m_pPriFileBuilder->GetDescriptor()->GetDecisionInfoBuilder();
+    if (!pDecisions->TryGetQualifierSetIndex(pQualifiers, &qualifierSetIndex))
+    {
+        qualifierSetIndex = NoQualifierSetIndex;
+    }
+
+    return AddRemoval(pResourceName, qualifierSetIndex);
+}
+
+HRESULT PriIncrementalBuilder::RemoveResource(_In_ PCWSTR pResourceName) { return AddRemoval(pResourceName, -1); }
+
+bool PriIncrementalBuilder::ShouldMergeCandidate(_In_ int resourceIndex, _In_ int qualifierSetIndex) const
+{
+    // Change sets are small, so a scan is cheaper than building an index over them.
+    for (int i = 0; i < m_pRemovedCandidates->Count(); i++)
+    {
+        RemovedCandidate removal;
+        (void)m_pRemovedCandidates->Get(i, &removal);
+
+        if ((removal.resourceIndex == resourceIndex) && ((removal.qualifierSetIndex < 0) || (removal.qualifierSetIndex == qualifierSetIndex)))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+HRESULT PriIncrementalBuilder::MergePreviousCandidates()
+{
+    if (m_bMergedPreviousCandidates)
+    {
+        return S_OK;
+    }
+
+    // The changed candidates are already in the builder, and ShouldMergeCandidate skips the previous
+    // candidates they replace, so their previous values never reach the data items. Any other duplicate
+    // is dropped too.
+    RETURN_IF_FAILED(PriMapMerger::MergeMap(
+        m_pPreviousMap,
+        true,
+        PriFileMerger::DefaultPriMergeFlags | PriFileMerger::DropDuplicateCandidates,
+        nullptr,
+        m_pPriFileBuilder->GetDescriptor(),
+        this));
+
+    m_bMergedPreviousCandidates = true;
+    return S_OK;
+}
+
+HRESULT PriIncrementalBuilder::GenerateFileContents(__deref_out void** ppBufferRtrn, __out_opt UINT32* pBufferLen)
+{
+    RETURN_IF_FAILED(MergePreviousCandidates());
+    return m_pPriFileBuilder->GenerateFileContents(ppBufferRtrn, pBufferLen);
+}
+
+HRESULT PriIncrementalBuilder::WriteToFile(_In_ PCWSTR pFilePath)
+{
+    RETURN_IF_FAILED(MergePreviousCandidates());
+    return m_pPriFileBuilder->WriteToFile(pFilePath);
+}
+
+bool PriIncrementalBuilder::IsUsingPreviousSchemaSection() const
+{
+    return m_pPriFileBuilder->GetDescriptor()->GetSchemaBuilder(0)->IsUsingPreviousSchemaSection();
+}
+
+} // namespace Microsoft::Resources::Build
@@ -311,7 +311,9 @@ PriFileMerger::MergeMap(
     RETURN_HR_IF_NULL(E_INVALIDARG, pResMap);
     RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_OPERATION), m_priBuilderPhase != PriBuilderPhase::PriInitialized);
 
-    return PriMapMerger::MergeMap(pResMap, bIsPrimary, mergeFlags, pRootFolder, m_pPriFileBuilder->GetDescriptor());
+    // Merging whole files has always dropped duplicate candidates, whether or not the caller asked for it.
+    return PriMapMerger::MergeMap(
+        pResMap, bIsPrimary, mergeFlags | PriFileMerger::DropDuplicateCandidates, pRootFolder, m_pPriFileBuilder->GetDescriptor());
 }
 
 HRESULT PriFileMerger::GetRelativeFolderFromPriFilePath(_In_ PCWSTR pPriFilePath, _Inout_ StringResult* pRelativeFolderPath)
@@ -416,7 +418,8 @@ HRESULT PriMapMerger::MergeMap(
     _In_ bool bIsPrimary,
     _In_ PriFileMerger::PriMergeFlags mergeFlags,
     _In_opt_ PCWSTR pRootFolder,
-    _Inout_ PriSectionBuilder* pMergedPriSectionBuilder)
+    _Inout_ PriSectionBuilder* pMergedPriSectionBuilder,
+    _In_opt_ const IPriMergeCandidateFilter* pFilter)
 {
     RETURN_HR_IF(E_INVALIDARG, (pResMap == nullptr) || (pMergedPriSectionBuilder == nullptr));
 
@@ -459,6 +462,9 @@ HRESULT PriMapMerger::MergeMap(
     pDecisionInfo = pResMap->GetDecisionInfo();
     RETURN_IF_FAILED(pMergedDecisions->Merge(pDecisionInfo, &qualifierMap, &qualifierSetMap, &decisionMap));
 
+    bool bDropDuplicates = ((mergeFlags & PriFileMerger::DropDuplicateCandidates) != 0);
+    bool bUseDataItems = pMergedPriSectionBuilder->GetBuildConfiguration()->UseDataItemLocator();
+
     for (int nResItr = 0; nResItr < pResMap->GetNumResources(); nResItr++)
     {
         RETURN_IF_FAILED(pResMap->GetResourceByIndex(nResItr, &namedResource));
@@ -472,6 +478,19 @@ HRESULT PriMapMerger::MergeMap(
             RETURN_IF_FAILED(resCandidate.GetResourceValueType(&valueType));
             if (qualifierSetMap.TryGetMapping(static_cast<UINT16>(nQualifierSetIndex), &nRemappedQualifierSetIndex))
             {
+                if ((pFilter != nullptr) && !pFilter->ShouldMergeCandidate(nResItr, static_cast<int>(nRemappedQualifierSetIndex)))
+                {
+                    continue;
+                }
+
+                // Check for a duplicate up front so that a dropped candidate doesn't leave its value behind
+                // in the data items.
+                if (bDropDuplicates &&
+                    pMergedMapBuilder->HasCandidateForQualifierSet(strResourceName.GetRef(), static_cast<int>(nRemappedQualifierSetIndex)))
+                {
+                    continue;
+                }
+
                 if (MrmEnvironment::IsBinaryResourceValueType(valueType))
                 {
                     BlobResult brCandidateValue;
@@ -487,9 +506,13 @@ HRESULT PriMapMerger::MergeMap(
 
                         HRESULT hr = pMergedMapBuilder->AddCandidate(
                             strResourceName.GetRef(), valueType, pBuildInstanceReference, static_cast<int>(nRemappedQualifierSetIndex));
-                        if ((hr == E_DEF_ALREADY_INITIALIZED) || (hr == HRESULT_FROM_WIN32(ERROR_MRM_DUPLICATE_ENTRY)))
+                        if (FAILED(hr))
+                        {
+                            delete pBuildInstanceReference;
+                        }
+                        if (hr == E_DEF_ALREADY_INITIALIZED)
                         {
-                            // ignore failure for duplicate candidates and duplicate invalid entries
+                            // ignore failure for duplicate invalid entries
                             hr = S_OK;
                         }
                         RETURN_IF_FAILED(hr);
@@ -498,6 +521,7 @@ HRESULT PriMapMerger::MergeMap(
                 else
                 {
                     StringResult strCandidateValue;
+                    MrmEnvironment::ResourceValueType originalValueType = valueType;
                     if (resCandidate.TryGetStringValue(&strCandidateValue))
                     {
                         StringResult strNewCandidateValue;
@@ -521,14 +545,38 @@ HRESULT PriMapMerger::MergeMap(
                             valueType = MrmEnvironment::ResourceValueType_Utf16String;
                         }
 
-                        HRESULT hr = pMergedMapBuilder->AddCandidateWithInternalString(
-                            strResourceName.GetRef(),
-                            valueType,
-                            strNewCandidateValue.GetRef(),
-                            static_cast<int>(nRemappedQualifierSetIndex));
-                        if ((hr == E_DEF_ALREADY_INITIALIZED) || (hr == HRESULT_FROM_WIN32(ERROR_MRM_DUPLICATE_ENTRY)))
+                        HRESULT hr;
+                        if (bUseDataItems && !MrmEnvironment::IsUtf16ResourceValueType(originalValueType))
+                        {
+                            // The value was stored as ASCII or UTF-8, which only the optimized data item encoding
+                            // produces, so encode it the same way again rather than widening it to UTF-16.
+                            DataItemOrchestrator* dataItems = pMergedPriSectionBuilder->GetDataItemOrchestrator();
+                            IBuildInstanceReference* pBuildInstanceReference;
+                            RETURN_IF_FAILED(dataItems->AddOptimizedStringAndCreateInstanceReference(
+                                valueType,
+                                strNewCandidateValue.GetRef(),
+                                static_cast<int>(nRemappedQualifierSetIndex),
+                                &pBuildInstanceReference,
+                                &valueType));
+
+                            hr = pMergedMapBuilder->AddCandidate(
+                                strResourceName.GetRef(), valueType, pBuildInstanceReference, static_cast<int>(nRemappedQualifierSetIndex));
+                            if (FAILED(hr))
+                            {
+                                delete pBuildInstanceReference;
+                            }
+                        }
+                        else
+                        {
+                            hr = pMergedMapBuilder->AddCandidateWithInternalString(
+                                strResourceName.GetRef(),
+                                valueType,
+                                strNewCandidateValue.GetRef(),
+                                static_cast<int>(nRemappedQualifierSetIndex));
+                        }
+                        if (hr == E_DEF_ALREADY_INITIALIZED)
                         {
-                            // Ignore failure for duplicate candidates and duplicate invalid entries.
+                            // Ignore failure for duplicate invalid entries.
                             hr = S_OK;
                         }
                         RETURN_IF_FAILED(hr);
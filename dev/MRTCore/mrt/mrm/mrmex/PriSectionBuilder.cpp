@@ -126,6 +126,8 @@ HRESULT PriSectionBuilder::Init(_In_ CoreProfile* pProfile)
         return E_OUTOFMEMORY;
     }
 
+    m_pFileBuilder->SetMaxBuildThreads(m_pBuilderConfiguration->GetMaxBuildThreads());
+
     RETURN_IF_FAILED(AtomPoolGroup::CreateInstance(10, &m_pAtoms));
 
     RETURN_IF_FAILED(UnifiedEnvironment::CreateInstance(pProfile, m_pAtoms, &m_pUnifiedEnvironment));
@@ -516,7 +518,7 @@ HRESULT PriSectionBuilder::AddPrimarySchemaBuilder(_In_ UINT16 majorVersion, _In
     }
     else if (
         (m_priBuildType == PriBuildType::PriBuildFromPrevSchema) || (m_priBuildType == PriBuildType::PriBuildFromPrevReadOnlySchema) ||
-        (m_priBuildType == PriBuildType::PriBuildForDeploymentMerge))
+        (m_priBuildType == PriBuildType::PriBuildForDeploymentMerge) || (m_priBuildType == PriBuildType::PriBuildIncremental))
     {
         RETURN_IF_FAILED(HierarchicalSchemaSectionBuilder::CreateInstance(this, pPreviousSchema, m_priBuildType, &pSchema));
     }
@@ -67,6 +67,14 @@ ResourcePackMerge::~ResourcePackMerge()
 }
 
 HRESULT ResourcePackMerge::AddPriFile(_In_ PCWSTR pszPriFileName, _In_ PriFileMerger::PriMergeFlags priMergeFlags)
+{
+    return AddPriFile(pszPriFileName, priMergeFlags, nullptr);
+}
+
+HRESULT ResourcePackMerge::AddPriFile(
+    _In_ PCWSTR pszPriFileName,
+    _In_ PriFileMerger::PriMergeFlags priMergeFlags,
+    _Inout_opt_ MrmFile** ppPreloadedFile)
 {
     if (IsFinalized())
     {
@@ -81,7 +89,12 @@ HRESULT ResourcePackMerge::AddPriFile(_In_ PCWSTR pszPriFileName, _In_ PriFileMe
 
     // AddFile will detect if the same file is added
     ManagedFile* pManagedFile;
-    RETURN_IF_FAILED(m_pPriFileManager->AddFile(pszPriFileName, nullptr, true, &pManagedFile));
+    RETURN_IF_FAILED(m_pPriFileManager->AddFile(pszPriFileName, nullptr, (ppPreloadedFile == nullptr), &pManagedFile));
+    if (ppPreloadedFile != nullptr)
+    {
+        RETURN_IF_FAILED(pManagedFile->Load(*ppPreloadedFile));
+        *ppPreloadedFile = nullptr;
+    }
 
     // The main PRI file always comes first and is resource complete, so we can use its schema in case the resource pack doesn't have one.
     AutoDeletePtr<PriFile> pPriFile;
@@ -175,6 +188,120 @@ HRESULT ResourcePackMerge::AddPriFile(_In_ PCWSTR pszPriFileName, _In_ PriFileMe
     return S_OK;
 }
 
+static DEF_CHECKSUM ComputeContentChecksum(_In_ const BaseFile* pBaseFile)
+{
+    const DEFFILE_HEADER* pHeader = pBaseFile->GetFileHeader();
+    return DefChecksum::ComputeChecksum(0, reinterpret_cast<const BYTE*>(pHeader), pHeader->cbTotal);
+}
+
+struct PriFilePreload
+{
+    PCWSTR pszPriFileName;
+    MrmFile* pFile;
+    DEF_CHECKSUM contentChecksum;
+    HRESULT hr;
+};
+
+struct PriFilePreloadBatch
+{
+    PriFileManager* pManager;
+    PriFilePreload* pPreloads;
+};
+
+// Opens the file the same way the file manager would, so that the merge can use it as is.
+static HRESULT PreloadPriFile(_In_ PriFileManager* pManager, _Inout_ PriFilePreload* pPreload)
+{
+    NormalizedFilePath normalizedPath;
+    RETURN_IF_FAILED(normalizedPath.Init(pPreload->pszPriFileName));
+
+    AutoDeletePtr<MrmFile> pFile;
+    RETURN_IF_FAILED(MrmFile::CreateInstance(pManager, normalizedPath.GetRef(), &pFile));
+
+    const BaseFile* pBaseFile;
+    RETURN_IF_FAILED(pFile->GetBaseFile(&pBaseFile));
+    pPreload->contentChecksum = ComputeContentChecksum(pBaseFile);
+
+    pPreload->pFile = pFile.Detach();
+    return S_OK;
+}
+
+static void RunPriFilePreload(_Inout_opt_ PVOID pContext, _In_ ULONG index)
+{
+    PriFilePreloadBatch* pBatch = static_cast<PriFilePreloadBatch*>(pContext);
+    PriFilePreload* pPreload = &pBatch->pPreloads[index];
+    pPreload->hr = PreloadPriFile(pBatch->pManager, pPreload);
+}
+
+HRESULT ResourcePackMerge::AddPriFiles(
+    _In_reads_(numFiles) const PCWSTR* ppszPriFileNames,
+    _In_ UINT32 numFiles,
+    _In_ PriFileMerger::PriMergeFlags priMergeFlags,
+    _In_ UINT32 maxThreads,
+    _Out_writes_opt_(numFiles) DEF_CHECKSUM* pContentChecksums)
+{
+    if (IsFinalized())
+    {
+        return HRESULT_FROM_WIN32(ERROR_INVALID_OPERATION);
+    }
+
+    RETURN_HR_IF(E_INVALIDARG, (ppszPriFileNames == nullptr) || (numFiles < 1) || (numFiles > LONG_MAX));
+
+    unique_deffree_ptr<PriFilePreload> pPreloads(_DefArray_AllocZeroed(PriFilePreload, numFiles));
+    RETURN_IF_NULL_ALLOC(pPreloads.get());
+
+    for (UINT32 i = 0; i < numFiles; i++)
+    {
+        RETURN_HR_IF(E_INVALIDARG, (ppszPriFileNames[i] == nullptr) || (ppszPriFileNames[i][0] == L'\0'));
+        pPreloads.get()[i].pszPriFileName = ppszPriFileNames[i];
+        pPreloads.get()[i].hr = E_ABORT;
+    }
+
+    // Files that were opened but not merged, because an earlier file failed.
+    auto deleteUnmergedFiles = wil::scope_exit([&] {
+        for (UINT32 i = 0; i < numFiles; i++)
+        {
+            delete pPreloads.get()[i].pFile;
+        }
+    });
+
+    PriFilePreloadBatch batch;
+    batch.pManager = m_pPriFileManager;
+    batch.pPreloads = pPreloads.get();
+    RETURN_IF_FAILED(_DefRunParallelForEach(numFiles, maxThreads, RunPriFilePreload, &batch));
+
+    // The builder, file list and file manager all depend on the order files are added in, so merge serially,
+    // handing each file that was opened above to the file manager instead of opening it again.
+    for (UINT32 i = 0; i < numFiles; i++)
+    {
+        RETURN_IF_FAILED(pPreloads.get()[i].hr);
+        RETURN_IF_FAILED(AddPriFile(ppszPriFileNames[i], priMergeFlags, &pPreloads.get()[i].pFile));
+
+        if (pContentChecksums != nullptr)
+        {
+            pContentChecksums[i] = pPreloads.get()[i].contentChecksum;
+        }
+    }
+
+    return S_OK;
+}
+
+HRESULT ResourcePackMerge::GetPriFileChecksums(_In_ PCWSTR pPriFileName, _In_opt_ CoreProfile* pProfile, _Out_ DEF_CHECKSUM* pContentChecksum)
+{
+    UNREFERENCED_PARAMETER(pProfile);
+
+    *pContentChecksum = 0;
+
+    RETURN_HR_IF(E_INVALIDARG, (pPriFileName == nullptr) || (pPriFileName[0] == L'\0'));
+
+    // Creating the BaseFile validates the file structure; the checksum covers the whole file as mapped.
+    AutoDeletePtr<BaseFile> pBaseFile;
+    RETURN_IF_FAILED(BaseFile::CreateInstance(BaseFile::MapFileFlag, pPriFileName, &pBaseFile));
+
+    *pContentChecksum = ComputeContentChecksum(pBaseFile);
+
+    return S_OK;
+}
+
 bool ResourcePackMerge::IsFinalized() const { return bFinalized; }
 
 HRESULT ResourcePackMerge::WriteToFile(_In_ PCWSTR pszOutputFile)
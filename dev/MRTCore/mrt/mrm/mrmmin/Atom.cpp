@@ -19,14 +19,90 @@ const Atom Atom::NullAtom(0, 0);
     (((A1).s.poolIndex == (A2).s.poolIndex) ? (((A1).s.index == (A2).s.index) ? DEF_ATOMS_EQUAL : DEF_ATOMS_UNEQUAL) : \
                                               DEF_ATOMS_INDETERMINATE)
 
+static const UINT64 DefAtom_HashPrime1 = 0x9E3779B185EBCA87ULL;
+static const UINT64 DefAtom_HashPrime2 = 0xC2B2AE3D27D4EB4FULL;
+static const UINT64 DefAtom_HashPrime3 = 0x165667B19E3779F9ULL;
+static const UINT64 DefAtom_HashPrime4 = 0x85EBCA77C2B2AE63ULL;
+static const UINT64 DefAtom_HashPrime5 = 0x27D4EB2F165667C5ULL;
+
+static inline UINT64 DefAtom_Rotl64(UINT64 value, int bits) { return (value << bits) | (value >> (64 - bits)); }
+
+// Lower-cases the ASCII letters in a block of four UTF-16 code units, all of which must be below 0x80.
+// Adding 0x3F sets bit 7 of a unit that is at least 'A', adding 0x25 sets it for a unit that is past 'Z',
+// and units below 0x80 never carry into their neighbor.
+static inline UINT64 DefAtom_FoldAsciiBlock(UINT64 block)
+{
+    const UINT64 atLeastA = block + 0x003F003F003F003FULL;
+    const UINT64 pastZ = block + 0x0025002500250025ULL;
+    return block | (((atLeastA & ~pastZ) & 0x0080008000800080ULL) >> 2);
+}
+
+static inline UINT64 DefAtom_FoldBlock(UINT64 block)
+{
+    if ((block & 0xFF80FF80FF80FF80ULL) == 0)
+    {
+        return DefAtom_FoldAsciiBlock(block);
+    }
+
+    // Same folding as the legacy hash for anything outside of ASCII.
+    UINT64 folded = 0;
+    for (int i = 0; i < 64; i += 16)
+    {
+        folded |= static_cast<UINT64>(towlower(static_cast<WCHAR>(block >> i))) << i;
+    }
+    return folded;
+}
+
+static inline UINT64 DefAtom_HashRound(UINT64 hash, UINT64 block)
+{
+    hash ^= DefAtom_Rotl64(block * DefAtom_HashPrime2, 31) * DefAtom_HashPrime1;
+    return (DefAtom_Rotl64(hash, 27) * DefAtom_HashPrime1) + DefAtom_HashPrime4;
+}
+
+// Version 2 hash. Consumes the string four code units (one UINT64) at a time with an xxHash64 style round
+// and finishes with an avalanche step, so that similar names (e.g. long names that differ only in their
+// last few characters) spread across the whole 32-bit range.
+static DEF_ATOM_HASH DefAtom_HashStringVersion2(__in PCWSTR pString, bool isCaseInsensitive)
+{
+    const size_t cch = wcslen(pString);
+    UINT64 hash = DefAtom_HashPrime5 + (static_cast<UINT64>(cch) * sizeof(WCHAR));
+
+    size_t i = 0;
+    UINT64 block;
+    for (; (i + 4) <= cch; i += 4)
+    {
+        memcpy(&block, &pString[i], sizeof(block));
+        hash = DefAtom_HashRound(hash, (isCaseInsensitive ? DefAtom_FoldBlock(block) : block));
+    }
+
+    if (i < cch)
+    {
+        // The length is already mixed into the seed, so zero padding the tail is unambiguous.
+        block = 0;
+        memcpy(&block, &pString[i], (cch - i) * sizeof(WCHAR));
+        hash = DefAtom_HashRound(hash, (isCaseInsensitive ? DefAtom_FoldBlock(block) : block));
+    }
+
+    hash ^= hash >> 33;
+    hash *= DefAtom_HashPrime2;
+    hash ^= hash >> 29;
+    hash *= DefAtom_HashPrime3;
+    hash ^= hash >> 32;
+
+    return static_cast<DEF_ATOM_HASH>(hash);
+}
+
 DEF_ATOM_HASH
 DefAtom_HashString(__in PCWSTR pString, DEF_ATOM_HASH_METHOD hashMethod)
 {
+    if (hashMethod & DEF_HASH_VERSION_2)
+    {
+        return DefAtom_HashStringVersion2(pString, ((hashMethod & DEF_HASH_CASE_INSENSITIVE) != 0));
+    }
+
+    // Legacy hash, used by every atom pool in a file. It collides heavily on long names that share a prefix.
     DEF_ATOM_HASH rtrn = 0x3482;
 
-    //! \todo really basic hash function.  Do something better someday.
-    //! \todo Repeated hashMethod tests should be factored out if they
-    //!       aren't optimized away (which they almost certainly are).
     for (; *pString; pString++)
     {
         rtrn = (rtrn << 1) ^ ((hashMethod & DEF_HASH_CASE_INSENSITIVE) ? towlower(*pString) : *pString);
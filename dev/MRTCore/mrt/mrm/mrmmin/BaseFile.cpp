@@ -222,7 +222,8 @@ HRESULT BaseFile::Init(__in UINT32 flags, __in PCWSTR pFileName)
     hr = InitFromData(data.pcData, cbData);
     if (SUCCEEDED(hr))
     {
-        m_flags = (flags | BaseFileOwnsDataFlag);
+        // Files on removable drives are loaded even if mapping was requested.
+        m_flags = ((isMapped ? flags : (flags & ~MapFileFlag)) | BaseFileOwnsDataFlag);
     }
     else if (isMapped)
     {
@@ -372,6 +373,55 @@ BaseFile::GetSectionData(_In_ int index, _Out_ const void** data, _Out_ UINT32*
     return S_OK;
 }
 
+HRESULT BaseFile::GetMappedSectionRange(_In_ SectionIndex index, _Outptr_result_maybenull_ const void** ppStart, _Out_ size_t* pcbSize) const
+{
+    *ppStart = nullptr;
+    *pcbSize = 0;
+
+    RETURN_HR_IF_NULL(E_DEF_NOT_READY, m_pHeader);
+    RETURN_HR_IF(E_INVALIDARG, (index < 0) || (index > m_pHeader->sizeToc - 1));
+
+    if (!IsMapped() || (m_pToc[index].cbSectionTotal == 0))
+    {
+        return S_FALSE;
+    }
+
+    // The TOC was checked against the file size when the file was opened, so this doesn't touch the section.
+    *ppStart = GetSectionHeader(m_pHeader, &m_pToc[index]);
+    *pcbSize = m_pToc[index].cbSectionTotal;
+    return S_OK;
+}
+
+HRESULT BaseFile::PrefetchSectionPages(_In_ SectionIndex index) const
+{
+    const void* pStart;
+    size_t cbSize;
+
+    HRESULT hr = GetMappedSectionRange(index, &pStart, &cbSize);
+    RETURN_IF_FAILED(hr);
+    if (hr == S_FALSE)
+    {
+        return S_FALSE;
+    }
+
+    return _DefPrefetchVirtualMemory(pStart, cbSize);
+}
+
+HRESULT BaseFile::TrimSectionPages(_In_ SectionIndex index) const
+{
+    const void* pStart;
+    size_t cbSize;
+
+    HRESULT hr = GetMappedSectionRange(index, &pStart, &cbSize);
+    RETURN_IF_FAILED(hr);
+    if (hr == S_FALSE)
+    {
+        return S_FALSE;
+    }
+
+    return _DefTrimVirtualMemory(pStart, cbSize);
+}
+
 bool BaseFile::IsIdentical(__in const BaseFile* pOther) const
 {
     if (pOther == NULL)
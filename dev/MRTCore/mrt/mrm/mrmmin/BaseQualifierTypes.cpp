@@ -8,6 +8,78 @@ namespace Microsoft::Resources
 
 const PCWSTR IBuildQualifierType::DefaultPackagingAffinity = L"default";
 
+// ParsedQualifierValue implementation
+ParsedQualifierValue::ParsedQualifierValue() :
+    m_kind(StringValue),
+    m_integerValue(0),
+    m_hrError(S_OK),
+    m_pListBuffer(nullptr),
+    m_ppListValues(nullptr),
+    m_numListValues(0),
+    m_generation(0)
+{}
+
+ParsedQualifierValue::~ParsedQualifierValue()
+{
+    _DefFree(m_ppListValues);
+    _DefFree(m_pListBuffer);
+    m_ppListValues = nullptr;
+    m_pListBuffer = nullptr;
+    m_numListValues = 0;
+}
+
+HRESULT ParsedQualifierValue::CreateInstance(_In_opt_ PCWSTR pValue, _Outptr_ ParsedQualifierValue** result)
+{
+    *result = nullptr;
+
+    AutoDeletePtr<ParsedQualifierValue> pRtrn = new ParsedQualifierValue();
+    RETURN_IF_NULL_ALLOC(pRtrn);
+    RETURN_IF_FAILED(pRtrn->m_value.SetCopy((pValue != nullptr) ? pValue : L""));
+
+    *result = pRtrn.Detach();
+    return S_OK;
+}
+
+HRESULT ParsedQualifierValue::SetList()
+{
+    RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_STATE), m_pListBuffer != nullptr);
+
+    // ProcessQualifierValueList finds the first separator before it skips leading whitespace, so
+    // leave lists that start with whitespace to be scored from the string to keep the same results.
+    PCWSTR pStart = m_value.GetRef();
+    if (iswspace(*pStart) && (wcschr(pStart, L';') != nullptr))
+    {
+        return S_OK;
+    }
+
+    size_t cchList = wcslen(pStart) + 1;
+    int numValues = 1;
+    for (PCWSTR pTest = pStart; *pTest != L'\0'; pTest++)
+    {
+        numValues += ((*pTest == L';') ? 1 : 0);
+    }
+
+    m_pListBuffer = _DefArray_AllocZeroed(WCHAR, cchList);
+    m_ppListValues = _DefArray_AllocZeroed(PCWSTR, numValues);
+    RETURN_IF_NULL_ALLOC(m_pListBuffer);
+    RETURN_IF_NULL_ALLOC(m_ppListValues);
+    RETURN_IF_FAILED(DefString_CchCopy(m_pListBuffer, cchList, pStart));
+
+    PWSTR pNext = m_pListBuffer;
+    m_ppListValues[m_numListValues++] = pNext;
+    for (; *pNext != L'\0'; pNext++)
+    {
+        if (*pNext == L';')
+        {
+            *pNext = L'\0';
+            m_ppListValues[m_numListValues++] = pNext + 1;
+        }
+    }
+
+    m_kind = ListValue;
+    return S_OK;
+}
+
 template<typename Func>
 HRESULT ProcessQualifierValueList(_In_ PCWSTR valueFromProvider, _In_ Func process)
 {
@@ -208,6 +280,59 @@ QualifierTypeBase::Evaluate(_In_ const IQualifier* qualifierOnAsset, _In_ PCWSTR
     return S_OK;
 }
 
+HRESULT QualifierTypeBase::ParseProviderValue(_In_opt_ PCWSTR pValue, _Outptr_ ParsedQualifierValue** result) const
+{
+    *result = nullptr;
+
+    AutoDeletePtr<ParsedQualifierValue> pParsed;
+    RETURN_IF_FAILED(ParsedQualifierValue::CreateInstance(pValue, &pParsed));
+    if (AreListValuesAllowed())
+    {
+        RETURN_IF_FAILED(pParsed->SetList());
+    }
+
+    *result = pParsed.Detach();
+    return S_OK;
+}
+
+HRESULT
+QualifierTypeBase::EvaluateParsed(_In_ const IQualifier* pQualifier, _In_ const ParsedQualifierValue* pValue, _Out_ double* score) const
+{
+    *score = 0.0;
+
+    switch (pValue->GetKind())
+    {
+    case ParsedQualifierValue::InvalidValue:
+        return pValue->GetError();
+    case ParsedQualifierValue::EmptyValue:
+        return S_OK;
+    case ParsedQualifierValue::ListValue:
+        if (AreListValuesAllowed())
+        {
+            StringResult valueOnAsset;
+            RETURN_IF_FAILED(pQualifier->GetOperand2Literal(&valueOnAsset));
+
+            // Same scoring as Evaluate, without splitting the list again.
+            for (int i = 0; i < pValue->GetNumListValues(); i++)
+            {
+                double singleItemScore = EvaluateSingleQualifierValue(valueOnAsset.GetRef(), pValue->GetListValue(i));
+                if (singleItemScore > 0.0)
+                {
+                    *score = ScoreInPosition(static_cast<unsigned>(i), singleItemScore);
+                    break;
+                }
+            }
+            return S_OK;
+        }
+        break;
+    default:
+        break;
+    }
+
+    // Types that score the string themselves still see exactly what the provider returned.
+    return Evaluate(pQualifier, pValue->GetValue(), score);
+}
+
 double QualifierTypeBase::EvaluateSingleQualifierValue(_In_ PCWSTR valueOnAsset, _In_ PCWSTR valueFromProvider) const
 {
     double result = 0.0;
@@ -438,8 +563,7 @@ EnumerationQualifierType::CreateInstance(
     return S_OK;
 }
 
-HRESULT
-EnumerationQualifierType::ValidateSingleQualifierValue(_In_ PCWSTR pValue) const
+int EnumerationQualifierType::GetOrdinal(_In_opt_ PCWSTR pValue) const
 {
     if (!DefString_IsEmpty(pValue))
     {
@@ -447,12 +571,39 @@ EnumerationQualifierType::ValidateSingleQualifierValue(_In_ PCWSTR pValue) const
         {
             if (DefString_ICompare(pValue, m_pAllowedValues[i]) == Def_Equal)
             {
-                return S_OK;
+                return i;
             }
         }
     }
 
-    return HRESULT_FROM_WIN32(ERROR_MRM_INVALID_QUALIFIER_VALUE);
+    return -1;
+}
+
+HRESULT
+EnumerationQualifierType::ValidateSingleQualifierValue(_In_ PCWSTR pValue) const
+{
+    return ((GetOrdinal(pValue) >= 0) ? S_OK : HRESULT_FROM_WIN32(ERROR_MRM_INVALID_QUALIFIER_VALUE));
+}
+
+HRESULT
+EnumerationQualifierType::GetQualifierOrdinal(_In_ const IQualifier* pQualifier, _Out_ int* pOrdinalOut) const
+{
+    *pOrdinalOut = -1;
+
+    ICondition::ConditionOperator op;
+    Atom qualifier;
+    StringResult qualifierValue;
+
+    RETURN_IF_FAILED(pQualifier->GetOperator(&op));
+    RETURN_IF_FAILED(pQualifier->GetOperand1Qualifier(&qualifier));
+    RETURN_IF_FAILED(pQualifier->GetOperand2Literal(&qualifierValue));
+    RETURN_IF_FAILED(ValidateQualifierComparison(qualifier, op, qualifierValue.GetRef()));
+
+    int ordinal = GetOrdinal(qualifierValue.GetRef());
+    RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_MRM_INVALID_QUALIFIER_VALUE), ordinal < 0);
+
+    *pOrdinalOut = ordinal;
+    return S_OK;
 }
 
 HRESULT
@@ -482,6 +633,48 @@ EnumerationQualifierType::Evaluate(_In_ const IQualifier* pQualifier, _In_ PCWST
     return S_OK;
 }
 
+HRESULT EnumerationQualifierType::ParseProviderValue(_In_opt_ PCWSTR pszProviderValue, _Outptr_ ParsedQualifierValue** result) const
+{
+    *result = nullptr;
+
+    AutoDeletePtr<ParsedQualifierValue> pParsed;
+    RETURN_IF_FAILED(ParsedQualifierValue::CreateInstance(pszProviderValue, &pParsed));
+
+    // Downlevel providers can return illegal values, which fail every evaluation.
+    int ordinal = GetOrdinal(pszProviderValue);
+    if (ordinal >= 0)
+    {
+        pParsed->SetOrdinal(ordinal);
+    }
+    else
+    {
+        pParsed->SetInvalid(HRESULT_FROM_WIN32(ERROR_MRM_INVALID_QUALIFIER_VALUE));
+    }
+
+    *result = pParsed.Detach();
+    return S_OK;
+}
+
+HRESULT
+EnumerationQualifierType::EvaluateParsed(_In_ const IQualifier* pQualifier, _In_ const ParsedQualifierValue* pProviderValue, _Out_ double* score)
+    const
+{
+    *score = 0.0;
+
+    if (pProviderValue->GetKind() == ParsedQualifierValue::StringValue)
+    {
+        return Evaluate(pQualifier, pProviderValue->GetValue(), score);
+    }
+
+    // Same order of checks as Evaluate: the asset qualifier first, then the provider value.
+    int qualifierOrdinal;
+    RETURN_IF_FAILED(GetQualifierOrdinal(pQualifier, &qualifierOrdinal));
+    RETURN_IF_FAILED(pProviderValue->GetError());
+
+    *score = ((qualifierOrdinal == pProviderValue->GetIntegerValue()) ? 1.0 : 0.0);
+    return S_OK;
+}
+
 _Pre_satisfies_(maxAllowedValue > minAllowedValue) HRESULT IntegerQualifierType::CreateInstance(
     _In_ int minAllowedValue,
     _In_ int maxAllowedValue,
@@ -538,28 +731,73 @@ IntegerQualifierType::Evaluate(_In_ const IQualifier* pQualifier, _In_ PCWSTR ps
     StringResult qualifierValue;
     RETURN_IF_FAILED(pQualifier->GetOperand2Literal(&qualifierValue));
 
-    int providerValue = _wtoi(pszProviderValue);
-    int qualiferValue = _wtoi(qualifierValue.GetRef());
+    *score = CalculateIntegerScore(_wtoi(qualifierValue.GetRef()), _wtoi(pszProviderValue));
+    return S_OK;
+}
+
+HRESULT IntegerQualifierType::ParseProviderValue(_In_opt_ PCWSTR pszProviderValue, _Outptr_ ParsedQualifierValue** result) const
+{
+    *result = nullptr;
+
+    AutoDeletePtr<ParsedQualifierValue> pParsed;
+    RETURN_IF_FAILED(ParsedQualifierValue::CreateInstance(pszProviderValue, &pParsed));
+
+    HRESULT hr;
+    if (DefString_IsEmpty(pszProviderValue))
+    {
+        pParsed->SetEmpty();
+    }
+    else if (FAILED(hr = ValidateQualifierValue(pszProviderValue)))
+    {
+        pParsed->SetInvalid(hr);
+    }
+    else
+    {
+        pParsed->SetInteger(_wtoi(pszProviderValue));
+    }
+
+    *result = pParsed.Detach();
+    return S_OK;
+}
+
+HRESULT
+IntegerQualifierType::EvaluateParsed(_In_ const IQualifier* pQualifier, _In_ const ParsedQualifierValue* pProviderValue, _Out_ double* score) const
+{
+    *score = 0.0;
+
+    if (pProviderValue->GetKind() == ParsedQualifierValue::StringValue)
+    {
+        return Evaluate(pQualifier, pProviderValue->GetValue(), score);
+    }
+
+    RETURN_IF_FAILED(ValidateQualifier(pQualifier));
+    RETURN_HR_IF_EXPECTED(S_OK, pProviderValue->GetKind() == ParsedQualifierValue::EmptyValue);
+    RETURN_IF_FAILED(pProviderValue->GetError());
+
+    StringResult qualifierValue;
+    RETURN_IF_FAILED(pQualifier->GetOperand2Literal(&qualifierValue));
+
+    *score = CalculateIntegerScore(_wtoi(qualifierValue.GetRef()), pProviderValue->GetIntegerValue());
+    return S_OK;
+}
 
+double IntegerQualifierType::CalculateIntegerScore(_In_ int assetValue, _In_ int providerValue)
+{
     // same value => 1.0
     // cond > prov => 0.75
     // cond < prov => 0.5
-    int comparisonResult = providerValue - qualiferValue;
+    int comparisonResult = providerValue - assetValue;
 
     if (comparisonResult == 0)
     {
-        *score = 1.0;
+        return 1.0;
     }
     else if (comparisonResult > 0)
     {
-        *score = 0.5;
-    }
-    else
-    {
-        *score = 0.75;
+        return 0.5;
     }
 
-    return S_OK;
+    return 0.75;
 }
 
 HRESULT
@@ -77,6 +77,38 @@ HRESULT ContrastQualifierType::Evaluate(_In_ const IQualifier* pQualifier, _In_
     return S_OK;
 }
 
+// Contrast scores indexed by [provider][asset], in the order of Qualifier_Contrast_AllowedValues
+// (standard, high, black, white).  Matches the rules in ContrastQualifierType::Evaluate.
+static const double c_contrastScores[4][4] = {
+    {1.0, 0.0, 0.0, 0.0},
+    {0.0, 1.0, 0.5, 0.1},
+    {0.0, 0.5, 1.0, 0.1},
+    {0.0, 0.5, 0.1, 1.0},
+};
+
+HRESULT
+ContrastQualifierType::EvaluateParsed(_In_ const IQualifier* pQualifier, _In_ const ParsedQualifierValue* pValue, _Out_ double* score) const
+{
+    *score = 0.0;
+
+    if (pValue->GetKind() == ParsedQualifierValue::StringValue)
+    {
+        return Evaluate(pQualifier, pValue->GetValue(), score);
+    }
+
+    int qualifierOrdinal;
+    RETURN_IF_FAILED(GetQualifierOrdinal(pQualifier, &qualifierOrdinal));
+    RETURN_IF_FAILED(pValue->GetError());
+
+    int providerOrdinal = pValue->GetIntegerValue();
+    if ((providerOrdinal < ARRAYSIZE(c_contrastScores)) && (qualifierOrdinal < ARRAYSIZE(c_contrastScores[0])))
+    {
+        *score = c_contrastScores[providerOrdinal][qualifierOrdinal];
+    }
+
+    return S_OK;
+}
+
 HRESULT ScaleQualifierType::CreateInstance(_Outptr_ ScaleQualifierType** type)
 {
     *type = nullptr;
@@ -222,6 +254,31 @@ HRESULT ScaleQualifierType::Evaluate(_In_ const IQualifier* pAssetQualifier, _In
     return S_OK;
 }
 
+HRESULT ScaleQualifierType::EvaluateParsed(_In_ const IQualifier* pAssetQualifier, _In_ const ParsedQualifierValue* pContextValue, _Out_ double* score) const
+{
+    *score = 0.0;
+
+    if (pContextValue->GetKind() == ParsedQualifierValue::StringValue)
+    {
+        return Evaluate(pAssetQualifier, pContextValue->GetValue(), score);
+    }
+
+    RETURN_IF_FAILED(ValidateQualifier(pAssetQualifier));
+    RETURN_IF_FAILED(pContextValue->GetError());
+
+    if (pContextValue->GetKind() == ParsedQualifierValue::EmptyValue)
+    {
+        // Unlike the base integer type, scale validates before it accepts an empty provider value.
+        return ValidateQualifierValue(L"");
+    }
+
+    StringResult assetQualifierValue;
+    RETURN_IF_FAILED(pAssetQualifier->GetOperand2Literal(&assetQualifierValue));
+
+    *score = CalculateScaleFactorScore(_wtoi(assetQualifierValue.GetRef()), pContextValue->GetIntegerValue());
+    return S_OK;
+}
+
 double ScaleQualifierType::CalculateScaleFactorScore(_In_ int assetValue, _In_ int contextValue)
 {
     double result = 0.0;
@@ -372,6 +429,41 @@ HRESULT DXFeatureLevelQualifierType::Evaluate(_In_ const IQualifier* pQualifier,
     return S_OK;
 }
 
+// DX feature level scores indexed by [provider][asset], in the order of
+// Qualifier_DXFeatureLevel_AllowedValues (DX9 through DX12).  Matches DXFeatureLevelQualifierType::Evaluate.
+static const double c_dxFeatureLevelScores[4][4] = {
+    {1.0, 0.0, 0.0, 0.0},
+    {0.75, 1.0, 0.0, 0.0},
+    {0.25, 0.75, 1.0, 0.0},
+    {0.25, 0.5, 0.75, 1.0},
+};
+
+HRESULT
+DXFeatureLevelQualifierType::EvaluateParsed(_In_ const IQualifier* pQualifier, _In_ const ParsedQualifierValue* pValue, _Out_ double* score) const
+{
+    *score = 0.0;
+
+    // Like Evaluate, unknown values on either side just don't match.
+    if (pValue->GetKind() != ParsedQualifierValue::OrdinalValue)
+    {
+        return S_OK;
+    }
+
+    StringResult qualifierValue;
+    if (SUCCEEDED(pQualifier->GetOperand2Literal(&qualifierValue)))
+    {
+        int providerOrdinal = pValue->GetIntegerValue();
+        int qualifierOrdinal = GetOrdinal(qualifierValue.GetRef());
+        if ((qualifierOrdinal >= 0) && (providerOrdinal < ARRAYSIZE(c_dxFeatureLevelScores)) &&
+            (qualifierOrdinal < ARRAYSIZE(c_dxFeatureLevelScores[0])))
+        {
+            *score = c_dxFeatureLevelScores[providerOrdinal][qualifierOrdinal];
+        }
+    }
+
+    return S_OK;
+}
+
 HRESULT DeviceFamilyQualifierType::CreateInstance(_Outptr_ DeviceFamilyQualifierType** type)
 {
     *type = nullptr;
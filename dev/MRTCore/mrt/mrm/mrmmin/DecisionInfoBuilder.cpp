@@ -561,6 +561,37 @@ HRESULT DecisionInfoBuilder::GetOrAddQualifierSet(_In_opt_ const IQualifierSet*
     return GetOrAddQualifierSet(pQualifierSet, nullptr, pIndexOut);
 }
 
+bool DecisionInfoBuilder::TryGetQualifierSetIndex(_In_opt_ const IQualifierSet* pQualifierSet, _Out_ int* pIndexOut) const
+{
+    // NULL means unconditional
+    if (pQualifierSet == nullptr)
+    {
+        *pIndexOut = UnconditionalQualifierSetIndex;
+        return true;
+    }
+
+    *pIndexOut = -1;
+
+    int numExisting = m_pData->GetNumQualifierSets();
+    QualifierSetResult existing;
+
+    // Compare from the end for better perf.  We tend to add in groups sequentially,
+    // so the qualifier we need is more often at or closer to the end of the list.
+    for (int i = numExisting - 1; i >= 0; i--)
+    {
+        if (SUCCEEDED(existing.Set(m_pData, i)))
+        {
+            if (IQualifierSet::Equal(&existing, pQualifierSet))
+            {
+                *pIndexOut = i;
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
 HRESULT DecisionInfoBuilder::GetOrAddQualifierSet(
     _In_opt_ const IQualifierSet* pNewQualifierSet,
     _In_opt_ RemapUInt16* pQualifierMapRemapInfo,
@@ -576,24 +607,14 @@ HRESULT DecisionInfoBuilder::GetOrAddQualifierSet(
         return S_OK;
     }
 
-    int numExisting = m_pData->GetNumQualifierSets();
-    QualifierSetResult existing;
-
-    // Compare from the end for better perf.  We tend to add in groups sequentially,
-    // so the qualifier we need is more often at or closer to the end of the list.
-    for (int i = numExisting - 1; i >= 0; i--)
+    int existingIndex;
+    if (TryGetQualifierSetIndex(pNewQualifierSet, &existingIndex))
     {
-        if (SUCCEEDED(existing.Set(m_pData, i)))
+        if (pIndexOut != nullptr)
         {
-            if (IQualifierSet::Equal(&existing, pNewQualifierSet))
-            {
-                if (pIndexOut != nullptr)
-                {
-                    *pIndexOut = i;
-                }
-                return S_OK;
-            }
+            *pIndexOut = existingIndex;
         }
+        return S_OK;
     }
 
     // No match. Add it.
@@ -0,0 +1,203 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#include "stdafx.h"
+
+namespace Microsoft::Resources
+{
+
+HRESULT DecodedStringCache::CreateInstance(_In_ size_t cbBudget, _Outptr_ DecodedStringCache** result)
+{
+    *result = nullptr;
+
+    AutoDeletePtr<DecodedStringCache> pRtrn = new DecodedStringCache(cbBudget);
+    RETURN_IF_NULL_ALLOC(pRtrn);
+    RETURN_IF_FAILED(pRtrn->Grow());
+
+    *result = pRtrn.Detach();
+    return S_OK;
+}
+
+DecodedStringCache::DecodedStringCache(_In_ size_t cbBudget) :
+    m_pEntries(nullptr),
+    m_pBuckets(nullptr),
+    m_numSlots(0),
+    m_numEntries(0),
+    m_firstFreeSlot(-1),
+    m_cbBudget(cbBudget),
+    m_cbStrings(0),
+    m_numHits(0),
+    m_numMisses(0)
+{
+    _DefInitializeSRWLock(&m_srwLock);
+}
+
+DecodedStringCache::~DecodedStringCache()
+{
+    Clear();
+
+    _DefFree(m_pEntries);
+    m_pEntries = nullptr;
+    _DefFree(m_pBuckets);
+    m_pBuckets = nullptr;
+}
+
+int DecodedStringCache::GetBucket(_In_ UINT16 sectionIndex, _In_ UINT32 itemIndex) const
+{
+    // Items in a section are numbered densely, so spread neighbouring indexes across the buckets.
+    UINT32 hash = (itemIndex * 0x9E3779B1) ^ (static_cast<UINT32>(sectionIndex) << 16);
+    hash ^= (hash >> 15);
+    return static_cast<int>(hash & static_cast<UINT32>(m_numSlots - 1));
+}
+
+int DecodedStringCache::FindEntry(_In_ UINT16 sectionIndex, _In_ UINT32 itemIndex) const
+{
+    for (int slot = m_pBuckets[GetBucket(sectionIndex, itemIndex)]; slot >= 0; slot = m_pEntries[slot].next)
+    {
+        if ((m_pEntries[slot].itemIndex == itemIndex) && (m_pEntries[slot].sectionIndex == sectionIndex))
+        {
+            return slot;
+        }
+    }
+    return -1;
+}
+
+// Doubles the number of slots (the bucket count always equals the slot count) and rehashes the entries.
+// Must be called with the lock held exclusively, or before the cache is shared.
+HRESULT DecodedStringCache::Grow()
+{
+    int newNumSlots = ((m_numSlots > 0) ? (m_numSlots * 2) : InitialNumSlots);
+    RETURN_HR_IF(E_OUTOFMEMORY, newNumSlots <= m_numSlots);
+
+    Entry* pNewEntries = _DefArray_AllocZeroed(Entry, newNumSlots);
+    RETURN_IF_NULL_ALLOC(pNewEntries);
+
+    int* pNewBuckets = _DefArray_Alloc(int, newNumSlots);
+    if (pNewBuckets == nullptr)
+    {
+        _DefFree(pNewEntries);
+        return E_OUTOFMEMORY;
+    }
+
+    if (m_numSlots > 0)
+    {
+        memcpy(pNewEntries, m_pEntries, m_numSlots * sizeof(Entry));
+    }
+
+    _DefFree(m_pEntries);
+    _DefFree(m_pBuckets);
+    m_pEntries = pNewEntries;
+    m_pBuckets = pNewBuckets;
+    int oldNumSlots = m_numSlots;
+    m_numSlots = newNumSlots;
+
+    for (int i = 0; i < m_numSlots; i++)
+    {
+        m_pBuckets[i] = -1;
+    }
+
+    m_firstFreeSlot = -1;
+    for (int slot = m_numSlots - 1; slot >= 0; slot--)
+    {
+        if ((slot < oldNumSlots) && (m_pEntries[slot].pString != nullptr))
+        {
+            int bucket = GetBucket(m_pEntries[slot].sectionIndex, m_pEntries[slot].itemIndex);
+            m_pEntries[slot].next = m_pBuckets[bucket];
+            m_pBuckets[bucket] = slot;
+        }
+        else
+        {
+            m_pEntries[slot].next = m_firstFreeSlot;
+            m_firstFreeSlot = slot;
+        }
+    }
+
+    return S_OK;
+}
+
+bool DecodedStringCache::TryGetString(_In_ UINT16 sectionIndex, _In_ UINT32 itemIndex, _Inout_ StringResult* pStringOut)
+{
+    AutoReaderWriterLock lock(&m_srwLock, true);
+
+    // Entries are never evicted, so the string stays where it is until the cache is cleared.
+    int slot = FindEntry(sectionIndex, itemIndex);
+    if ((slot >= 0) && SUCCEEDED(pStringOut->SetRef(m_pEntries[slot].pString)))
+    {
+        InterlockedIncrement64(&m_numHits);
+        return true;
+    }
+
+    InterlockedIncrement64(&m_numMisses);
+    return false;
+}
+
+HRESULT
+DecodedStringCache::AddString(_In_ UINT16 sectionIndex, _In_ UINT32 itemIndex, _In_reads_(cchString) PCWSTR pString, _In_ size_t cchString)
+{
+    RETURN_HR_IF(E_INVALIDARG, (pString == nullptr) || (cchString < 1));
+
+    size_t cbString = cchString * sizeof(WCHAR);
+
+    AutoReaderWriterLock lock(&m_srwLock);
+
+    if (((m_cbStrings + cbString) > m_cbBudget) || (FindEntry(sectionIndex, itemIndex) >= 0))
+    {
+        // The cache is full, or another thread decoded and added the same item first.
+        return S_OK;
+    }
+
+    if (m_firstFreeSlot < 0)
+    {
+        RETURN_IF_FAILED(Grow());
+    }
+
+    PWSTR pCopy = _DefArray_Alloc(WCHAR, cchString);
+    RETURN_IF_NULL_ALLOC(pCopy);
+    memcpy(pCopy, pString, cbString);
+
+    int slot = m_firstFreeSlot;
+    Entry* pEntry = &m_pEntries[slot];
+    m_firstFreeSlot = pEntry->next;
+
+    pEntry->pString = pCopy;
+    pEntry->cchString = cchString;
+    pEntry->itemIndex = itemIndex;
+    pEntry->sectionIndex = sectionIndex;
+
+    int bucket = GetBucket(sectionIndex, itemIndex);
+    pEntry->next = m_pBuckets[bucket];
+    m_pBuckets[bucket] = slot;
+
+    m_cbStrings += cbString;
+    m_numEntries++;
+
+    return S_OK;
+}
+
+void DecodedStringCache::SetBudget(_In_ size_t cbBudget)
+{
+    AutoReaderWriterLock lock(&m_srwLock);
+
+    // Lookups may still reference the cached strings, so a smaller budget only stops new entries.
+    m_cbBudget = cbBudget;
+}
+
+void DecodedStringCache::Clear()
+{
+    AutoReaderWriterLock lock(&m_srwLock);
+
+    m_firstFreeSlot = -1;
+    for (int slot = m_numSlots - 1; slot >= 0; slot--)
+    {
+        _DefFree(m_pEntries[slot].pString);
+        m_pEntries[slot].pString = nullptr;
+        m_pEntries[slot].next = m_firstFreeSlot;
+        m_firstFreeSlot = slot;
+        m_pBuckets[slot] = -1;
+    }
+
+    m_cbStrings = 0;
+    m_numEntries = 0;
+}
+
+} // namespace Microsoft::Resources
@@ -39,7 +39,10 @@ FileAtomPool::FileAtomPool() :
     m_pHashes(NULL),
     m_pOffsets(NULL),
     m_pPool(NULL),
-    m_pPoolGroup(NULL)
+    m_pPoolGroup(NULL),
+    m_pHashIndex(NULL),
+    m_numHashIndexBuckets(0),
+    m_pLazyHashIndex(NULL)
 {}
 
 HRESULT FileAtomPool::Initialize(__in_opt const IFileSection* pSection, __in_bcount(cbData) const void* pData, __in int cbData)
@@ -67,6 +70,25 @@ HRESULT FileAtomPool::Initialize(__in_opt const IFileSection* pSection, __in_bco
         m_pOffsets = _SECTION_PARSER_NEXT_ARRAY(data, m_pHeader->nAtoms, UINT32, &hr);
         m_pPool = _SECTION_PARSER_NEXT_ARRAY(data, m_pHeader->cchPool, WCHAR, &hr);
 
+        m_pHashIndex = NULL;
+        m_numHashIndexBuckets = 0;
+        if ((m_pHeader->flags & DEFFILE_ATOMPOOL_HASH_INDEX) && !(m_pHeader->flags & DEFFILE_ATOMPOOL_HASH_NONE))
+        {
+            (void)data.GetPadBytes(&hr, nullptr);
+            const DEFFILE_ATOMPOOL_HASH_INDEX_HEADER* pIndexHeader = _SECTION_PARSER_NEXT(data, DEFFILE_ATOMPOOL_HASH_INDEX_HEADER, &hr);
+            if (pIndexHeader != nullptr)
+            {
+                // Lookups mask with numBuckets - 1 and rely on there being an empty bucket.
+                UINT32 numBuckets = pIndexHeader->numBuckets;
+                if ((numBuckets == 0) || ((numBuckets & (numBuckets - 1)) != 0) || (numBuckets <= static_cast<UINT32>(m_pHeader->nAtoms)))
+                {
+                    hr = HRESULT_FROM_WIN32(ERROR_MRM_INVALID_PRI_FILE);
+                }
+                m_pHashIndex = _SECTION_PARSER_NEXT_ARRAY(data, numBuckets, HashIndex, &hr);
+                m_numHashIndexBuckets = ((m_pHashIndex != NULL) ? numBuckets : 0);
+            }
+        }
+
         m_flags = 0;
         m_poolIndex = m_pHeader->poolIndex;
         m_cbTotalSize = cbPoolTotal;
@@ -86,7 +108,14 @@ HRESULT FileAtomPool::Initialize(__in_opt const IFileSection* pSection, __in_bco
     return hr;
 }
 
-FileAtomPool::~FileAtomPool() {}
+FileAtomPool::~FileAtomPool()
+{
+    if (m_pLazyHashIndex != NULL)
+    {
+        _DefFree(m_pLazyHashIndex);
+        m_pLazyHashIndex = NULL;
+    }
+}
 
 HRESULT FileAtomPool::CreateInstance(__in const IFileSection* pFileSection, _Outptr_ FileAtomPool** result)
 {
@@ -264,6 +293,9 @@ bool FileAtomPool::TryGetIndex(__in PCWSTR pString, __out_opt Atom::Index* pInde
         return false;
     }
 
+    UINT32 numHashIndexBuckets = 0;
+    const HashIndex* pHashIndex = GetHashIndex(&numHashIndexBuckets);
+
     if (m_pHeader->flags & DEFFILE_ATOMPOOL_HASH_NONE)
     {
         for (i = 0; i < m_pHeader->nAtoms; i++)
@@ -275,9 +307,13 @@ bool FileAtomPool::TryGetIndex(__in PCWSTR pString, __out_opt Atom::Index* pInde
             }
         }
     }
+    else if (pHashIndex != nullptr)
+    {
+        found = TryGetIndexFromHashIndex(pHashIndex, numHashIndexBuckets, pString, &i);
+    }
     else if (m_pHeader->flags & DEFFILE_ATOMPOOL_HASH_UNSORTED)
     {
-        hash = Atom::HashString(pString, static_cast<Atom::HashMethod>(m_pHeader->flags));
+        hash = Atom::HashString(pString, GetHashMethod());
         for (i = 0; i < m_pHeader->nAtoms; i++)
         {
             if ((m_pHashes[i].hash == hash) && (CompareAtHashIndex(i, pString) == 0))
@@ -292,7 +328,7 @@ bool FileAtomPool::TryGetIndex(__in PCWSTR pString, __out_opt Atom::Index* pInde
         Atom::Index low = 0, high = m_pHeader->nAtoms - 1;
 
         // Binary search
-        hash = Atom::HashString(pString, (DEF_ATOM_HASH_METHOD)m_pHeader->flags);
+        hash = Atom::HashString(pString, GetHashMethod());
         while (low <= high)
         {
             i = ((high - low) / 2) + low;
@@ -342,6 +378,162 @@ bool FileAtomPool::TryGetIndex(__in PCWSTR pString, __out_opt Atom::Index* pInde
     return found;
 }
 
+const FileAtomPool::HashIndex* FileAtomPool::GetHashIndex(__out UINT32* pNumBucketsOut) const
+{
+    *pNumBucketsOut = m_numHashIndexBuckets;
+    if (m_pHashIndex != NULL)
+    {
+        return m_pHashIndex;
+    }
+
+    // Older files don't have a hash index. Build one from the hash table in the file.
+    if ((m_pHashes == NULL) || (m_pHeader->nAtoms < MinAtomsForLazyHashIndex))
+    {
+        return NULL;
+    }
+
+    UINT32 numBuckets = GetHashIndexNumBuckets(m_pHeader->nAtoms);
+    HashIndex* pIndex = m_pLazyHashIndex;
+    if ((pIndex == NULL) && (numBuckets > 0))
+    {
+        // No lock; if two threads race to build the index, the one that loses frees its copy.
+        HashIndex* pNewIndex = _DefArray_Alloc(HashIndex, numBuckets);
+        if (pNewIndex == NULL)
+        {
+            return NULL;
+        }
+
+        if (FAILED(BuildHashIndex(m_pHashes, m_pHeader->nAtoms, pNewIndex, numBuckets)))
+        {
+            _DefFree(pNewIndex);
+            return NULL;
+        }
+
+        pIndex = static_cast<HashIndex*>(
+            InterlockedCompareExchangePointer(reinterpret_cast<PVOID volatile*>(&m_pLazyHashIndex), pNewIndex, NULL));
+        if (pIndex == NULL)
+        {
+            pIndex = pNewIndex;
+        }
+        else
+        {
+            _DefFree(pNewIndex);
+        }
+    }
+
+    if (pIndex == NULL)
+    {
+        return NULL;
+    }
+
+    *pNumBucketsOut = numBuckets;
+    return pIndex;
+}
+
+bool FileAtomPool::TryGetIndexFromHashIndex(
+    __in_ecount(numBuckets) const HashIndex* pBuckets,
+    __in UINT32 numBuckets,
+    __in PCWSTR pString,
+    __out Atom::Index* pIndexOut) const
+{
+    const Atom::Hash hash = Atom::HashString(pString, GetHashMethod());
+    const UINT32 mask = numBuckets - 1;
+
+    *pIndexOut = Atom::NullAtomIndex;
+
+    UINT32 bucket = DefFileAtomPool_GetHashIndexHomeBucket(hash, numBuckets);
+    for (UINT32 distance = 0; distance < numBuckets; distance++)
+    {
+        const HashIndex* pEntry = &pBuckets[bucket];
+        if (pEntry->index == DEFFILE_ATOMPOOL_HASH_INDEX_EMPTY)
+        {
+            return false;
+        }
+
+        // Entries are ordered by distance from their home bucket, so once we reach one that is
+        // closer to home than we would be, the string isn't in the pool.
+        if (((bucket - DefFileAtomPool_GetHashIndexHomeBucket(pEntry->hash, numBuckets)) & mask) < distance)
+        {
+            return false;
+        }
+
+        if ((pEntry->hash == hash) && (CompareAtIndex(pEntry->index, pString) == Def_Equal))
+        {
+            *pIndexOut = pEntry->index;
+            return true;
+        }
+
+        bucket = (bucket + 1) & mask;
+    }
+    return false;
+}
+
+UINT32 FileAtomPool::GetHashIndexNumBuckets(__in Atom::AtomCount nAtoms)
+{
+    // Keep the index at most half full so that most lookups touch a single cache line.
+    if ((nAtoms < 0) || (nAtoms > MaxAtomsForHashIndex))
+    {
+        return 0;
+    }
+
+    UINT32 minBuckets = (static_cast<UINT32>(nAtoms) * 2) + 1;
+    UINT32 numBuckets = 2;
+    while (numBuckets < minBuckets)
+    {
+        numBuckets *= 2;
+    }
+    return numBuckets;
+}
+
+UINT32 FileAtomPool::GetHashIndexSizeInBytes(__in Atom::AtomCount nAtoms)
+{
+    return sizeof(DEFFILE_ATOMPOOL_HASH_INDEX_HEADER) + (GetHashIndexNumBuckets(nAtoms) * sizeof(HashIndex));
+}
+
+HRESULT FileAtomPool::BuildHashIndex(
+    __in_ecount(nAtoms) const HashIndex* pHashes,
+    __in Atom::AtomCount nAtoms,
+    __out_ecount(numBuckets) HashIndex* pBuckets,
+    __in UINT32 numBuckets)
+{
+    RETURN_HR_IF(E_INVALIDARG, (pBuckets == nullptr) || (nAtoms < 0) || ((nAtoms > 0) && (pHashes == nullptr)));
+    RETURN_HR_IF(E_INVALIDARG, (numBuckets == 0) || (numBuckets != GetHashIndexNumBuckets(nAtoms)));
+
+    for (UINT32 i = 0; i < numBuckets; i++)
+    {
+        pBuckets[i].hash = 0;
+        pBuckets[i].index = DEFFILE_ATOMPOOL_HASH_INDEX_EMPTY;
+    }
+
+    const UINT32 mask = numBuckets - 1;
+    for (Atom::AtomCount i = 0; i < nAtoms; i++)
+    {
+        HashIndex entry = pHashes[i];
+        UINT32 bucket = DefFileAtomPool_GetHashIndexHomeBucket(entry.hash, numBuckets);
+        UINT32 distance = 0;
+
+        // Robin Hood: an entry displaces any entry that is closer to its own home bucket. The index
+        // is at most half full, so this always reaches an empty bucket.
+        while (pBuckets[bucket].index != DEFFILE_ATOMPOOL_HASH_INDEX_EMPTY)
+        {
+            UINT32 residentDistance = (bucket - DefFileAtomPool_GetHashIndexHomeBucket(pBuckets[bucket].hash, numBuckets)) & mask;
+            if (residentDistance < distance)
+            {
+                HashIndex displaced = pBuckets[bucket];
+                pBuckets[bucket] = entry;
+                entry = displaced;
+                distance = residentDistance;
+            }
+
+            bucket = (bucket + 1) & mask;
+            distance++;
+        }
+        pBuckets[bucket] = entry;
+    }
+
+    return S_OK;
+}
+
 DEFCOMPARISON FileAtomPool::CompareAtIndex(__in Atom::Index index, __in PCWSTR pString) const
 {
     if ((pString == nullptr) || (m_pOffsets == nullptr) || (m_pPool == nullptr) || (m_pHeader == nullptr) ||
@@ -353,6 +353,9 @@ HierarchicalNames::HierarchicalNames() :
     m_pItemsLarge(nullptr),
     m_pUtf16Names(nullptr),
     m_pAsciiNames(nullptr),
+    m_pPathIndex(nullptr),
+    m_pPathIndexEntries(nullptr),
+    m_pScopePathHashes(nullptr),
     m_pScopeNames(nullptr),
     m_pItemNames(nullptr),
     m_largeNode(false)
@@ -431,6 +434,23 @@ HRESULT HierarchicalNames::Init(
     m_pAsciiNames = _SECTION_PARSER_NEXT_ARRAY(data, m_pHeader->cchAsciiNamesPool, char, &hr);
     RETURN_IF_FAILED(hr);
 
+    if ((m_pHeader->flags & DEFFILE_HNAMES_FLAGS_PATH_INDEX) != 0)
+    {
+        data.GetPadBytes(&hr, nullptr);
+        m_pPathIndex = _SECTION_PARSER_NEXT(data, DEFFILE_HNAMES_PATH_INDEX_HEADER, &hr);
+        RETURN_IF_FAILED(hr);
+
+        if ((m_pPathIndex->numBuckets == 0) || ((m_pPathIndex->numBuckets & (m_pPathIndex->numBuckets - 1)) != 0) ||
+            (m_pPathIndex->numBuckets <= (m_pHeader->numNodes - 1)) || (m_pPathIndex->numScopeHashes != m_pHeader->numScopes))
+        {
+            return HRESULT_FROM_WIN32(ERROR_MRM_INVALID_PRI_FILE);
+        }
+
+        m_pPathIndexEntries = _SECTION_PARSER_NEXT_ARRAY(data, m_pPathIndex->numBuckets, DEFFILE_HNAMES_PATH_INDEX_ENTRY, &hr);
+        m_pScopePathHashes = _SECTION_PARSER_NEXT_ARRAY(data, m_pPathIndex->numScopeHashes, UINT32, &hr);
+        RETURN_IF_FAILED(hr);
+    }
+
     if (m_largeNode)
     {
         RETURN_IF_FAILED(ScopesAtomPool<DEFFILE_HNAMES_SCOPE_LARGE>::CreateInstance(
@@ -720,6 +740,33 @@ bool HierarchicalNames::Contains(
         *pNameIndexOut = -1;
     }
 
+    int indexedNameIndex;
+    if ((m_pPathIndex != nullptr) && TryFindInPathIndex(pPath, relativeToScope, &indexedNameIndex))
+    {
+        DEFFILE_HNAMES_NODE_LARGE indexedNode;
+        if ((indexedNameIndex < 0) || !TryGetNode(indexedNameIndex, &indexedNode))
+        {
+            return false;
+        }
+
+        bool isScope = ((indexedNode.flagsAndNameOffsetHigh & DEFFILE_HNAMES_FLAGS_NODE_IS_SCOPE) != 0);
+        if (pScopeIndexOut != nullptr)
+        {
+            *pScopeIndexOut = (isScope ? indexedNode.payload : -1);
+        }
+
+        if (pItemIndexOut != nullptr)
+        {
+            *pItemIndexOut = (isScope ? -1 : indexedNode.payload);
+        }
+
+        if (pNameIndexOut != nullptr)
+        {
+            *pNameIndexOut = indexedNameIndex;
+        }
+        return true;
+    }
+
     // Start at 'relativeTo'
     const DEFFILE_HNAMES_SCOPE_LARGE* pScope;
     DEFFILE_HNAMES_SCOPE_LARGE scopeNode;
@@ -1259,6 +1306,141 @@ HRESULT HierarchicalNames::CompareNameSegment(_In_ const T* pNode, _In_ PCWSTR p
     return S_OK;
 }
 
+bool HierarchicalNames::TryGetNode(_In_ int nodeIndex, _Out_ DEFFILE_HNAMES_NODE_LARGE* pNodeOut) const
+{
+    if ((nodeIndex < 0) || (static_cast<UINT32>(nodeIndex) >= m_pHeader->numNodes))
+    {
+        return false;
+    }
+
+    *pNodeOut = (m_largeNode ? m_pNodesLarge[nodeIndex] : HNAMES_NODE_TO_HNAMES_NODE_LARGE(&m_pNodes[nodeIndex]));
+    return true;
+}
+
+bool HierarchicalNames::TryFindInPathIndex(_In_ PCWSTR pPath, _In_ int relativeToScope, _Out_ int* pNameIndexOut) const
+{
+    *pNameIndexOut = -1;
+
+    UINT32 relativeToNode = (m_largeNode ? m_pScopesLarge[relativeToScope].nameNodeIndex : m_pScopes[relativeToScope].nameNodeIndex);
+    UINT32 hash = m_pScopePathHashes[relativeToScope];
+    if (relativeToNode != 0)
+    {
+        // Paths below the root are joined to their scope with a separator.
+        hash = HNamesHashPathChar(hash, GetDefaultPathSeparator());
+    }
+
+    // ignore leading separator, if present
+    PCWSTR pStr = (IsPathSeparator(pPath[0]) ? &pPath[1] : pPath);
+
+    int cchPath = 0;
+    bool atSegmentStart = true;
+    for (; pStr[cchPath] != L'\0'; cchPath++)
+    {
+        WCHAR ch = pStr[cchPath];
+        if (ch >= 0x80)
+        {
+            // Case-insensitive matching of non-ASCII names is left to the segment walk.
+            return false;
+        }
+
+        if (IsPathSeparator(ch))
+        {
+            if (atSegmentStart)
+            {
+                // Empty segments are rejected by the segment walk.
+                return false;
+            }
+            atSegmentStart = true;
+        }
+        else
+        {
+            atSegmentStart = false;
+        }
+        hash = HNamesHashPathChar(hash, ch);
+    }
+
+    if (atSegmentStart)
+    {
+        // Empty path or trailing separator.
+        return false;
+    }
+
+    UINT32 mask = m_pPathIndex->numBuckets - 1;
+    for (UINT32 probe = 0, bucket = (hash & mask); probe < m_pPathIndex->numBuckets; probe++, bucket = ((bucket + 1) & mask))
+    {
+        const DEFFILE_HNAMES_PATH_INDEX_ENTRY* pEntry = &m_pPathIndexEntries[bucket];
+        if (pEntry->nodeIndex == 0)
+        {
+            // Empty bucket. The name isn't present.
+            return true;
+        }
+
+        if ((pEntry->pathHash == hash) && PathIndexEntryMatches(pEntry->nodeIndex, relativeToNode, pStr, cchPath))
+        {
+            *pNameIndexOut = static_cast<int>(pEntry->nodeIndex);
+            return true;
+        }
+    }
+    return true;
+}
+
+bool HierarchicalNames::PathIndexEntryMatches(
+    _In_ UINT32 nodeIndex,
+    _In_ UINT32 relativeToNode,
+    _In_reads_(cchPath) PCWSTR pPath,
+    _In_ int cchPath) const
+{
+    // Compare segments from the end of the path back to the scope we're looking in.
+    // Each step consumes at least one character, so the loop always terminates.
+    int cchRemaining = cchPath;
+    while (nodeIndex != relativeToNode)
+    {
+        DEFFILE_HNAMES_NODE_LARGE node;
+        if ((nodeIndex == 0) || !TryGetNode(static_cast<int>(nodeIndex), &node) || (node.cchName == 0) || (node.cchName > cchRemaining))
+        {
+            return false;
+        }
+
+        int segmentStart = cchRemaining - node.cchName;
+        if ((segmentStart > 0) && !IsPathSeparator(pPath[segmentStart - 1]))
+        {
+            return false;
+        }
+
+        UINT32 nameOffset = HNamesGetNodeNameOffsetLarge(&node);
+        if ((node.flagsAndNameOffsetHigh & DEFFILE_HNAMES_FLAGS_NAME_IS_ASCII) != 0)
+        {
+            PCSTR pName;
+            if (FAILED(GetAsciiName(nameOffset, node.cchName, &pName)) ||
+                (CompareStoredAsciiSegment(pName, node.cchName, &pPath[segmentStart]) != 0))
+            {
+                return false;
+            }
+        }
+        else
+        {
+            PCWSTR pName;
+            if (FAILED(GetUtf16Name(nameOffset, node.cchName, &pName)) ||
+                (CompareSegments(pName, node.cchName, &pPath[segmentStart], node.cchName) != 0))
+            {
+                return false;
+            }
+        }
+
+        if (segmentStart == 0)
+        {
+            // That was the first segment, so its parent must be the scope we're looking in.
+            return (node.parentNodeIndex == relativeToNode);
+        }
+
+        cchRemaining = segmentStart - 1;
+        nodeIndex = node.parentNodeIndex;
+    }
+
+    // Reached the scope we're looking in before using up the path.
+    return false;
+}
+
 HRESULT
 HierarchicalNames::GetNumDescendents(_In_ int scopeIndex, _In_ UINT32 currentDepth, _Out_opt_ int* pNumScopes, _Out_opt_ int* pNumItems)
     const
@@ -119,10 +119,14 @@ ManagedFile::ManagedFile(_In_ const MrmFile* pBaseFile) :
     m_loadFailed(false),
     m_pBaseFile(pBaseFile),
     m_pMyBaseFile(nullptr),
+    m_numPins(0),
+    m_lastAccess(0),
+    m_bEvicted(false),
     m_pPath(nullptr),
     m_fileSizeInBytes(0),
     m_fileLastModifiedDate(0),
     m_pPackageRoot(nullptr),
+    m_pDecodedStringCache(nullptr),
     m_pEnvironment(pBaseFile->GetUnifiedEnvironment())
 {}
 
@@ -149,6 +153,11 @@ ManagedFile::Initialize(_In_ const PriFileManager* pManager, _In_ const Normaliz
     RETURN_IF_FAILED(NormalizePackageRoot(m_pPath, pPackageRoot, &path));
     RETURN_IF_FAILED(path.ReleaseContents(&m_pPackageRoot, &size));
 
+    if (pManager->GetDecodedStringCacheBudget() > 0)
+    {
+        RETURN_IF_FAILED(SetDecodedStringCacheBudget(pManager->GetDecodedStringCacheBudget()));
+    }
+
     return S_OK;
 }
 
@@ -158,10 +167,14 @@ ManagedFile::ManagedFile(_In_ const PriFileManager* pManager, _In_ int globalInd
     m_loadFailed(false),
     m_pBaseFile(nullptr),
     m_pMyBaseFile(nullptr),
+    m_numPins(0),
+    m_lastAccess(0),
+    m_bEvicted(false),
     m_pPath(nullptr),
     m_fileSizeInBytes(0),
     m_fileLastModifiedDate(0),
     m_pPackageRoot(nullptr),
+    m_pDecodedStringCache(nullptr),
     m_pEnvironment(pManager->GetUnifiedEnvironment())
 {}
 
@@ -183,6 +196,9 @@ ManagedFile::~ManagedFile()
         Def_Free(m_pPackageRoot);
         m_pPackageRoot = nullptr;
     }
+
+    delete m_pDecodedStringCache;
+    m_pDecodedStringCache = nullptr;
 }
 
 HRESULT ManagedFile::InnerLoad() const
@@ -192,12 +208,37 @@ HRESULT ManagedFile::InnerLoad() const
         return S_OK;
     }
 
-    RETURN_IF_FAILED(MrmFile::CreateInstance(const_cast<PriFileManager*>(m_pManager), m_pPath, (MrmFile**)&m_pMyBaseFile));
+    MrmFile* pFile;
+    RETURN_IF_FAILED(MrmFile::CreateInstance(const_cast<PriFileManager*>(m_pManager), m_pPath, &pFile));
+    AdoptLoadedFile(pFile);
+
+    return S_OK;
+}
+
+HRESULT ManagedFile::Load(_In_ MrmFile* pLoadedFile)
+{
+    RETURN_HR_IF_NULL(E_INVALIDARG, pLoadedFile);
+    RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_OPERATION), (m_pBaseFile != nullptr) || (m_pManager == nullptr));
+
+    AdoptLoadedFile(pLoadedFile);
+
+    return S_OK;
+}
+
+void ManagedFile::AdoptLoadedFile(_In_ MrmFile* pFile) const
+{
+    pFile->SetDecodedStringCache(m_pDecodedStringCache);
+    m_pMyBaseFile = pFile;
     m_pBaseFile = m_pMyBaseFile;
 
     m_loadFailed = false;
 
-    return S_OK;
+    if (m_pManager != nullptr)
+    {
+        m_lastAccess = m_pManager->NoteFileAccess();
+        m_pManager->NoteFileLoaded(this, m_bEvicted);
+    }
+    m_bEvicted = false;
 }
 
 HRESULT ManagedFile::InnerUnload() const
@@ -214,9 +255,86 @@ HRESULT ManagedFile::InnerUnload() const
     delete m_pMyBaseFile;
     m_pMyBaseFile = nullptr;
     m_pBaseFile = nullptr;
+
+    if (m_pManager != nullptr)
+    {
+        m_pManager->NoteFileUnloaded(this);
+    }
+
+    // The file might change on disk before it is loaded again.
+    if (m_pDecodedStringCache != nullptr)
+    {
+        m_pDecodedStringCache->Clear();
+    }
+    return S_OK;
+}
+
+HRESULT ManagedFile::EnsureLoaded() const
+{
+    if (m_pBaseFile == nullptr)
+    {
+        // Loading stamps the access itself.
+        return InnerLoad();
+    }
+
+    if (m_pManager != nullptr)
+    {
+        m_lastAccess = m_pManager->NoteFileAccess();
+    }
     return S_OK;
 }
 
+HRESULT ManagedFile::Evict()
+{
+    if (!IsLoaded())
+    {
+        return S_OK;
+    }
+
+    RETURN_IF_FAILED(InnerUnload());
+
+    m_bEvicted = true;
+    return S_OK;
+}
+
+HRESULT ManagedFile::TrimColdSections() const
+{
+    if (!IsLoaded())
+    {
+        return S_FALSE;
+    }
+
+    return static_cast<const MrmFile*>(m_pBaseFile)->TrimColdSections();
+}
+
+HRESULT ManagedFile::SetDecodedStringCacheBudget(_In_ size_t cbBudget)
+{
+    if (m_pDecodedStringCache != nullptr)
+    {
+        // Lookups might be using the cache and the strings it returned, so keep it and just change the budget.
+        m_pDecodedStringCache->SetBudget(cbBudget);
+        return S_OK;
+    }
+
+    if (cbBudget == 0)
+    {
+        return S_OK;
+    }
+
+    RETURN_IF_FAILED(DecodedStringCache::CreateInstance(cbBudget, &m_pDecodedStringCache));
+
+    if (m_pMyBaseFile != nullptr)
+    {
+        static_cast<MrmFile*>(m_pMyBaseFile)->SetDecodedStringCache(m_pDecodedStringCache);
+    }
+    return S_OK;
+}
+
+DecodedStringCache* ManagedFile::GetDecodedStringCache(_In_ int fileIndex) const
+{
+    return ((fileIndex == 0) ? m_pDecodedStringCache : nullptr);
+}
+
 HRESULT ManagedFile::SetPackageRoot(_In_ PCWSTR pPackageRoot)
 {
     // Nothing to do if the path hasn't changed
@@ -245,10 +363,7 @@ HRESULT ManagedFile::SetPackageRoot(_In_ PCWSTR pPackageRoot)
 HRESULT ManagedFile::GetBaseFile(_Out_ const BaseFile** result) const
 {
     *result = nullptr;
-    if (m_pBaseFile == nullptr)
-    {
-        RETURN_IF_FAILED(InnerLoad());
-    }
+    RETURN_IF_FAILED(EnsureLoaded());
 
     DEF_ASSERT(m_pBaseFile != nullptr);
 
@@ -260,10 +375,7 @@ HRESULT ManagedFile::GetBaseFile(_Out_ const BaseFile** result) const
 HRESULT ManagedFile::GetBaseMrmFile(_Out_ const IMrmFile** result) const
 {
     *result = nullptr;
-    if (m_pBaseFile == nullptr)
-    {
-        RETURN_IF_FAILED(InnerLoad());
-    }
+    RETURN_IF_FAILED(EnsureLoaded());
     *result = m_pBaseFile;
     return S_OK;
 }
@@ -278,10 +390,7 @@ HRESULT ManagedFile::GetSection(
 
     RETURN_HR_IF(E_DEF_NOT_READY, fileIndex != 0);
 
-    if (m_pBaseFile == nullptr)
-    {
-        RETURN_IF_FAILED(InnerLoad());
-    }
+    RETURN_IF_FAILED(EnsureLoaded());
 
     DEF_ASSERT(m_pBaseFile != nullptr);
 
@@ -296,7 +405,7 @@ const bool ManagedFile::TryGetSectionIndexByType(
     _In_ int startAtSectionIndex,
     _Out_ int* nextSectionIndex) const
 {
-    if ((fileIndex != 0) || ((m_pBaseFile == nullptr) && FAILED(InnerLoad())))
+    if ((fileIndex != 0) || FAILED(EnsureLoaded()))
     {
         return false;
     }
@@ -312,10 +421,7 @@ HRESULT ManagedFile::GetAtomPoolSection(_In_ int fileIndex, _In_ BaseFile::Secti
 
     RETURN_HR_IF(E_DEF_NOT_READY, fileIndex != 0);
 
-    if (m_pBaseFile == nullptr)
-    {
-        RETURN_IF_FAILED(InnerLoad());
-    }
+    RETURN_IF_FAILED(EnsureLoaded());
 
     DEF_ASSERT(m_pBaseFile != nullptr);
 
@@ -332,10 +438,7 @@ ManagedFile::GetDecisionInfoSection(_In_ int fileIndex, _In_ BaseFile::SectionIn
 
     RETURN_HR_IF(E_DEF_NOT_READY, fileIndex != 0);
 
-    if (m_pBaseFile == nullptr)
-    {
-        RETURN_IF_FAILED(InnerLoad());
-    }
+    RETURN_IF_FAILED(EnsureLoaded());
 
     DEF_ASSERT(m_pBaseFile != nullptr);
 
@@ -350,10 +453,7 @@ HRESULT ManagedFile::GetSchemaSection(_In_ int fileIndex, _In_ BaseFile::Section
 
     RETURN_HR_IF(E_DEF_NOT_READY, fileIndex != 0);
 
-    if (m_pBaseFile == nullptr)
-    {
-        RETURN_IF_FAILED(InnerLoad());
-    }
+    RETURN_IF_FAILED(EnsureLoaded());
 
     DEF_ASSERT(m_pBaseFile != nullptr);
 
@@ -372,10 +472,7 @@ HRESULT ManagedFile::GetResourceMapSection(
 
     RETURN_HR_IF(E_DEF_NOT_READY, fileIndex != 0);
 
-    if (m_pBaseFile == nullptr)
-    {
-        RETURN_IF_FAILED(InnerLoad());
-    }
+    RETURN_IF_FAILED(EnsureLoaded());
 
     DEF_ASSERT(m_pBaseFile != nullptr);
 
@@ -394,10 +491,7 @@ HRESULT ManagedFile::GetPriDescriptorSection(
 
     RETURN_HR_IF(E_DEF_NOT_READY, fileIndex != 0);
 
-    if (m_pBaseFile == nullptr)
-    {
-        RETURN_IF_FAILED(InnerLoad());
-    }
+    RETURN_IF_FAILED(EnsureLoaded());
 
     DEF_ASSERT(m_pBaseFile != nullptr);
 
@@ -412,10 +506,7 @@ HRESULT ManagedFile::GetFileListSection(_In_ int fileIndex, _In_ BaseFile::Secti
 
     RETURN_HR_IF(E_DEF_NOT_READY, fileIndex != 0);
 
-    if (m_pBaseFile == nullptr)
-    {
-        RETURN_IF_FAILED(InnerLoad());
-    }
+    RETURN_IF_FAILED(EnsureLoaded());
 
     DEF_ASSERT(m_pBaseFile != nullptr);
 
@@ -431,10 +522,7 @@ ManagedFile::GetDataItemsSection(_In_ int fileIndex, _In_ BaseFile::SectionIndex
 
     RETURN_HR_IF(E_DEF_NOT_READY, fileIndex != 0);
 
-    if (m_pBaseFile == nullptr)
-    {
-        RETURN_IF_FAILED(InnerLoad());
-    }
+    RETURN_IF_FAILED(EnsureLoaded());
 
     DEF_ASSERT(m_pBaseFile != nullptr);
 
@@ -449,10 +537,7 @@ HRESULT ManagedFile::GetDataSection(_In_ int fileIndex, _In_ BaseFile::SectionIn
 
     RETURN_HR_IF(E_DEF_NOT_READY, fileIndex != 0);
 
-    if (m_pBaseFile == nullptr)
-    {
-        RETURN_IF_FAILED(InnerLoad());
-    }
+    RETURN_IF_FAILED(EnsureLoaded());
 
     DEF_ASSERT(m_pBaseFile != nullptr);
 
@@ -468,10 +553,7 @@ ManagedFile::GetReverseFileMapSection(_In_ int fileIndex, _In_ BaseFile::Section
 
     RETURN_HR_IF(E_DEF_NOT_READY, fileIndex != 0);
 
-    if (m_pBaseFile == nullptr)
-    {
-        RETURN_IF_FAILED(InnerLoad());
-    }
+    RETURN_IF_FAILED(EnsureLoaded());
 
     DEF_ASSERT(m_pBaseFile != nullptr);
 
@@ -489,10 +571,7 @@ HRESULT ManagedFile::GetEnvironmentMappingSection(
 
     RETURN_HR_IF(E_DEF_NOT_READY, fileIndex != 0);
 
-    if (m_pBaseFile == nullptr)
-    {
-        RETURN_IF_FAILED(InnerLoad());
-    }
+    RETURN_IF_FAILED(EnsureLoaded());
 
     DEF_ASSERT(m_pBaseFile != nullptr);
 
@@ -511,10 +590,7 @@ HRESULT ManagedFile::GetResourceLinkSection(
 
     RETURN_HR_IF(E_DEF_NOT_READY, fileIndex != 0);
 
-    if (m_pBaseFile == nullptr)
-    {
-        RETURN_IF_FAILED(InnerLoad());
-    }
+    RETURN_IF_FAILED(EnsureLoaded());
 
     DEF_ASSERT(m_pBaseFile != nullptr);
 
@@ -530,10 +606,7 @@ HRESULT ManagedFile::GetFileDefaultEnvironment(
 {
     RETURN_HR_IF(E_DEF_NOT_READY, fileIndex != 0);
 
-    if (m_pBaseFile == nullptr)
-    {
-        RETURN_IF_FAILED(InnerLoad());
-    }
+    RETURN_IF_FAILED(EnsureLoaded());
 
     DEF_ASSERT(m_pBaseFile != nullptr);
 
@@ -545,10 +618,7 @@ HRESULT ManagedFile::GetDefaultQualifierMapping(_In_ int fileIndex, _Out_ const
     *result = nullptr;
     RETURN_HR_IF(E_DEF_NOT_READY, fileIndex != 0);
 
-    if (m_pBaseFile == nullptr)
-    {
-        RETURN_IF_FAILED(InnerLoad());
-    }
+    RETURN_IF_FAILED(EnsureLoaded());
 
     DEF_ASSERT(m_pBaseFile != nullptr);
 
@@ -557,6 +627,98 @@ HRESULT ManagedFile::GetDefaultQualifierMapping(_In_ int fileIndex, _Out_ const
     return S_OK;
 }
 
+// Process-wide cache of normalized relative paths.  A fixed open-addressed table keyed by the
+// case-insensitive hash of the full path; it is simply emptied when it gets three quarters full.
+typedef struct NormalizedPathCacheEntry
+{
+    Atom::Hash hash;
+    PWSTR pFullPath;
+    PWSTR pNormalizedPath;
+} NormalizedPathCacheEntry;
+
+static const int NormalizedPathCacheSize = 256;
+static NormalizedPathCacheEntry g_normalizedPathCache[NormalizedPathCacheSize];
+static int g_numNormalizedPaths = 0;
+static SRWLOCK g_normalizedPathCacheLock = SRWLOCK_INIT;
+
+static void ClearNormalizedPathCacheLocked()
+{
+    for (int i = 0; i < NormalizedPathCacheSize; i++)
+    {
+        _DefFree(g_normalizedPathCache[i].pFullPath);
+        _DefFree(g_normalizedPathCache[i].pNormalizedPath);
+        g_normalizedPathCache[i].hash = 0;
+        g_normalizedPathCache[i].pFullPath = nullptr;
+        g_normalizedPathCache[i].pNormalizedPath = nullptr;
+    }
+    g_numNormalizedPaths = 0;
+}
+
+static bool TryGetCachedNormalizedPath(_In_ PCWSTR pFullPath, _In_ Atom::Hash hash, _Inout_ StringResult* pPathOut)
+{
+    bool bFound = false;
+
+    AcquireSRWLockShared(&g_normalizedPathCacheLock);
+    for (int slot = static_cast<int>(hash % NormalizedPathCacheSize); g_normalizedPathCache[slot].pFullPath != nullptr;
+         slot = ((slot + 1) % NormalizedPathCacheSize))
+    {
+        if ((g_normalizedPathCache[slot].hash == hash) && (DefString_ICompare(pFullPath, g_normalizedPathCache[slot].pFullPath) == Def_Equal))
+        {
+            bFound = SUCCEEDED(pPathOut->SetCopy(g_normalizedPathCache[slot].pNormalizedPath));
+            break;
+        }
+    }
+    ReleaseSRWLockShared(&g_normalizedPathCacheLock);
+
+    return bFound;
+}
+
+// Failing to cache a path isn't an error; the next lookup just goes to the file system again.
+static void CacheNormalizedPath(_In_ PCWSTR pFullPath, _In_ Atom::Hash hash, _In_ PCWSTR pNormalizedPath)
+{
+    size_t cchFullPath = wcslen(pFullPath) + 1;
+    size_t cchNormalizedPath = wcslen(pNormalizedPath) + 1;
+    unique_deffree_ptr<WCHAR> pFullPathCopy(_DefArray_AllocZeroed(WCHAR, cchFullPath));
+    unique_deffree_ptr<WCHAR> pNormalizedPathCopy(_DefArray_AllocZeroed(WCHAR, cchNormalizedPath));
+    if ((pFullPathCopy.get() == nullptr) || (pNormalizedPathCopy.get() == nullptr) ||
+        FAILED(DefString_CchCopy(pFullPathCopy.get(), cchFullPath, pFullPath)) ||
+        FAILED(DefString_CchCopy(pNormalizedPathCopy.get(), cchNormalizedPath, pNormalizedPath)))
+    {
+        return;
+    }
+
+    AcquireSRWLockExclusive(&g_normalizedPathCacheLock);
+    if (((g_numNormalizedPaths + 1) * 4) > (NormalizedPathCacheSize * 3))
+    {
+        ClearNormalizedPathCacheLocked();
+    }
+
+    int slot = static_cast<int>(hash % NormalizedPathCacheSize);
+    while (g_normalizedPathCache[slot].pFullPath != nullptr)
+    {
+        if ((g_normalizedPathCache[slot].hash == hash) && (DefString_ICompare(pFullPath, g_normalizedPathCache[slot].pFullPath) == Def_Equal))
+        {
+            // Another thread got here first.
+            ReleaseSRWLockExclusive(&g_normalizedPathCacheLock);
+            return;
+        }
+        slot = ((slot + 1) % NormalizedPathCacheSize);
+    }
+
+    g_normalizedPathCache[slot].hash = hash;
+    g_normalizedPathCache[slot].pFullPath = pFullPathCopy.release();
+    g_normalizedPathCache[slot].pNormalizedPath = pNormalizedPathCopy.release();
+    g_numNormalizedPaths++;
+    ReleaseSRWLockExclusive(&g_normalizedPathCacheLock);
+}
+
+void ManagedFile::ClearNormalizedPathCache()
+{
+    AcquireSRWLockExclusive(&g_normalizedPathCacheLock);
+    ClearNormalizedPathCacheLocked();
+    ReleaseSRWLockExclusive(&g_normalizedPathCacheLock);
+}
+
 HRESULT ManagedFile::NormalizeFilePath(_In_ PCWSTR pFilePath, _Inout_ StringResult* pPathOut)
 {
     RETURN_HR_IF(E_INVALIDARG, (pPathOut == nullptr) || (DefString_IsEmpty(pFilePath)));
@@ -570,6 +732,31 @@ HRESULT ManagedFile::NormalizeFilePath(_In_ PCWSTR pFilePath, _Inout_ StringResu
     }
     else
     {
+        // Key the cache on the full path so that a change of current directory can't return a stale
+        // result.  Getting the full path is just string manipulation, unlike opening the file.
+        unique_deffree_ptr<wchar_t> pszFullPath;
+        Atom::Hash fullPathHash = 0;
+        DWORD cchFullPath = ::GetFullPathNameW(pFilePath, 0, nullptr, nullptr);
+        if (cchFullPath > 0)
+        {
+            pszFullPath.reset(_DefArray_AllocZeroed(wchar_t, cchFullPath));
+            RETURN_IF_NULL_ALLOC(pszFullPath.get());
+
+            DWORD cchWritten = ::GetFullPathNameW(pFilePath, cchFullPath, pszFullPath.get(), nullptr);
+            if ((cchWritten == 0) || (cchWritten >= cchFullPath))
+            {
+                pszFullPath.reset();
+            }
+            else
+            {
+                fullPathHash = Atom::HashString(pszFullPath.get(), Atom::HashMethodCaseInsensitiveVersion2);
+                if (TryGetCachedNormalizedPath(pszFullPath.get(), fullPathHash, pPathOut))
+                {
+                    return S_OK;
+                }
+            }
+        }
+
         wil::unique_handle hFile(::CreateFileW(pFilePath, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, 0, OPEN_EXISTING, 0, 0));
         RETURN_LAST_ERROR_IF(hFile.get() == INVALID_HANDLE_VALUE);
 
@@ -612,6 +799,11 @@ HRESULT ManagedFile::NormalizeFilePath(_In_ PCWSTR pFilePath, _Inout_ StringResu
         {
             RETURN_LAST_ERROR();
         }
+
+        if (pszFullPath.get() != nullptr)
+        {
+            CacheNormalizedPath(pszFullPath.get(), fullPathHash, pPathOut->GetRef());
+        }
     }
 
     return S_OK;
@@ -482,6 +482,9 @@ HRESULT MrmFile::Init(_In_ PriFileManager* pManager, _In_ PCWSTR pPath)
     RETURN_IF_FAILED(InitSections());
     RETURN_IF_FAILED(MrmFileResolver::CreateInstance(m_pPriFileManager, &m_pFileResolver));
 
+    // Start reading the sections that the first lookup needs while the caller sets up the rest.
+    (void)PrefetchHotSections();
+
     PCWSTR pFileName = wcsrchr(pPath, L'\\');
     if (pFileName != nullptr)
     {
@@ -547,6 +550,74 @@ void MrmFile::ReleaseSections()
     m_pBaseFile = nullptr;
 }
 
+static const DEFFILE_SECTION_TYPEID* const gHotSectionTypes[] = {
+    &gPriDescriptorSectionType,
+    &gPriDescriptorExSectionType,
+    &gHierarchicalSchemaSectionType,
+    &gHierarchicalSchemaExSectionType,
+    &gHierarchicalNamesSectionType,
+    &gDecisionInfoSectionType,
+    &gResourceMapSectionType,
+    &gResourceMap2SectionType,
+    &gResourceMap3SectionType,
+};
+
+bool MrmFile::IsHotSectionType(_In_ const DEFFILE_SECTION_TYPEID& sectionType)
+{
+    for (int i = 0; i < ARRAYSIZE(gHotSectionTypes); i++)
+    {
+        if (BaseFile::SectionTypesEqual(sectionType, *gHotSectionTypes[i]))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+HRESULT MrmFile::PrefetchHotSections() const
+{
+    RETURN_HR_IF_NULL(E_DEF_NOT_READY, m_pBaseFile);
+
+    if (!m_pBaseFile->IsMapped())
+    {
+        return S_FALSE;
+    }
+
+    for (int i = 0; i < m_pBaseFile->GetNumSections(); i++)
+    {
+        const DEFFILE_TOC_ENTRY* pToc;
+        RETURN_IF_FAILED(m_pBaseFile->GetTocEntry(i, &pToc));
+        if (IsHotSectionType(pToc->type))
+        {
+            RETURN_IF_FAILED(m_pBaseFile->PrefetchSectionPages(i));
+        }
+    }
+    return S_OK;
+}
+
+HRESULT MrmFile::TrimColdSections() const
+{
+    RETURN_HR_IF_NULL(E_DEF_NOT_READY, m_pBaseFile);
+
+    if (!m_pBaseFile->IsMapped())
+    {
+        return S_FALSE;
+    }
+
+    // Sections aren't page aligned, so this can also trim the edge of a neighboring hot section. Those
+    // pages come back from the file on their next use like any other.
+    for (int i = 0; i < m_pBaseFile->GetNumSections(); i++)
+    {
+        const DEFFILE_TOC_ENTRY* pToc;
+        RETURN_IF_FAILED(m_pBaseFile->GetTocEntry(i, &pToc));
+        if (!IsHotSectionType(pToc->type))
+        {
+            RETURN_IF_FAILED(m_pBaseFile->TrimSectionPages(i));
+        }
+    }
+    return S_OK;
+}
+
 HRESULT MrmFile::InitializeAndGetSection(_In_ BaseFile::SectionIndex sectionIndex, _Out_ MrmFileSection** result) const
 {
     *result = nullptr;
@@ -1206,4 +1277,20 @@ HRESULT MrmFile::GetFilePath(_In_ int fileIndex, _Inout_ StringResult* pStringRe
 
 int MrmFile::GetNumFiles() const { return m_pPriFileManager->GetNumFiles(); }
 
+DecodedStringCache* MrmFile::GetDecodedStringCache(_In_ int fileIndex) const
+{
+    if (fileIndex == 0)
+    {
+        return m_pDecodedStringCache;
+    }
+
+    int globalFileIndex;
+    if ((m_pPriFileManager == nullptr) || (m_pFileResolver == nullptr) || FAILED(m_pFileResolver->GetGlobalIndex(fileIndex, &globalFileIndex)))
+    {
+        return nullptr;
+    }
+
+    return m_pPriFileManager->GetDecodedStringCache(globalFileIndex);
+}
+
 } // namespace Microsoft::Resources
@@ -3,6 +3,10 @@
 
 #include "mrm/common/Base.h"
 
+#if !defined(DEF_RTL) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
 // Platform specific implementations of common utility functions.
 
 #ifdef DEF_RTL
@@ -893,6 +897,45 @@ extern "C"
         return TRUE;
     }
 
+    HRESULT
+    _DefPrefetchVirtualMemory(__in_bcount(cbSize) const VOID* pAddress, __in size_t cbSize)
+    {
+        UNREFERENCED_PARAMETER(pAddress);
+        UNREFERENCED_PARAMETER(cbSize);
+
+        // Prefetching is only a hint, so skip it here.
+        return S_FALSE;
+    }
+
+    HRESULT
+    _DefTrimVirtualMemory(__in_bcount(cbSize) const VOID* pAddress, __in size_t cbSize)
+    {
+        UNREFERENCED_PARAMETER(pAddress);
+        UNREFERENCED_PARAMETER(cbSize);
+
+        // Trimming is only a hint, so skip it here.
+        return S_FALSE;
+    }
+
+    HRESULT
+    _DefRunParallelForEach(__in ULONG count, __in ULONG maxThreads, __in PDEF_PARALLEL_CALLBACK pCallback, __inout_opt PVOID pContext)
+    {
+        UNREFERENCED_PARAMETER(maxThreads);
+
+        if (pCallback == nullptr)
+        {
+            return E_INVALIDARG;
+        }
+
+        // No thread pool here, so make every call on this thread.
+        for (ULONG i = 0; i < count; i++)
+        {
+            pCallback(pContext, i);
+        }
+
+        return S_OK;
+    }
+
     UINT _DefGetDriveTypeW(_In_opt_ PCWSTR rootPathName)
     {
         UNREFERENCED_PARAMETER(rootPathName);
@@ -1094,6 +1137,104 @@ extern "C"
     BOOLEAN
     _DefUnmapViewOfFile(__in PVOID pBaseAddress) { return (BOOLEAN)UnmapViewOfFile(pBaseAddress); }
 
+    HRESULT
+    _DefPrefetchVirtualMemory(__in_bcount(cbSize) const VOID* pAddress, __in size_t cbSize)
+    {
+        if ((pAddress == nullptr) || (cbSize == 0))
+        {
+            return E_INVALIDARG;
+        }
+
+        WIN32_MEMORY_RANGE_ENTRY range = {const_cast<PVOID>(pAddress), cbSize};
+        if (!PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0))
+        {
+            return HRESULT_FROM_WIN32(GetLastError());
+        }
+
+        return S_OK;
+    }
+
+    HRESULT
+    _DefTrimVirtualMemory(__in_bcount(cbSize) const VOID* pAddress, __in size_t cbSize)
+    {
+        if ((pAddress == nullptr) || (cbSize == 0))
+        {
+            return E_INVALIDARG;
+        }
+
+        // Unlocking pages that aren't locked removes them from the working set. Clean pages of a
+        // mapped file stay cached by the system and are mapped in again on their next use.
+        if (!VirtualUnlock(const_cast<PVOID>(pAddress), cbSize))
+        {
+            DWORD error = GetLastError();
+            if (error != ERROR_NOT_LOCKED)
+            {
+                return HRESULT_FROM_WIN32(error);
+            }
+        }
+
+        return S_OK;
+    }
+
+    typedef struct _DEF_PARALLEL_BATCH
+    {
+        PDEF_PARALLEL_CALLBACK pCallback;
+        PVOID pContext;
+        LONG count;
+        volatile LONG next;
+    } DEF_PARALLEL_BATCH;
+
+    // Every thread claims the next index until there are none left, so threads that finish early take more.
+    static void _DefRunParallelBatch(__inout DEF_PARALLEL_BATCH* pBatch)
+    {
+        LONG i;
+        while ((i = InterlockedIncrement(&pBatch->next) - 1) < pBatch->count)
+        {
+            pBatch->pCallback(pBatch->pContext, static_cast<ULONG>(i));
+        }
+    }
+
+    static VOID CALLBACK _DefParallelBatchCallback(__inout PTP_CALLBACK_INSTANCE, __inout_opt PVOID pContext, __inout PTP_WORK)
+    {
+        _DefRunParallelBatch(static_cast<DEF_PARALLEL_BATCH*>(pContext));
+    }
+
+    HRESULT
+    _DefRunParallelForEach(__in ULONG count, __in ULONG maxThreads, __in PDEF_PARALLEL_CALLBACK pCallback, __inout_opt PVOID pContext)
+    {
+        if ((pCallback == nullptr) || (count > LONG_MAX))
+        {
+            return E_INVALIDARG;
+        }
+
+        DEF_PARALLEL_BATCH batch = {pCallback, pContext, static_cast<LONG>(count), 0};
+
+        // The calling thread takes indexes too, so it only needs help with the rest.
+        ULONG numWorkers = (((count > 1) && (maxThreads > 1)) ? (min(count, maxThreads) - 1) : 0);
+        if (numWorkers == 0)
+        {
+            _DefRunParallelBatch(&batch);
+            return S_OK;
+        }
+
+        PTP_WORK work = CreateThreadpoolWork(_DefParallelBatchCallback, &batch, nullptr);
+        if (work == nullptr)
+        {
+            return HRESULT_FROM_WIN32(GetLastError());
+        }
+
+        for (ULONG i = 0; i < numWorkers; i++)
+        {
+            SubmitThreadpoolWork(work);
+        }
+
+        _DefRunParallelBatch(&batch);
+        WaitForThreadpoolWorkCallbacks(work, FALSE);
+        CloseThreadpoolWork(work);
+
+        return S_OK;
+    }
+
     ULONG
     _DefVirtualQuery(__in_opt PVOID Address, __out_bcount(Length) PMEMORY_BASIC_INFORMATION Buffer, __in ULONG Length)
     {
@@ -1149,7 +1290,7 @@ extern "C"
     //
     //
 
-    const UINT32 gCrc32Table[] = {
+    constexpr UINT32 gCrc32Table[] = {
         0x00000000, 0x77073096, 0xee0e612c, 0x990951ba, 0x076dc419, 0x706af48f, 0xe963a535, 0x9e6495a3, 0x0edb8832, 0x79dcb8a4, 0xe0d5e91e,
         0x97d2d988, 0x09b64c2b, 0x7eb17cbd, 0xe7b82d07, 0x90bf1d91, 0x1db71064, 0x6ab020f2, 0xf3b97148, 0x84be41de, 0x1adad47d, 0x6ddde4eb,
         0xf4d4b551, 0x83d385c7, 0x136c9856, 0x646ba8c0, 0xfd62f97a, 0x8a65c9ec, 0x14015c4f, 0x63066cd9, 0xfa0f3d63, 0x8d080df5, 0x3b6e20c8,
@@ -1175,6 +1316,202 @@ extern "C"
         0x53b39330, 0x24b4a3a6, 0xbad03605, 0xcdd70693, 0x54de5729, 0x23d967bf, 0xb3667a2e, 0xc4614ab8, 0x5d681b02, 0x2a6f2b94, 0xb40bbe37,
         0xc30c8ea1, 0x5a05df1b, 0x2d02ef8d};
 
+    //
+    // Tables for the slice-by-8 CRC. Slice 0 is gCrc32Table and slice n gives
+    // the CRC contribution of a byte followed by n zero bytes, so eight bytes
+    // can be folded into the CRC with eight independent lookups.
+    //
+
+    struct DefCrc32SliceTables
+    {
+        UINT32 entries[8][256];
+    };
+
+    static constexpr DefCrc32SliceTables _DefMakeCrc32SliceTables()
+    {
+        DefCrc32SliceTables tables = {};
+        for (int i = 0; i < 256; i++)
+        {
+            tables.entries[0][i] = gCrc32Table[i];
+        }
+
+        for (int slice = 1; slice < 8; slice++)
+        {
+            for (int i = 0; i < 256; i++)
+            {
+                UINT32 previous = tables.entries[slice - 1][i];
+                tables.entries[slice][i] = gCrc32Table[previous & 0xff] ^ (previous >> 8);
+            }
+        }
+        return tables;
+    }
+
+    constexpr DefCrc32SliceTables gCrc32SliceTables = _DefMakeCrc32SliceTables();
+
+    // Takes and returns the CRC without pre- and post-conditioning.
+    static UINT32 _DefUpdateCrc32Slice8(__in UINT32 crc, __in_bcount(cbBuf) const BYTE* pBuf, __in UINT32 cbBuf)
+    {
+        const UINT32(&table)[8][256] = gCrc32SliceTables.entries;
+
+        while (cbBuf >= 8)
+        {
+            UINT32 low;
+            UINT32 high;
+            memcpy(&low, pBuf, sizeof(low));
+            memcpy(&high, pBuf + 4, sizeof(high));
+            low ^= crc;
+
+            crc = table[7][low & 0xff] ^ table[6][(low >> 8) & 0xff] ^ table[5][(low >> 16) & 0xff] ^ table[4][low >> 24] ^
+                  table[3][high & 0xff] ^ table[2][(high >> 8) & 0xff] ^ table[1][(high >> 16) & 0xff] ^ table[0][high >> 24];
+
+            pBuf += 8;
+            cbBuf -= 8;
+        }
+
+        while (cbBuf > 0)
+        {
+            crc = table[0][(crc ^ *pBuf) & 0xff] ^ (crc >> 8);
+            pBuf++;
+            cbBuf--;
+        }
+
+        return crc;
+    }
+
+#if defined(_M_X64)
+
+    //
+    // CRC folding with carry-less multiplication, from "Fast CRC Computation for
+    // Generic Polynomials Using PCLMULQDQ Instruction" (Intel, 2009). The constants
+    // are the bit-reflected fold and Barrett reduction constants for the CRC-32
+    // polynomial used by gCrc32Table.
+    //
+
+    static const int DefCrc32ClmulMinimumLength = 64;
+
+    __declspec(align(16)) static const UINT64 gCrc32ClmulFold4[2] = {0x0154442bd4, 0x01c6e41596};
+    __declspec(align(16)) static const UINT64 gCrc32ClmulFold1[2] = {0x01751997d0, 0x00ccaa009e};
+    __declspec(align(16)) static const UINT64 gCrc32ClmulFold64[2] = {0x0163cd6124, 0x0000000000};
+    __declspec(align(16)) static const UINT64 gCrc32ClmulBarrett[2] = {0x01db710641, 0x01f7011641};
+
+    // -1 until the processor has been checked, then 1 if PCLMULQDQ and SSE4.1 are available.
+    static volatile LONG gCrc32UseClmul = -1;
+
+    static BOOLEAN _DefCrc32CanUseClmul()
+    {
+        LONG useClmul = gCrc32UseClmul;
+        if (useClmul < 0)
+        {
+            int cpuInfo[4];
+            __cpuid(cpuInfo, 1);
+
+            // PCLMULQDQ is ECX bit 1 and SSE4.1 is ECX bit 19.
+            useClmul = ((((cpuInfo[2] >> 1) & 1) != 0) && (((cpuInfo[2] >> 19) & 1) != 0)) ? 1 : 0;
+            gCrc32UseClmul = useClmul;
+        }
+        return (useClmul != 0);
+    }
+
+    // Takes and returns the CRC without pre- and post-conditioning. cbBuf must be
+    // at least DefCrc32ClmulMinimumLength and a multiple of 16.
+    static UINT32 _DefUpdateCrc32Clmul(__in UINT32 crc, __in_bcount(cbBuf) const BYTE* pBuf, __in UINT32 cbBuf)
+    {
+        __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8, y5, y6, y7, y8;
+
+        // Load the first 64 bytes and mix in the incoming CRC.
+        x1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pBuf + 0x00));
+        x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pBuf + 0x10));
+        x3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pBuf + 0x20));
+        x4 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pBuf + 0x30));
+        x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(static_cast<int>(crc)));
+
+        x0 = _mm_load_si128(reinterpret_cast<const __m128i*>(gCrc32ClmulFold4));
+
+        pBuf += 64;
+        cbBuf -= 64;
+
+        // Fold four 128-bit lanes in parallel, 64 bytes at a time.
+        while (cbBuf >= 64)
+        {
+            x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+            x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+            x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+            x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+
+            x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+            x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+            x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+            x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+
+            y5 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pBuf + 0x00));
+            y6 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pBuf + 0x10));
+            y7 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pBuf + 0x20));
+            y8 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pBuf + 0x30));
+
+            x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), y5);
+            x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), y6);
+            x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), y7);
+            x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), y8);
+
+            pBuf += 64;
+            cbBuf -= 64;
+        }
+
+        // Fold the four lanes into one.
+        x0 = _mm_load_si128(reinterpret_cast<const __m128i*>(gCrc32ClmulFold1));
+
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+        // Fold in any remaining 16-byte blocks.
+        while (cbBuf >= 16)
+        {
+            x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pBuf));
+
+            x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+            x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+            x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+            pBuf += 16;
+            cbBuf -= 16;
+        }
+
+        // Fold 128 bits down to 64.
+        x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+        x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+        x1 = _mm_srli_si128(x1, 8);
+        x1 = _mm_xor_si128(x1, x2);
+
+        x0 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(gCrc32ClmulFold64));
+
+        x2 = _mm_srli_si128(x1, 4);
+        x1 = _mm_and_si128(x1, x3);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x1 = _mm_xor_si128(x1, x2);
+
+        // Barrett reduction to 32 bits.
+        x0 = _mm_load_si128(reinterpret_cast<const __m128i*>(gCrc32ClmulBarrett));
+
+        x2 = _mm_and_si128(x1, x3);
+        x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+        x2 = _mm_and_si128(x2, x3);
+        x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+        x1 = _mm_xor_si128(x1, x2);
+
+        return static_cast<UINT32>(_mm_extract_epi32(x1, 1));
+    }
+
+#endif // _M_X64
+
     /*
  * Compute the CRC32 as specified in in IS0 3309. See RFC-1662 and RFC-1952
  * for implementation details and references.
@@ -1205,7 +1542,6 @@ extern "C"
     _DefComputeCrc32(__in UINT32 partialCrc, __in_bcount(cbBuf) const BYTE* pBuf, __in UINT32 cbBuf)
     {
         UINT32 crc;
-        UINT32 i;
 
         //
         // Compute the CRC32 checksum.
@@ -1213,10 +1549,19 @@ extern "C"
 
         crc = partialCrc ^ 0xffffffffL;
 
-        for (i = 0; i < cbBuf; i++)
+#if defined(_M_X64)
+        // Fold the bulk of the buffer with carry-less multiplication when the processor
+        // supports it; slice-by-8 picks up the last few bytes.
+        if ((cbBuf >= DefCrc32ClmulMinimumLength) && _DefCrc32CanUseClmul())
         {
-            crc = gCrc32Table[(crc ^ pBuf[i]) & 0xff] ^ (crc >> 8);
+            UINT32 cbFolded = cbBuf & ~static_cast<UINT32>(15);
+            crc = _DefUpdateCrc32Clmul(crc, pBuf, cbFolded);
+            pBuf += cbFolded;
+            cbBuf -= cbFolded;
         }
+#endif
+
+        crc = _DefUpdateCrc32Slice8(crc, pBuf, cbBuf);
 
         return (crc ^ 0xffffffffL);
     }
@@ -31,22 +31,121 @@ HRESULT PriFileManager::GetFile(_In_ int index, _Out_ ManagedFile** result) cons
     return E_INVALIDARG;
 }
 
-HRESULT PriFileManager::GetFile(_In_ const NormalizedFilePath* pNormalizedPath, _Out_ ManagedFile** result) const
+ManagedFile* PriFileManager::FindFile(_In_ PCWSTR pNormalizedPath) const
 {
-    *result = nullptr;
+    if (m_numIndexedFiles == 0)
+    {
+        return nullptr;
+    }
 
-    ManagedFile* pRtrn = nullptr;
-    // See if we already have the file
-    for (int i = 0; i < m_pFiles->Count(); i++)
+    Atom::Hash hash = HashFilePath(pNormalizedPath);
+    ManagedFile* pFound = nullptr;
+
+    // Keep probing past the first match; InsertFile can put a second copy of a path ahead of the first.
+    int mask = m_fileIndexSize - 1;
+    for (int slot = static_cast<int>(hash & mask); m_pFileIndex[slot].pFile != nullptr; slot = ((slot + 1) & mask))
     {
-        GetFile(i, &pRtrn);
-        if ((pRtrn != nullptr) && (DefString_ICompare(pNormalizedPath->GetRef(), pRtrn->GetPath()) == Def_Equal))
+        ManagedFile* pFile = m_pFileIndex[slot].pFile;
+        if ((m_pFileIndex[slot].pathHash == hash) && (DefString_ICompare(pNormalizedPath, pFile->GetPath()) == Def_Equal) &&
+            ((pFound == nullptr) || (pFile->GetGlobalIndex() < pFound->GetGlobalIndex())))
         {
-            *result = pRtrn;
-            return S_OK;
+            pFound = pFile;
+        }
+    }
+
+    return pFound;
+}
+
+HRESULT PriFileManager::IndexFile(_In_ ManagedFile* pFile) const
+{
+    // Keep the table at most three quarters full so that probes stay short.
+    if (((m_numIndexedFiles + 1) * 4) > (m_fileIndexSize * 3))
+    {
+        int newSize = ((m_fileIndexSize > 0) ? (m_fileIndexSize * 2) : DefaultInitialFileIndexSize);
+        FileIndexEntry* pNewIndex = _DefArray_AllocZeroed(FileIndexEntry, newSize);
+        RETURN_IF_NULL_ALLOC(pNewIndex);
+
+        // Rehash from the stored hashes.
+        for (int i = 0; i < m_fileIndexSize; i++)
+        {
+            if (m_pFileIndex[i].pFile != nullptr)
+            {
+                int slot = static_cast<int>(m_pFileIndex[i].pathHash & (newSize - 1));
+                while (pNewIndex[slot].pFile != nullptr)
+                {
+                    slot = ((slot + 1) & (newSize - 1));
+                }
+                pNewIndex[slot] = m_pFileIndex[i];
+            }
+        }
+
+        _DefFree(m_pFileIndex);
+        m_pFileIndex = pNewIndex;
+        m_fileIndexSize = newSize;
+    }
+
+    Atom::Hash hash = HashFilePath(pFile->GetPath());
+    int mask = m_fileIndexSize - 1;
+    int slot = static_cast<int>(hash & mask);
+    while (m_pFileIndex[slot].pFile != nullptr)
+    {
+        slot = ((slot + 1) & mask);
+    }
+
+    m_pFileIndex[slot].pathHash = hash;
+    m_pFileIndex[slot].pFile = pFile;
+    m_numIndexedFiles++;
+    return S_OK;
+}
+
+void PriFileManager::UnindexFile(_In_ const ManagedFile* pFile) const
+{
+    if (m_numIndexedFiles == 0)
+    {
+        return;
+    }
+
+    int mask = m_fileIndexSize - 1;
+    int slot = static_cast<int>(HashFilePath(pFile->GetPath()) & mask);
+    while ((m_pFileIndex[slot].pFile != nullptr) && (m_pFileIndex[slot].pFile != pFile))
+    {
+        slot = ((slot + 1) & mask);
+    }
+
+    if (m_pFileIndex[slot].pFile == nullptr)
+    {
+        return;
+    }
+
+    // Shift later entries of the probe run back so that lookups never stop early at the hole.
+    int hole = slot;
+    for (int next = ((hole + 1) & mask); m_pFileIndex[next].pFile != nullptr; next = ((next + 1) & mask))
+    {
+        int home = static_cast<int>(m_pFileIndex[next].pathHash & mask);
+        bool bCanMove = (hole <= next) ? ((home <= hole) || (home > next)) : ((home <= hole) && (home > next));
+        if (bCanMove)
+        {
+            m_pFileIndex[hole] = m_pFileIndex[next];
+            hole = next;
         }
     }
 
+    m_pFileIndex[hole].pFile = nullptr;
+    m_pFileIndex[hole].pathHash = 0;
+    m_numIndexedFiles--;
+}
+
+HRESULT PriFileManager::GetFile(_In_ const NormalizedFilePath* pNormalizedPath, _Out_ ManagedFile** result) const
+{
+    *result = nullptr;
+
+    ManagedFile* pRtrn = FindFile(pNormalizedPath->GetRef());
+    if (pRtrn != nullptr)
+    {
+        *result = pRtrn;
+        return S_OK;
+    }
+
     return E_INVALIDARG;
 }
 
@@ -80,27 +179,17 @@ HRESULT PriFileManager::GetOrAddFile(
     RETURN_IF_FAILED(ManagedFile::NormalizePackageRoot(pNormalizedPath->GetRef(), pPackageRoot, &rootPath));
 
     // See if we already have the file
-    for (int i = 0; i < m_pFiles->Count(); i++)
+    pRtrn = FindFile(pNormalizedPath->GetRef());
+    if (pRtrn != nullptr)
     {
-        if (m_pFiles->TryGet(i, &finfo))
-        {
-            pRtrn = finfo.pFile;
-        }
-        else
-        {
-            pRtrn = nullptr;
-        }
-        if ((pRtrn != nullptr) && (DefString_ICompare(pNormalizedPath->GetRef(), pRtrn->GetPath()) == Def_Equal))
-        {
-            RETURN_IF_FAILED(pRtrn->SetPackageRoot(rootPath.GetRef()));
+        RETURN_IF_FAILED(pRtrn->SetPackageRoot(rootPath.GetRef()));
 
-            if ((flags & LoadPriFlags::Preload) == LoadPriFlags::Preload)
-            {
-                RETURN_IF_FAILED(pRtrn->Load());
-            }
-            *result = pRtrn;
-            return S_OK;
+        if ((flags & LoadPriFlags::Preload) == LoadPriFlags::Preload)
+        {
+            RETURN_IF_FAILED(pRtrn->Load());
         }
+        *result = pRtrn;
+        return S_OK;
     }
 
     // not found - create a new file
@@ -110,11 +199,19 @@ HRESULT PriFileManager::GetOrAddFile(
         HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND),
         HRESULT_FROM_WIN32(ERROR_PATH_NOT_FOUND));
 
+    HRESULT hr = IndexFile(pRtrn);
+    if (FAILED(hr))
+    {
+        delete pRtrn;
+        return hr;
+    }
+
     finfo.pFile = pRtrn;
 
-    HRESULT hr = m_pFiles->Add(finfo, &index);
+    hr = m_pFiles->Add(finfo, &index);
     if (FAILED(hr))
     {
+        UnindexFile(pRtrn);
         delete pRtrn;
         return hr;
     }
@@ -158,20 +255,9 @@ HRESULT PriFileManager::AddFile(
     RETURN_IF_FAILED(ManagedFile::NormalizePackageRoot(pNormalizedPath->GetRef(), pPackageRoot, &rootPath));
 
     // See if we already have the file
-    for (int i = 0; i < m_pFiles->Count(); i++)
+    if (FindFile(pNormalizedPath->GetRef()) != nullptr)
     {
-        if (m_pFiles->TryGet(i, &finfo))
-        {
-            pRtrn = finfo.pFile;
-        }
-        else
-        {
-            pRtrn = nullptr;
-        }
-        if ((pRtrn != nullptr) && (DefString_ICompare(pNormalizedPath->GetRef(), pRtrn->GetPath()) == Def_Equal))
-        {
-            return HRESULT_FROM_WIN32(ERROR_MRM_DUPLICATE_ENTRY);
-        }
+        return HRESULT_FROM_WIN32(ERROR_MRM_DUPLICATE_ENTRY);
     }
 
     // not found - create a new file
@@ -179,11 +265,19 @@ HRESULT PriFileManager::AddFile(
     RETURN_IF_FAILED(ManagedFile::CreateInstance(
         this, index, pNormalizedPath, rootPath.GetRef(), fPreload ? LoadPriFlags::Preload : LoadPriFlags::Default, &pRtrn));
 
+    HRESULT hr = IndexFile(pRtrn);
+    if (FAILED(hr))
+    {
+        delete pRtrn;
+        return hr;
+    }
+
     finfo.pFile = pRtrn;
 
-    HRESULT hr = m_pFiles->Add(finfo, &index);
+    hr = m_pFiles->Add(finfo, &index);
     if (FAILED(hr))
     {
+        UnindexFile(pRtrn);
         delete pRtrn;
         return hr;
     }
@@ -221,10 +315,17 @@ HRESULT PriFileManager::InsertFile(
     RETURN_IF_FAILED(
         ManagedFile::CreateInstance(this, newIndex, pPath, pPackageRoot, fPreload ? LoadPriFlags::Preload : LoadPriFlags::Default, &pRtrn));
 
+    RETURN_IF_FAILED(IndexFile(pRtrn));
+
     FileManagerFileInfo finfo;
     finfo.pFile = pRtrn;
     // Insert move all contents to
-    RETURN_IF_FAILED(m_pFiles->Insert(finfo, pRtrn->GetGlobalIndex()));
+    HRESULT hr = m_pFiles->Insert(finfo, pRtrn->GetGlobalIndex());
+    if (FAILED(hr))
+    {
+        UnindexFile(pRtrn);
+        return hr;
+    }
 
     ManagedFile* mf = pRtrn.Detach();
 
@@ -283,6 +384,7 @@ HRESULT PriFileManager::RemoveFile(_In_ const ManagedFile* pFile)
     FileManagerFileInfo finfoNull = {};
     RETURN_IF_FAILED(m_pFiles->Set(pFile->GetGlobalIndex(), finfoNull));
 
+    UnindexFile(finfo.pFile);
     delete finfo.pFile;
     return S_OK;
 }
@@ -295,6 +397,93 @@ HRESULT PriFileManager::SetDefaultFileFlags(_In_ UINT32 flags)
     return S_OK;
 }
 
+HRESULT PriFileManager::SetDecodedStringCacheBudget(_In_ size_t cbBudget)
+{
+    FileManagerFileInfo finfo;
+    for (int i = 0; i < m_pFiles->Count(); i++)
+    {
+        if (m_pFiles->TryGet(i, &finfo) && (finfo.pFile != nullptr))
+        {
+            RETURN_IF_FAILED(finfo.pFile->SetDecodedStringCacheBudget(cbBudget));
+        }
+    }
+
+    m_cbDecodedStringCacheBudget = cbBudget;
+    return S_OK;
+}
+
+HRESULT PriFileManager::SetResidencyBudget(_In_ size_t cbBudget)
+{
+    m_cbResidencyBudget = cbBudget;
+    return EnforceResidencyBudget();
+}
+
+HRESULT PriFileManager::EnforceResidencyBudget()
+{
+    if (m_cbResidencyBudget == 0)
+    {
+        return S_OK;
+    }
+
+    // Evictions are rare next to lookups, so a scan for the coldest file is cheaper than keeping a list in order.
+    while (GetResidentSizeInBytes() > m_cbResidencyBudget)
+    {
+        ManagedFile* pColdest = nullptr;
+        FileManagerFileInfo finfo;
+        for (int i = 0; i < m_pFiles->Count(); i++)
+        {
+            if (m_pFiles->TryGet(i, &finfo) && (finfo.pFile != nullptr) && finfo.pFile->IsLoaded() && !finfo.pFile->IsPinned() &&
+                ((pColdest == nullptr) || (finfo.pFile->GetLastAccess() < pColdest->GetLastAccess())))
+            {
+                pColdest = finfo.pFile;
+            }
+        }
+
+        // Whatever is left is pinned, so stay over budget until some of it is released.
+        if (pColdest == nullptr)
+        {
+            return S_OK;
+        }
+        RETURN_IF_FAILED(pColdest->Evict());
+        InterlockedIncrement64(&m_numResidencyEvictions);
+    }
+    return S_OK;
+}
+
+void PriFileManager::NoteFileLoaded(_In_ const ManagedFile* pFile, _In_ bool bReload) const
+{
+    InterlockedExchangeAdd64(&m_cbResident, static_cast<LONG64>(pFile->GetSizeInBytes()));
+    InterlockedIncrement(&m_numResidentFiles);
+    InterlockedIncrement64(&m_numResidencyLoads);
+    if (bReload)
+    {
+        InterlockedIncrement64(&m_numResidencyReloads);
+    }
+}
+
+void PriFileManager::NoteFileUnloaded(_In_ const ManagedFile* pFile) const
+{
+    LONG64 cbResident = InterlockedExchangeAdd64(&m_cbResident, -static_cast<LONG64>(pFile->GetSizeInBytes())) -
+                        static_cast<LONG64>(pFile->GetSizeInBytes());
+    LONG numResidentFiles = InterlockedDecrement(&m_numResidentFiles);
+    DEF_ASSERT((numResidentFiles >= 0) && (cbResident >= 0));
+    UNREFERENCED_PARAMETER(numResidentFiles);
+    UNREFERENCED_PARAMETER(cbResident);
+}
+
+HRESULT PriFileManager::TrimColdSections() const
+{
+    FileManagerFileInfo finfo;
+    for (int i = 0; i < GetNumFiles(); i++)
+    {
+        if (m_pFiles->TryGet(i, &finfo) && (finfo.pFile != nullptr))
+        {
+            RETURN_IF_FAILED(finfo.pFile->TrimColdSections());
+        }
+    }
+    return S_OK;
+}
+
 HRESULT PriFileManager::GetSection(
     _In_ const ISchemaCollection* pSchemaCollection,
     _In_ int fileIndex,
@@ -554,6 +743,18 @@ HRESULT PriFileManager::GetDefaultQualifierMapping(_In_ int fileIndex, _Out_ con
     return HRESULT_FROM_WIN32(ERROR_NOT_FOUND);
 }
 
+DecodedStringCache* PriFileManager::GetDecodedStringCache(_In_ int fileIndex) const
+{
+    FileManagerFileInfo finfo;
+
+    if (m_pFiles->TryGet(fileIndex, &finfo) && (finfo.pFile != nullptr))
+    {
+        return finfo.pFile->GetDecodedStringCache(0);
+    }
+
+    return nullptr;
+}
+
 HRESULT PriFileManager::Init(_In_ UnifiedEnvironment* pEnvironment)
 {
     m_pEnvironment = pEnvironment;
@@ -583,6 +784,11 @@ PriFileManager::~PriFileManager()
         delete m_pFiles;
         m_pFiles = nullptr;
     }
+
+    _DefFree(m_pFileIndex);
+    m_pFileIndex = nullptr;
+    m_fileIndexSize = 0;
+    m_numIndexedFiles = 0;
 }
 
 } // namespace Microsoft::Resources
@@ -66,25 +66,38 @@ public:
         RETURN_HR_IF(E_INVALIDARG, index >= GetNumPerThreadQualifiers());
 
         StringResult* pStrValue = nullptr;
-        if (!m_qualifierCaches->TryGet(index, &pStrValue))
         {
-            Atom name;
-            AutoDeletePtr<IQualifierValueProvider> pProvider;
-            RETURN_IF_FAILED(GetQualifierPerThread(index, &name));
-            RETURN_IF_FAILED(GetProvider(name, &pProvider));
+            // Return a copy, because a reset can delete the cached value as soon as we let go of the lock.
+            AutoReaderWriterLock autoLock(&m_srwLock, true);
+            if (m_qualifierCaches->TryGet(index, &pStrValue) && (pStrValue != nullptr))
+            {
+                RETURN_IF_FAILED(pStringResult->SetCopy(pStrValue->GetRef()));
+                return S_OK;
+            }
+        }
+
+        Atom name;
+        AutoDeletePtr<IQualifierValueProvider> pProvider;
+        RETURN_IF_FAILED(GetQualifierPerThread(index, &name));
+        RETURN_IF_FAILED(GetProvider(name, &pProvider));
+
+        AutoDeletePtr<StringResult> strValue = new StringResult();
+        RETURN_IF_NULL_ALLOC(strValue);
 
-            AutoDeletePtr<StringResult> strValue = new StringResult();
-            RETURN_IF_NULL_ALLOC(strValue);
+        RETURN_IF_FAILED(pProvider->GetQualifierValue(name, nullptr, strValue));
 
-            RETURN_IF_FAILED(pProvider->GetQualifierValue(name, nullptr, strValue));
+        AutoReaderWriterLock autoLock(&m_srwLock);
 
+        // Another thread might have cached the value while we were asking the provider.
+        if (!m_qualifierCaches->TryGet(index, &pStrValue) || (pStrValue == nullptr))
+        {
             RETURN_IF_FAILED(m_qualifierCaches->SetExtent(index));
             RETURN_IF_FAILED(m_qualifierCaches->Insert(strValue, index));
 
             pStrValue = strValue.Detach();
         }
 
-        RETURN_IF_FAILED(pStringResult->SetRef(pStrValue->GetRef()));
+        RETURN_IF_FAILED(pStringResult->SetCopy(pStrValue->GetRef()));
 
         return S_OK;
     }
@@ -135,6 +148,7 @@ public:
     {
         if (m_qualifierCaches)
         {
+            AutoReaderWriterLock autoLock(&m_srwLock);
             for (int i = 0; i < m_qualifierCaches->Count(); i++)
             {
                 StringResult* pStrResult;
@@ -152,6 +166,7 @@ public:
     {
         if (m_qualifierCaches)
         {
+            AutoReaderWriterLock autoLock(&m_srwLock);
             Atom localName;
             int numThreadQualifiers = GetNumPerThreadQualifiers();
             for (int i = 0; i < numThreadQualifiers; i++)
@@ -172,7 +187,7 @@ public:
     }
 
 private:
-    PerThreadQualifier() : m_qualifierCaches(nullptr) {}
+    PerThreadQualifier() : m_qualifierCaches(nullptr) { ::InitializeSRWLock(&m_srwLock); }
 
     HRESULT Init(_In_ const CoreProfile* pProfile, _In_ const UnifiedEnvironment* pEnvironment, _In_ const IResolver* pParentResolver)
     {
@@ -191,6 +206,107 @@ private:
     const CoreProfile* m_pProfile;
     const IResolver* m_pParentResolver;
     DynamicArray<StringResult*>* m_qualifierCaches;
+    SRWLOCK m_srwLock;
+};
+
+// A grow-only array of 64-bit values that can be read and written without taking a lock.
+// Growing the array takes a lock and replaces the table, so a write that races with a grow
+// can be lost. That only costs a cache miss. Replaced tables are kept until the array is
+// destroyed because readers may still be looking at them.
+class LockFreeCacheArray
+{
+public:
+    LockFreeCacheArray() : m_pTable(nullptr) { ::InitializeSRWLock(&m_srwGrowLock); }
+
+    ~LockFreeCacheArray()
+    {
+        Table* pTable = m_pTable;
+        while (pTable != nullptr)
+        {
+            Table* pPrevious = pTable->pPrevious;
+            _DefFree(pTable);
+            pTable = pPrevious;
+        }
+    }
+
+    LockFreeCacheArray(const LockFreeCacheArray&) = delete;
+    LockFreeCacheArray& operator=(const LockFreeCacheArray&) = delete;
+
+    int Count() const
+    {
+        const Table* pTable = GetTable();
+        return ((pTable != nullptr) ? pTable->size : 0);
+    }
+
+    // Returns 0 for entries that are out of range.
+    LONG64 Get(_In_ int index) const
+    {
+        const Table* pTable = GetTable();
+        if ((pTable == nullptr) || (index < 0) || (index >= pTable->size))
+        {
+            return 0;
+        }
+        return ReadAcquire64(&pTable->entries[index]);
+    }
+
+    // Sets an entry only if it still has the expected value. Returns the value that was there.
+    // Silently ignores entries that are out of range; callers are expected to call EnsureSize first.
+    LONG64 CompareExchange(_In_ int index, _In_ LONG64 value, _In_ LONG64 expected)
+    {
+        Table* pTable = GetTable();
+        if ((pTable == nullptr) || (index < 0) || (index >= pTable->size))
+        {
+            return expected;
+        }
+        return InterlockedCompareExchange64(&pTable->entries[index], value, expected);
+    }
+
+    HRESULT EnsureSize(_In_ int size)
+    {
+        if (size <= Count())
+        {
+            return S_OK;
+        }
+
+        AutoReaderWriterLock autoLock(&m_srwGrowLock);
+
+        Table* pOld = GetTable();
+        int oldSize = ((pOld != nullptr) ? pOld->size : 0);
+        if (size <= oldSize)
+        {
+            return S_OK;
+        }
+
+        RETURN_HR_IF(E_OUTOFMEMORY, static_cast<size_t>(size) > ((SIZE_MAX - sizeof(Table)) / sizeof(LONG64)));
+        Table* pNew = static_cast<Table*>(_DefBlob_AllocZeroed(sizeof(Table) + (size * sizeof(LONG64))));
+        RETURN_IF_NULL_ALLOC(pNew);
+
+        pNew->pPrevious = pOld;
+        pNew->size = size;
+        for (int i = 0; i < oldSize; i++)
+        {
+            pNew->entries[i] = ReadAcquire64(&pOld->entries[i]);
+        }
+
+        InterlockedExchangePointer(reinterpret_cast<PVOID volatile*>(&m_pTable), pNew);
+        return S_OK;
+    }
+
+private:
+    typedef struct _Table
+    {
+        _Table* pPrevious;
+        int size;
+        volatile LONG64 entries[1];
+    } Table;
+
+    Table* GetTable() const
+    {
+        return static_cast<Table*>(ReadPointerAcquire(reinterpret_cast<PVOID volatile*>(const_cast<Table* volatile*>(&m_pTable))));
+    }
+
+    Table* volatile m_pTable;
+    SRWLOCK m_srwGrowLock;
 };
 
 class ResolverBase::DecisionInfoCache : public DefObject
@@ -212,7 +328,16 @@ public:
         return S_OK;
     }
 
-    ~DecisionInfoCache() {}
+    ~DecisionInfoCache()
+    {
+        DecisionResults* pResults = m_pAllocatedDecisionResults;
+        while (pResults != nullptr)
+        {
+            DecisionResults* pNext = pResults->pNextAllocated;
+            _DefFree(pResults);
+            pResults = pNext;
+        }
+    }
 
     const IDecisionInfo* GetDecisionInfo() const { return m_pDecisions; }
 
@@ -237,8 +362,6 @@ public:
         UINT32 pad : 7;
     } QualifierSetCacheEntry;
 
-    static const UINT16 kDecisionAttemptedMask = 0x8000;
-
     class QualifierSetComparer
     {
     public:
@@ -445,34 +568,15 @@ public:
         UINT16 _nextFreeEntry = 0;
     };
 
+    // Invalidates every cached result. Entries are tagged with the generation that they were computed in,
+    // so nothing needs to be cleared and lookups that are in progress never see a partial reset.
     void Reset()
     {
-        // using UNREFERENCED_PARAMETER because prefast complains about inconsisten
-        // annotation if I comment out pStatus.
-        AutoReaderWriterLock autoLock(&m_srwLock);
-
-        _QualifierCacheEntry* pCachedQualifiers = m_qualifierCache.GetAll();
-        for (unsigned int i = 0; i < m_qualifierCache.Count(); ++i)
-        {
-            (pCachedQualifiers + i)->bAttempted = 0;
-        }
-        m_qualifierCache.Reset();
-
-        QualifierSetCacheEntry* pCachedQualifierSets = m_qualifierSetCache.GetAll();
-        for (unsigned int i = 0; i < m_qualifierSetCache.Count(); ++i)
+        if (InterlockedIncrement(&m_generation) == 0)
         {
-            (pCachedQualifierSets + i)->attempted = 0;
+            // Generation 0 is never current, because zeroed entries carry it.
+            InterlockedIncrement(&m_generation);
         }
-        m_qualifierSetCache.Reset();
-
-        UINT16* pCachedDecision = m_decisionCache.GetAll();
-        for (unsigned int i = 0; i < m_decisionCache.Count(); ++i)
-        {
-            *(pCachedDecision + i) &= ~kDecisionAttemptedMask;
-        }
-        m_decisionCache.Reset();
-
-        m_decisionPerSetInfo.Reset();
     }
 
     void Reset(_In_ Atom)
@@ -481,26 +585,46 @@ public:
         return Reset();
     }
 
-    HRESULT GetQualifierScores(_In_ const IQualifier* pQualifier, _Out_ UINT16* pScoreOut, _Out_ UINT16* pFallbackScoreOut)
+    UINT32 GetGeneration() const { return static_cast<UINT32>(ReadAcquire(&m_generation)); }
+
+    bool TryGetQualifierCacheEntry(_In_ int index, _In_ UINT32 generation, _Out_ QualifierCacheEntry* pEntryOut) const
+    {
+        return TryGetCacheEntry(m_qualifierCache, index, generation, pEntryOut);
+    }
+
+    bool TryGetQualifierSetCacheEntry(_In_ int index, _In_ UINT32 generation, _Out_ QualifierSetCacheEntry* pEntryOut) const
+    {
+        return TryGetCacheEntry(m_qualifierSetCache, index, generation, pEntryOut);
+    }
+
+    HRESULT GetQualifierScores(
+        _In_ const IQualifier* pQualifier,
+        _In_ UINT32 generation,
+        _Out_ UINT16* pScoreOut,
+        _Out_ UINT16* pFallbackScoreOut) const
     {
         int index;
         RETURN_IF_FAILED(pQualifier->GetQualifierIndex(&index));
 
-        AutoReaderWriterLock autoLock(&m_srwLock, true);
-        QualifierCacheEntry* pEntries = m_qualifierCache.GetAll();
-        if ((index < 0) || (index >= m_qualifierCache.Count()) || (!pEntries[index].bAttempted))
+        QualifierCacheEntry entry;
+        if (!TryGetQualifierCacheEntry(index, generation, &entry))
         {
             *pScoreOut = 0;
             *pFallbackScoreOut = 0;
             return HRESULT_FROM_WIN32(ERROR_NOT_FOUND);
         }
 
-        *pScoreOut = pEntries[index].score;
-        *pFallbackScoreOut = pEntries[index].fallbackScore;
+        *pScoreOut = entry.score;
+        *pFallbackScoreOut = entry.fallbackScore;
         return S_OK;
     }
 
-    HRESULT SetQualifierScores(_In_ const IQualifier* pQualifier, _In_ int priority, _In_ UINT16 score, _In_ UINT16 fallbackScore)
+    HRESULT SetQualifierScores(
+        _In_ const IQualifier* pQualifier,
+        _In_ UINT32 generation,
+        _In_ int priority,
+        _In_ UINT16 score,
+        _In_ UINT16 fallbackScore)
     {
         int index;
         RETURN_IF_FAILED(pQualifier->GetQualifierIndex(&index));
@@ -510,39 +634,33 @@ public:
         RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_RANGE_NOT_FOUND), (score < 0) || (score > IQualifier::MaxFallbackScore));
         RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_RANGE_NOT_FOUND), (fallbackScore < 0) || (fallbackScore > IQualifier::MaxFallbackScore));
 
-        AutoReaderWriterLock autoLock(&m_srwLock);
-        if (index >= m_qualifierCache.Count())
-        {
-            // decision info has grown since we were initialized
-            // but we weren't able to grow our cache.
-            RETURN_IF_FAILED(m_qualifierCache.SetExtent(m_pDecisions->GetNumQualifiers()));
-        }
+        // decision info may have grown since we were initialized
+        RETURN_IF_FAILED(m_qualifierCache.EnsureSize(m_pDecisions->GetNumQualifiers()));
 
-        QualifierCacheEntry entry;
+        QualifierCacheEntry entry = {};
         entry.bAttempted = 1;
         entry.priority = priority;
         entry.score = score;
         entry.fallbackScore = fallbackScore;
-        RETURN_IF_FAILED(m_qualifierCache.Set(index, entry));
+        SetCacheEntry(m_qualifierCache, index, generation, entry);
 
         return S_OK;
     }
 
     HRESULT GetQualifierSetResults(
         _In_ const IQualifierSet* pQualifierSet,
+        _In_ UINT32 generation,
         _Out_ bool* pbIsMatchOut,
         _Out_ bool* pbIsDefaultOut,
         _Out_ bool* pbIsMatchOrDefaultOut,
         _Out_opt_ UINT16* pBestActualMatchScoreOut = NULL,
-        _Out_opt_ UINT16* pBestActualMatchPriorityOut = NULL)
+        _Out_opt_ UINT16* pBestActualMatchPriorityOut = NULL) const
     {
         int index;
         RETURN_IF_FAILED(pQualifierSet->GetIndex(&index));
 
-        AutoReaderWriterLock autoLock(&m_srwLock, true);
-
-        QualifierSetCacheEntry* pEntries = m_qualifierSetCache.GetAll();
-        if ((index < 0) || (index >= m_qualifierSetCache.Count()) || (!pEntries[index].attempted))
+        QualifierSetCacheEntry entry;
+        if (!TryGetQualifierSetCacheEntry(index, generation, &entry))
         {
             *pbIsMatchOut = *pbIsDefaultOut = *pbIsMatchOrDefaultOut = false;
             if (pBestActualMatchScoreOut)
@@ -556,39 +674,25 @@ public:
             return HRESULT_FROM_WIN32(ERROR_NOT_FOUND);
         }
 
-        *pbIsMatchOut = (pEntries[index].isMatch != 0);
-        *pbIsDefaultOut = (pEntries[index].isDefault != 0);
-        *pbIsMatchOrDefaultOut = (pEntries[index].isMatchOrDefault != 0);
+        *pbIsMatchOut = (entry.isMatch != 0);
+        *pbIsDefaultOut = (entry.isDefault != 0);
+        *pbIsMatchOrDefaultOut = (entry.isMatchOrDefault != 0);
 
         if (pBestActualMatchScoreOut)
         {
-            *pBestActualMatchScoreOut = pEntries[index].bestMatchScore;
+            *pBestActualMatchScoreOut = entry.bestMatchScore;
         }
         if (pBestActualMatchPriorityOut)
         {
-            *pBestActualMatchPriorityOut = pEntries[index].bestMatchPriority;
+            *pBestActualMatchPriorityOut = entry.bestMatchPriority;
         }
 
         return S_OK;
     }
 
-    HRESULT GetQualifierSetCacheEntry(_In_ int index, _Out_ const QualifierSetCacheEntry** ppQualifierSetResult)
-    {
-        AutoReaderWriterLock autoLock(&m_srwLock, true);
-
-        QualifierSetCacheEntry* pEntries = m_qualifierSetCache.GetAll();
-        if ((index < 0) || (index >= m_qualifierSetCache.Count()) || (!pEntries[index].attempted))
-        {
-            *ppQualifierSetResult = NULL;
-            return HRESULT_FROM_WIN32(ERROR_NOT_FOUND);
-        }
-
-        *ppQualifierSetResult = &pEntries[index];
-        return S_OK;
-    }
-
     HRESULT SetQualifierSetResults(
         _In_ const IQualifierSet* pQualifierSet,
+        _In_ UINT32 generation,
         _In_ bool isMatch,
         _In_ bool isDefaultMatch,
         _In_ bool isMatchOrDefault,
@@ -606,15 +710,10 @@ public:
         RETURN_HR_IF(
             HRESULT_FROM_WIN32(ERROR_RANGE_NOT_FOUND), (bestActualMatchScore < 0) || (bestActualMatchScore > IQualifier::MaxFallbackScore));
 
-        AutoReaderWriterLock autoLock(&m_srwLock);
-        if (index >= m_qualifierSetCache.Count())
-        {
-            // decision info has grown since we were initialized
-            // but we weren't able to grow our cache.
-            RETURN_IF_FAILED(m_qualifierSetCache.SetExtent(m_pDecisions->GetNumQualifierSets()));
-        }
+        // decision info may have grown since we were initialized
+        RETURN_IF_FAILED(m_qualifierSetCache.EnsureSize(m_pDecisions->GetNumQualifierSets()));
 
-        QualifierSetCacheEntry entry;
+        QualifierSetCacheEntry entry = {};
         entry.attempted = 1;
         entry.isMatch = (isMatch ? 1 : 0);
         entry.isDefault = (isDefaultMatch ? 1 : 0);
@@ -622,8 +721,7 @@ public:
         entry.requireComplexResolution = (requireComplexResolution ? 1 : 0);
         entry.bestMatchPriority = bestActualMatchPriority;
         entry.bestMatchScore = bestActualMatchScore;
-
-        RETURN_IF_FAILED(m_qualifierSetCache.Set(index, entry));
+        SetCacheEntry(m_qualifierSetCache, index, generation, entry);
 
         return S_OK;
     }
@@ -634,117 +732,135 @@ public:
         UINT16 setIndexInPool;
     } DecisionPerSetInfo;
 
+    /*!
+     * Sorted results for one decision. Each decision gets one of these the first time that it is
+     * evaluated, and keeps it until the cache is destroyed. state holds the generation of the
+     * results in the upper 32 bits and a DecisionResultsState in the lower 32 bits.
+     */
+    typedef struct _DecisionResults
+    {
+        _DecisionResults* pNextAllocated;
+        volatile LONG64 state;
+        int numSets;
+        DecisionPerSetInfo sets[1];
+    } DecisionResults;
+
     HRESULT GetDecisionResults(
         _In_ const IDecision* pDecision,
+        _In_ UINT32 generation,
         _In_ int numResults,
         _Out_writes_(numResults) int* pSetIndexesInDecisionOut,
-        _Out_writes_(numResults) int* pSetIndexesInPoolOut)
+        _Out_writes_(numResults) int* pSetIndexesInPoolOut) const
     {
         int index;
         RETURN_IF_FAILED(pDecision->GetIndex(&index));
 
-        UINT16 offset = 0;
-
-        AutoReaderWriterLock autoLock(&m_srwLock, true);
-        if ((index < 0) || (index >= m_decisionCache.Count()) || (!m_decisionCache.TryGet(index, &offset)) ||
-            ((offset & kDecisionAttemptedMask) == 0))
+        const DecisionResults* pResults = TryGetDecisionResults(index);
+        if (pResults == nullptr)
         {
-            // out of range or not attempted
             return HRESULT_FROM_WIN32(ERROR_NOT_FOUND);
         }
 
-        // mask off the bit that indicates that the decision was cached
-        offset &= ~kDecisionAttemptedMask;
-
-        int numDecisionResults = pDecision->GetNumQualifierSets();
-        numResults = min(numResults, numDecisionResults);
+        // Optimistic read: the results are only good if nobody started rewriting them while we copied them.
+        LONG64 state = ReadAcquire64(&pResults->state);
+        if (state != MakeCacheEntry(generation, DecisionResultsComplete))
+        {
+            return HRESULT_FROM_WIN32(ERROR_NOT_FOUND);
+        }
 
-        DEF_ASSERT((offset + numResults) <= m_decisionPerSetInfo.Count());
+        CopyDecisionResults(pResults->sets, pResults->numSets, numResults, pSetIndexesInDecisionOut, pSetIndexesInPoolOut);
 
-        const DecisionPerSetInfo* pSets = &m_decisionPerSetInfo.GetAll()[offset];
-        for (int i = 0; (i < numResults); i++)
+        MemoryBarrier();
+        if (ReadAcquire64(&pResults->state) != state)
         {
-            pSetIndexesInDecisionOut[i] = pSets[i].setIndexInDecision;
-            pSetIndexesInPoolOut[i] = pSets[i].setIndexInPool;
+            return HRESULT_FROM_WIN32(ERROR_NOT_FOUND);
         }
         return S_OK;
     }
 
-    HRESULT
-    BeginSetDecisionResults(_In_ const IDecision* pDecision, _Out_writes_(*pNumSetsOut) DecisionPerSetInfo** result, _Out_ int* pNumSetsOut)
+    /*!
+     * Claims the cached results of a decision so that the caller can fill them in for the given
+     * generation. Returns nullptr (and S_OK) if another thread is already writing them, in which
+     * case the caller should evaluate the decision without caching it.
+     */
+    HRESULT BeginSetDecisionResults(_In_ const IDecision* pDecision, _In_ UINT32 generation, _Outptr_result_maybenull_ DecisionResults** result)
     {
         *result = nullptr;
-        *pNumSetsOut = 0;
 
         int index;
         RETURN_IF_FAILED(pDecision->GetIndex(&index));
-
-        AutoReaderWriterLock autoLock(&m_srwLock);
         DEF_ASSERT((index >= 0) && (index < m_pDecisions->GetNumDecisions()));
 
-        if (index >= m_decisionCache.Count())
-        {
-            // couldn't extend the cache
-            RETURN_IF_FAILED(m_decisionCache.SetExtent(m_pDecisions->GetNumDecisions()));
-        }
-
-        UINT16* pCachedDecision = &m_decisionCache.GetAll()[index];
-
-        // We have our entry in the decision cache, now we need to figure
-        // out where the qualifier set data will go.
-        int offset = m_decisionPerSetInfo.Count();
-        int numSets = pDecision->GetNumQualifierSets();
-
         // If there are no qualifier sets, return with MRM_NO_MATCHING_CANDIDATE
-        // If we can't extend, SetExtent reports the error.
+        int numSets = pDecision->GetNumQualifierSets();
         RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_MRM_NO_MATCH_OR_DEFAULT_CANDIDATE), numSets == 0);
-        RETURN_IF_FAILED(m_decisionPerSetInfo.SetExtent(offset + numSets));
 
-        DecisionPerSetInfo* pSets = &m_decisionPerSetInfo.GetAll()[offset];
-        SecureZeroMemory(pSets, numSets * sizeof(DecisionPerSetInfo));
+        DecisionResults* pResults;
+        RETURN_IF_FAILED(GetOrCreateDecisionResults(index, numSets, &pResults));
+
+        // Never let an evaluation that started before a reset replace results from after it.
+        LONG64 state = ReadAcquire64(&pResults->state);
+        if ((pResults->numSets != numSets) || (GetCacheEntryPayload(state) == DecisionResultsWriting) ||
+            (state == MakeCacheEntry(generation, DecisionResultsComplete)) ||
+            ((state != 0) && IsNewerGeneration(GetCacheEntryGeneration(state), generation)))
+        {
+            return S_OK;
+        }
 
-        // Set the offset in the cached decisions, but don't set the attempted bit
-        // until EndDecisionResults
-        *pCachedDecision = static_cast<UINT16>(offset);
-        *pNumSetsOut = numSets;
-        *result = pSets;
+        if (InterlockedCompareExchange64(&pResults->state, MakeCacheEntry(generation, DecisionResultsWriting), state) != state)
+        {
+            // Somebody else got there first.
+            return S_OK;
+        }
 
+        *result = pResults;
         return S_OK;
     }
 
-    HRESULT EndSetDecisionResults(_In_ const IDecision* pDecision)
+    void EndSetDecisionResults(_Inout_ DecisionResults* pResults, _In_ UINT32 generation)
     {
-        int index;
-        RETURN_IF_FAILED(pDecision->GetIndex(&index));
-
-        AutoReaderWriterLock autoLock(&m_srwLock);
-        DEF_ASSERT((index >= 0) && (index < m_pDecisions->GetNumDecisions()) && (index < m_decisionCache.Count()));
-
-        UINT16* pCachedDecision = &m_decisionCache.GetAll()[index];
-
-        (*pCachedDecision) |= kDecisionAttemptedMask;
+        // Only the thread that claimed the results in BeginSetDecisionResults can get here, so nobody else moves the state.
+        DEF_ASSERT(ReadAcquire64(&pResults->state) == MakeCacheEntry(generation, DecisionResultsWriting));
+        WriteRelease64(&pResults->state, MakeCacheEntry(generation, DecisionResultsComplete));
+    }
 
-        return S_OK;
+    static void CopyDecisionResults(
+        _In_reads_(numSets) const DecisionPerSetInfo* pSets,
+        _In_ int numSets,
+        _In_ int numResults,
+        _Out_writes_(numResults) int* pSetIndexesInDecisionOut,
+        _Out_writes_(numResults) int* pSetIndexesInPoolOut)
+    {
+        numResults = min(numResults, numSets);
+        for (int i = 0; (i < numResults); i++)
+        {
+            pSetIndexesInDecisionOut[i] = pSets[i].setIndexInDecision;
+            pSetIndexesInPoolOut[i] = pSets[i].setIndexInPool;
+        }
     }
 
-    // Comments out below lock held as OACR can't understand ReadWriterLock.
-    // _Requires_lock_held_(ResolverBase::m_srwLock)
-    // _Requires_lock_held_(ResolverBase::m_srwQualifierSetLock)
-    int CompareQualifierSetResults(_In_ int setIndexInPool1, _In_ int setIndexInPool2, _Inout_ const IResolver* pResolver)
+    int CompareQualifierSetResults(
+        _In_ int setIndexInPool1,
+        _In_ int setIndexInPool2,
+        _In_ UINT32 generation,
+        _Inout_ const IResolver* pResolver) const
     {
-        if ((setIndexInPool1 < 0) || (setIndexInPool1 > m_qualifierSetCache.Count() - 1))
+        if ((setIndexInPool1 < 0) || (setIndexInPool1 > m_pDecisions->GetNumQualifierSets() - 1))
         {
             return 0;
         }
 
-        if ((setIndexInPool2 < 0) || (setIndexInPool2 > m_qualifierSetCache.Count() - 1))
+        if ((setIndexInPool2 < 0) || (setIndexInPool2 > m_pDecisions->GetNumQualifierSets() - 1))
         {
             return 0;
         }
 
-        QualifierSetCacheEntry* pEntries = m_qualifierSetCache.GetAll();
-        const DecisionInfoCache::QualifierSetCacheEntry* pEntry1 = &pEntries[setIndexInPool1];
-        const DecisionInfoCache::QualifierSetCacheEntry* pEntry2 = &pEntries[setIndexInPool2];
+        QualifierSetCacheEntry entry1;
+        QualifierSetCacheEntry entry2;
+        (void)TryGetQualifierSetCacheEntry(setIndexInPool1, generation, &entry1);
+        (void)TryGetQualifierSetCacheEntry(setIndexInPool2, generation, &entry2);
+        const DecisionInfoCache::QualifierSetCacheEntry* pEntry1 = &entry1;
+        const DecisionInfoCache::QualifierSetCacheEntry* pEntry2 = &entry2;
 
         int diff = 0;
 
@@ -768,8 +884,8 @@ public:
                 if (diff == 0)
                 {
                     diff = (pEntry1->requireComplexResolution == 1 || pEntry2->requireComplexResolution == 1) ?
-                               CompareQualifierSetResultComplex(setIndexInPool1, setIndexInPool2, pResolver) :
-                               CompareQualifierSetResultDetails(setIndexInPool1, setIndexInPool2, pResolver);
+                               CompareQualifierSetResultComplex(setIndexInPool1, setIndexInPool2, generation, pResolver) :
+                               CompareQualifierSetResultDetails(setIndexInPool1, setIndexInPool2, generation, pResolver);
                 }
             }
         }
@@ -785,8 +901,8 @@ public:
             else
             {
                 diff = (pEntry1->requireComplexResolution == 1 || pEntry2->requireComplexResolution == 1) ?
-                           CompareQualifierSetResultComplex(setIndexInPool1, setIndexInPool2, pResolver) :
-                           CompareQualifierSetResultDetails(setIndexInPool1, setIndexInPool2, pResolver);
+                           CompareQualifierSetResultComplex(setIndexInPool1, setIndexInPool2, generation, pResolver) :
+                           CompareQualifierSetResultDetails(setIndexInPool1, setIndexInPool2, generation, pResolver);
             }
         }
         else
@@ -799,7 +915,8 @@ public:
 
     typedef struct _DecisionSortingInfo
     {
-        DecisionInfoCache* pCache;
+        const DecisionInfoCache* pCache;
+        UINT32 generation;
         const IResolver* pResolver;
     } _DecisionSortingInfo;
 
@@ -810,7 +927,7 @@ public:
         const _DecisionPerSetInfo* pResult2)
     {
         int diff = pSortingContextInfo->pCache->CompareQualifierSetResults(
-            pResult1->setIndexInPool, pResult2->setIndexInPool, pSortingContextInfo->pResolver);
+            pResult1->setIndexInPool, pResult2->setIndexInPool, pSortingContextInfo->generation, pSortingContextInfo->pResolver);
         // If the two decision results compare identically, position in the decision is the final tie breaker.
         if (diff != 0)
         {
@@ -836,23 +953,25 @@ protected:
     const IDecisionInfo* m_pDecisions;
     const UnifiedEnvironment* m_pEnvironment;
 
-    DynamicArray<QualifierCacheEntry> m_qualifierCache;
-    DynamicArray<QualifierSetCacheEntry> m_qualifierSetCache;
-    DynamicArray<DecisionPerSetInfo> m_decisionPerSetInfo;
-    DynamicArray<UINT16> m_decisionCache;
+    LockFreeCacheArray m_qualifierCache;
+    LockFreeCacheArray m_qualifierSetCache;
+    LockFreeCacheArray m_decisionResults;
 
     DecisionInfoCache(_In_ const IDecisionInfo* pDecisions, _In_ const UnifiedEnvironment* pEnvironment) :
         m_pDecisions(pDecisions),
         m_pEnvironment(pEnvironment),
         m_qualifierCache(),
         m_qualifierSetCache(),
-        m_decisionPerSetInfo(),
-        m_decisionCache()
-    {
-        ::InitializeSRWLock(&m_srwLock);
-    }
+        m_decisionResults(),
+        m_generation(1),
+        m_pAllocatedDecisionResults(nullptr)
+    {}
 
-    int CompareQualifierSetResultDetails(_In_ int setIndexInPool1, _In_ int setIndexInPool2, _In_ const IResolver* pResolver)
+    int CompareQualifierSetResultDetails(
+        _In_ int setIndexInPool1,
+        _In_ int setIndexInPool2,
+        _In_ UINT32 generation,
+        _In_ const IResolver* pResolver) const
     {
         QualifierSetResult set1;
         QualifierSetResult set2;
@@ -864,19 +983,20 @@ protected:
 
         int q1;
         int q2;
-        _QualifierCacheEntry* pQualifiers = m_qualifierCache.GetAll();
-        _QualifierCacheEntry* pQ1;
-        _QualifierCacheEntry* pQ2;
+        QualifierCacheEntry qualifier1;
+        QualifierCacheEntry qualifier2;
+        const QualifierCacheEntry* pQ1 = &qualifier1;
+        const QualifierCacheEntry* pQ2 = &qualifier2;
 
         for (int i = 0; i < set1.GetNumQualifiers(); i++)
         {
             // Get the next qualifier from set 1
-            if (FAILED(set1.GetQualifierIndexInPool(i, &q1)) || (q1 < 0) || (q1 > m_qualifierCache.Count() - 1))
+            if (FAILED(set1.GetQualifierIndexInPool(i, &q1)) || (q1 < 0) || (q1 > m_pDecisions->GetNumQualifiers() - 1))
             {
                 // error, can't continue.
                 return 0;
             }
-            pQ1 = &pQualifiers[q1];
+            (void)TryGetQualifierCacheEntry(q1, generation, &qualifier1);
 
             // See if set 2 also has a qualifier
             if (i >= set2.GetNumQualifiers())
@@ -886,12 +1006,12 @@ protected:
             }
 
             // Get the qualifier from set 2
-            if (FAILED(set2.GetQualifierIndexInPool(i, &q2)) || (q2 < 0) || (q2 > m_qualifierCache.Count() - 1))
+            if (FAILED(set2.GetQualifierIndexInPool(i, &q2)) || (q2 < 0) || (q2 > m_pDecisions->GetNumQualifiers() - 1))
             {
                 // error, can't continue.
                 return 0;
             }
-            pQ2 = &pQualifiers[q2];
+            (void)TryGetQualifierCacheEntry(q2, generation, &qualifier2);
 
             if (pQ2->priority > pQ1->priority)
             {
@@ -981,12 +1101,12 @@ protected:
         if (set2.GetNumQualifiers() > set1.GetNumQualifiers())
         {
             // Set 2 is more specific.  See who wins.
-            if (FAILED(set2.GetQualifierIndexInPool(set1.GetNumQualifiers(), &q2)) || (q2 < 0) || (q2 > m_qualifierCache.Count() - 1))
+            if (FAILED(set2.GetQualifierIndexInPool(set1.GetNumQualifiers(), &q2)) || (q2 < 0) || (q2 > m_pDecisions->GetNumQualifiers() - 1))
             {
                 // error, can't continue.
                 return 0;
             }
-            pQ2 = &pQualifiers[q2];
+            (void)TryGetQualifierCacheEntry(q2, generation, &qualifier2);
             return ((pQ2->score > 0) ? -1 : 1);
         }
 
@@ -994,7 +1114,11 @@ protected:
         return 0;
     }
 
-    int CompareQualifierSetResultComplex(_In_ int setIndexInPool1, _In_ int setIndexInPool2, _In_ const IResolver* resolver)
+    int CompareQualifierSetResultComplex(
+        _In_ int setIndexInPool1,
+        _In_ int setIndexInPool2,
+        _In_ UINT32 generation,
+        _In_ const IResolver* resolver) const
     {
         QualifierSetResult set1;
         QualifierSetResult set2;
@@ -1006,33 +1130,34 @@ protected:
 
         int q1;
         int q2;
-        _QualifierCacheEntry* pQualifiers = m_qualifierCache.GetAll();
-        _QualifierCacheEntry* pQ1;
-        _QualifierCacheEntry* pQ2;
+        QualifierCacheEntry qualifier1;
+        QualifierCacheEntry qualifier2;
+        const QualifierCacheEntry* pQ1 = &qualifier1;
+        const QualifierCacheEntry* pQ2 = &qualifier2;
 
         QualifierSetComparer comparer1;
         QualifierSetComparer comparer2;
 
         for (int i = 0; i < set1.GetNumQualifiers(); i++)
         {
-            if (FAILED(set1.GetQualifierIndexInPool(i, &q1)) || (q1 < 0) || (q1 > m_qualifierCache.Count() - 1))
+            if (FAILED(set1.GetQualifierIndexInPool(i, &q1)) || (q1 < 0) || (q1 > m_pDecisions->GetNumQualifiers() - 1))
             {
                 return 0;
             }
 
-            pQ1 = &pQualifiers[q1];
+            (void)TryGetQualifierCacheEntry(q1, generation, &qualifier1);
 
             comparer1.SetScore(pQ1->priority, pQ1->score, pQ1->fallbackScore);
         }
 
         for (int i = 0; i < set2.GetNumQualifiers(); i++)
         {
-            if (FAILED(set2.GetQualifierIndexInPool(i, &q2)) || (q2 < 0) || (q2 > m_qualifierCache.Count() - 1))
+            if (FAILED(set2.GetQualifierIndexInPool(i, &q2)) || (q2 < 0) || (q2 > m_pDecisions->GetNumQualifiers() - 1))
             {
                 return 0;
             }
 
-            pQ2 = &pQualifiers[q2];
+            (void)TryGetQualifierCacheEntry(q2, generation, &qualifier2);
 
             comparer2.SetScore(pQ2->priority, pQ2->score, pQ2->fallbackScore);
         }
@@ -1069,7 +1194,7 @@ protected:
         return 0;
     }
 
-    int CompareQualiferType(_In_ int qualifier1, _In_ int qualifier2, _In_ const IResolver* resolver)
+    int CompareQualiferType(_In_ int qualifier1, _In_ int qualifier2, _In_ const IResolver* resolver) const
     {
         QualifierResult qr1;
         QualifierResult qr2;
@@ -1092,18 +1217,166 @@ protected:
     }
 
 private:
-    SRWLOCK m_srwLock;
+    enum DecisionResultsState
+    {
+        DecisionResultsNone = 0,
+        DecisionResultsWriting = 1,
+        DecisionResultsComplete = 2
+    };
+
+    // Cache entries hold the generation they were computed in above the 32-bit payload.
+    static LONG64 MakeCacheEntry(_In_ UINT32 generation, _In_ UINT32 payload)
+    {
+        return static_cast<LONG64>((static_cast<UINT64>(generation) << 32) | payload);
+    }
+
+    static UINT32 GetCacheEntryGeneration(_In_ LONG64 entry) { return static_cast<UINT32>(static_cast<UINT64>(entry) >> 32); }
+
+    static UINT32 GetCacheEntryPayload(_In_ LONG64 entry) { return static_cast<UINT32>(static_cast<UINT64>(entry)); }
+
+    // Generations wrap, so compare them by distance rather than by value.
+    static bool IsNewerGeneration(_In_ UINT32 generation, _In_ UINT32 thanGeneration)
+    {
+        return (static_cast<INT32>(generation - thanGeneration) > 0);
+    }
+
+    template<typename T>
+    static bool TryGetCacheEntry(_In_ const LockFreeCacheArray& cache, _In_ int index, _In_ UINT32 generation, _Out_ T* pEntryOut)
+    {
+        static_assert(sizeof(T) == sizeof(UINT32), "cache entries must fit in 32 bits");
+
+        LONG64 entry = cache.Get(index);
+        UINT32 payload = 0;
+        if ((entry != 0) && (GetCacheEntryGeneration(entry) == generation))
+        {
+            payload = GetCacheEntryPayload(entry);
+        }
+
+        memcpy(pEntryOut, &payload, sizeof(payload));
+        return (payload != 0);
+    }
+
+    template<typename T>
+    static void SetCacheEntry(_Inout_ LockFreeCacheArray& cache, _In_ int index, _In_ UINT32 generation, _In_ const T& entry)
+    {
+        static_assert(sizeof(T) == sizeof(UINT32), "cache entries must fit in 32 bits");
+
+        UINT32 payload;
+        memcpy(&payload, &entry, sizeof(payload));
+
+        // Don't replace an entry that a newer generation already filled in.
+        LONG64 newEntry = MakeCacheEntry(generation, payload);
+        LONG64 current = cache.Get(index);
+        while ((current == 0) || !IsNewerGeneration(GetCacheEntryGeneration(current), generation))
+        {
+            LONG64 previous = cache.CompareExchange(index, newEntry, current);
+            if (previous == current)
+            {
+                break;
+            }
+            current = previous;
+        }
+    }
+
+    const DecisionResults* TryGetDecisionResults(_In_ int index) const
+    {
+        return reinterpret_cast<const DecisionResults*>(static_cast<LONG_PTR>(m_decisionResults.Get(index)));
+    }
+
+    HRESULT GetOrCreateDecisionResults(_In_ int index, _In_ int numSets, _Outptr_ DecisionResults** result)
+    {
+        *result = nullptr;
+
+        RETURN_IF_FAILED(m_decisionResults.EnsureSize(m_pDecisions->GetNumDecisions()));
+
+        DecisionResults* pResults = reinterpret_cast<DecisionResults*>(static_cast<LONG_PTR>(m_decisionResults.Get(index)));
+        if (pResults == nullptr)
+        {
+            size_t cbResults = sizeof(DecisionResults) + ((numSets - 1) * sizeof(DecisionPerSetInfo));
+            DecisionResults* pNew = static_cast<DecisionResults*>(_DefBlob_AllocZeroed(cbResults));
+            RETURN_IF_NULL_ALLOC(pNew);
+            pNew->numSets = numSets;
+
+            // Every block goes on the allocated list so that the destructor can free it, even if
+            // another thread wins the race to publish one for this decision.
+            DecisionResults* pHead;
+            do
+            {
+                pHead = static_cast<DecisionResults*>(ReadPointerAcquire(reinterpret_cast<PVOID volatile*>(&m_pAllocatedDecisionResults)));
+                pNew->pNextAllocated = pHead;
+            } while (InterlockedCompareExchangePointer(reinterpret_cast<PVOID volatile*>(&m_pAllocatedDecisionResults), pNew, pHead) != pHead);
+
+            LONG64 existing = m_decisionResults.CompareExchange(index, static_cast<LONG64>(reinterpret_cast<LONG_PTR>(pNew)), 0);
+            pResults = ((existing != 0) ? reinterpret_cast<DecisionResults*>(static_cast<LONG_PTR>(existing)) : pNew);
+        }
+
+        *result = pResults;
+        return S_OK;
+    }
+
+    volatile LONG m_generation;
+    DecisionResults* volatile m_pAllocatedDecisionResults;
 };
 
+// The winner of each decision, filled in as decisions are resolved. Each entry holds the low 32 bits of the
+// resolver generation that it was resolved in above two UINT16: the index of the winning qualifier set in the
+// decision and in the pool. pSnapshotEntries, if set, holds the winners passed to UseDecisionTable, which belong
+// to the caller and were resolved for the qualifier values in snapshotQualifierChecksum. They are only used in
+// snapshotGeneration, which moves forward whenever a qualifier change lands back on those values. The snapshot
+// only covers the first numSnapshotDecisions decisions; decisions added later are filled in like any other.
+struct ResolverBase::DecisionTable
+{
+    DecisionTable* pPrevious;
+    int numDecisions;
+    const UINT16* pSnapshotEntries;
+    int numSnapshotDecisions;
+    DEF_CHECKSUM snapshotQualifierChecksum;
+    volatile LONG64 snapshotGeneration;
+    volatile LONG64 entries[1];
+};
+
+static const UINT16 DecisionTableNoWinner = 0xffff;
+
+static LONG64 MakeDecisionTableEntry(_In_ UINT64 generation, _In_ UINT16 indexInDecision, _In_ UINT16 indexInPool)
+{
+    return static_cast<LONG64>((generation << 32) | (static_cast<UINT64>(indexInDecision) << 16) | indexInPool);
+}
+
+static UINT32 GetDecisionTableEntryGeneration(_In_ LONG64 entry) { return static_cast<UINT32>(static_cast<UINT64>(entry) >> 32); }
+
 ResolverBase::ResolverBase(_In_ const UnifiedEnvironment* pEnvironment, _In_ const IDecisionInfo* pDecisions) :
-    m_pEnvironment(pEnvironment), m_pDecisions(pDecisions), m_pCache(NULL)
+    m_pEnvironment(pEnvironment),
+    m_pDecisions(pDecisions),
+    m_generation(1),
+    m_pCache(NULL),
+    m_decisionTableEnabled(0),
+    m_pDecisionTable(nullptr),
+    m_pProviderValues(nullptr),
+    m_numProviderValues(0)
 {
-    ::InitializeSRWLock(&m_srwLock);
-    ::InitializeSRWLock(&m_srwQualifierSetLock);
-    ::InitializeSRWLock(&m_srwQualifierLock);
+    ::InitializeSRWLock(&m_srwDecisionTableLock);
+    ::InitializeSRWLock(&m_srwProviderValuesLock);
 }
 
-ResolverBase::~ResolverBase() { delete m_pCache; }
+ResolverBase::~ResolverBase()
+{
+    // Tables that were outgrown are kept on the chain because readers may still have been using them.
+    DecisionTable* pTable = m_pDecisionTable;
+    while (pTable != nullptr)
+    {
+        DecisionTable* pPrevious = pTable->pPrevious;
+        _DefFree(pTable);
+        pTable = pPrevious;
+    }
+
+    for (int i = 0; i < m_numProviderValues; i++)
+    {
+        delete m_pProviderValues[i].pValue;
+    }
+    _DefFree(m_pProviderValues);
+
+    delete m_pCache;
+}
 
 HRESULT ResolverBase::Init()
 {
@@ -1114,20 +1387,10 @@ HRESULT ResolverBase::Init()
 
 void ResolverBase::Reset()
 {
-    // Frequent reset during evalueDecision can corrupt the cache.
-    // Order is important here, m_srwLock -> m_srwQualifierSetLock -> m_srwQualifierLock.
-    // We consider to have separate scope for respective m_srwLock and m_srwQualifierSetLock in future.
-    AutoReaderWriterLock autoLock(&m_srwLock);
-    {
-        AutoReaderWriterLock autoQualifierSetLock(&m_srwQualifierSetLock); // protect pResults object for potential race condition
-        {
-            AutoReaderWriterLock autoQualifierLock(&m_srwQualifierLock); // protect pResults object for potential race condit
-            {
-                // the cache doesn't do anythnig interesting with per-qualifier reset yet so just reset the whole thing.
-                m_pCache->Reset();
-            }
-        }
-    }
+    // the cache doesn't do anythnig interesting with per-qualifier reset yet so just reset the whole thing.
+    // Evaluations that are already running finish against the generation they started with.
+    m_pCache->Reset();
+    InterlockedIncrement64(&m_generation);
 }
 
 HRESULT ResolverBase::Reset(__in_ecount(numQualifierNames) Atom* pQualifierNames, _In_ int numQualifierNames)
@@ -1135,20 +1398,9 @@ HRESULT ResolverBase::Reset(__in_ecount(numQualifierNames) Atom* pQualifierNames
     RETURN_HR_IF(
         E_INVALIDARG, (pQualifierNames == nullptr) || (numQualifierNames < 1) || (numQualifierNames > m_pDecisions->GetNumQualifiers()));
 
-    // Frequent reset during evalueDecision can corrupt the cache.
-    // Order is important here, m_srwLock -> m_srwQualifierSetLock -> m_srwQualifierLock.
-    // We consider to have separate scope for respective m_srwLock and m_srwQualifierSetLock in future.
-    AutoReaderWriterLock autoLock(&m_srwLock);
-    {
-        AutoReaderWriterLock autoQualifierSetLock(&m_srwQualifierSetLock); // protect pResults object for potential race condition
-        {
-            AutoReaderWriterLock autoQualifierLock(&m_srwQualifierLock); // protect pResults object for potential race condit
-            {
-                // the cache doesn't do anythnig interesting with per-qualifier reset yet so just reset the whole thing.
-                m_pCache->Reset();
-            }
-        }
-    }
+    // the cache doesn't do anythnig interesting with per-qualifier reset yet so just reset the whole thing.
+    m_pCache->Reset();
+    InterlockedIncrement64(&m_generation);
 
     return S_OK;
 }
@@ -1158,17 +1410,21 @@ HRESULT ResolverBase::EvaluateQualifier(_In_ const IQualifier* pQualifier, _Out_
     UINT16 score = 0;
     UINT16 fallbackScore = 0;
 
-    RETURN_IF_FAILED(EvaluateQualifier(pQualifier, &score, &fallbackScore));
+    RETURN_IF_FAILED(EvaluateQualifier(pQualifier, m_pCache->GetGeneration(), &score, &fallbackScore));
 
     RETURN_IF_FAILED(IQualifier::ToDoubleScore(score, pScoreOut));
     RETURN_IF_FAILED(IQualifier::ToDoubleScore(fallbackScore, pFallbackScoreOut));
     return S_OK;
 }
 
-HRESULT ResolverBase::EvaluateQualifier(_In_ const IQualifier* pQualifier, _Out_ UINT16* pScoreOut, _Out_ UINT16* pFallbackScoreOut) const
+HRESULT ResolverBase::EvaluateQualifier(
+    _In_ const IQualifier* pQualifier,
+    _In_ UINT32 cacheGeneration,
+    _Out_ UINT16* pScoreOut,
+    _Out_ UINT16* pFallbackScoreOut) const
 {
     // Have we seen this qualifier before?
-    if (SUCCEEDED(m_pCache->GetQualifierScores(pQualifier, pScoreOut, pFallbackScoreOut)))
+    if (SUCCEEDED(m_pCache->GetQualifierScores(pQualifier, cacheGeneration, pScoreOut, pFallbackScoreOut)))
     {
         return S_OK;
     }
@@ -1178,12 +1434,9 @@ HRESULT ResolverBase::EvaluateQualifier(_In_ const IQualifier* pQualifier, _Out_
     RETURN_IF_FAILED(pQualifier->GetFallbackScore(&fallbackScore));
 
     // Nope. Try to evaluate it.
+    // Two threads might both get here for the same qualifier. They compute the same score, so the last write wins harmlessly.
     Atom qualifierName;
     const IBuildQualifierType* pType = NULL;
-    StringResult value;
-
-    // The method can be called by (1) under m_srwLock and m_srwQualifierSetLock exclusive lock, or (2) no lock
-    AutoReaderWriterLock autoLock(&m_srwQualifierLock);
 
     HRESULT hr = pQualifier->GetOperand1Attribute(&qualifierName);
     if (SUCCEEDED(hr))
@@ -1193,13 +1446,7 @@ HRESULT ResolverBase::EvaluateQualifier(_In_ const IQualifier* pQualifier, _Out_
 
     if (SUCCEEDED(hr))
     {
-        hr = GetQualifierValue(qualifierName, &value);
-    }
-
-    if (SUCCEEDED(hr))
-    {
-        // looks good, get a score
-        (void)pType->Evaluate(pQualifier, value.GetRef(), &score);
+        hr = EvaluateProviderValue(pQualifier, qualifierName, pType, cacheGeneration, &score);
     }
 
     if (hr == HRESULT_FROM_WIN32(ERROR_MRM_UNKNOWN_QUALIFIER))
@@ -1213,19 +1460,127 @@ HRESULT ResolverBase::EvaluateQualifier(_In_ const IQualifier* pQualifier, _Out_
     // from this function, and still use fallbackScore for evaluation.
     RETURN_IF_FAILED(IQualifier::ToUint16Score(score, pScoreOut));
     RETURN_IF_FAILED(IQualifier::ToUint16Score(fallbackScore, pFallbackScoreOut));
-    RETURN_IF_FAILED(m_pCache->SetQualifierScores(pQualifier, pQualifier->GetPriority(), *pScoreOut, *pFallbackScoreOut));
+    RETURN_IF_FAILED(m_pCache->SetQualifierScores(pQualifier, cacheGeneration, pQualifier->GetPriority(), *pScoreOut, *pFallbackScoreOut));
     return hr;
 }
 
+HRESULT ResolverBase::EvaluateProviderValue(
+    _In_ const IQualifier* pQualifier,
+    _In_ Atom qualifierName,
+    _In_ const IBuildQualifierType* pType,
+    _In_ UINT32 cacheGeneration,
+    _Out_ double* pScoreOut) const
+{
+    *pScoreOut = 0.0;
+
+    int index = static_cast<int>(qualifierName.GetIndex());
+
+    // Evaluate while holding the lock so that a newer value can't free the one being used.
+    if (index >= 0)
+    {
+        bool bFound = false;
+
+        AcquireSRWLockShared(&m_srwProviderValuesLock);
+        if (index < m_numProviderValues)
+        {
+            const ProviderValueEntry& entry = m_pProviderValues[index];
+            if ((entry.pValue != nullptr) && (entry.pValue->GetGeneration() == cacheGeneration) && entry.qualifierName.IsEqual(qualifierName))
+            {
+                (void)pType->EvaluateParsed(pQualifier, entry.pValue, pScoreOut);
+                bFound = true;
+            }
+        }
+        ReleaseSRWLockShared(&m_srwProviderValuesLock);
+
+        if (bFound)
+        {
+            return S_OK;
+        }
+    }
+
+    // Not parsed for this generation yet. GetQualifierValue does its own locking and hands back a copy of
+    // the value, so nothing here needs to hold a resolver lock while the provider runs.
+    StringResult value;
+    HRESULT hr = GetQualifierValue(qualifierName, &value);
+    if (FAILED(hr))
+    {
+        // Unknown qualifiers are expected; the caller decides what to do with them.
+        return hr;
+    }
+
+    AutoDeletePtr<ParsedQualifierValue> pParsed;
+    RETURN_IF_FAILED(pType->ParseProviderValue(value.GetRef(), &pParsed));
+    pParsed->SetGeneration(cacheGeneration);
+
+    if (index < 0)
+    {
+        (void)pType->EvaluateParsed(pQualifier, pParsed, pScoreOut);
+        return S_OK;
+    }
+
+    AcquireSRWLockExclusive(&m_srwProviderValuesLock);
+    if (index >= m_numProviderValues)
+    {
+        int numNewValues = index + 1;
+        ProviderValueEntry* pNewValues = _DefArray_AllocZeroed(ProviderValueEntry, numNewValues);
+        if (pNewValues == nullptr)
+        {
+            ReleaseSRWLockExclusive(&m_srwProviderValuesLock);
+
+            // Still score it, just without keeping the parsed value.
+            (void)pType->EvaluateParsed(pQualifier, pParsed, pScoreOut);
+            return S_OK;
+        }
+
+        if (m_pProviderValues != nullptr)
+        {
+            memcpy(pNewValues, m_pProviderValues, m_numProviderValues * sizeof(ProviderValueEntry));
+            _DefFree(m_pProviderValues);
+        }
+        m_pProviderValues = pNewValues;
+        m_numProviderValues = numNewValues;
+    }
+
+    // Threads from the same generation parse the same value, so whichever stores last wins harmlessly, but
+    // an evaluation that started before a reset must not replace the value parsed after it.
+    ProviderValueEntry& entry = m_pProviderValues[index];
+    if ((entry.pValue != nullptr) && (static_cast<INT32>(static_cast<UINT32>(entry.pValue->GetGeneration()) - cacheGeneration) > 0))
+    {
+        ReleaseSRWLockExclusive(&m_srwProviderValuesLock);
+        (void)pType->EvaluateParsed(pQualifier, pParsed, pScoreOut);
+        return S_OK;
+    }
+
+    delete entry.pValue;
+    entry.qualifierName = qualifierName;
+    entry.pValue = pParsed.Detach();
+
+    (void)pType->EvaluateParsed(pQualifier, entry.pValue, pScoreOut);
+    ReleaseSRWLockExclusive(&m_srwProviderValuesLock);
+    return S_OK;
+}
+
 HRESULT ResolverBase::EvaluateQualifierSet(
     _In_ const IQualifierSet* pQualifierSet,
     _Out_ bool* pbIsMatchOut,
     _Out_ bool* pbIsDefaultOut,
     _Out_ bool* pbIsMatchOrDefaultOut,
     _Out_opt_ UINT16* pScoreOut = NULL) const
+{
+    return EvaluateQualifierSet(pQualifierSet, m_pCache->GetGeneration(), pbIsMatchOut, pbIsDefaultOut, pbIsMatchOrDefaultOut, pScoreOut);
+}
+
+HRESULT ResolverBase::EvaluateQualifierSet(
+    _In_ const IQualifierSet* pQualifierSet,
+    _In_ UINT32 cacheGeneration,
+    _Out_ bool* pbIsMatchOut,
+    _Out_ bool* pbIsDefaultOut,
+    _Out_ bool* pbIsMatchOrDefaultOut,
+    _Out_opt_ UINT16* pScoreOut) const
 {
     // Have we seen this qualifier set before
-    if (SUCCEEDED(m_pCache->GetQualifierSetResults(pQualifierSet, pbIsMatchOut, pbIsDefaultOut, pbIsMatchOrDefaultOut, pScoreOut)))
+    if (SUCCEEDED(m_pCache->GetQualifierSetResults(
+            pQualifierSet, cacheGeneration, pbIsMatchOut, pbIsDefaultOut, pbIsMatchOrDefaultOut, pScoreOut)))
     {
         return S_OK;
     }
@@ -1241,9 +1596,6 @@ HRESULT ResolverBase::EvaluateQualifierSet(
     UINT16 fallbackScore;
     int lastQualifierPriority = 0;
 
-    // The method can be called by (1) under m_srwLock exclusive lock, or (2) no lock
-    AutoReaderWriterLock autoLock(&m_srwQualifierSetLock);
-
     int numQualifiers = pQualifierSet->GetNumQualifiers();
     if (numQualifiers > 0)
     {
@@ -1251,7 +1603,7 @@ HRESULT ResolverBase::EvaluateQualifierSet(
         for (int i = 0; (i < numQualifiers) && (bIsMatch || bIsDefault || bIsMatchOrDefault); i++)
         {
             score = fallbackScore = 0;
-            if (FAILED(pQualifierSet->GetQualifier(i, &qualifier)) || FAILED(EvaluateQualifier(&qualifier, &score, &fallbackScore)))
+            if (FAILED(pQualifierSet->GetQualifier(i, &qualifier)) || FAILED(EvaluateQualifier(&qualifier, cacheGeneration, &score, &fallbackScore)))
             {
                 // some kind of error occurred.  Just treat it as if it's no match.
                 bIsMatch = false;
@@ -1295,7 +1647,14 @@ HRESULT ResolverBase::EvaluateQualifierSet(
     }
 
     RETURN_IF_FAILED(m_pCache->SetQualifierSetResults(
-        pQualifierSet, bIsMatch, bIsDefault, bIsMatchOrDefault, bMultipleOfSameQualifier, bestActualMatchPriority, bestActualMatchScore));
+        pQualifierSet,
+        cacheGeneration,
+        bIsMatch,
+        bIsDefault,
+        bIsMatchOrDefault,
+        bMultipleOfSameQualifier,
+        bestActualMatchPriority,
+        bestActualMatchScore));
 
     return S_OK;
 }
@@ -1317,23 +1676,64 @@ HRESULT ResolverBase::EvaluateDecision(
     _Out_writes_(numResults) int* pResultIndexesOut,
     _Out_writes_(numResults) int* pResultSetIndexesOut) const
 {
-    AutoReaderWriterLock autoLock(&m_srwLock); // protect pResults object for potential race condition
+    if ((numResults == 1) && IsDecisionTableEnabled())
+    {
+        if (TryGetDecisionFromTable(pDecision, pResultIndexesOut, pResultSetIndexesOut))
+        {
+            return S_OK;
+        }
+
+        // Take the generation before resolving, so that a concurrent reset leaves the stored winner stale rather than wrong.
+        UINT64 generation = GetGeneration();
+        HRESULT hr = ResolveDecision(pDecision, 1, pResultIndexesOut, pResultSetIndexesOut);
+        if (SUCCEEDED(hr))
+        {
+            (void)StoreDecisionInTable(pDecision, generation, *pResultIndexesOut, *pResultSetIndexesOut);
+        }
+        return hr;
+    }
+
+    return ResolveDecision(pDecision, numResults, pResultIndexesOut, pResultSetIndexesOut);
+}
 
-    if (SUCCEEDED(m_pCache->GetDecisionResults(pDecision, numResults, pResultIndexesOut, pResultSetIndexesOut)))
+HRESULT ResolverBase::ResolveDecision(
+    _In_ const IDecision* pDecision,
+    _In_ int numResults,
+    _Out_writes_(numResults) int* pResultIndexesOut,
+    _Out_writes_(numResults) int* pResultSetIndexesOut) const
+{
+    // Everything below uses the same cache generation, so a concurrent Reset can't mix results
+    // from before and after the reset. Results from an old generation are simply never read again.
+    UINT32 cacheGeneration = m_pCache->GetGeneration();
+    if (SUCCEEDED(m_pCache->GetDecisionResults(pDecision, cacheGeneration, numResults, pResultIndexesOut, pResultSetIndexesOut)))
     {
         return S_OK;
     }
-    int numSets = 0;
+
+    DecisionInfoCache::DecisionResults* pCached;
+    RETURN_IF_FAILED(m_pCache->BeginSetDecisionResults(pDecision, cacheGeneration, &pCached));
+
+    // If another thread is already writing the cached results for this decision, work in a private
+    // buffer rather than waiting for it.
+    int numSets = pDecision->GetNumQualifierSets();
+    DecisionInfoCache::DecisionPerSetInfo* pPrivate = nullptr;
     DecisionInfoCache::DecisionPerSetInfo* pResults;
-    RETURN_IF_FAILED(m_pCache->BeginSetDecisionResults(pDecision, &pResults, &numSets));
-    DEF_ASSERT(numSets == pDecision->GetNumQualifierSets());
+    if (pCached != nullptr)
+    {
+        pResults = pCached->sets;
+    }
+    else
+    {
+        pPrivate = _DefArray_Alloc(DecisionInfoCache::DecisionPerSetInfo, numSets);
+        RETURN_IF_NULL_ALLOC(pPrivate);
+        pResults = pPrivate;
+    }
 
     QualifierSetResult qualifierSet;
     int indexInPool;
     bool bIsMatch;
     bool bIsFallbackMatch;
     bool bIsMatchOrDefault;
-    const DecisionInfoCache::QualifierSetCacheEntry* pEntry;
 
     // We'll put matches at the head and non-matches at the tail
     int nextMatch = 0;
@@ -1341,14 +1741,13 @@ HRESULT ResolverBase::EvaluateDecision(
     for (int i = 0; i < numSets; i++)
     {
         if (FAILED(pDecision->GetQualifierSet(i, &qualifierSet, &indexInPool)) ||
-            FAILED(EvaluateQualifierSet(&qualifierSet, &bIsMatch, &bIsFallbackMatch, &bIsMatchOrDefault)) ||
-            FAILED(m_pCache->GetQualifierSetCacheEntry(indexInPool, &pEntry)))
+            FAILED(EvaluateQualifierSet(&qualifierSet, cacheGeneration, &bIsMatch, &bIsFallbackMatch, &bIsMatchOrDefault, nullptr)))
         {
             // something went badly wrong.  Count this set as a failure.
             bIsMatch = bIsFallbackMatch = bIsMatchOrDefault = false;
         }
 
-        // Okay, we now have our qualifier set, our index in the global pool and our cache entry.
+        // Okay, we now have our qualifier set and our index in the global pool.
         if (bIsMatch)
         {
             pResults[nextMatch].setIndexInDecision = static_cast<UINT16>(i);
@@ -1365,22 +1764,311 @@ HRESULT ResolverBase::EvaluateDecision(
 
     // Sort the results so that the matches are prioritized ahead of the fallbacks, ahead of the non-matches
     DEF_ASSERT(nextFailed + 1 == nextMatch);
-    DecisionInfoCache::_DecisionSortingInfo sortingContextInfo = {m_pCache, this};
+    DecisionInfoCache::_DecisionSortingInfo sortingContextInfo = {m_pCache, cacheGeneration, this};
 
-    AutoReaderWriterLock autoQualifierSetLock(&m_srwQualifierSetLock);
     qsort_s(
         pResults,
         numSets,
         sizeof(*pResults),
         (int(__cdecl*)(void*, const void*, const void*))DecisionInfoCache::_DecisionSortingHelper,
         &sortingContextInfo);
-    RETURN_IF_FAILED(m_pCache->EndSetDecisionResults(pDecision));
 
-    RETURN_IF_FAILED(m_pCache->GetDecisionResults(pDecision, numResults, pResultIndexesOut, pResultSetIndexesOut));
+    DecisionInfoCache::CopyDecisionResults(pResults, numSets, numResults, pResultIndexesOut, pResultSetIndexesOut);
+
+    if (pCached != nullptr)
+    {
+        m_pCache->EndSetDecisionResults(pCached, cacheGeneration);
+    }
+    else
+    {
+        _DefFree(pPrivate);
+    }
 
     return S_OK;
 }
 
+HRESULT ResolverBase::EvaluateDecisions(
+    _In_ int numDecisions,
+    _In_reads_(numDecisions) const IDecision* const* ppDecisions,
+    _Out_writes_(numDecisions) int* pResultIndexesOut,
+    _Out_writes_(numDecisions) int* pResultSetIndexesOut,
+    _Out_writes_opt_(numDecisions) HRESULT* pResultsOut) const
+{
+    RETURN_HR_IF(E_INVALIDARG, (numDecisions < 0) || ((numDecisions > 0) && (ppDecisions == nullptr)));
+
+    for (int i = 0; i < numDecisions; i++)
+    {
+        HRESULT hr = EvaluateDecision(ppDecisions[i], 1, &pResultIndexesOut[i], &pResultSetIndexesOut[i]);
+        if (pResultsOut != nullptr)
+        {
+            pResultsOut[i] = hr;
+        }
+        else
+        {
+            RETURN_IF_FAILED(hr);
+        }
+    }
+
+    return S_OK;
+}
+
+HRESULT ResolverBase::EnableDecisionTable(_In_ bool enable)
+{
+    InterlockedExchange(&m_decisionTableEnabled, (enable ? 1 : 0));
+    return S_OK;
+}
+
+HRESULT ResolverBase::GetDecisionTable(_In_ int numEntries, _Out_writes_(numEntries) UINT16* pEntriesOut) const
+{
+    int numDecisions = m_pDecisions->GetNumDecisions();
+    RETURN_HR_IF(E_INVALIDARG, (pEntriesOut == nullptr) || (numEntries != numDecisions * 2));
+
+    UINT64 generation = GetGeneration();
+    for (int i = 0; i < numDecisions; i++)
+    {
+        DecisionResult decision;
+        int indexInDecision;
+        int indexInPool;
+        UINT16 winner = DecisionTableNoWinner;
+        UINT16 winnerInPool = DecisionTableNoWinner;
+
+        if (SUCCEEDED(m_pDecisions->GetDecision(i, &decision)) &&
+            SUCCEEDED(ResolverBase::EvaluateDecision(&decision, 1, &indexInDecision, &indexInPool)) && (indexInDecision >= 0) &&
+            (indexInDecision < DecisionTableNoWinner) && (indexInPool >= 0) && (indexInPool < DecisionTableNoWinner))
+        {
+            winner = static_cast<UINT16>(indexInDecision);
+            winnerInPool = static_cast<UINT16>(indexInPool);
+        }
+
+        // Decisions with no winner fall back to the cache, which reports the error.
+        pEntriesOut[i * 2] = winner;
+        pEntriesOut[(i * 2) + 1] = winnerInPool;
+    }
+
+    // The resolver was reset while we were resolving.
+    RETURN_HR_IF(E_PENDING, GetGeneration() != generation);
+    return S_OK;
+}
+
+HRESULT ResolverBase::UseDecisionTable(_In_reads_(numEntries) const UINT16* pEntries, _In_ int numEntries)
+{
+    int numDecisions = m_pDecisions->GetNumDecisions();
+    RETURN_HR_IF(E_INVALIDARG, (pEntries == nullptr) || (numEntries != numDecisions * 2));
+
+    // The entries usually come from a file, so make sure that every winner really is a qualifier set of its decision.
+    for (int i = 0; i < numDecisions; i++)
+    {
+        UINT16 indexInDecision = pEntries[i * 2];
+        UINT16 indexInPool = pEntries[(i * 2) + 1];
+        if (indexInDecision == DecisionTableNoWinner)
+        {
+            RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), indexInPool != DecisionTableNoWinner);
+            continue;
+        }
+
+        DecisionResult decision;
+        QualifierSetResult qualifierSet;
+        int expectedIndexInPool;
+        RETURN_IF_FAILED(m_pDecisions->GetDecision(i, &decision));
+        RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), indexInDecision >= decision.GetNumQualifierSets());
+        RETURN_IF_FAILED(decision.GetQualifierSet(indexInDecision, &qualifierSet, &expectedIndexInPool));
+        RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), indexInPool != expectedIndexInPool);
+    }
+
+    // Take the generation before reading the values, so that a concurrent change moves past it.
+    UINT64 generation = GetGeneration();
+    DEF_CHECKSUM qualifierChecksum;
+    RETURN_IF_FAILED(ComputeQualifierChecksum(&qualifierChecksum));
+
+    DecisionTable* pNew;
+    RETURN_IF_FAILED(AllocateDecisionTable(numDecisions, &pNew));
+    pNew->pSnapshotEntries = pEntries;
+    pNew->numSnapshotDecisions = numDecisions;
+    pNew->snapshotQualifierChecksum = qualifierChecksum;
+    pNew->snapshotGeneration = static_cast<LONG64>(generation);
+
+    AcquireSRWLockExclusive(&m_srwDecisionTableLock);
+    pNew->pPrevious = m_pDecisionTable;
+    InterlockedExchangePointer(reinterpret_cast<PVOID volatile*>(&m_pDecisionTable), pNew);
+    ReleaseSRWLockExclusive(&m_srwDecisionTableLock);
+
+    InterlockedExchange(&m_decisionTableEnabled, 1);
+    return S_OK;
+}
+
+HRESULT ResolverBase::ComputeQualifierChecksum(_Out_ DEF_CHECKSUM* pChecksumOut) const
+{
+    *pChecksumOut = 0;
+
+    AutoDeletePtr<DynamicArray<Atom>> pQualifierNames;
+    RETURN_IF_FAILED(m_pEnvironment->GetAllAtoms(UnifiedEnvironment::QualifierNames, &pQualifierNames));
+
+    DEF_CHECKSUM checksum = 0;
+    for (UINT i = 0; i < pQualifierNames->Count(); i++)
+    {
+        Atom nameAtom;
+        RETURN_IF_FAILED(pQualifierNames->Get(i, &nameAtom));
+
+        StringResult name;
+        RETURN_IF_FAILED(m_pEnvironment->GetName(UnifiedEnvironment::QualifierNames, nameAtom, &name));
+        RETURN_IF_FAILED(DefChecksum::ComputeStringChecksum(checksum, true, name.GetRef(), &checksum));
+
+        // Qualifiers without a value still count, as an empty value.
+        StringResult value;
+        PCWSTR pValue = L"";
+        if (SUCCEEDED(GetQualifierValue(nameAtom, &value)) && (value.GetRef() != nullptr))
+        {
+            pValue = value.GetRef();
+        }
+        RETURN_IF_FAILED(DefChecksum::ComputeStringChecksum(checksum, true, pValue, &checksum));
+    }
+
+    *pChecksumOut = checksum;
+    return S_OK;
+}
+
+void ResolverBase::RevalidateDecisionTableSnapshot()
+{
+    DecisionTable* pTable = static_cast<DecisionTable*>(ReadPointerAcquire(reinterpret_cast<PVOID volatile*>(&m_pDecisionTable)));
+    if ((pTable == nullptr) || (pTable->pSnapshotEntries == nullptr))
+    {
+        return;
+    }
+
+    // Take the generation before reading the values. If another change lands while we read them, it starts a
+    // newer generation than this one, so the snapshot is never used with values that it wasn't resolved for.
+    UINT64 generation = GetGeneration();
+    DEF_CHECKSUM qualifierChecksum;
+    if (FAILED(ComputeQualifierChecksum(&qualifierChecksum)) || (qualifierChecksum != pTable->snapshotQualifierChecksum))
+    {
+        return;
+    }
+
+    // The lock keeps a growing table from copying the old generation after we've moved it forward.
+    AutoReaderWriterLock autoLock(&m_srwDecisionTableLock);
+    pTable = m_pDecisionTable;
+    LONG64 current = ReadAcquire64(&pTable->snapshotGeneration);
+    if (static_cast<INT64>(generation - static_cast<UINT64>(current)) > 0)
+    {
+        (void)InterlockedCompareExchange64(&pTable->snapshotGeneration, static_cast<LONG64>(generation), current);
+    }
+}
+
+bool ResolverBase::TryGetDecisionFromTable(_In_ const IDecision* pDecision, _Out_ int* pResultIndexOut, _Out_ int* pResultSetIndexOut) const
+{
+    int index;
+    if ((ReadAcquire(&m_decisionTableEnabled) == 0) || FAILED(pDecision->GetIndex(&index)) || (index < 0))
+    {
+        return false;
+    }
+
+    UINT64 generation = GetGeneration();
+    const DecisionTable* pTable = static_cast<const DecisionTable*>(ReadPointerAcquire(reinterpret_cast<PVOID volatile*>(&m_pDecisionTable)));
+    if ((pTable == nullptr) || (index >= pTable->numDecisions))
+    {
+        return false;
+    }
+
+    UINT16 indexInDecision;
+    UINT16 indexInPool;
+    if ((pTable->pSnapshotEntries != nullptr) && (static_cast<UINT64>(ReadAcquire64(&pTable->snapshotGeneration)) == generation) &&
+        (index < pTable->numSnapshotDecisions))
+    {
+        indexInDecision = pTable->pSnapshotEntries[index * 2];
+        indexInPool = pTable->pSnapshotEntries[(index * 2) + 1];
+    }
+    else
+    {
+        // Not resolved for this generation yet. The caller resolves it and stores the winner.
+        LONG64 entry = ReadAcquire64(&pTable->entries[index]);
+        if ((entry == 0) || (GetDecisionTableEntryGeneration(entry) != static_cast<UINT32>(generation)))
+        {
+            return false;
+        }
+        indexInDecision = static_cast<UINT16>(static_cast<UINT64>(entry) >> 16);
+        indexInPool = static_cast<UINT16>(entry);
+    }
+
+    if (indexInDecision == DecisionTableNoWinner)
+    {
+        return false;
+    }
+
+    *pResultIndexOut = indexInDecision;
+    *pResultSetIndexOut = indexInPool;
+    return true;
+}
+
+HRESULT ResolverBase::StoreDecisionInTable(
+    _In_ const IDecision* pDecision,
+    _In_ UINT64 generation,
+    _In_ int indexInDecision,
+    _In_ int indexInPool) const
+{
+    int index;
+    RETURN_IF_FAILED(pDecision->GetIndex(&index));
+    if ((index < 0) || (indexInDecision < 0) || (indexInDecision >= DecisionTableNoWinner) || (indexInPool < 0) ||
+        (indexInPool >= DecisionTableNoWinner))
+    {
+        return S_FALSE;
+    }
+
+    DecisionTable* pTable = static_cast<DecisionTable*>(ReadPointerAcquire(reinterpret_cast<PVOID volatile*>(&m_pDecisionTable)));
+    if ((pTable == nullptr) || (index >= pTable->numDecisions))
+    {
+        // decision info may have grown since the table was allocated
+        AutoReaderWriterLock autoLock(&m_srwDecisionTableLock);
+
+        pTable = m_pDecisionTable;
+        if ((pTable == nullptr) || (index >= pTable->numDecisions))
+        {
+            DecisionTable* pNew;
+            RETURN_IF_FAILED(AllocateDecisionTable(max(m_pDecisions->GetNumDecisions(), index + 1), &pNew));
+            if (pTable != nullptr)
+            {
+                pNew->pSnapshotEntries = pTable->pSnapshotEntries;
+                pNew->numSnapshotDecisions = pTable->numSnapshotDecisions;
+                pNew->snapshotQualifierChecksum = pTable->snapshotQualifierChecksum;
+                pNew->snapshotGeneration = ReadAcquire64(&pTable->snapshotGeneration);
+                for (int i = 0; i < pTable->numDecisions; i++)
+                {
+                    pNew->entries[i] = ReadAcquire64(&pTable->entries[i]);
+                }
+            }
+
+            // Outgrown tables stay on the chain because readers may still be using them.
+            pNew->pPrevious = pTable;
+            InterlockedExchangePointer(reinterpret_cast<PVOID volatile*>(&m_pDecisionTable), pNew);
+            pTable = pNew;
+        }
+    }
+
+    // Never replace a winner that was resolved after a reset with one that was resolved before it.
+    LONG64 current = ReadAcquire64(&pTable->entries[index]);
+    if ((current == 0) || (static_cast<INT32>(GetDecisionTableEntryGeneration(current) - static_cast<UINT32>(generation)) <= 0))
+    {
+        (void)InterlockedCompareExchange64(
+            &pTable->entries[index],
+            MakeDecisionTableEntry(generation, static_cast<UINT16>(indexInDecision), static_cast<UINT16>(indexInPool)),
+            current);
+    }
+
+    return S_OK;
+}
+
+HRESULT ResolverBase::AllocateDecisionTable(_In_ int numDecisions, _Outptr_ DecisionTable** result)
+{
+    *result = nullptr;
+
+    size_t cbTable = sizeof(DecisionTable) + (max(numDecisions - 1, 0) * sizeof(LONG64));
+    DecisionTable* pTable = static_cast<DecisionTable*>(_DefBlob_AllocZeroed(cbTable));
+    RETURN_IF_NULL_ALLOC(pTable);
+    pTable->numDecisions = numDecisions;
+
+    *result = pTable;
+    return S_OK;
+}
+
 class ProviderResolver::PerQualifierPoolInfo : public DefObject
 {
 public:
@@ -1480,8 +2168,6 @@ public:
 
     HRESULT GetQualifierValue(_In_ Atom atom, _In_ const IProviderDataSources* pData, _Inout_ StringResult* pRtrn)
     {
-        AutoReaderWriterLock autoLock(&m_srwLock, true);
-
         UINT32 atomIx =
             atom.GetIndex(); // OACR doesn't like using atom.GetIndex() as an index on m_pCachedValues below (wasn't mollified with "__analysis_assume(atom.GetIndex() < m_cacheSize)")
         if ((atom.GetPoolIndex() != m_pPool->GetPoolIndex()) || (atomIx >= m_cacheSize))
@@ -1496,26 +2182,34 @@ public:
 
         UINT32 maskbit = (1 << atomIx);
 
-        if (((m_attemptedValues & maskbit) == 0) && ((m_presentValues & maskbit) == 0))
         {
-            //  Nothing in the cache.  Try to get the value.
-            m_attemptedValues |= maskbit;
+            AutoReaderWriterLock autoLock(&m_srwLock, true);
+            if (((m_attemptedValues | m_presentValues) & maskbit) != 0)
+            {
+                return GetCachedValue(atomIx, pRtrn);
+            }
+        }
+
+        //  Nothing in the cache.  Asking the provider fills in the cached value, so that takes the lock exclusively.
+        AutoReaderWriterLock autoLock(&m_srwLock);
+        if (((m_attemptedValues | m_presentValues) & maskbit) == 0)
+        {
             IQualifierValueProvider* pProvider;
             RETURN_IF_FAILED(m_pProviders->Get(atomIx, &pProvider));
             DEF_ASSERT(pProvider != NULL);
-            RETURN_IF_FAILED(pProvider->GetQualifierValue(atom, pData, &m_pCachedValues[atomIx]));
 
-            m_presentValues |= maskbit;
+            // Only mark the value as attempted once the provider is done with it, so nobody sees a
+            // value that is still being written.
+            HRESULT hr = pProvider->GetQualifierValue(atom, pData, &m_pCachedValues[atomIx]);
+            if (SUCCEEDED(hr))
+            {
+                m_presentValues |= maskbit;
+            }
+            m_attemptedValues |= maskbit;
+            RETURN_IF_FAILED(hr);
         }
 
-        if ((m_presentValues & maskbit) != 0)
-        {
-            // we have a cached value, return that
-            RETURN_IF_FAILED(pRtrn->SetRef(m_pCachedValues[atomIx].GetRef()));
-            return S_OK;
-        }
-        // Couldn't get a value
-        return HRESULT_FROM_WIN32(ERROR_NOT_FOUND);
+        return GetCachedValue(atomIx, pRtrn);
     }
 
     HRESULT SetQualifierValue(_In_ Atom atom, _In_ PCWSTR pValue, _In_ bool bCopy)
@@ -1538,6 +2232,20 @@ public:
     }
 
 protected:
+    // Callers must hold m_srwLock. Returns a copy because SetQualifierValue can replace the cached
+    // string as soon as the lock is released.
+    HRESULT GetCachedValue(_In_ UINT32 atomIx, _Inout_ StringResult* pRtrn) const
+    {
+        if ((m_presentValues & (1 << atomIx)) != 0)
+        {
+            // we have a cached value, return that
+            RETURN_IF_FAILED(pRtrn->SetCopy(m_pCachedValues[atomIx].GetRef()));
+            return S_OK;
+        }
+        // Couldn't get a value
+        return HRESULT_FROM_WIN32(ERROR_NOT_FOUND);
+    }
+
     const IAtomPool* m_pPool;
 
     mutable DynamicArray<IQualifierValueProvider*>* m_pProviders;
@@ -1659,16 +2367,16 @@ HRESULT ProviderResolver::InitAllQualifierProviders(_In_ CoreProfile* pProfile)
 
 void ProviderResolver::Reset()
 {
-    ResolverBase::Reset();
+    // Drop the cached values before moving to a new generation, so that nothing resolved for the new
+    // generation can see an old value.
     m_pQualifiers->ResetCache();
+    ResolverBase::Reset();
 }
 
 HRESULT ProviderResolver::Reset(__in_ecount(numQualifierNames) Atom* pQualifierNames, _In_ int numQualifierNames)
 {
     RETURN_HR_IF_NULL(E_INVALIDARG, pQualifierNames);
 
-    RETURN_IF_FAILED(ResolverBase::Reset(pQualifierNames, numQualifierNames));
-
     bool badPool = false;
 
     Atom qualifier;
@@ -1685,6 +2393,8 @@ HRESULT ProviderResolver::Reset(__in_ecount(numQualifierNames) Atom* pQualifierN
         }
     }
 
+    RETURN_IF_FAILED(ResolverBase::Reset(pQualifierNames, numQualifierNames));
+
     RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_MRM_INVALID_FILE_TYPE), badPool);
 
     return S_OK;
@@ -1726,9 +2436,13 @@ HRESULT ProviderResolver::SetQualifier(_In_ PCWSTR pQualifierName, _In_ PCWSTR p
 
 HRESULT ProviderResolver::SetQualifier(_In_ Atom qualifier, _In_ PCWSTR pNewValue)
 {
-    (void)Reset(&qualifier, 1);
-
+    // Store the new value before starting a new generation, so that lookups in the new generation never see the old one.
     RETURN_IF_FAILED(m_pQualifiers->SetQualifierValue(qualifier, pNewValue, true));
+    (void)ResolverBase::Reset(&qualifier, 1);
+
+    // Setting the values that a snapshot was taken for, as a resource context does when it is applied, keeps
+    // using the snapshot.
+    RevalidateDecisionTableSnapshot();
 
     return S_OK;
 }
@@ -1812,8 +2526,8 @@ public:
 
         if ((m_presentValues & maskbit) != 0)
         {
-            // we have a cached value, return that
-            RETURN_IF_FAILED(pRtrn->SetRef(m_pCachedValues[atom.GetIndex()].GetRef()));
+            // we have a cached value, return a copy since SetQualifierValue can replace it once we let go of the lock
+            RETURN_IF_FAILED(pRtrn->SetCopy(m_pCachedValues[atom.GetIndex()].GetRef()));
             return S_OK;
         }
 
@@ -2001,11 +2715,15 @@ HRESULT OverrideResolver::SetQualifier(_In_ PCWSTR pQualifierName, _In_ PCWSTR p
 
 HRESULT OverrideResolver::SetQualifier(_In_ Atom qualifier, _In_ PCWSTR pNewValue)
 {
-    (void)Reset(&qualifier, 1);
+    AutoReaderWriterLock autoLock(&m_srwQualifierValuesLock);
+
+    // Store the new value before starting a new generation, so that lookups in the new generation never see the old one.
+    m_pQualifiers->ResetCache(qualifier);
+    RETURN_IF_FAILED(m_pQualifiers->SetQualifierValue(qualifier, pNewValue, true));
 
     // Once Resolver has its unique value, it will have its own score cache.
     m_bHasScoreCache = true;
-    RETURN_IF_FAILED(m_pQualifiers->SetQualifierValue(qualifier, pNewValue, true));
+    (void)ResolverBase::Reset(&qualifier, 1);
 
     return S_OK;
 }
@@ -2015,14 +2733,13 @@ HRESULT OverrideResolver::OverrideToMatch(_In_ const IQualifierSet* /*pQualifier
 void OverrideResolver::Reset()
 {
     AutoReaderWriterLock autoLock(&m_srwQualifierValuesLock);
+    m_pQualifiers->ResetCache();
     ResolverBase::Reset();
     if (!m_bIsDifferentQualifierValueFromParent)
     {
         m_bHasScoreCache =
             false; // once per thread resolver is reset, it can share the same score cache with process as long as scale value is same
     }
-
-    m_pQualifiers->ResetCache();
 }
 
 HRESULT OverrideResolver::Reset(_In_reads_(numQualifierNames) Atom* pQualifierNames, _In_ int numQualifierNames)
@@ -2030,7 +2747,6 @@ HRESULT OverrideResolver::Reset(_In_reads_(numQualifierNames) Atom* pQualifierNa
     RETURN_HR_IF_NULL(E_INVALIDARG, pQualifierNames);
 
     AutoReaderWriterLock autoLock(&m_srwQualifierValuesLock);
-    RETURN_IF_FAILED(ResolverBase::Reset(pQualifierNames, numQualifierNames));
 
     bool badPool = false;
 
@@ -2053,6 +2769,9 @@ HRESULT OverrideResolver::Reset(_In_reads_(numQualifierNames) Atom* pQualifierNa
         }
     }
 
+    // Start the new generation only once the old values are gone.
+    RETURN_IF_FAILED(ResolverBase::Reset(pQualifierNames, numQualifierNames));
+
     RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_MRM_INVALID_FILE_TYPE), badPool);
 
     return S_OK;
@@ -2132,6 +2851,21 @@ HRESULT OverrideResolver::EvaluateDecision(
     return m_pParent->EvaluateDecision(pDecision, numResults, pResultIndexesOut, pResultSetIndexesOut);
 }
 
+HRESULT OverrideResolver::EvaluateDecisions(
+    _In_ int numDecisions,
+    _In_reads_(numDecisions) const IDecision* const* ppDecisions,
+    _Out_writes_(numDecisions) int* pResultIndexesOut,
+    _Out_writes_(numDecisions) int* pResultSetIndexesOut,
+    _Out_writes_opt_(numDecisions) HRESULT* pResultsOut) const
+{
+    if (m_bHasScoreCache)
+    {
+        return ResolverBase::EvaluateDecisions(numDecisions, ppDecisions, pResultIndexesOut, pResultSetIndexesOut, pResultsOut);
+    }
+    // OverrideResolver has ProviderResolver as parent all the time
+    return m_pParent->EvaluateDecisions(numDecisions, ppDecisions, pResultIndexesOut, pResultSetIndexesOut, pResultsOut);
+}
+
 HRESULT OverrideResolver::EvaluateQualifierSet(
     _In_ const IQualifierSet* pQualifierSet,
     _Out_ bool* pbIsMatchOut,
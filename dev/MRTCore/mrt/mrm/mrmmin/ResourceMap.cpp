@@ -355,7 +355,8 @@ public:
             RETURN_IF_FAILED(pDataSection->GetItemDataRef(itemIndex, &blob));
 
             // It prepend the file full path if the valueType is 'Path'
-            return GetDataAsString(&blob, valueType, fileIndex, pStringOut);
+            return GetDataAsString(
+                &blob, valueType, fileIndex, pStringOut, m_pSectionResolver->GetDecodedStringCache(fileIndex), sectionIndex, itemIndex);
         }
 
         return HRESULT_FROM_WIN32(ERROR_NOT_FOUND);
@@ -412,11 +413,45 @@ public:
     }
 
 private:
+    // Decodes a data item to UTF-16, going through the file's decoded string cache if it has one.
+    static HRESULT DecodeDataItem(
+        _In_ BlobResult* pBlobResult,
+        _In_ DEFSTRING_ENCODING encoding,
+        _In_opt_ DecodedStringCache* pCache,
+        _In_ UINT16 sectionIndex,
+        _In_ UINT32 itemIndex,
+        _Inout_ StringResult* pStringOut)
+    {
+        if ((pCache == nullptr) || (encoding == DEFSTRING_ENCODING_UTF16))
+        {
+            // UTF-16 values are returned by reference, so there is nothing to save by caching them.
+            return GetStringResultFromBlobResult(pBlobResult, encoding, pStringOut);
+        }
+
+        if (pCache->TryGetString(sectionIndex, itemIndex, pStringOut))
+        {
+            return S_OK;
+        }
+
+        RETURN_IF_FAILED(GetStringResultFromBlobResult(pBlobResult, encoding, pStringOut));
+
+        size_t cchString;
+        if (SUCCEEDED(pStringOut->GetLength(&cchString)))
+        {
+            // A string that can't be cached is still a good result.
+            (void)pCache->AddString(sectionIndex, itemIndex, pStringOut->GetRef(), cchString + 1);
+        }
+        return S_OK;
+    }
+
     HRESULT GetDataAsString(
         _In_ BlobResult* pBlobResult,
         _In_ MrmEnvironment::ResourceValueType valueType,
         _In_ int fileIndex,
-        _Inout_ StringResult* pStringOut) const
+        _Inout_ StringResult* pStringOut,
+        _In_opt_ DecodedStringCache* pCache = nullptr,
+        _In_ UINT16 sectionIndex = 0,
+        _In_ UINT32 itemIndex = 0) const
     {
         if (MrmEnvironment::IsBinaryResourceValueType(valueType))
         {
@@ -424,14 +459,16 @@ private:
             return HRESULT_FROM_WIN32(ERROR_MRM_RESOURCE_TYPE_MISMATCH);
         }
 
+        DEFSTRING_ENCODING encoding = MrmEnvironment::MapResourceValueTypeToEncoding(valueType);
+
         if (!MrmEnvironment::IsPathResourceValueType(valueType) || m_packageRootPath.IsEmpty())
         {
-            return GetStringResultFromBlobResult(pBlobResult, MrmEnvironment::MapResourceValueTypeToEncoding(valueType), pStringOut);
+            return DecodeDataItem(pBlobResult, encoding, pCache, sectionIndex, itemIndex, pStringOut);
         }
 
         // It's a path, and we have a package root.  Prepare to concatenate.
         StringResult tmp;
-        RETURN_IF_FAILED(GetStringResultFromBlobResult(pBlobResult, MrmEnvironment::MapResourceValueTypeToEncoding(valueType), &tmp));
+        RETURN_IF_FAILED(DecodeDataItem(pBlobResult, encoding, pCache, sectionIndex, itemIndex, &tmp));
 
         bool absolutePath;
         RETURN_IF_FAILED(tmp.IsAbsolutePath(&absolutePath));
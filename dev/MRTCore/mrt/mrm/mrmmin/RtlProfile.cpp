@@ -162,6 +162,12 @@ public:
         return S_OK;
     }
 
+    // The language distance helper works on the whole list, so leave the value unsplit.
+    HRESULT ParseProviderValue(_In_opt_ PCWSTR pszProviderValue, _Outptr_ ParsedQualifierValue** result) const override
+    {
+        return ParsedQualifierValue::CreateInstance(pszProviderValue, result);
+    }
+
     int GetMaxQualifierEntries() const override { return 256; }
 
 protected:
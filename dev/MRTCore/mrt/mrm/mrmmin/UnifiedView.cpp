@@ -38,6 +38,7 @@ public:
 
         // file manager owns the ManagedFile
         // parent view owns the ManagedResourceMap
+        m_pFile->Unpin();
         m_pFile = nullptr;
         m_pPrimaryMap = nullptr;
     }
@@ -145,7 +146,10 @@ protected:
         m_bPriAttempted(false),
         m_bPrimaryMapAttempted(false),
         m_pProfile(pProfile)
-    {}
+    {
+        // The PRI file and the managed schemas and maps keep pointers into the file's sections.
+        m_pFile->Pin();
+    }
 
     UnifiedResourceView* m_pView;
     PriFile* m_pMyPri;
@@ -433,6 +437,96 @@ HRESULT UnifiedResourceView::GetOrAddReferencedFile(
     return S_OK;
 }
 
+static void RunManagedFilePreload(_Inout_opt_ PVOID pContext, _In_ ULONG index)
+{
+    // A failed load leaves the file unloaded, and loading it again reports the error.
+    (void)static_cast<ManagedFile**>(pContext)[index]->Load();
+}
+
+HRESULT UnifiedResourceView::PreloadPriFiles(
+    _In_ DynamicArray<StringResult*>* pFilePathsCollection,
+    _In_ LoadPriFlags flags,
+    _Inout_ DynamicArray<ManagedFile*>* pAddedFiles)
+{
+    UINT uiNumPriFiles = pFilePathsCollection->Count();
+    unique_deffree_ptr<ManagedFile*> pFiles(_DefArray_AllocZeroed(ManagedFile*, uiNumPriFiles));
+    RETURN_IF_NULL_ALLOC(pFiles.get());
+
+    // The file manager isn't thread-safe, so files are registered here and only loaded concurrently.
+    LONG numFiles = 0;
+    for (UINT uItr = 0; uItr < uiNumPriFiles; uItr++)
+    {
+        StringResult* pStrFilePath;
+        RETURN_IF_FAILED(pFilePathsCollection->Get(uItr, &pStrFilePath));
+        DEF_ASSERT(pStrFilePath && pStrFilePath->GetRef());
+
+        NormalizedFilePath path;
+        RETURN_IF_FAILED(path.Init(pStrFilePath->GetRef()));
+
+        StringResult root;
+        RETURN_IF_FAILED(ManagedFile::NormalizePackageRoot(path.GetRef(), nullptr, &root));
+
+        if (TryFindReferencedFile(path.GetRef(), root.GetRef(), nullptr, nullptr))
+        {
+            continue;
+        }
+
+        ManagedFile* pFile;
+        bool bAdded = FAILED(m_pFileManager->GetFile(&path, &pFile));
+        if (FAILED(m_pFileManager->GetOrAddFile(&path, root.GetRef(), flags & ~LoadPriFlags::Preload, &pFile)))
+        {
+            // LoadPriFiles stops at this file, so don't load any of the files after it.
+            break;
+        }
+
+        if (bAdded)
+        {
+            RETURN_IF_FAILED(pAddedFiles->Add(pFile));
+        }
+
+        bool bQueued = pFile->IsLoaded();
+        for (LONG i = 0; (i < numFiles) && !bQueued; i++)
+        {
+            bQueued = (pFiles.get()[i] == pFile);
+        }
+
+        if (!bQueued)
+        {
+            pFiles.get()[numFiles++] = pFile;
+        }
+    }
+
+    RETURN_IF_FAILED(_DefRunParallelForEach(static_cast<ULONG>(numFiles), MaxPreloadThreads, RunManagedFilePreload, pFiles.get()));
+
+    // Unregister the files that this call added and failed to load. LoadPriFiles then adds them again, which
+    // reports the failure through the usual path and leaves nothing registered.
+    for (UINT i = 0; i < pAddedFiles->Count(); i++)
+    {
+        ManagedFile* pFile;
+        RETURN_IF_FAILED(pAddedFiles->Get(i, &pFile));
+        if ((pFile != nullptr) && !pFile->IsLoaded())
+        {
+            RETURN_IF_FAILED(pAddedFiles->Set(i, nullptr));
+            RETURN_IF_FAILED(m_pFileManager->RemoveFile(pFile));
+        }
+    }
+
+    return S_OK;
+}
+
+void UnifiedResourceView::RemoveUnreferencedFiles(_In_ DynamicArray<ManagedFile*>* pAddedFiles)
+{
+    for (UINT i = 0; i < pAddedFiles->Count(); i++)
+    {
+        ManagedFile* pFile;
+        if (SUCCEEDED(pAddedFiles->Get(i, &pFile)) && (pFile != nullptr) &&
+            !TryFindReferencedFile(pFile->GetPath(), nullptr, nullptr, nullptr))
+        {
+            (void)m_pFileManager->RemoveFile(pFile);
+        }
+    }
+}
+
 HRESULT UnifiedResourceView::LoadPriFiles(
     _In_ MRMPROFILE_PHASE mrmProfilePhase,
     _In_ DynamicArray<StringResult*>* pFilePathsCollection,
@@ -444,6 +538,10 @@ HRESULT UnifiedResourceView::LoadPriFiles(
     RETURN_HR_IF(E_INVALIDARG, pFilePathsCollection->Count() < 1);
 
     UINT uiNumPriFiles = pFilePathsCollection->Count();
+    DynamicArray<ManagedFile*>* pPreloadedFiles;
+    RETURN_IF_FAILED(DynamicArray<ManagedFile*>::CreateInstance(uiNumPriFiles, &pPreloadedFiles));
+    auto deletePreloadedFiles = wil::scope_exit([&] { delete pPreloadedFiles; });
+
     DynamicArray<PriFileInfo*>* pUnifiedViewFileInfoCollection;
     RETURN_IF_FAILED(DynamicArray<PriFileInfo*>::CreateInstance(uiNumPriFiles, &pUnifiedViewFileInfoCollection));
 
@@ -459,8 +557,16 @@ HRESULT UnifiedResourceView::LoadPriFiles(
 
         delete pUnifiedViewFileInfoCollection;
         pUnifiedViewFileInfoCollection = nullptr;
+
+        // Don't leave files that were only registered for preloading, such as those after the failing
+        // one, loaded in the file manager.
+        RemoveUnreferencedFiles(pPreloadedFiles);
     });
 
+    // Open, map and validate the files up front. The loop below then finds them already loaded, and the
+    // schema checks and merges that follow stay on this thread.
+    RETURN_IF_FAILED(PreloadPriFiles(pFilePathsCollection, flags, pPreloadedFiles));
+
     HRESULT hr = S_OK;
     for (UINT uItr = 0; uItr < uiNumPriFiles; uItr++)
     {
@@ -653,6 +759,10 @@ HRESULT UnifiedResourceView::LoadPriFiles(
     cleanupOnFailure.release();
     *ppLoadedPriFilesInfo = pUnifiedViewFileInfoCollection;
 
+    // Loading is between lookups, so this is a safe point to get back under the residency budget. Going over
+    // it only costs memory, so a failed eviction doesn't fail the load.
+    (void)m_pFileManager->EnforceResidencyBudget();
+
     return S_OK;
 }
 
@@ -693,6 +803,9 @@ HRESULT UnifiedResourceView::RemoveFileReference(_In_ PCWSTR pPriPath)
     RETURN_IF_FAILED(m_pFileManager->UnloadFile(pFile));
     RETURN_IF_FAILED(RemoveReferencedFile(pFileInfo));
 
+    // The file is no longer pinned by this view, so files that it kept over the budget can go now.
+    (void)m_pFileManager->EnforceResidencyBudget();
+
     return S_OK;
 }
 
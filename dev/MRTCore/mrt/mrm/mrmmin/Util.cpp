@@ -4,6 +4,12 @@
 #include "mrm/common/BaseInternal.h"
 #include "mrm/common/Base.h"
 
+#if defined(_M_IX86) || defined(_M_X64)
+#include <emmintrin.h>
+#elif defined(_M_ARM64)
+#include <arm64_neon.h>
+#endif
+
 BOOLEAN
 DefString_IsEmpty(__in PCWSTR pSelf) { return ((!pSelf) || (!pSelf[0])); }
 
@@ -257,6 +263,115 @@ DefString_ChooseBestEncoding(_In_ PCWSTR pszStringUtf16)
     }
 }
 
+// Widens bytes to UTF-16 code units 16 at a time and returns how many were widened. If stopAtNonAscii is set, stops
+// at the first block that contains a byte above 0x7F. Leaves any remainder of less than a block to the caller.
+static size_t _DefString_WidenBlocks(
+    _In_reads_(cbSrc) const unsigned char* pSrc,
+    _In_ size_t cbSrc,
+    _Out_writes_to_(cbSrc, return) WCHAR* pDest,
+    _In_ bool stopAtNonAscii)
+{
+    size_t i = 0;
+#if defined(_M_IX86) || defined(_M_X64)
+    const __m128i zero = _mm_setzero_si128();
+    for (; (i + 16) <= cbSrc; i += 16)
+    {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + i));
+        if (stopAtNonAscii && (_mm_movemask_epi8(bytes) != 0))
+        {
+            break;
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDest + i), _mm_unpacklo_epi8(bytes, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDest + i + 8), _mm_unpackhi_epi8(bytes, zero));
+    }
+#elif defined(_M_ARM64)
+    for (; (i + 16) <= cbSrc; i += 16)
+    {
+        uint8x16_t bytes = vld1q_u8(pSrc + i);
+        if (stopAtNonAscii && (vmaxvq_u8(bytes) > ASCII_BOUNDARY))
+        {
+            break;
+        }
+        vst1q_u16(reinterpret_cast<uint16_t*>(pDest + i), vmovl_u8(vget_low_u8(bytes)));
+        vst1q_u16(reinterpret_cast<uint16_t*>(pDest + i + 8), vmovl_u8(vget_high_u8(bytes)));
+    }
+#else
+    UNREFERENCED_PARAMETER(pSrc);
+    UNREFERENCED_PARAMETER(cbSrc);
+    UNREFERENCED_PARAMETER(pDest);
+    UNREFERENCED_PARAMETER(stopAtNonAscii);
+#endif
+    return i;
+}
+
+// Decodes one multi-byte UTF-8 sequence starting at pSrc. Returns the number of bytes consumed, or 0 if the sequence
+// is not well-formed (overlong forms, surrogates, values above U+10FFFF, bad continuation bytes or truncation), per
+// table 3-7 of the Unicode standard.
+static size_t _DefString_DecodeUtf8Sequence(_In_reads_(cbAvailable) const unsigned char* pSrc, _In_ size_t cbAvailable, _Out_ UINT32* pCodePoint)
+{
+    unsigned char lead = pSrc[0];
+    unsigned char minSecond = 0x80;
+    unsigned char maxSecond = 0xBF;
+    size_t cbSequence;
+    UINT32 codePoint;
+
+    *pCodePoint = 0;
+
+    if ((lead >= 0xC2) && (lead <= 0xDF))
+    {
+        cbSequence = 2;
+        codePoint = lead & 0x1F;
+    }
+    else if ((lead >= 0xE0) && (lead <= 0xEF))
+    {
+        cbSequence = 3;
+        codePoint = lead & 0x0F;
+        if (lead == 0xE0)
+        {
+            minSecond = 0xA0; // Overlong
+        }
+        else if (lead == 0xED)
+        {
+            maxSecond = 0x9F; // Surrogates
+        }
+    }
+    else if ((lead >= 0xF0) && (lead <= 0xF4))
+    {
+        cbSequence = 4;
+        codePoint = lead & 0x07;
+        if (lead == 0xF0)
+        {
+            minSecond = 0x90; // Overlong
+        }
+        else if (lead == 0xF4)
+        {
+            maxSecond = 0x8F; // Above U+10FFFF
+        }
+    }
+    else
+    {
+        return 0;
+    }
+
+    if ((cbAvailable < cbSequence) || (pSrc[1] < minSecond) || (pSrc[1] > maxSecond))
+    {
+        return 0;
+    }
+
+    codePoint = (codePoint << 6) | (pSrc[1] & 0x3F);
+    for (size_t i = 2; i < cbSequence; i++)
+    {
+        if ((pSrc[i] & 0xC0) != 0x80)
+        {
+            return 0;
+        }
+        codePoint = (codePoint << 6) | (pSrc[i] & 0x3F);
+    }
+
+    *pCodePoint = codePoint;
+    return cbSequence;
+}
+
 // Converts an ASCII encoded string into a UTF-16-encoded one.
 // Returns NULL on failure.
 
@@ -280,29 +395,31 @@ DefString_ConvertAsciiToUtf16(
         return E_OUTOFMEMORY;
     }
 
-    for (size_t i = 0; i < cchStringAsciiIncludingNull; i++)
-    {
-
-        // Since we control who creates these strings we don't test for them being ASCII here for performance reasons.
-        // Even if they are not, they will convert up cleanly if they are ANSI and will convert into garbage but won't
-        // produce a failure if they are UTF-8 or garbage to begin with. We will never read over the end of the buffer
-        // or do other truly bad things so the extra check is not worth it.
-        // We still do the check on debug builds to catch any potential violations of the "is always ASCII in the PRI file"
-        // invariant or other bugs.
+    // Since we control who creates these strings we don't test for them being ASCII here for performance reasons.
+    // Even if they are not, they will convert up cleanly if they are ANSI and will convert into garbage but won't
+    // produce a failure if they are UTF-8 or garbage to begin with. We will never read over the end of the buffer
+    // or do other truly bad things so the extra check is not worth it.
+    // We still do the check on debug builds to catch any potential violations of the "is always ASCII in the PRI file"
+    // invariant or other bugs.
 
 #ifdef DBG
-
+    for (size_t i = 0; i < cchStringAsciiIncludingNull; i++)
+    {
         if (((unsigned char)pszStringAscii[i]) > ASCII_BOUNDARY)
         {
 
             _DefFree(pszRet);
             return E_INVALIDARG;
         }
+    }
 #endif
 
-        // Even though this compiles without the cast, the cast is critical to avoid the compiler doing sign extension
-        // when the string isn't ASCII.
-        pszRet[i] = (unsigned char)(pszStringAscii[i]);
+    const unsigned char* pSrc = reinterpret_cast<const unsigned char*>(pszStringAscii);
+    size_t i = _DefString_WidenBlocks(pSrc, cchStringAsciiIncludingNull, pszRet, false);
+    for (; i < cchStringAsciiIncludingNull; i++)
+    {
+        // Reading through unsigned char is critical to avoid the compiler doing sign extension when the string isn't ASCII.
+        pszRet[i] = pSrc[i];
     }
 
     *result = pszRet;
@@ -310,7 +427,9 @@ DefString_ConvertAsciiToUtf16(
     return S_OK;
 }
 
-// Converts an UTF-8 encoded string into a UTF-16-encoded one.
+// Converts an UTF-8 encoded string into a UTF-16-encoded one in a single pass, rejecting the same ill-formed input as
+// MultiByteToWideChar with MB_ERR_INVALID_CHARS. The result buffer is sized for the worst case (one UTF-16 code unit
+// per byte), so it may be larger than *cchStringUtf16IncludingNull.
 // Returns NULL on failure.
 HRESULT
 DefString_ConvertUtf8ToUtf16(
@@ -325,33 +444,105 @@ DefString_ConvertUtf8ToUtf16(
 
     *cchStringUtf16IncludingNull = 0;
 
-    int cchStringUtf16IncludingNullLocal =
-        MultiByteToWideChar(CP_UTF8, MB_ERR_INVALID_CHARS, pszStringUtf8, (int)cbStringUtf8IncludingNull, nullptr, 0);
-    if (cchStringUtf16IncludingNullLocal == 0)
-    {
-        return HRESULT_FROM_WIN32(GetLastError());
-    }
-
-    PWSTR pszRet = _DefArray_Alloc(WCHAR, cchStringUtf16IncludingNullLocal);
+    // Every UTF-8 sequence decodes to no more UTF-16 code units than it has bytes.
+    PWSTR pszRet = _DefArray_Alloc(WCHAR, cbStringUtf8IncludingNull);
     if (pszRet == nullptr)
     {
         return E_OUTOFMEMORY;
     }
 
-    cchStringUtf16IncludingNullLocal = MultiByteToWideChar(
-        CP_UTF8, MB_ERR_INVALID_CHARS, pszStringUtf8, (int)cbStringUtf8IncludingNull, pszRet, cchStringUtf16IncludingNullLocal);
-    if (cchStringUtf16IncludingNullLocal == 0)
+    const unsigned char* pSrc = reinterpret_cast<const unsigned char*>(pszStringUtf8);
+    size_t iSrc = 0;
+    size_t iDest = 0;
+    while (iSrc < cbStringUtf8IncludingNull)
     {
-        _DefFree(pszRet);
-        return HRESULT_FROM_WIN32(GetLastError());
+        if (pSrc[iSrc] <= ASCII_BOUNDARY)
+        {
+            // Localized strings are often mostly ASCII, so widen whole runs of it at once.
+            size_t cchWidened = _DefString_WidenBlocks(&pSrc[iSrc], cbStringUtf8IncludingNull - iSrc, &pszRet[iDest], true);
+            iSrc += cchWidened;
+            iDest += cchWidened;
+            while ((iSrc < cbStringUtf8IncludingNull) && (pSrc[iSrc] <= ASCII_BOUNDARY))
+            {
+                pszRet[iDest++] = pSrc[iSrc++];
+            }
+            continue;
+        }
+
+        UINT32 codePoint;
+        size_t cbSequence = _DefString_DecodeUtf8Sequence(&pSrc[iSrc], cbStringUtf8IncludingNull - iSrc, &codePoint);
+        if (cbSequence == 0)
+        {
+            _DefFree(pszRet);
+            return HRESULT_FROM_WIN32(ERROR_NO_UNICODE_TRANSLATION);
+        }
+        iSrc += cbSequence;
+
+        if (codePoint >= UTF_16_SUPPLEMENTARY_PLANES_START)
+        {
+            codePoint -= UTF_16_SUPPLEMENTARY_PLANES_START;
+            pszRet[iDest++] = static_cast<WCHAR>(UTF_16_LEAD_SURROGATE_MIN_VALUE + (codePoint >> 10));
+            pszRet[iDest++] = static_cast<WCHAR>(UTF_16_TRAIL_SURROGATE_MIN_VALUE + (codePoint & 0x3FF));
+        }
+        else
+        {
+            pszRet[iDest++] = static_cast<WCHAR>(codePoint);
+        }
     }
 
-    *cchStringUtf16IncludingNull = cchStringUtf16IncludingNullLocal;
+    *cchStringUtf16IncludingNull = iDest;
 
     *result = pszRet;
     return S_OK;
 }
 
+// Narrows a UTF-16 string that only holds ASCII characters, as chosen by DefString_ChooseBestEncoding.
+// Returns E_INVALIDARG without a usable result if any character is above 0x7F.
+HRESULT
+DefString_ConvertUtf16ToAscii(
+    _In_reads_(cchString) PCWSTR pszStringUtf16,
+    _In_ size_t cchString,
+    _Out_writes_(cchString) PSTR pszStringAscii)
+{
+    size_t i = 0;
+#if defined(_M_IX86) || defined(_M_X64)
+    const __m128i nonAsciiMask = _mm_set1_epi16(static_cast<short>(0xFF80));
+    const __m128i zero = _mm_setzero_si128();
+    for (; (i + 16) <= cchString; i += 16)
+    {
+        __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pszStringUtf16 + i));
+        __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pszStringUtf16 + i + 8));
+        __m128i nonAscii = _mm_and_si128(_mm_or_si128(low, high), nonAsciiMask);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(nonAscii, zero)) != 0xFFFF)
+        {
+            return E_INVALIDARG;
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pszStringAscii + i), _mm_packus_epi16(low, high));
+    }
+#elif defined(_M_ARM64)
+    for (; (i + 16) <= cchString; i += 16)
+    {
+        uint16x8_t low = vld1q_u16(reinterpret_cast<const uint16_t*>(pszStringUtf16 + i));
+        uint16x8_t high = vld1q_u16(reinterpret_cast<const uint16_t*>(pszStringUtf16 + i + 8));
+        if (vmaxvq_u16(vorrq_u16(low, high)) > ASCII_BOUNDARY)
+        {
+            return E_INVALIDARG;
+        }
+        vst1q_u8(reinterpret_cast<uint8_t*>(pszStringAscii + i), vcombine_u8(vmovn_u16(low), vmovn_u16(high)));
+    }
+#endif
+    for (; i < cchString; i++)
+    {
+        if (pszStringUtf16[i] > ASCII_BOUNDARY)
+        {
+            return E_INVALIDARG;
+        }
+        pszStringAscii[i] = static_cast<char>(pszStringUtf16[i]);
+    }
+
+    return S_OK;
+}
+
 DEFCOMPARISON
 DefBlob_Compare(__in const void* pSelf, __in const void* pOther, __in size_t cbCmp)
 {